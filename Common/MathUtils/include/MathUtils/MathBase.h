@@ -14,7 +14,10 @@
 /// \file   MathBase.h
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <vector>
 
 #include "Rtypes.h"
 #include "TLinearFitter.h"
@@ -158,6 +161,143 @@ namespace mathBase {
   
   }
 
+  /// struct for returning the parameters of fitGausBatch
+  struct GausFitResult {
+    double mConstant{0}; ///< constant of the gaussian
+    double mMean{0};     ///< mean of the gaussian
+    double mSigma{0};    ///< sigma of the gaussian
+    double mSum{0};      ///< sum of all bins
+    double mChi2{-4};    ///< chi2 or exit code, see fitGaus
+  };
+
+  /// reentrant fast fit of many histograms with gaussian functions
+  ///
+  /// Same procedure, conditions and exit codes as fitGaus. The weighted
+  /// parabola fit of the logarithm is solved directly with its normal
+  /// equations, so no ROOT objects and no static state are used and the
+  /// function can be called from several threads. The sums over the bins are
+  /// branch free, bins with less than two entries get a weight of zero, to let
+  /// the compiler vectorise them.
+  ///
+  /// \param[in]  arr         nHistograms histograms of nBins bins, one after the other
+  /// \param[in]  nHistograms number of histograms
+  /// \param[in]  nBins       number of bins of each histogram
+  /// \param[in]  xMin        minimum range of the histograms
+  /// \param[in]  xMax        maximum range of the histograms
+  /// \param[out] results     fit results, nHistograms elements
+  template <typename T>
+  void fitGausBatch(const T* arr, const size_t nHistograms, const size_t nBins, const double xMin, const double xMax, GausFitResult* results)
+  {
+    // same tolerance as the default one of TMatrixD used in fitGaus
+    constexpr double kTol = std::numeric_limits<double>::epsilon();
+    const double binWidth = (xMax - xMin) / double(nBins);
+    // the fit uses the bin centres u in units of bins relative to the histogram centre x0, x = x0 + u * binWidth
+    const double uOffset = 0.5 - 0.5 * double(nBins);
+    const double x0 = 0.5 * (xMin + xMax);
+
+    for (size_t ihist = 0; ihist < nHistograms; ++ihist) {
+      const T* hist = arr + ihist * nBins;
+      GausFitResult& result = results[ihist];
+      result = GausFitResult();
+      if (nBins == 0) {
+        continue;
+      }
+
+      double entries = 0, entries2 = 0, max = hist[0];
+      double s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+      double sy = 0, suy = 0, su2y = 0;
+      size_t npoints = 0;
+      for (size_t ibin = 0; ibin < nBins; ++ibin) {
+        const double entriesI = hist[ibin];
+        entries += entriesI;
+        entries2 += entriesI * entriesI;
+        max = std::max(max, entriesI);
+
+        // points with error 1/sqrt(entries) enter with the weight entries
+        const double w = (entriesI > 1) ? entriesI : 0.;
+        const double y = std::log(std::max(entriesI, 1.));
+        const double u = double(ibin) + uOffset;
+        const double wu = w * u;
+        const double wu2 = wu * u;
+        s0 += w;
+        s1 += wu;
+        s2 += wu2;
+        s3 += wu2 * u;
+        s4 += wu2 * u * u;
+        sy += w * y;
+        suy += wu * y;
+        su2y += wu2 * y;
+        npoints += (entriesI > 1);
+      }
+
+      const double meanEntries = entries / double(nBins);
+      const double rms = std::sqrt(std::abs(entries2 / double(nBins) - meanEntries * meanEntries));
+      if (max < 4 || entries < 12 || rms < kTol) {
+        continue;
+      }
+      result.mSum = entries;
+
+      if (npoints >= 3) {
+        // solve the normal equations of ln(y) = a + b*u + c*u^2 with Cramer's rule
+        const double m00 = s2 * s4 - s3 * s3;
+        const double m01 = s1 * s4 - s2 * s3;
+        const double m02 = s1 * s3 - s2 * s2;
+        const double det = s0 * m00 - s1 * m01 + s2 * m02;
+        if (std::abs(det) < kTol) {
+          continue;
+        }
+        const double a = (sy * m00 - suy * m01 + su2y * m02) / det;
+        const double b = (s0 * (suy * s4 - su2y * s3) - s1 * (sy * s4 - su2y * s2) + s2 * (sy * s3 - suy * s2)) / det;
+        const double c = (s0 * (s2 * su2y - s3 * suy) - s1 * (s1 * su2y - s3 * sy) + s2 * (s1 * suy - s2 * sy)) / det;
+
+        // coefficients of the parabola in x
+        const double p2 = c / (binWidth * binWidth);
+        const double p1 = b / binWidth - 2. * p2 * x0;
+        if (std::abs(p1) < kTol || std::abs(p2) < kTol) {
+          continue;
+        }
+
+        const double meanU = -b / (2. * c);
+        const double lnConstant = a + b * meanU + c * meanU * meanU;
+        if (lnConstant > 307) {
+          continue;
+        }
+        result.mConstant = std::exp(lnConstant);
+        result.mMean = x0 + meanU * binWidth;
+        result.mSigma = binWidth / std::sqrt(std::abs(2. * c));
+        if (npoints == 3) {
+          result.mChi2 = -3.;
+        } else {
+          // the chi2 is summed from the residuals in a second pass, rather than expanded in the sums above,
+          // which would subtract large and nearly equal numbers for histograms with many bins
+          double chi2 = 0;
+          for (size_t ibin = 0; ibin < nBins; ++ibin) {
+            const double entriesI = hist[ibin];
+            const double w = (entriesI > 1) ? entriesI : 0.;
+            const double u = double(ibin) + uOffset;
+            const double residual = std::log(std::max(entriesI, 1.)) - (a + (b + c * u) * u);
+            chi2 += w * residual * residual;
+          }
+          result.mChi2 = chi2 / double(npoints);
+        }
+      } else if (npoints == 2) {
+        // use center of gravity for 2 points
+        const double meanU = s1 / s0;
+        result.mConstant = max;
+        result.mMean = x0 + meanU * binWidth;
+        result.mSigma = binWidth * std::sqrt(std::abs(s2 / s0 - meanU * meanU));
+        result.mChi2 = -2.;
+      } else if (npoints == 1) {
+        result.mConstant = max;
+        result.mMean = x0 + s1 / s0 * binWidth;
+        result.mSigma = binWidth / std::sqrt(12.);
+        result.mChi2 = -1.;
+      } else {
+        result.mChi2 = 0.;
+      }
+    }
+  }
+
   /// struct for returning statistical parameters
   ///
   /// \todo make type templated?
@@ -22,6 +22,9 @@
 #pragma link C++ function o2::mathUtils::mathBase::fitGaus < float > ;
 #pragma link C++ function o2::mathUtils::mathBase::fitGaus < double > ;
 
+#pragma link C++ function o2::mathUtils::mathBase::fitGausBatch < float > ;
+#pragma link C++ function o2::mathUtils::mathBase::fitGausBatch < double > ;
+
 #pragma link C++ function o2::mathUtils::mathBase::getStatisticsData < float > ;
 #pragma link C++ function o2::mathUtils::mathBase::getStatisticsData < double > ;
 #pragma link C++ function o2::mathUtils::mathBase::getStatisticsData < short > ;
@@ -0,0 +1,97 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmark_FitGaus.cxx
+/// \brief Benchmark of the gaussian fits of many pedestal like spectra
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <future>
+#include <random>
+#include <vector>
+
+#include "MathUtils/MathBase.h"
+
+using namespace o2::mathUtils::mathBase;
+
+namespace
+{
+constexpr size_t NChannels = 500000;
+constexpr size_t NBins = 64;
+constexpr float XMin = 0.f;
+constexpr float XMax = float(NBins);
+
+/// spectra of all channels, one after the other, with 200 entries around a random pedestal
+const std::vector<float>& getSpectra()
+{
+  static std::vector<float> spectra = []() {
+    std::vector<float> data(NChannels * NBins);
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> pedestal(20.f, 40.f);
+    std::uniform_real_distribution<float> noise(1.f, 3.f);
+    for (size_t channel = 0; channel < NChannels; ++channel) {
+      std::normal_distribution<float> adc(pedestal(generator), noise(generator));
+      for (int entry = 0; entry < 200; ++entry) {
+        const int bin = int(adc(generator));
+        if (bin >= 0 && bin < int(NBins)) {
+          data[channel * NBins + bin] += 1.f;
+        }
+      }
+    }
+    return data;
+  }();
+  return spectra;
+}
+} // namespace
+
+// Fit of all channels one by one with the TLinearFitter based fitGaus
+static void BM_fitGaus(benchmark::State& state)
+{
+  const auto& spectra = getSpectra();
+  std::vector<float> param;
+  for (auto _ : state) {
+    for (size_t channel = 0; channel < NChannels; ++channel) {
+      benchmark::DoNotOptimize(fitGaus(NBins, spectra.data() + channel * NBins, XMin, XMax, param));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NChannels);
+}
+
+// Fit of all channels with fitGausBatch, split in blocks over state.range(0) threads
+static void BM_fitGausBatch(benchmark::State& state)
+{
+  const auto& spectra = getSpectra();
+  const size_t nThreads = state.range(0);
+  const size_t channelsPerThread = (NChannels + nThreads - 1) / nThreads;
+  std::vector<GausFitResult> results(NChannels);
+  auto fitChannels = [&](size_t thread) {
+    const size_t first = std::min(NChannels, thread * channelsPerThread);
+    const size_t last = std::min(NChannels, first + channelsPerThread);
+    fitGausBatch(spectra.data() + first * NBins, last - first, NBins, XMin, XMax, results.data() + first);
+  };
+  for (auto _ : state) {
+    std::vector<std::future<void>> workers;
+    for (size_t thread = 1; thread < nThreads; ++thread) {
+      workers.emplace_back(std::async(std::launch::async, fitChannels, thread));
+    }
+    fitChannels(0);
+    for (auto& worker : workers) {
+      worker.get();
+    }
+    benchmark::DoNotOptimize(results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * NChannels);
+}
+
+BENCHMARK(BM_fitGaus)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_fitGausBatch)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,102 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test MathBase
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "MathUtils/MathBase.h"
+
+#include <random>
+#include <vector>
+
+using namespace o2::mathUtils::mathBase;
+
+BOOST_AUTO_TEST_CASE(FitGausBatch_test)
+{
+  const size_t nHistograms = 200;
+  const size_t nBins = 50;
+  const float xMin = -5.f;
+  const float xMax = 20.f;
+
+  // gaussian spectra with increasing statistics, the first ones with too few
+  // entries, plus spectra with one and two filled bins
+  std::vector<float> histograms(nHistograms * nBins);
+  std::mt19937 generator(1);
+  for (size_t ihist = 0; ihist < nHistograms - 2; ++ihist) {
+    std::normal_distribution<float> gaus(2. + ihist * 0.05, 0.5 + ihist * 0.01);
+    for (size_t entry = 0; entry < 5 * ihist; ++entry) {
+      const float x = gaus(generator);
+      if (x >= xMin && x < xMax) {
+        histograms[ihist * nBins + size_t((x - xMin) / (xMax - xMin) * nBins)] += 1.f;
+      }
+    }
+  }
+  histograms[(nHistograms - 2) * nBins + 10] = 20.f;
+  histograms[(nHistograms - 1) * nBins + 10] = 20.f;
+  histograms[(nHistograms - 1) * nBins + 11] = 10.f;
+
+  std::vector<GausFitResult> results(nHistograms);
+  fitGausBatch(histograms.data(), nHistograms, nBins, xMin, xMax, results.data());
+
+  // same results as the TLinearFitter based fit, up to the numerical precision
+  std::vector<float> param;
+  for (size_t ihist = 0; ihist < nHistograms; ++ihist) {
+    const double chi2 = fitGaus(nBins, histograms.data() + ihist * nBins, xMin, xMax, param);
+    const auto& result = results[ihist];
+    BOOST_CHECK_CLOSE(result.mChi2, chi2, 0.1);
+    BOOST_CHECK_CLOSE(result.mSum, double(param[3]), 1e-4);
+    if (chi2 != -4) {
+      BOOST_CHECK_CLOSE(result.mConstant, double(param[0]), 1e-2);
+      BOOST_CHECK_CLOSE(result.mMean, double(param[1]), 1e-2);
+      BOOST_CHECK_CLOSE(result.mSigma, double(param[2]), 1e-2);
+    }
+  }
+
+  BOOST_CHECK_EQUAL(results[0].mChi2, -4);
+  BOOST_CHECK_EQUAL(results[nHistograms - 2].mChi2, -1);
+  BOOST_CHECK_EQUAL(results[nHistograms - 1].mChi2, -2);
+  BOOST_CHECK_CLOSE(results[nHistograms - 3].mMean, 2. + (nHistograms - 3) * 0.05, 5.);
+}
+
+BOOST_AUTO_TEST_CASE(FitGausBatchWide_test)
+{
+  // wide histograms with high statistics, where the chi2 is small compared to the sums of the fit
+  const size_t nHistograms = 20;
+  const size_t nBins = 1024;
+  const float xMin = 0.f;
+  const float xMax = 50.f;
+
+  std::vector<float> histograms(nHistograms * nBins);
+  std::mt19937 generator(2);
+  for (size_t ihist = 0; ihist < nHistograms; ++ihist) {
+    std::normal_distribution<float> gaus(10. + ihist, 1. + ihist * 0.1);
+    for (size_t entry = 0; entry < 200000; ++entry) {
+      const float x = gaus(generator);
+      if (x >= xMin && x < xMax) {
+        histograms[ihist * nBins + size_t((x - xMin) / (xMax - xMin) * nBins)] += 1.f;
+      }
+    }
+  }
+
+  std::vector<GausFitResult> results(nHistograms);
+  fitGausBatch(histograms.data(), nHistograms, nBins, xMin, xMax, results.data());
+
+  std::vector<float> param;
+  for (size_t ihist = 0; ihist < nHistograms; ++ihist) {
+    const double chi2 = fitGaus(nBins, histograms.data() + ihist * nBins, xMin, xMax, param);
+    const auto& result = results[ihist];
+    BOOST_CHECK_GT(chi2, 0.);
+    BOOST_CHECK_CLOSE(result.mChi2, chi2, 0.1);
+    BOOST_CHECK_CLOSE(result.mConstant, double(param[0]), 1e-2);
+    BOOST_CHECK_CLOSE(result.mMean, double(param[1]), 1e-2);
+    BOOST_CHECK_CLOSE(result.mSigma, double(param[2]), 1e-2);
+  }
+}
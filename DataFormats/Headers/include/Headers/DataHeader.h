@@ -458,6 +458,75 @@ struct BaseHeader
   }
 };
 
+//__________________________________________________________________________________________________
+/// @struct HeaderIndex
+/// @brief optional index of the headers in a stack
+///
+/// Maps the header types of a stack to the position of their first occurrence,
+/// so that get() finds a header without walking the stack. Stack builds it on
+/// request right after the first header (see Stack::WithIndex). The offsets are
+/// relative to the index, which keeps it valid when the stack is copied into
+/// another one; headers not covered by the index, e.g. appended later or beyond
+/// the capacity, are found by walking on from the last covered header.
+/// @ingroup aliceo2_dataformats_dataheader
+struct HeaderIndex : public BaseHeader {
+  //static data for this header type/version
+  static const uint32_t sVersion;
+  static const o2::header::HeaderType sHeaderType;
+  static const o2::header::SerializationMethod sSerializationMethod;
+  static constexpr uint32_t sMaxEntries = 8;
+
+  struct Entry {
+    HeaderType description;
+    int64_t offset; /// of the header, relative to the index
+  };
+
+  /// number of indexed header types
+  uint32_t nEntries;
+
+  /// offset of the last header covered by the index, relative to the index
+  int32_t lastOffset;
+
+  Entry entries[sMaxEntries];
+
+  HeaderIndex(); ///ctor
+
+  /// add the next header of the stack
+  /// @return false if the header could not be covered, the following headers must then not be added
+  bool add(const BaseHeader* header);
+
+  /// find the first header of a type in the stack of this index
+  const BaseHeader* find(HeaderType type) const
+  {
+    for (uint32_t entry = 0; entry < nEntries; ++entry) {
+      if (entries[entry].description == type) {
+        return at(entries[entry].offset);
+      }
+    }
+    const BaseHeader* current = at(lastOffset);
+    while ((current = current->next())) {
+      if (current->description == type) {
+        return current;
+      }
+    }
+    return nullptr;
+  }
+
+  /// typed version of find, use like this:
+  /// const NameHeader<0>* h = index->get<NameHeader<0>>()
+  template <typename T>
+  const T* get() const
+  {
+    return reinterpret_cast<const T*>(find(T::sHeaderType));
+  }
+
+ private:
+  const BaseHeader* at(int64_t offset) const
+  {
+    return reinterpret_cast<const BaseHeader*>(reinterpret_cast<const o2::byte*>(this) + offset);
+  }
+};
+
 /// find a header of type HeaderType in a buffer
 /// use like this:
 /// HeaderType* h = get<HeaderType*>(buffer)
@@ -475,6 +544,9 @@ auto get(const o2::byte* buffer, size_t /*len*/ = 0)
   while ((current = current->next())) {
     if (current->description == HeaderValueType::sHeaderType)
       return reinterpret_cast<HeaderConstPtrType>(current);
+    // the headers before the index did not match, it knows the position of the following ones
+    if (current->description == HeaderIndex::sHeaderType)
+      return reinterpret_cast<HeaderConstPtrType>(static_cast<const HeaderIndex*>(current)->find(HeaderValueType::sHeaderType));
   }
   return HeaderConstPtrType{ nullptr };
 }
@@ -13,6 +13,9 @@
 #include "MemoryResources/MemoryResources.h"
 #include "Headers/DataHeader.h"
 
+#include <cstring>
+#include <new>
+
 namespace o2
 {
 namespace header
@@ -31,6 +34,8 @@ namespace header
 //    Stack::Stack(const T& header1, const T& header2, ...)
 //    - arguments can be headers, or stacks, all will be concatenated in a new Stack
 ///   - returns a Stack ready to be shipped.
+///   - with Stack::WithIndex{} as first argument a HeaderIndex is added after the
+///     first header, get() then finds the headers independently of the stack depth
 struct Stack {
 
   using memory_resource = o2::pmr::memory_resource;
@@ -53,6 +58,10 @@ struct Stack {
   Stack& operator=(Stack&) = delete;
   Stack& operator=(Stack&&) = default;
 
+  /// tag for the constructors adding a HeaderIndex to the stack
+  struct WithIndex {
+  };
+
   value_type* data() const { return buffer.get(); }
   size_t size() const { return bufferSize; }
   allocator_type get_allocator() const { return allocator; }
@@ -66,7 +75,9 @@ struct Stack {
   /// all headers must derive from BaseHeader, in addition also other stacks can be passed to ctor.
   template <typename FirstArgType, typename... Headers,
             typename std::enable_if_t<
-              !std::is_convertible<FirstArgType, boost::container::pmr::polymorphic_allocator<o2::byte>>::value, int> = 0>
+              !std::is_convertible<FirstArgType, boost::container::pmr::polymorphic_allocator<o2::byte>>::value &&
+                !std::is_same<std::decay_t<FirstArgType>, WithIndex>::value,
+              int> = 0>
   Stack(FirstArgType&& firstHeader, Headers&&... headers)
     : Stack(boost::container::pmr::new_delete_resource(), std::forward<FirstArgType>(firstHeader),
             std::forward<Headers>(headers)...)
@@ -83,6 +94,29 @@ struct Stack {
     inject(buffer.get(), std::forward<Headers>(headers)...);
   }
 
+  /// Same as above, in addition a HeaderIndex is placed after the first header.
+  /// The index costs sizeof(HeaderIndex) in the stack, use it for deep stacks
+  /// whose headers are looked up often.
+  template <typename FirstArgType, typename... Headers,
+            typename std::enable_if_t<
+              !std::is_convertible<FirstArgType, boost::container::pmr::polymorphic_allocator<o2::byte>>::value, int> = 0>
+  Stack(WithIndex, FirstArgType&& firstHeader, Headers&&... headers)
+    : Stack(WithIndex{}, boost::container::pmr::new_delete_resource(), std::forward<FirstArgType>(firstHeader),
+            std::forward<Headers>(headers)...)
+  {
+  }
+
+  template <typename... Headers>
+  Stack(WithIndex, const allocator_type allocatorArg, Headers&&... headers)
+    : allocator{ allocatorArg },
+      bufferSize{ sizeof(HeaderIndex) + calculateSize(std::forward<Headers>(headers)...) },
+      buffer{ static_cast<o2::byte*>(allocator.resource()->allocate(bufferSize, alignof(std::max_align_t))),
+              freeobj(allocator.resource()) }
+  {
+    inject(buffer.get() + sizeof(HeaderIndex), std::forward<Headers>(headers)...);
+    insertIndex();
+  }
+
  private:
   allocator_type allocator{ boost::container::pmr::new_delete_resource() };
   size_t bufferSize{ 0 };
@@ -103,6 +137,29 @@ struct Stack {
   //recursion terminator
   constexpr static size_t calculateSize() { return 0; }
 
+  /// move the first header in front of the space reserved for the index and
+  /// build the index of the headers in its place
+  void insertIndex() noexcept
+  {
+    if (bufferSize == sizeof(HeaderIndex)) {
+      // only empty stacks, nothing to index
+      bufferSize = 0;
+      return;
+    }
+    BaseHeader* first = BaseHeader::get(buffer.get() + sizeof(HeaderIndex));
+    const auto firstSize = first->size();
+    std::memmove(buffer.get(), first, firstSize);
+    first = BaseHeader::get(buffer.get());
+    auto* index = new (buffer.get() + firstSize) HeaderIndex();
+    index->flagsNextHeader = first->flagsNextHeader;
+    first->flagsNextHeader = true;
+    for (const BaseHeader* current = first; current != nullptr; current = current->next()) {
+      if (current != index && !index->add(current)) {
+        break;
+      }
+    }
+  }
+
   template <typename T>
   static o2::byte* inject(o2::byte* here, T&& h) noexcept
   {
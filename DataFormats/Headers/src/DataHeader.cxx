@@ -37,6 +37,11 @@ const uint32_t o2::header::DataHeader::sVersion = 1;
 const o2::header::HeaderType o2::header::DataHeader::sHeaderType = String2<uint64_t>("DataHead");
 const o2::header::SerializationMethod o2::header::DataHeader::sSerializationMethod = o2::header::gSerializationMethodNone;
 
+//storage for HeaderIndex static members
+const uint32_t o2::header::HeaderIndex::sVersion = 1;
+const o2::header::HeaderType o2::header::HeaderIndex::sHeaderType = String2<uint64_t>("HdrIndex");
+const o2::header::SerializationMethod o2::header::HeaderIndex::sSerializationMethod = o2::header::gSerializationMethodNone;
+
 using namespace o2::header;
 
 //__________________________________________________________________________________________________
@@ -91,6 +96,34 @@ void o2::header::DataHeader::print() const
   printf("  payloadSize  : %llu\n", (long long unsigned int)payloadSize);
 }
 
+//__________________________________________________________________________________________________
+o2::header::HeaderIndex::HeaderIndex()
+  : BaseHeader(sizeof(HeaderIndex),sHeaderType,sSerializationMethod,sVersion)
+  , nEntries(0)
+  , lastOffset(0)
+  , entries()
+{
+}
+
+//__________________________________________________________________________________________________
+bool o2::header::HeaderIndex::add(const BaseHeader* header)
+{
+  const auto offset = reinterpret_cast<const o2::byte*>(header) - reinterpret_cast<const o2::byte*>(this);
+  // only the first header of a type is indexed, get() returns that one
+  bool indexed = false;
+  for (uint32_t entry = 0; entry < nEntries && !indexed; ++entry) {
+    indexed = entries[entry].description == header->description;
+  }
+  if (!indexed) {
+    if (nEntries == sMaxEntries) {
+      return false;
+    }
+    entries[nEntries++] = Entry{ header->description, offset };
+  }
+  lastOffset = static_cast<int32_t>(offset);
+  return true;
+}
+
 //__________________________________________________________________________________________________
 bool o2::header::DataHeader::operator==(const DataOrigin& that) const
 {
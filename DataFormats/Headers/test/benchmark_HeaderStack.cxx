@@ -0,0 +1,64 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmark_HeaderStack.cxx
+/// \brief Benchmark of the header lookup in stacks of increasing depth, with and without HeaderIndex
+
+#include <benchmark/benchmark.h>
+
+#include "Headers/DataHeader.h"
+#include "Headers/NameHeader.h"
+#include "Headers/Stack.h"
+
+using namespace o2::header;
+
+namespace
+{
+struct LastHeader : public BaseHeader {
+  static const o2::header::HeaderType sHeaderType;
+  static const uint32_t sVersion = 1;
+
+  LastHeader() : BaseHeader(sizeof(LastHeader), sHeaderType, o2::header::gSerializationMethodNone, sVersion) {}
+};
+constexpr o2::header::HeaderType LastHeader::sHeaderType = "LastHead";
+
+/// DataHeader, followed by depth - 2 name headers and the header looked up
+Stack createStack(int depth)
+{
+  Stack stack{ DataHeader{ gDataDescriptionInvalid, gDataOriginInvalid, DataHeader::SubSpecificationType{ 0 }, 0 } };
+  for (int i = 2; i < depth; ++i) {
+    stack = Stack{ stack, NameHeader<8>{ "filler" } };
+  }
+  return Stack{ stack, LastHeader{} };
+}
+} // namespace
+
+// Lookup of the last header of a stack of state.range(0) headers
+static void BM_getWithoutIndex(benchmark::State& state)
+{
+  const auto stack = createStack(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(get<LastHeader*>(stack.data()));
+  }
+}
+
+// Same, with a HeaderIndex after the first header
+static void BM_getWithIndex(benchmark::State& state)
+{
+  const Stack stack{ Stack::WithIndex{}, createStack(state.range(0)) };
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(get<LastHeader*>(stack.data()));
+  }
+}
+
+BENCHMARK(BM_getWithoutIndex)->RangeMultiplier(2)->Range(2, 64);
+BENCHMARK(BM_getWithIndex)->RangeMultiplier(2)->Range(2, 64);
+
+BENCHMARK_MAIN()
@@ -19,6 +19,7 @@
 #include "Headers/Stack.h"
 
 #include <chrono>
+#include <vector>
 
 using system_clock = std::chrono::system_clock;
 using TimeScale = std::chrono::nanoseconds;
@@ -42,6 +43,13 @@ struct MetaHeader : public BaseHeader {
   uint64_t secret;
 };
 constexpr o2::header::HeaderType MetaHeader::sHeaderType = "MetaHead";
+
+struct TypeHeader : public BaseHeader {
+  TypeHeader(HeaderType type)
+    : BaseHeader(sizeof(TypeHeader), type, o2::header::gSerializationMethodNone, 1)
+  {
+  }
+};
 }
 }
 }
@@ -287,6 +295,64 @@ namespace o2 {
       BOOST_CHECK(h3->secret == 42);
     }
 
+    BOOST_AUTO_TEST_CASE(headerIndex_test)
+    {
+      DataHeader dh{ gDataDescriptionInvalid, gDataOriginInvalid, DataHeader::SubSpecificationType{ 0 }, 0 };
+      auto meta = test::MetaHeader{ 42 };
+
+      Stack s1{ Stack::WithIndex{}, dh, NameHeader<9>{ "somename" }, test::MetaHeader{ 1 } };
+      BOOST_CHECK(s1.size() == sizeof(dh) + sizeof(HeaderIndex) + sizeof(NameHeader<9>) + sizeof(meta));
+
+      // the DataHeader stays in front, followed by the index
+      const DataHeader* h1 = get<DataHeader*>(s1.data());
+      BOOST_REQUIRE(h1 == reinterpret_cast<const DataHeader*>(s1.data()));
+      BOOST_CHECK(*h1 == dh);
+      const HeaderIndex* index = get<HeaderIndex*>(s1.data());
+      BOOST_REQUIRE(index == h1->next());
+      BOOST_CHECK(index->nEntries == 3);
+      BOOST_CHECK(index->get<DataHeader>() == h1);
+
+      const NameHeader<0>* h2 = get<NameHeader<0>*>(s1.data());
+      BOOST_REQUIRE(h2 != nullptr);
+      BOOST_CHECK(h2 == index->get<NameHeader<0>>());
+      BOOST_CHECK(0 == std::strcmp(h2->getName(), "somename"));
+      const test::MetaHeader* h3 = get<test::MetaHeader*>(s1.data());
+      BOOST_REQUIRE(h3 != nullptr);
+      BOOST_CHECK(h3->secret == 1);
+      BOOST_CHECK(h3->flagsNextHeader == false);
+
+      // headers appended after the indexed stack are found behind the indexed ones,
+      // the first header of a type is returned as without index
+      Stack s2{ s1, meta, test::MetaHeader{ 2 } };
+      BOOST_CHECK(get<test::MetaHeader*>(s2.data())->secret == 1);
+      Stack s3{ Stack::WithIndex{}, dh, Stack{ meta } };
+      Stack s4{ s3, NameHeader<9>{ "nextname" } };
+      h2 = get<NameHeader<0>*>(s4.data());
+      BOOST_REQUIRE(h2 != nullptr);
+      BOOST_CHECK(0 == std::strcmp(h2->getName(), "nextname"));
+      BOOST_CHECK(get<HeaderIndex*>(s4.data())->find(BaseHeader::sHeaderType) == nullptr);
+
+      // the types beyond the capacity of the index are found by walking the stack
+      std::vector<test::TypeHeader> typeHeaders;
+      for (uint64_t i = 0; i < HeaderIndex::sMaxEntries + 2; ++i) {
+        typeHeaders.emplace_back(HeaderType{ String2<uint64_t>("Type") + (i << 40) });
+      }
+      Stack s5{ Stack::WithIndex{}, dh, typeHeaders[0], typeHeaders[1], typeHeaders[2], typeHeaders[3],
+                typeHeaders[4], typeHeaders[5], typeHeaders[6], typeHeaders[7], typeHeaders[8], typeHeaders[9] };
+      index = get<HeaderIndex*>(s5.data());
+      BOOST_REQUIRE(index != nullptr);
+      BOOST_CHECK(index->nEntries == HeaderIndex::sMaxEntries);
+      for (auto const& typeHeader : typeHeaders) {
+        const BaseHeader* found = index->find(typeHeader.description);
+        BOOST_REQUIRE(found != nullptr);
+        BOOST_CHECK(found->description == typeHeader.description);
+      }
+
+      // empty stacks give an empty stack
+      Stack s6{ Stack::WithIndex{}, Stack{} };
+      BOOST_CHECK(s6.size() == 0);
+    }
+
     BOOST_AUTO_TEST_CASE(Descriptor_benchmark)
     {
       using TestDescriptor = Descriptor<8>;
@@ -0,0 +1,143 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file DigitAccumulator.h
+/// \brief Sparse container to accumulate digits during digitization
+
+#ifndef ALICEO2_DATAFORMATS_DIGITACCUMULATOR_H_
+#define ALICEO2_DATAFORMATS_DIGITACCUMULATOR_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace o2
+{
+namespace dataformats
+{
+
+/// @class DigitAccumulator
+/// Collects the digits of a readout window by a 64 bit key, typically made
+/// of a time bucket and a channel. Digits are kept in a flat pool, and
+/// an open addressing hash table maps keys to positions in the pool.
+/// Memory is kept when the accumulator is cleared, so in steady state
+/// adding digits does not allocate. The digits are delivered sorted by
+/// key when the accumulator is flushed.
+///
+/// Pointers to digits are only valid until the next call to emplace.
+template <typename T>
+class DigitAccumulator
+{
+ public:
+  using key_type = uint64_t;
+  using value_type = T;
+
+  /// @return the digit stored for key, nullptr if there is none
+  T* find(key_type key)
+  {
+    if (mEntries.empty()) {
+      return nullptr;
+    }
+    for (size_t slot = hash(key);; slot = (slot + 1) & mMask) {
+      auto index = mSlots[slot];
+      if (index == Empty) {
+        return nullptr;
+      }
+      if (mEntries[index].first == key) {
+        return &mEntries[index].second;
+      }
+    }
+  }
+
+  /// Add a digit constructed from args for key, unless there is already one
+  /// @return the digit stored for key and whether it has been added
+  template <typename... Args>
+  std::pair<T*, bool> emplace(key_type key, Args&&... args)
+  {
+    // keep the load factor of the hash table below 1/2
+    if (2 * (mEntries.size() + 1) > mSlots.size()) {
+      grow();
+    }
+    size_t slot = hash(key);
+    for (; mSlots[slot] != Empty; slot = (slot + 1) & mMask) {
+      auto& entry = mEntries[mSlots[slot]];
+      if (entry.first == key) {
+        return { &entry.second, false };
+      }
+    }
+    mSlots[slot] = mEntries.size();
+    mEntries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+    return { &mEntries.back().second, true };
+  }
+
+  size_t size() const { return mEntries.size(); }
+  bool empty() const { return mEntries.empty(); }
+
+  /// remove all digits, the memory is kept for reuse
+  void clear()
+  {
+    if (mEntries.empty()) {
+      return;
+    }
+    mEntries.clear();
+    std::fill(mSlots.begin(), mSlots.end(), Empty);
+  }
+
+  /// append all digits ordered by key to output and clear the accumulator
+  template <typename Container>
+  void flush(Container& output)
+  {
+    mOrder.clear();
+    for (uint32_t index = 0; index < mEntries.size(); ++index) {
+      mOrder.emplace_back(mEntries[index].first, index);
+    }
+    std::sort(mOrder.begin(), mOrder.end());
+    for (auto const& element : mOrder) {
+      output.emplace_back(std::move(mEntries[element.second].second));
+    }
+    clear();
+  }
+
+ private:
+  static constexpr uint32_t Empty = ~uint32_t(0);
+
+  size_t hash(key_type key) const
+  {
+    // Fibonacci hashing, the upper bits of the product are well mixed
+    return (key * 0x9E3779B97F4A7C15ULL) >> (64 - mBits);
+  }
+
+  void grow()
+  {
+    mBits = mSlots.empty() ? 4 : mBits + 1;
+    mSlots.assign(size_t(1) << mBits, Empty);
+    mMask = mSlots.size() - 1;
+    for (uint32_t index = 0; index < mEntries.size(); ++index) {
+      size_t slot = hash(mEntries[index].first);
+      while (mSlots[slot] != Empty) {
+        slot = (slot + 1) & mMask;
+      }
+      mSlots[slot] = index;
+    }
+  }
+
+  std::vector<std::pair<key_type, T>> mEntries;          ///< the digits in order of insertion
+  std::vector<uint32_t> mSlots;                          ///< hash table of positions in mEntries
+  std::vector<std::pair<key_type, uint32_t>> mOrder;     ///< work space for sorting
+  size_t mMask = 0;                                      ///< mSlots.size() - 1
+  int mBits = 0;                                         ///< log2 of mSlots.size()
+};
+
+} // namespace dataformats
+} // namespace o2
+
+#endif
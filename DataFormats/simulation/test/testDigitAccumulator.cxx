@@ -0,0 +1,74 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test DigitAccumulator class
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "SimulationDataFormat/DigitAccumulator.h"
+#include <map>
+#include <random>
+
+namespace o2
+{
+BOOST_AUTO_TEST_CASE(DigitAccumulator)
+{
+  struct Digit {
+    uint64_t key;
+    int charge;
+  };
+  dataformats::DigitAccumulator<Digit> accumulator;
+  BOOST_CHECK(accumulator.empty());
+  BOOST_CHECK(accumulator.find(1) == nullptr);
+
+  auto first = accumulator.emplace(10, Digit{ 10, 1 });
+  BOOST_CHECK(first.second);
+  BOOST_CHECK(first.first->charge == 1);
+  auto second = accumulator.emplace(10, Digit{ 10, 2 });
+  BOOST_CHECK(second.second == false);
+  BOOST_CHECK(second.first->charge == 1);
+  BOOST_CHECK(accumulator.find(10) == second.first);
+  BOOST_CHECK(accumulator.size() == 1);
+  accumulator.clear();
+  BOOST_CHECK(accumulator.find(10) == nullptr);
+
+  // compare with a map over several readout windows, keys with
+  // the same lower bits in order to provoke collisions
+  std::mt19937_64 generator(1);
+  std::vector<Digit> digits;
+  for (int window = 0; window < 3; ++window) {
+    std::map<uint64_t, int> reference;
+    for (int i = 0; i < 10000; ++i) {
+      uint64_t key = (generator() % 3000) << (i % 2 ? 18 : 0);
+      int charge = generator() % 100;
+      reference[key] += charge;
+      auto digit = accumulator.emplace(key, Digit{ key, 0 });
+      digit.first->charge += charge;
+    }
+    BOOST_CHECK(accumulator.size() == reference.size());
+    for (auto const& element : reference) {
+      auto digit = accumulator.find(element.first);
+      BOOST_REQUIRE(digit != nullptr);
+      BOOST_CHECK(digit->charge == element.second);
+    }
+    digits.clear();
+    accumulator.flush(digits);
+    BOOST_CHECK(accumulator.empty());
+    BOOST_CHECK(accumulator.find(digits[0].key) == nullptr);
+    BOOST_REQUIRE(digits.size() == reference.size());
+    size_t index = 0;
+    for (auto const& element : reference) {
+      BOOST_CHECK(digits[index].key == element.first);
+      BOOST_CHECK(digits[index].charge == element.second);
+      ++index;
+    }
+  }
+}
+} // namespace o2
@@ -12,9 +12,7 @@
 #define ALICEO2_EMCAL_DIGITIZER_H
 
 #include <memory>
-#include <unordered_map>
 #include <vector>
-#include <deque>
 
 #include "Rtypes.h"  // for Digitizer::Class, Double_t, ClassDef, etc
 #include "TObject.h" // for TObject
@@ -25,6 +23,7 @@
 #include "EMCALBase/Hit.h"
 #include "EMCALSimulation/MCLabel.h"
 
+#include "SimulationDataFormat/DigitAccumulator.h"
 #include "SimulationDataFormat/MCTruthContainer.h"
 
 namespace o2
@@ -50,6 +49,7 @@ class Digitizer : public TObject
 
   void setContinuous(bool v) { mContinuous = v; }
   bool isContinuous() const { return mContinuous; }
+  /// Appends the digits to @a digits, ordered by time sample and by tower within each sample
   void fillOutputContainer(std::vector<Digit>& digits);
 
   void setCoeffToNanoSecond(double cf) { mCoeffToNanoSecond = cf; }
@@ -65,6 +65,17 @@ class Digitizer : public TObject
 
   Digit hitToDigit(const Hit& hit, const Int_t label);
 
+  /// Add the digit to the ones of the current readout window. Digits of the
+  /// same tower less than a time sample apart are summed up.
+  /// \return the label index of the digit it has been summed into, or of the digit itself
+  Int_t addDigit(const Digit& digit);
+
+  /// time sample of time t (ns), negative times are in negative samples
+  static Long64_t getTimeBin(double t);
+
+  /// key of the digits of tower in the time sample timeBin, ordered by time first
+  static ULong64_t getDigitKey(Long64_t timeBin, Short_t tower);
+
  private:
   const Geometry* mGeometry = nullptr; // EMCAL geometry
   double mEventTime = 0;               ///< global event time
@@ -75,11 +86,11 @@ class Digitizer : public TObject
   int mCurrSrcID = 0;                  ///< current MC source from the manager
   int mCurrEvID = 0;                   ///< current event ID from the manager
 
-  std::unordered_map<Int_t, std::deque<Digit>> mDigits; ///< used to sort digits by tower
+  o2::dataformats::DigitAccumulator<Digit> mDigits; //! digits by time bin and tower
   o2::dataformats::MCTruthContainer<o2::EMCAL::MCLabel> mMCTruthContainer;    ///< temporary storage for MC truth information
   o2::dataformats::MCTruthContainer<o2::MCCompLabel> mMCTruthOutputContainer; ///< contains MC truth information
 
-  ClassDefOverride(Digitizer, 1);
+  ClassDefOverride(Digitizer, 2);
 };
 } // namespace EMCAL
 } // namespace o2
@@ -18,7 +18,7 @@
 
 #include <TRandom.h>
 #include <climits>
-#include <forward_list>
+#include <cmath>
 #include "FairLogger.h" // for LOG
 
 ClassImp(o2::EMCAL::Digitizer);
@@ -52,19 +52,7 @@ void Digitizer::process(const std::vector<Hit>& hits, std::vector<Digit>& digits
         continue;
       }
 
-      Bool_t flag = false;
-      for (auto& digit0 : mDigits[id]) {
-        if (digit0.canAdd(digit)) {
-          digit0 += digit;
-          LabelIndex = digit0.GetLabel();
-          flag = true;
-          break;
-        }
-      }
-
-      if (!flag) {
-        mDigits[id].push_front(digit);
-      }
+      LabelIndex = addDigit(digit);
 
       o2::EMCAL::MCLabel label(hit.GetTrackID(), mCurrEvID, mCurrSrcID, mEventTime);
       mMCTruthContainer.addElementRandomAccess(LabelIndex, label);
@@ -87,6 +75,40 @@ o2::EMCAL::Digit Digitizer::hitToDigit(const Hit& hit, const Int_t label)
   return digit;
 }
 
+//_______________________________________________________________________
+Int_t Digitizer::addDigit(const Digit& digit)
+{
+  // Digits are stored by time sample. Two digits less than a sample apart
+  // are either in the same sample or in neighbouring ones, and since the
+  // time of a digit does not change when adding to it, there is at most one
+  // digit per sample and tower.
+  auto timeBin = getTimeBin(digit.getTimeStamp());
+  for (auto bin : { timeBin, timeBin - 1, timeBin + 1 }) {
+    auto digit0 = mDigits.find(getDigitKey(bin, digit.GetTower()));
+    if (digit0 && digit0->canAdd(digit)) {
+      *digit0 += digit;
+      return digit0->GetLabel();
+    }
+  }
+  mDigits.emplace(getDigitKey(timeBin, digit.GetTower()), digit);
+  return digit.GetLabel();
+}
+
+//_______________________________________________________________________
+Long64_t Digitizer::getTimeBin(double t)
+{
+  return static_cast<Long64_t>(std::floor(t / constants::EMCAL_TIMESAMPLE));
+}
+
+//_______________________________________________________________________
+ULong64_t Digitizer::getDigitKey(Long64_t timeBin, Short_t tower)
+{
+  // the time sample takes the upper 48 bits, offset such that negative
+  // samples come before the positive ones
+  auto time = static_cast<ULong64_t>(timeBin + (Long64_t(1) << 47)) & ((ULong64_t(1) << 48) - 1);
+  return (time << 16) | static_cast<UShort_t>(tower);
+}
+
 //_______________________________________________________________________
 void Digitizer::setEventTime(double t)
 {
@@ -103,19 +125,8 @@ void Digitizer::setEventTime(double t)
 //_______________________________________________________________________
 void Digitizer::fillOutputContainer(std::vector<Digit>& digits)
 {
-  std::forward_list<Digit> l;
-
-  for (auto tower : mDigits) {
-    for (auto& digit : tower.second) {
-      l.push_front(digit);
-    }
-  }
-
-  l.sort();
-
-  for (auto digit : l) {
-    digits.push_back(digit);
-  }
+  // sorted by time sample, then by tower within a sample (not by time within a sample)
+  mDigits.flush(digits);
 
   mMCTruthOutputContainer.clear();
   for (int index = 0; index < mMCTruthContainer.getIndexedSize(); ++index) {
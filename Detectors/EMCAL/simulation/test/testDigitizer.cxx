@@ -0,0 +1,80 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testDigitizer.cxx
+/// \brief Tests the summing of digits in the EMCAL digitizer
+
+#define BOOST_TEST_MODULE Test EMCAL Digitizer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "EMCALBase/Constants.h"
+#include "EMCALBase/Digit.h"
+#include "EMCALSimulation/Digitizer.h"
+
+namespace o2
+{
+namespace EMCAL
+{
+
+/// Digits of a tower less than a time sample apart are summed up, also
+/// across the boundary of a time sample.
+BOOST_AUTO_TEST_CASE(Digitizer_addDigit)
+{
+  const double sample = constants::EMCAL_TIMESAMPLE;
+  Digitizer digitizer;
+  std::vector<Digit> digits;
+
+  BOOST_CHECK_EQUAL(digitizer.addDigit(Digit(1, 1., sample - 0.5, 0)), 0);
+  // 1 ns later, in the next sample
+  BOOST_CHECK_EQUAL(digitizer.addDigit(Digit(1, 2., sample + 0.5, 1)), 0);
+  // another tower
+  BOOST_CHECK_EQUAL(digitizer.addDigit(Digit(2, 4., sample + 0.5, 2)), 2);
+  // more than a sample after the first one
+  BOOST_CHECK_EQUAL(digitizer.addDigit(Digit(1, 8., 2 * sample + 1., 3)), 3);
+  digitizer.fillOutputContainer(digits);
+
+  BOOST_REQUIRE_EQUAL(digits.size(), 3);
+  BOOST_CHECK_EQUAL(digits[0].GetTower(), 1);
+  BOOST_CHECK_EQUAL(digits[0].GetAmplitude(), 3.);
+  BOOST_CHECK_EQUAL(digits[1].GetTower(), 2);
+  BOOST_CHECK_EQUAL(digits[1].GetAmplitude(), 4.);
+  BOOST_CHECK_EQUAL(digits[2].GetTower(), 1);
+  BOOST_CHECK_EQUAL(digits[2].GetAmplitude(), 8.);
+}
+
+/// Digits come out ordered by time, negative times first.
+BOOST_AUTO_TEST_CASE(Digitizer_negativeTime)
+{
+  const double sample = constants::EMCAL_TIMESAMPLE;
+  BOOST_CHECK_EQUAL(Digitizer::getTimeBin(-1.), -1);
+  BOOST_CHECK_EQUAL(Digitizer::getTimeBin(0.), 0);
+  BOOST_CHECK(Digitizer::getDigitKey(-1, 100) < Digitizer::getDigitKey(0, 0));
+  BOOST_CHECK(Digitizer::getDigitKey(-2, 0) < Digitizer::getDigitKey(-1, 0));
+
+  Digitizer digitizer;
+  std::vector<Digit> digits;
+  digitizer.addDigit(Digit(1, 1., 3 * sample, 0));
+  digitizer.addDigit(Digit(1, 2., -3 * sample, 1));
+  digitizer.addDigit(Digit(1, 4., 0.5, 2));
+  // sums up with the previous one across time 0
+  digitizer.addDigit(Digit(1, 8., -0.5, 3));
+  digitizer.fillOutputContainer(digits);
+
+  BOOST_REQUIRE_EQUAL(digits.size(), 3);
+  BOOST_CHECK_EQUAL(digits[0].getTimeStamp(), -3 * sample);
+  BOOST_CHECK_EQUAL(digits[1].getTimeStamp(), 0.5);
+  BOOST_CHECK_EQUAL(digits[1].GetAmplitude(), 12.);
+  BOOST_CHECK_EQUAL(digits[2].getTimeStamp(), 3 * sample);
+}
+
+} // namespace EMCAL
+} // namespace o2
@@ -71,6 +71,7 @@ class Digit : public DigitBase
   }
 
   const std::vector<ChannelData>& getChDgData() const { return mChDgDataArr; }
+  std::vector<ChannelData>& getChDgData() { return mChDgDataArr; }
   void setChDgData(const std::vector<ChannelData>& ChDgDataArr) { mChDgDataArr = ChDgDataArr; }
   void setChDgData(std::vector<ChannelData>&& ChDgDataArr) { mChDgDataArr = std::move(ChDgDataArr); }
 
@@ -17,6 +17,8 @@
 #include "SimulationDataFormat/MCCompLabel.h"
 #include "FITSimulation/MCLabel.h"
 
+#include <array>
+
 namespace o2
 {
 namespace fit
@@ -40,6 +42,11 @@ class Digitizer
 
   void setTriggers(Digit* digit);
   void smearCFDtime(Digit* digit);
+  /// setTriggers and smearCFDtime in a single pass over the channels of the digit
+  void finalizeDigit(Digit* digit);
+
+  /// seed of the generator of the CFD time smearing, by default taken from gRandom in init()
+  void setRandomSeed(ULong64_t seed);
 
   void init();
   void finish();
@@ -47,6 +54,32 @@ class Digitizer
   void setMCLabels(o2::dataformats::MCTruthContainer<o2::fit::MCLabel>* mclb) { mMCLabels = mclb; }
 
  private:
+  static constexpr Int_t NMCPs = (Geometry::NCellsA + Geometry::NCellsC) * 4; // number of MCPs
+  static constexpr size_t NRandomBlock = 256;                                 // random numbers drawn at once
+
+  /// sums of the fired channels for the trigger decision
+  struct TriggerSums {
+    Int_t nHitA = 0;
+    Int_t nHitC = 0;
+    Float_t meanTimeA = 0.;
+    Float_t meanTimeC = 0.;
+    Float_t summAmplA = 0.;
+    Float_t summAmplC = 0.;
+  };
+
+  void addToTriggers(TriggerSums& sums, Int_t mcp, Double_t cfd, Float_t amp) const;
+  void storeTriggers(Digit* digit, TriggerSums& sums) const;
+
+  /// next gaussian random number of unit width
+  Double_t getNextGaus()
+  {
+    if (mNextGaus == mGaus.size()) {
+      fillGausBlock();
+    }
+    return mGaus[mNextGaus++];
+  }
+  void fillGausBlock();
+
   // digit info
   // parameters
   Int_t mMode;  //triggered or continuos
@@ -57,15 +90,27 @@ class Digitizer
   Double_t mEventTime; // timestamp
 
   Float_t mBC_clk_center = 12.5;                             // clk center
-  Int_t mMCPs = (Geometry::NCellsA + Geometry::NCellsC) * 4; //number of MCPs
   Float_t mCFD_trsh_mip = 0.4;                               // = 4[mV] / 10[mV/mip]
   Float_t mTime_trg_gate = 4.;                               // ns
   Int_t mAmpThreshold = 100;                                 // number of photoelectrons
   Float_t mTimeDiffAC = (Geometry::ZdetA - Geometry::ZdetC) * TMath::C();
 
+  // per channel sums of the current digit, kept between the calls to avoid allocations
+  std::array<Int_t, NMCPs> mChannelNPe;      // number of photoelectrons in the signal gate
+  std::array<Double_t, NMCPs> mChannelTime;  // sum of the times of the photoelectrons
+  std::array<Double_t, NMCPs> mChannelCFD;   // CFD time of the channel before this call
+  std::array<Double_t, NMCPs> mChannelAmpl;  // amplitude of the channel before this call
+  std::array<Bool_t, NMCPs> mChannelInDigit; // channel fired before this call
+
+  // counter based generator of the CFD time smearing
+  ULong64_t mRandomSeed = 0;
+  ULong64_t mRandomCounter = 0;
+  std::array<Double_t, NRandomBlock> mGaus;
+  size_t mNextGaus = NRandomBlock;
+
   o2::dataformats::MCTruthContainer<o2::fit::MCLabel>* mMCLabels = nullptr;
 
-  ClassDefNV(Digitizer, 1);
+  ClassDefNV(Digitizer, 2);
 };
 } // namespace fit
 } // namespace o2
@@ -17,6 +17,7 @@
 #include "TRandom.h"
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 
 using namespace o2::fit;
@@ -40,11 +41,8 @@ void Digitizer::process(const std::vector<HitType>* hits, Digit* digit)
   digit->setOrbit(mOrbit);
 
   //Calculating signal time, amplitude in mean_time +- time_gate --------------
-  Double_t cfd[300] = {};
-  Float_t amp[300] = {};
-  Int_t ch_signal_nPe[300] = {};
-  Double_t ch_signal_MIP[300] = {};
-  Double_t ch_signal_time[300] = {};
+  mChannelNPe.fill(0);
+  mChannelTime.fill(0.);
   for (auto& hit : *hits) {
     Int_t hit_ch = hit.GetDetectorID();
     Double_t hit_time = hit.GetTime();
@@ -56,9 +54,9 @@ void Digitizer::process(const std::vector<HitType>* hits, Digit* digit)
 
     Double_t hit_time_corr = hit_time - time_compensate /* + mBC_clk_center + mEventTime*/;
 
-    if (/*is_time_in_gate &&*/ is_hit_in_signal_gate) {
-      ch_signal_nPe[hit_ch]++;
-      ch_signal_time[hit_ch] += hit_time_corr;
+    if (/*is_time_in_gate &&*/ is_hit_in_signal_gate && hit_ch < NMCPs) {
+      mChannelNPe[hit_ch]++;
+      mChannelTime[hit_ch] += hit_time_corr;
     }
 
     //charge particles in MCLabel
@@ -73,128 +71,182 @@ void Digitizer::process(const std::vector<HitType>* hits, Digit* digit)
     }
   }
 
-  // sum  different sources
-  std::vector<ChannelData> mChDgDataArr;
-  for (const auto& d : digit->getChDgData()) {
+  // sum  different sources, the channels of the digit are rewritten in place
+  // from the per channel sums, keeping the channels fired only by the previous sources
+  auto& chDgDataArr = digit->getChDgData();
+  mChannelCFD.fill(0.);
+  mChannelAmpl.fill(0.);
+  mChannelInDigit.fill(kFALSE);
+  for (const auto& d : chDgDataArr) {
     Int_t mcp = d.ChId;
-    cfd[mcp] = d.CFDTime;
-    amp[mcp] = d.QTCAmpl;
+    mChannelCFD[mcp] = d.CFDTime;
+    mChannelAmpl[mcp] = d.QTCAmpl;
+    mChannelInDigit[mcp] = kTRUE;
   }
 
-  for (Int_t ch_iter = 0; ch_iter < mMCPs; ch_iter++) {
-    if (ch_signal_nPe[ch_iter] != 0) {
-      ch_signal_MIP[ch_iter] = amp[ch_iter] + ch_signal_nPe[ch_iter] / nPe_in_mip;
-      if (cfd[ch_iter] > 0) {
-        cfd[ch_iter] = cfd[ch_iter] - mBC_clk_center - mEventTime;
-        ch_signal_time[ch_iter] = ((cfd[ch_iter] + ch_signal_time[ch_iter] / (float)ch_signal_nPe[ch_iter]) / 2.) + mBC_clk_center + mEventTime;
-      } else
-        ch_signal_time[ch_iter] = (ch_signal_time[ch_iter] / (float)ch_signal_nPe[ch_iter]) + mBC_clk_center + mEventTime;
-
-      if (ch_signal_MIP[ch_iter] > mCFD_trsh_mip) {
-        LOG(DEBUG) << ch_iter << " : "
-                   << " : " << ch_signal_time[ch_iter] - mBC_clk_center - mEventTime << " : "
-                   << ch_signal_MIP[ch_iter] << " : " << mEventTime << " cfd " << cfd[ch_iter] << FairLogger::endl;
-        mChDgDataArr.emplace_back(ChannelData{ ch_iter, ch_signal_time[ch_iter], ch_signal_MIP[ch_iter] });
-      } else {
-        ch_signal_MIP[ch_iter] = 0;
-        ch_signal_time[ch_iter] = 0;
+  chDgDataArr.clear();
+  for (Int_t ch_iter = 0; ch_iter < NMCPs; ch_iter++) {
+    if (mChannelNPe[ch_iter] == 0) {
+      // channel fired only by the previous sources
+      if (mChannelInDigit[ch_iter]) {
+        chDgDataArr.emplace_back(ChannelData{ ch_iter, mChannelCFD[ch_iter], mChannelAmpl[ch_iter] });
       }
+      continue;
     }
-  }
+    Double_t cfd = mChannelCFD[ch_iter];
+    Double_t ch_signal_time = mChannelTime[ch_iter];
+    Double_t ch_signal_MIP = Float_t(mChannelAmpl[ch_iter]) + mChannelNPe[ch_iter] / nPe_in_mip;
+    if (cfd > 0) {
+      cfd = cfd - mBC_clk_center - mEventTime;
+      ch_signal_time = ((cfd + ch_signal_time / (float)mChannelNPe[ch_iter]) / 2.) + mBC_clk_center + mEventTime;
+    } else
+      ch_signal_time = (ch_signal_time / (float)mChannelNPe[ch_iter]) + mBC_clk_center + mEventTime;
 
-  digit->setChDgData(std::move(mChDgDataArr));
+    if (ch_signal_MIP > mCFD_trsh_mip) {
+      LOG(DEBUG) << ch_iter << " : "
+                 << " : " << ch_signal_time - mBC_clk_center - mEventTime << " : "
+                 << ch_signal_MIP << " : " << mEventTime << " cfd " << cfd << FairLogger::endl;
+      chDgDataArr.emplace_back(ChannelData{ ch_iter, ch_signal_time, ch_signal_MIP });
+    }
+  }
 }
 
 //------------------------------------------------------------------------
 void Digitizer::smearCFDtime(Digit* digit)
 {
   //smeared CFD time for 50ps
-  std::vector<ChannelData> mChDgDataArr;
-  for (const auto& d : digit->getChDgData()) {
+  auto& chDgDataArr = digit->getChDgData();
+  size_t nChannels = 0;
+  for (const auto& d : chDgDataArr) {
     Int_t mcp = d.ChId;
     Double_t cfd = d.CFDTime - mBC_clk_center - mEventTime;
     Float_t amp = d.QTCAmpl;
     if (amp > mCFD_trsh_mip) {
-      Double_t smeared_time = gRandom->Gaus(cfd, 0.050) + mBC_clk_center + mEventTime;
-      mChDgDataArr.emplace_back(ChannelData{ mcp, smeared_time, amp });
+      Double_t smeared_time = cfd + 0.050 * getNextGaus() + mBC_clk_center + mEventTime;
+      chDgDataArr[nChannels++] = ChannelData{ mcp, smeared_time, amp };
     }
   }
-  digit->setChDgData(std::move(mChDgDataArr));
+  chDgDataArr.resize(nChannels);
 }
 
 //------------------------------------------------------------------------
 void Digitizer::setTriggers(Digit* digit)
 {
-  constexpr Double_t BC_clk_center = 12.5;      // clk center
-  constexpr Double_t trg_central_trh = 100.;    // mip
-  constexpr Double_t trg_semicentral_trh = 50.; // mip
-  constexpr Double_t trg_vertex_min = -3.;      //ns
-  constexpr Double_t trg_vertex_max = 3.;       //ns
-
   // Calculating triggers -----------------------------------------------------
-  Int_t n_hit_A = 0, n_hit_C = 0;
-  Float_t mean_time_A = 0.;
-  Float_t mean_time_C = 0.;
-  Float_t summ_ampl_A = 0.;
-  Float_t summ_ampl_C = 0.;
-  Float_t vertex_time;
-
-  Double_t cfd[300] = {};
-  Float_t amp[300] = {};
+  TriggerSums sums;
   for (const auto& d : digit->getChDgData()) {
-    Int_t mcp = d.ChId;
-    cfd[mcp] = d.CFDTime - mBC_clk_center - mEventTime;
-    amp[mcp] = d.QTCAmpl;
-    if (amp[mcp] < mCFD_trsh_mip)
-      continue;
-    if (cfd[mcp] < -mTime_trg_gate / 2. || cfd[mcp] > mTime_trg_gate / 2.)
-      continue;
+    addToTriggers(sums, d.ChId, d.CFDTime - mBC_clk_center - mEventTime, d.QTCAmpl);
+  }
+  storeTriggers(digit, sums);
+}
 
-    Bool_t is_A_side = (mcp <= 4 * Geometry::NCellsA);
-    if (is_A_side) {
-      n_hit_A++;
-      summ_ampl_A += amp[mcp];
-      mean_time_A += cfd[mcp];
-    } else {
-      n_hit_C++;
-      summ_ampl_C += amp[mcp];
-      mean_time_C += cfd[mcp];
+//------------------------------------------------------------------------
+void Digitizer::finalizeDigit(Digit* digit)
+{
+  // the triggers see the CFD times before the smearing, as with setTriggers followed by smearCFDtime
+  TriggerSums sums;
+  auto& chDgDataArr = digit->getChDgData();
+  size_t nChannels = 0;
+  for (const auto& d : chDgDataArr) {
+    Int_t mcp = d.ChId;
+    Double_t cfd = d.CFDTime - mBC_clk_center - mEventTime;
+    Float_t amp = d.QTCAmpl;
+    addToTriggers(sums, mcp, cfd, amp);
+    if (amp > mCFD_trsh_mip) {
+      Double_t smeared_time = cfd + 0.050 * getNextGaus() + mBC_clk_center + mEventTime;
+      chDgDataArr[nChannels++] = ChannelData{ mcp, smeared_time, amp };
     }
   }
+  chDgDataArr.resize(nChannels);
+  storeTriggers(digit, sums);
+}
 
-  Bool_t is_A = n_hit_A > 0;
-  Bool_t is_C = n_hit_C > 0;
-  Bool_t is_Central = summ_ampl_A + summ_ampl_C >= trg_central_trh;
-  Bool_t is_SemiCentral = summ_ampl_A + summ_ampl_C >= trg_semicentral_trh;
+//------------------------------------------------------------------------
+void Digitizer::addToTriggers(TriggerSums& sums, Int_t mcp, Double_t cfd, Float_t amp) const
+{
+  if (amp < mCFD_trsh_mip)
+    return;
+  if (cfd < -mTime_trg_gate / 2. || cfd > mTime_trg_gate / 2.)
+    return;
+
+  Bool_t is_A_side = (mcp <= 4 * Geometry::NCellsA);
+  if (is_A_side) {
+    sums.nHitA++;
+    sums.summAmplA += amp;
+    sums.meanTimeA += cfd;
+  } else {
+    sums.nHitC++;
+    sums.summAmplC += amp;
+    sums.meanTimeC += cfd;
+  }
+}
+
+//------------------------------------------------------------------------
+void Digitizer::storeTriggers(Digit* digit, TriggerSums& sums) const
+{
+  constexpr Double_t trg_central_trh = 100.;    // mip
+  constexpr Double_t trg_semicentral_trh = 50.; // mip
+  constexpr Double_t trg_vertex_min = -3.;      //ns
+  constexpr Double_t trg_vertex_max = 3.;       //ns
+
+  Bool_t is_A = sums.nHitA > 0;
+  Bool_t is_C = sums.nHitC > 0;
+  Bool_t is_Central = sums.summAmplA + sums.summAmplC >= trg_central_trh;
+  Bool_t is_SemiCentral = sums.summAmplA + sums.summAmplC >= trg_semicentral_trh;
 
-  mean_time_A = is_A ? mean_time_A / n_hit_A : 0;
-  mean_time_C = is_C ? mean_time_C / n_hit_C : 0;
-  vertex_time = (mean_time_A + mean_time_C) * .5;
+  sums.meanTimeA = is_A ? sums.meanTimeA / sums.nHitA : 0;
+  sums.meanTimeC = is_C ? sums.meanTimeC / sums.nHitC : 0;
+  Float_t vertex_time = (sums.meanTimeA + sums.meanTimeC) * .5;
   Bool_t is_Vertex = (vertex_time > trg_vertex_min) && (vertex_time < trg_vertex_max);
 
   //filling digit
   digit->setTriggers(is_A, is_C, is_Central, is_SemiCentral, is_Vertex);
 
   // Debug output -------------------------------------------------------------
-  LOG(DEBUG) << "\n\nTest digizing data ===================" << FairLogger::endl;
+  LOG(DEBUG) << "Event ID: " << mEventID << " Event Time " << mEventTime << FairLogger::endl;
+  LOG(DEBUG) << "N hit A: " << sums.nHitA << " N hit C: " << sums.nHitC << " summ ampl A: " << sums.summAmplA
+             << " summ ampl C: " << sums.summAmplC << " mean time A: " << sums.meanTimeA
+             << " mean time C: " << sums.meanTimeC << FairLogger::endl;
 
-  LOG(INFO) << "Event ID: " << mEventID << " Event Time " << mEventTime << FairLogger::endl;
-  LOG(INFO) << "N hit A: " << n_hit_A << " N hit C: " << n_hit_C << " summ ampl A: " << summ_ampl_A
-            << " summ ampl C: " << summ_ampl_C << " mean time A: " << mean_time_A
-            << " mean time C: " << mean_time_C << FairLogger::endl;
+  LOG(DEBUG) << "IS A " << is_A << " IS C " << is_C << " is Central " << is_Central
+             << " is SemiCentral " << is_SemiCentral << " is Vertex " << is_Vertex << FairLogger::endl;
+  // --------------------------------------------------------------------------
+}
 
-  LOG(INFO) << "IS A " << is_A << " IS C " << is_C << " is Central " << is_Central
-            << " is SemiCentral " << is_SemiCentral << " is Vertex " << is_Vertex << FairLogger::endl;
+//------------------------------------------------------------------------
+void Digitizer::setRandomSeed(ULong64_t seed)
+{
+  mRandomSeed = seed;
+  mRandomCounter = 0;
+  mNextGaus = mGaus.size();
+}
 
-  LOG(DEBUG) << "======================================\n\n"
-             << FairLogger::endl;
-  // --------------------------------------------------------------------------
+//------------------------------------------------------------------------
+void Digitizer::fillGausBlock()
+{
+  // Box-Muller on pairs of uniform numbers, each being the SplitMix64 hash of
+  // the seed and a running counter, so the numbers depend only on the seed
+  // and on how many were drawn before
+  auto uniform = [this](ULong64_t counter) {
+    ULong64_t z = mRandomSeed + (counter + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+    return ((z >> 11) + 0.5) * (1. / 9007199254740992.); // in (0, 1)
+  };
+  for (size_t i = 0; i < mGaus.size(); i += 2) {
+    const Double_t radius = std::sqrt(-2. * std::log(uniform(mRandomCounter + i)));
+    const Double_t phi = TMath::TwoPi() * uniform(mRandomCounter + i + 1);
+    mGaus[i] = radius * std::cos(phi);
+    mGaus[i + 1] = radius * std::sin(phi);
+  }
+  mRandomCounter += mGaus.size();
+  mNextGaus = 0;
 }
 
 void Digitizer::initParameters()
 {
   mBC_clk_center = 12.5; // clk center
-  mMCPs = (Geometry::NCellsA + Geometry::NCellsC) * 4;
   mCFD_trsh_mip = 0.4; // = 4[mV] / 10[mV/mip]
   mTime_trg_gate = 4.; // ns
   mAmpThreshold = 100;
@@ -202,7 +254,11 @@ void Digitizer::initParameters()
   // murmur
 }
 //_______________________________________________________________________
-void Digitizer::init() {}
+void Digitizer::init()
+{
+  // the smearing follows the seed of gRandom
+  setRandomSeed(gRandom->GetSeed());
+}
 
 //_______________________________________________________________________
 void Digitizer::finish() {}
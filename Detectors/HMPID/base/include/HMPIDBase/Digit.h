@@ -40,12 +40,20 @@ class Digit : public DigitBase
   {
     float localX;
     float localY;
+    getPadAndTotalCharge(hit, chamber, pc, px, py, localX, localY, totalcharge);
+  }
+
+  // same as above, also giving back the local coordinates of the hit which are used for the charge fractions
+  static void getPadAndTotalCharge(HitType const& hit, int& chamber, int& pc, int& px, int& py, float& localX, float& localY,
+                                   float& totalcharge)
+  {
     chamber = hit.GetDetectorID();
     double tmp[3] = { hit.GetX(), hit.GetY(), hit.GetZ() };
     Param::Instance()->Mars2Lors(chamber, tmp, localX, localY);
     Param::Lors2Pad(localX, localY, pc, px, py);
 
-    totalcharge = Digit::QdcTot(hit.GetEnergyLoss(), hit.GetTime(), pc, px, py, localX, localY);
+    float shiftedY = localY;
+    totalcharge = Digit::QdcTot(hit.GetEnergyLoss(), hit.GetTime(), pc, px, py, localX, shiftedY);
   }
 
   static float getFractionalContributionForPad(HitType const& hit, int somepad)
@@ -62,6 +70,32 @@ class Digit : public DigitBase
     return Digit::InMathieson(localX, localY, somepad);
   }
 
+  // charge fraction of the pad column px (row py) of the photocathode pc for a hit at the local x (y);
+  // the fraction of the pad (px, py) is 4 * getMathiesonIntegralX * getMathiesonIntegralY
+  static float getMathiesonIntegralX(float x, int pc, int px)
+  {
+    // Integration of Mathieson.
+    // This is the answer to electrostatic problem of charge distrubution in MWPC described elsewhere. (NIM A370(1988)602-603)
+    auto shift1 = -Param::LorsX(pc, px) + 0.5 * Param::SizePadX();
+    auto shift2 = -Param::LorsX(pc, px) - 0.5 * Param::SizePadX();
+
+    auto ux1 = Param::SqrtK3x() * TMath::TanH(Param::K2x() * (x + shift1) / Param::PitchAnodeCathode());
+    auto ux2 = Param::SqrtK3x() * TMath::TanH(Param::K2x() * (x + shift2) / Param::PitchAnodeCathode());
+
+    return Param::K4x() * (TMath::ATan(ux2) - TMath::ATan(ux1));
+  }
+
+  static Double_t getMathiesonIntegralY(Double_t y, int pc, int py)
+  {
+    Double_t shift1 = -Param::LorsY(pc, py) + 0.5 * Param::SizePadY();
+    Double_t shift2 = -Param::LorsY(pc, py) - 0.5 * Param::SizePadY();
+
+    Double_t uy1 = Param::SqrtK3y() * TMath::TanH(Param::K2y() * (y + shift1) / Param::PitchAnodeCathode());
+    Double_t uy2 = Param::SqrtK3y() * TMath::TanH(Param::K2y() * (y + shift2) / Param::PitchAnodeCathode());
+
+    return Param::K4y() * (TMath::ATan(uy2) - TMath::ATan(uy1));
+  }
+
   // add charge to existing digit
   void addCharge(float q) { mQ += q; }
 
@@ -79,32 +113,17 @@ class Digit : public DigitBase
   static float IntPartMathiX(float x, int pad)
   {
     // Integration of Mathieson.
-    // This is the answer to electrostatic problem of charge distrubution in MWPC described elsewhere. (NIM A370(1988)602-603)
     // Arguments: x,y- position of the center of Mathieson distribution
     //  Returns: a charge fraction [0-1] imposed into the pad
-    auto shift1 = -LorsX(pad) + 0.5 * Param::SizePadX();
-    auto shift2 = -LorsX(pad) - 0.5 * Param::SizePadX();
-
-    auto ux1 = Param::SqrtK3x() * TMath::TanH(Param::K2x() * (x + shift1) / Param::PitchAnodeCathode());
-    auto ux2 = Param::SqrtK3x() * TMath::TanH(Param::K2x() * (x + shift2) / o2::hmpid::Param::PitchAnodeCathode());
-
-    return o2::hmpid::Param::K4x() * (TMath::ATan(ux2) - TMath::ATan(ux1));
+    return getMathiesonIntegralX(x, Param::A2P(pad), Param::A2X(pad));
   }
-  //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
   static Double_t IntPartMathiY(Double_t y, int pad)
   {
     // Integration of Mathieson.
-    // This is the answer to electrostatic problem of charge distrubution in MWPC described elsewhere. (NIM A370(1988)602-603)
     // Arguments: x,y- position of the center of Mathieson distribution
     //  Returns: a charge fraction [0-1] imposed into the pad
-    Double_t shift1 = -LorsY(pad) + 0.5 * o2::hmpid::Param::SizePadY();
-    Double_t shift2 = -LorsY(pad) - 0.5 * o2::hmpid::Param::SizePadY();
-
-    Double_t uy1 = Param::SqrtK3y() * TMath::TanH(Param::K2y() * (y + shift1) / Param::PitchAnodeCathode());
-    Double_t uy2 = Param::SqrtK3y() * TMath::TanH(Param::K2y() * (y + shift2) / Param::PitchAnodeCathode());
-
-    return Param::K4y() * (TMath::ATan(uy2) - TMath::ATan(uy1));
+    return getMathiesonIntegralY(y, Param::A2P(pad), Param::A2Y(pad));
   }
 
   static float InMathieson(float localX, float localY, int pad)
@@ -67,6 +67,8 @@ class HMPIDDigitizer
   }
 
   // this will process hits and fill the digit vector with digits which are finalized
+  // (the hits are processed as one batch: first the pads and charges of all hits, then the
+  // charge sharing of all hits and finally the accumulation into the digits)
   void process(std::vector<o2::hmpid::HitType> const&, std::vector<o2::hmpid::Digit>& digit);
 
   // flush accumulated digits into the given container
@@ -76,9 +78,11 @@ class HMPIDDigitizer
 
  private:
   void zeroSuppress(std::vector<o2::hmpid::Digit> const& digits, std::vector<o2::hmpid::Digit>& newdigits,
-                    o2::dataformats::MCTruthContainer<o2::MCCompLabel> const& labels,
                     o2::dataformats::MCTruthContainer<o2::MCCompLabel>* newlabels);
 
+  // adds the label to the digit at index unless it is already there
+  void addLabel(int index, o2::MCCompLabel const& label);
+
   float getThreshold(o2::hmpid::Digit const&) const; // gives back threshold to apply for a certain digit
                                                      // (using noise and other tables for pad)
 
@@ -91,17 +95,40 @@ class HMPIDDigitizer
   constexpr static double TRACKHOLDTIME = 1200; // defines the window for pile-up after a trigger received in nanoseconds
   constexpr static double BUSYTIME = 22000;     // the time for which no new trigger can be received in nanoseconds
 
-  std::map<int, short> mIndexForPad; //! logarithmic mapping of pad to digit index
-
-  std::vector<int> mInvolvedPads; //! list of pads where digits created
+  // number of pads of all chambers, a pad (ch, pc, px, py) has the flat index ((ch * 6 + pc) * 80 + px) * 48 + py
+  constexpr static int NPADSX = Param::kPadPcX;
+  constexpr static int NPADSY = Param::kPadPcY;
+  constexpr static int NPADS = (Param::kMaxCh + 1) * (Param::kMaxPc + 1) * NPADSX * NPADSY;
+
+  std::vector<int> mIndexForPad; //! flat mapping of pad to digit index, -1 for pads without digit
+
+  std::vector<int> mInvolvedPads; //! list of flat pad indices where digits created
+
+  // labels of the digits, the labels of one digit are linked in the order they were added
+  struct LabelLink {
+    o2::MCCompLabel label;
+    int next = -1; // index of the next label of the same digit
+  };
+  std::vector<LabelLink> mLabelPool; //! labels of all digits
+  std::vector<int> mFirstLabel;      //! index of the first label of each digit, -1 if none
+
+  // hits of the current batch with their pad, charge and charge sharing
+  struct HitCharge {
+    int hit;             // index of the hit in the batch
+    int chamber, pc, px, py;
+    float localX, localY;
+    float totalQ;
+    float fractionX[3];  // Mathieson integrals of the pad columns px - 1, px, px + 1
+    double fractionY[3]; // Mathieson integrals of the pad rows py - 1, py, py + 1
+  };
+  std::vector<HitCharge> mHitCharges; //! workspace of process
 
   int mReadoutCounter = -1;
 
   // other stuff needed for digitization
-  o2::dataformats::MCTruthContainer<o2::MCCompLabel> mTmpLabelContainer;                   // temp label container as workspace
   o2::dataformats::MCTruthContainer<o2::MCCompLabel>* mRegisteredLabelContainer = nullptr; // label container to be filled
 
-  ClassDefNV(HMPIDDigitizer, 1);
+  ClassDefNV(HMPIDDigitizer, 2);
 };
 } // namespace hmpid
 } // namespace o2
@@ -23,7 +23,6 @@ float HMPIDDigitizer::getThreshold(o2::hmpid::Digit const& digiti) const
 
 // applies threshold to digits; removes the ones below a certain charge threshold
 void HMPIDDigitizer::zeroSuppress(std::vector<o2::hmpid::Digit> const& digits, std::vector<o2::hmpid::Digit>& newdigits,
-                                  o2::dataformats::MCTruthContainer<o2::MCCompLabel> const& labels,
                                   o2::dataformats::MCTruthContainer<o2::MCCompLabel>* newlabels)
 {
   int index = 0;
@@ -33,7 +32,9 @@ void HMPIDDigitizer::zeroSuppress(std::vector<o2::hmpid::Digit> const& digits, s
 
       if (newlabels) {
         // copy the labels to the new place with the right new index
-        newlabels->addElements(newdigits.size() - 1, labels.getLabels(index));
+        for (int l = mFirstLabel[index]; l != -1; l = mLabelPool[l].next) {
+          newlabels->addElement(newdigits.size() - 1, mLabelPool[l].label);
+        }
       }
     }
     index++;
@@ -43,78 +44,102 @@ void HMPIDDigitizer::zeroSuppress(std::vector<o2::hmpid::Digit> const& digits, s
 void HMPIDDigitizer::flush(std::vector<o2::hmpid::Digit>& digits)
 {
   // flushing and finalizing digits in the workspace
-  zeroSuppress(mDigits, digits, mTmpLabelContainer, mRegisteredLabelContainer);
+  zeroSuppress(mDigits, digits, mRegisteredLabelContainer);
   reset();
 }
 
 void HMPIDDigitizer::reset()
 {
-  mIndexForPad.clear();
+  // only the pads which got a digit have to be cleared
+  for (auto pad : mInvolvedPads) {
+    mIndexForPad[pad] = -1;
+  }
   mInvolvedPads.clear();
   mDigits.clear();
-  mTmpLabelContainer.clear();
+  mLabelPool.clear();
+  mFirstLabel.clear();
+}
+
+void HMPIDDigitizer::addLabel(int index, o2::MCCompLabel const& label)
+{
+  int last = -1;
+  for (int l = mFirstLabel[index]; l != -1; l = mLabelPool[l].next) {
+    if (mLabelPool[l].label == label) {
+      return;
+    }
+    last = l;
+  }
+  mLabelPool.push_back({ label, -1 });
+  if (last == -1) {
+    mFirstLabel[index] = mLabelPool.size() - 1;
+  } else {
+    mLabelPool[last].next = mLabelPool.size() - 1;
+  }
 }
 
 // this will process hits and fill the digit vector with digits which are finalized
 void HMPIDDigitizer::process(std::vector<o2::hmpid::HitType> const& hits, std::vector<o2::hmpid::Digit>& digits)
 {
-  for (auto& hit : hits) {
-    int chamber, pc, px, py;
-    float totalQ;
-    // retrieves center pad and the total charge
-    Digit::getPadAndTotalCharge(hit, chamber, pc, px, py, totalQ);
+  if (mIndexForPad.empty()) {
+    mIndexForPad.resize(NPADS, -1);
+  }
 
-    if (px < 0 || py < 0) {
+  // retrieve the center pad and the total charge of all hits, in the order of
+  // the hits since the charge is sampled with random numbers
+  mHitCharges.clear();
+  for (size_t ihit = 0; ihit < hits.size(); ++ihit) {
+    HitCharge hc;
+    hc.hit = ihit;
+    Digit::getPadAndTotalCharge(hits[ihit], hc.chamber, hc.pc, hc.px, hc.py, hc.localX, hc.localY, hc.totalQ);
+    if (hc.px < 0 || hc.py < 0) {
       continue;
     }
+    mHitCharges.push_back(hc);
+  }
 
-    // determine which pads to loop over
-    std::array<int, 9> allpads;
-    int counter = 0;
-    for (int nx = -1; nx <= 1; ++nx) {
-      for (int ny = -1; ny <= 1; ++ny) {
-        allpads[counter] = Param::Abs(chamber, pc, px + nx, py + ny);
-        counter++;
-      }
+  // charge sharing: the fraction of a pad is the product of the integrals of
+  // the Mathieson distribution over its column and its row, so 3 + 3 integrals
+  // give the fractions of the 3x3 pads around the center pad
+  for (auto& hc : mHitCharges) {
+    for (int n = 0; n < 3; ++n) {
+      hc.fractionX[n] = Digit::getMathiesonIntegralX(hc.localX, hc.pc, hc.px + n - 1);
+    }
+    for (int n = 0; n < 3; ++n) {
+      hc.fractionY[n] = Digit::getMathiesonIntegralY(hc.localY, hc.pc, hc.py + n - 1);
     }
+  }
 
-    for (auto& pad : allpads) {
-      auto iter = mIndexForPad.find(pad);
-      int index = -1;
-      if (iter != mIndexForPad.end()) {
-        index = iter->second;
+  // accumulate the charges into the digits; pads outside of the photocathode are skipped
+  for (auto const& hc : mHitCharges) {
+    const o2::MCCompLabel label(hits[hc.hit].GetTrackID(), mEventID, mSrcID);
+    for (int nx = 0; nx < 3; ++nx) {
+      const int px = hc.px + nx - 1;
+      if (px < 0 || px >= NPADSX) {
+        continue;
       }
-      // auto index = mIndexForPad[pad];
-      float fraction = Digit::getFractionalContributionForPad(hit, pad);
-      // LOG(INFO) << "FRACTION ON PAD " << pad << " IS " << fraction;
-      if (index != -1) {
-        // digit exists ... reuse
-        auto& digit = mDigits[index];
-        digit.addCharge(totalQ * fraction);
+      for (int ny = 0; ny < 3; ++ny) {
+        const int py = hc.py + ny - 1;
+        if (py < 0 || py >= NPADSY) {
+          continue;
+        }
+        const int flatPad = ((hc.chamber * (Param::kMaxPc + 1) + hc.pc) * NPADSX + px) * NPADSY + py;
+        const float fraction = 4. * hc.fractionX[nx] * hc.fractionY[ny];
 
-        if (mRegisteredLabelContainer) {
-          auto labels = mTmpLabelContainer.getLabels(index);
-          o2::MCCompLabel newlabel(hit.GetTrackID(), mEventID, mSrcID);
-          bool newlabelneeded = true;
-          for (auto& l : labels) {
-            if (l == newlabel) {
-              newlabelneeded = false;
-              break;
-            }
-          }
-          if (newlabelneeded) {
-            mTmpLabelContainer.addElementRandomAccess(index, newlabel);
-          }
+        int index = mIndexForPad[flatPad];
+        if (index != -1) {
+          // digit exists ... reuse
+          mDigits[index].addCharge(hc.totalQ * fraction);
+        } else {
+          // create digit ... and register
+          index = mDigits.size();
+          mDigits.emplace_back(mCurrentTriggerTime, Param::Abs(hc.chamber, hc.pc, px, py), hc.totalQ * fraction);
+          mIndexForPad[flatPad] = index;
+          mInvolvedPads.emplace_back(flatPad);
+          mFirstLabel.emplace_back(-1);
         }
-      } else {
-        // create digit ... and register
-        mDigits.emplace_back(mCurrentTriggerTime, pad, totalQ * fraction);
-        mIndexForPad[pad] = mDigits.size() - 1;
-        mInvolvedPads.emplace_back(pad);
 
         if (mRegisteredLabelContainer) {
-          // add label for this digit
-          mTmpLabelContainer.addElement(mDigits.size() - 1, o2::MCCompLabel(hit.GetTrackID(), mEventID, mSrcID));
+          addLabel(index, label);
         }
       }
     }
@@ -0,0 +1,68 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmark_HMPIDDigitizer.cxx
+/// \brief Benchmark of the HMPID digitization for increasing hit multiplicities
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "HMPIDBase/Param.h"
+#include "HMPIDSimulation/HMPIDDigitizer.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+
+using namespace o2::hmpid;
+
+namespace
+{
+/// Hits uniformly distributed over the photocathodes of all chambers, in the ideal geometry
+std::vector<HitType> createHits(int nHits)
+{
+  auto param = Param::InstanceNoGeo();
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> x(0.f, Param::SizeAllX());
+  std::uniform_real_distribution<float> y(0.f, Param::SizeAllY());
+  std::uniform_int_distribution<int> chamber(Param::kMinCh, Param::kMaxCh);
+  std::vector<HitType> hits;
+  for (int i = 0; i < nHits; ++i) {
+    const int ch = chamber(generator);
+    double mars[3];
+    param->Lors2Mars(ch, x(generator), y(generator), mars);
+    hits.emplace_back(mars[0], mars[1], mars[2], 1.e-7, 1.e-7, i, ch);
+  }
+  return hits;
+}
+} // namespace
+
+// Digitization of state.range(0) hits in one readout cycle, with MC labels
+static void BM_HMPIDDigitizer(benchmark::State& state)
+{
+  const auto hits = createHits(state.range(0));
+  HMPIDDigitizer digitizer;
+  o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels;
+  std::vector<Digit> digits;
+  digitizer.setLabelContainer(&labels);
+  digitizer.setTriggerTime(0.);
+
+  for (auto _ : state) {
+    digits.clear();
+    labels.clear();
+    digitizer.process(hits, digits);
+    digitizer.flush(digits);
+    benchmark::DoNotOptimize(digits.data());
+  }
+  state.SetItemsProcessed(state.iterations() * hits.size());
+}
+
+BENCHMARK(BM_HMPIDDigitizer)->RangeMultiplier(4)->Range(1 << 8, 1 << 16)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN()
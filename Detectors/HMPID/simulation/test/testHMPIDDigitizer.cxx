@@ -0,0 +1,130 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testHMPIDDigitizer.cxx
+/// \brief Compares the digits of the HMPID digitizer with the charge sharing computed pad by pad
+
+#define BOOST_TEST_MODULE Test HMPID Digitizer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <map>
+#include <vector>
+#include "TRandom.h"
+#include "HMPIDBase/Digit.h"
+#include "HMPIDBase/Param.h"
+#include "HMPIDSimulation/HMPIDDigitizer.h"
+
+using namespace o2::hmpid;
+
+namespace
+{
+const int Seed = 42;
+const float Threshold = 4.; // zero suppression threshold of the digitizer
+
+struct ReferenceDigit {
+  float charge = 0.;
+  bool inside = true; // whether the pad is in the photocathode of the hit
+};
+
+/// hit at the local coordinates (x, y) of the chamber ch
+HitType createHit(int ch, float x, float y, int trackID)
+{
+  double mars[3];
+  Param::InstanceNoGeo()->Lors2Mars(ch, x, y, mars);
+  return HitType(mars[0], mars[1], mars[2], 1.e-7, 1.e-6, trackID, ch);
+}
+
+/// charge of the 3x3 pads around the pad of each hit, computed pad by pad with
+/// Digit::getFractionalContributionForPad, before the zero suppression
+std::map<int, ReferenceDigit> shareChargePerPad(std::vector<HitType> const& hits)
+{
+  std::map<int, ReferenceDigit> digits;
+  for (auto& hit : hits) {
+    int chamber, pc, px, py;
+    float totalQ;
+    Digit::getPadAndTotalCharge(hit, chamber, pc, px, py, totalQ);
+    if (px < 0 || py < 0) {
+      continue;
+    }
+    for (int nx = -1; nx <= 1; ++nx) {
+      for (int ny = -1; ny <= 1; ++ny) {
+        const int pad = Param::Abs(chamber, pc, px + nx, py + ny);
+        auto& digit = digits[pad];
+        digit.charge += totalQ * Digit::getFractionalContributionForPad(hit, pad);
+        digit.inside = px + nx >= 0 && px + nx < Param::kPadPcX && py + ny >= 0 && py + ny < Param::kPadPcY;
+      }
+    }
+  }
+  return digits;
+}
+
+/// Digitizes the hits and checks the digits against the ones computed pad by pad, with
+/// the same random numbers. Returns the number of pads outside of the photocathodes.
+int compareWithPerPad(std::vector<HitType> const& hits)
+{
+  gRandom->SetSeed(Seed);
+  const auto reference = shareChargePerPad(hits);
+
+  gRandom->SetSeed(Seed);
+  HMPIDDigitizer digitizer;
+  std::vector<Digit> digits;
+  digitizer.setTriggerTime(0.);
+  digitizer.process(hits, digits);
+  digitizer.flush(digits);
+
+  size_t nExpected = 0;
+  int nOutside = 0;
+  for (auto& entry : reference) {
+    if (!entry.second.inside) {
+      ++nOutside;
+    } else if (entry.second.charge >= Threshold) {
+      ++nExpected;
+    }
+  }
+  BOOST_CHECK_EQUAL(digits.size(), nExpected);
+  for (auto& digit : digits) {
+    BOOST_TEST_CONTEXT("pad " << digit.getPadID())
+    {
+      auto iter = reference.find(digit.getPadID());
+      BOOST_REQUIRE(iter != reference.end());
+      BOOST_CHECK(iter->second.inside);
+      BOOST_CHECK_CLOSE(digit.getCharge(), iter->second.charge, 1e-3);
+    }
+  }
+  return nOutside;
+}
+} // namespace
+
+/// Hits in the interior of the photocathodes, two of them sharing pads
+BOOST_AUTO_TEST_CASE(HMPIDDigitizer_interior)
+{
+  Param::InstanceNoGeo(); // the pad sizes are set with the instance
+  std::vector<HitType> hits{
+    createHit(0, Param::LorsX(0, 40) + 0.1, Param::LorsY(0, 24) - 0.2, 0),
+    createHit(0, Param::LorsX(0, 41) - 0.3, Param::LorsY(0, 25) + 0.1, 1),
+    createHit(3, Param::LorsX(2, 10), Param::LorsY(2, 30), 2),
+  };
+  BOOST_CHECK_EQUAL(compareWithPerPad(hits), 0);
+}
+
+/// Hits in the pads at the edge of the photocathodes, whose neighbours outside of the
+/// photocathode do not give digits
+BOOST_AUTO_TEST_CASE(HMPIDDigitizer_edge)
+{
+  Param::InstanceNoGeo(); // the pad sizes are set with the instance
+  std::vector<HitType> hits{
+    createHit(1, Param::LorsX(0, 0) - 0.2, Param::LorsY(0, 0) - 0.2, 0),             // corner
+    createHit(2, Param::LorsX(0, Param::kPadPcX - 1) + 0.2, Param::LorsY(0, 20), 1), // side in x
+    createHit(5, Param::LorsX(3, 40), Param::LorsY(3, Param::kPadPcY - 1) + 0.2, 2), // side in y
+  };
+  // 5 pads around the corner and 3 along each side are outside of the photocathode
+  BOOST_CHECK_EQUAL(compareWithPerPad(hits), 11);
+}
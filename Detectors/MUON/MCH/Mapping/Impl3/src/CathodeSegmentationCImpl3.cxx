@@ -46,6 +46,13 @@ int mchCathodeSegmentationFindPadByPosition(MchCathodeSegmentationHandle segHand
   return segHandle->impl->findPadByPosition(x, y);
 }
 
+MCHMAPPINGIMPL3_EXPORT
+void mchCathodeSegmentationFindPadsByPositions(MchCathodeSegmentationHandle segHandle, int npoints, const double* x,
+                                               const double* y, int* catPadIndexs)
+{
+  segHandle->impl->findPadsByPositions(npoints, x, y, catPadIndexs);
+}
+
 MCHMAPPINGIMPL3_EXPORT
 int mchCathodeSegmentationFindPadByFEE(MchCathodeSegmentationHandle segHandle, int dualSampaId, int dualSampaChannel)
 {
@@ -150,8 +157,6 @@ MCHMAPPINGIMPL3_EXPORT
 void mchCathodeSegmentationForEachNeighbouringPad(MchCathodeSegmentationHandle segHandle, int catPadIndex, MchPadHandler handler,
                                                   void* userData)
 {
-  for (auto p : segHandle->impl->getNeighbouringCatPadIndexs(catPadIndex)) {
-    handler(userData, p);
-  }
+  segHandle->impl->forEachNeighbouringCatPadIndex(catPadIndex, [handler, userData](int p) { handler(userData, p); });
 }
 } // extern "C"
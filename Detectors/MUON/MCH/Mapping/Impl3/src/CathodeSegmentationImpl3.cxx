@@ -18,8 +18,11 @@
 #include "PadSize.h"
 #include "MCHMappingInterface/CathodeSegmentation.h"
 #include "CathodeSegmentationCreator.h"
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <set>
@@ -39,6 +42,12 @@ namespace mapping
 namespace impl3
 {
 
+namespace
+{
+// tolerance (in cm) used to decide whether a position is within a pad
+const double epsilon{ 1E-4 };
+} // namespace
+
 CathodeSegmentation* createCathodeSegmentation(int detElemId, bool isBendingPlane)
 {
   int segType = detElemId2SegType(detElemId);
@@ -70,6 +79,7 @@ void CathodeSegmentation::fillRtree()
 
           mRtree.insert(std::make_pair(
             CathodeSegmentation::Box{ CathodeSegmentation::Point(xmin, ymin), CathodeSegmentation::Point(xmax, ymax) }, catPadIndex));
+          mPadBoxes.push_back({ xmin, ymin, xmax, ymax });
 
           mCatPadIndex2PadGroupIndex.push_back(padGroupIndex);
           mCatPadIndex2PadGroupTypeFastIndex.push_back(pgt.fastIndex(ix, iy));
@@ -80,6 +90,89 @@ void CathodeSegmentation::fillRtree()
   }
 }
 
+void CathodeSegmentation::fillPadGrids()
+{
+  // one grid per pad size, with pads extended by epsilon so that all the pads
+  // that might contain a position are found in the cell of that position
+  for (auto padSizeId = 0; padSizeId < mPadSizes.size(); ++padSizeId) {
+    PadGrid grid;
+    grid.mCellSizeX = mPadSizes[padSizeId].first;
+    grid.mCellSizeY = mPadSizes[padSizeId].second;
+    std::vector<int> catPadIndexs;
+    double xmax{ std::numeric_limits<double>::lowest() };
+    double ymax{ std::numeric_limits<double>::lowest() };
+    grid.mXmin = std::numeric_limits<double>::max();
+    grid.mYmin = std::numeric_limits<double>::max();
+    for (auto catPadIndex = 0; catPadIndex < mPadBoxes.size(); ++catPadIndex) {
+      if (padGroup(catPadIndex).mPadSizeId != padSizeId) {
+        continue;
+      }
+      catPadIndexs.push_back(catPadIndex);
+      auto& box = mPadBoxes[catPadIndex];
+      grid.mXmin = std::min(grid.mXmin, box.xmin - epsilon);
+      grid.mYmin = std::min(grid.mYmin, box.ymin - epsilon);
+      xmax = std::max(xmax, box.xmax + epsilon);
+      ymax = std::max(ymax, box.ymax + epsilon);
+    }
+    if (catPadIndexs.empty()) {
+      continue;
+    }
+    grid.mNofCellsX = static_cast<int>(std::floor((xmax - grid.mXmin) / grid.mCellSizeX)) + 1;
+    grid.mNofCellsY = static_cast<int>(std::floor((ymax - grid.mYmin) / grid.mCellSizeY)) + 1;
+
+    auto cellRange = [](double min, double max, double origin, double cellSize, int nofCells) {
+      int i1 = std::max(0, static_cast<int>(std::floor((min - origin) / cellSize)));
+      int i2 = std::min(nofCells - 1, static_cast<int>(std::floor((max - origin) / cellSize)));
+      return std::make_pair(i1, i2);
+    };
+
+    // two passes : count the pads of each cell, then fill them in
+    grid.mCellOffsets.assign(grid.mNofCellsX * grid.mNofCellsY + 1, 0);
+    for (int pass = 0; pass < 2; ++pass) {
+      std::vector<int> fill(grid.mCellOffsets.begin(), grid.mCellOffsets.end() - 1);
+      for (auto catPadIndex : catPadIndexs) {
+        auto& box = mPadBoxes[catPadIndex];
+        auto ix = cellRange(box.xmin - epsilon, box.xmax + epsilon, grid.mXmin, grid.mCellSizeX, grid.mNofCellsX);
+        auto iy = cellRange(box.ymin - epsilon, box.ymax + epsilon, grid.mYmin, grid.mCellSizeY, grid.mNofCellsY);
+        for (int i = ix.first; i <= ix.second; ++i) {
+          for (int j = iy.first; j <= iy.second; ++j) {
+            int cell = i + j * grid.mNofCellsX;
+            if (pass == 0) {
+              ++grid.mCellOffsets[cell + 1];
+            } else {
+              grid.mCatPadIndexs[fill[cell]++] = catPadIndex;
+            }
+          }
+        }
+      }
+      if (pass == 0) {
+        for (auto i = 1; i < grid.mCellOffsets.size(); ++i) {
+          grid.mCellOffsets[i] += grid.mCellOffsets[i - 1];
+        }
+        grid.mCatPadIndexs.resize(grid.mCellOffsets.back());
+      }
+    }
+    mPadGrids.push_back(std::move(grid));
+  }
+}
+
+void CathodeSegmentation::fillNeighbours()
+{
+  const double offset{ 0.1 }; // 1 mm
+
+  mNeighbourOffsets.reserve(mPadBoxes.size() + 1);
+  mNeighbourOffsets.push_back(0);
+  for (auto catPadIndex = 0; catPadIndex < mPadBoxes.size(); ++catPadIndex) {
+    auto& box = mPadBoxes[catPadIndex];
+    for (auto p : getCatPadIndexs(box.xmin - offset, box.ymin - offset, box.xmax + offset, box.ymax + offset)) {
+      if (p != catPadIndex) {
+        mNeighbours.push_back(p);
+      }
+    }
+    mNeighbourOffsets.push_back(mNeighbours.size());
+  }
+}
+
 std::set<int> getUnique(const std::vector<PadGroup>& padGroups)
 {
   // extract from padGroup vector the unique integer values given by func
@@ -112,9 +205,15 @@ CathodeSegmentation::CathodeSegmentation(int segType, bool isBendingPlane, std::
     mPadSizes{ std::move(padSizes) },
     mCatPadIndex2PadGroupIndex{},
     mCatPadIndex2PadGroupTypeFastIndex{},
-    mPadGroupIndex2CatPadIndexIndex{}
+    mPadGroupIndex2CatPadIndexIndex{},
+    mPadBoxes{},
+    mPadGrids{},
+    mNeighbourOffsets{},
+    mNeighbours{}
 {
   fillRtree();
+  fillPadGrids();
+  fillNeighbours();
 }
 
 std::vector<int> CathodeSegmentation::getCatPadIndexs(int dualSampaId) const
@@ -148,44 +247,48 @@ std::vector<int> CathodeSegmentation::getCatPadIndexs(double xmin, double ymin,
 
 std::vector<int> CathodeSegmentation::getNeighbouringCatPadIndexs(int catPadIndex) const
 {
-  double x = padPositionX(catPadIndex);
-  double y = padPositionY(catPadIndex);
-  double dx = padSizeX(catPadIndex) / 2.0;
-  double dy = padSizeY(catPadIndex) / 2.0;
-
-  const double offset{ 0.1 }; // 1 mm
-
-  auto pads = getCatPadIndexs(x - dx - offset, y - dy - offset, x + dx + offset, y + dy + offset);
-  pads.erase(std::remove(begin(pads), end(pads), catPadIndex), end(pads));
-  return pads;
-}
-
-double CathodeSegmentation::squaredDistance(int catPadIndex, double x, double y) const
-{
-  double px = padPositionX(catPadIndex) - x;
-  double py = padPositionY(catPadIndex) - y;
-  return px * px + py * py;
+  return std::vector<int>(mNeighbours.begin() + mNeighbourOffsets[catPadIndex],
+                          mNeighbours.begin() + mNeighbourOffsets[catPadIndex + 1]);
 }
 
 int CathodeSegmentation::findPadByPosition(double x, double y) const
 {
-  const double epsilon{ 1E-4 };
-  auto pads = getCatPadIndexs(x - epsilon, y - epsilon, x + epsilon, y + epsilon);
-
   double dmin{ std::numeric_limits<double>::max() };
   int catPadIndex{ InvalidCatPadIndex };
 
-  for (auto i = 0; i < pads.size(); ++i) {
-    double d{ squaredDistance(pads[i], x, y) };
-    if (d < dmin) {
-      catPadIndex = pads[i];
-      dmin = d;
+  for (auto& grid : mPadGrids) {
+    int ix = static_cast<int>(std::floor((x - grid.mXmin) / grid.mCellSizeX));
+    int iy = static_cast<int>(std::floor((y - grid.mYmin) / grid.mCellSizeY));
+    if (ix < 0 || ix >= grid.mNofCellsX || iy < 0 || iy >= grid.mNofCellsY) {
+      continue;
+    }
+    int cell = ix + iy * grid.mNofCellsX;
+    for (auto i = grid.mCellOffsets[cell]; i < grid.mCellOffsets[cell + 1]; ++i) {
+      int p = grid.mCatPadIndexs[i];
+      auto& box = mPadBoxes[p];
+      if (x + epsilon < box.xmin || x - epsilon > box.xmax || y + epsilon < box.ymin || y - epsilon > box.ymax) {
+        continue;
+      }
+      double px = 0.5 * (box.xmin + box.xmax) - x;
+      double py = 0.5 * (box.ymin + box.ymax) - y;
+      double d{ px * px + py * py };
+      if (d < dmin) {
+        catPadIndex = p;
+        dmin = d;
+      }
     }
   }
 
   return catPadIndex;
 }
 
+void CathodeSegmentation::findPadsByPositions(int npoints, const double* x, const double* y, int* catPadIndexs) const
+{
+  for (auto i = 0; i < npoints; ++i) {
+    catPadIndexs[i] = findPadByPosition(x[i], y[i]);
+  }
+}
+
 const PadGroup& CathodeSegmentation::padGroup(int catPadIndex) const { return gsl::at(mPadGroups, mCatPadIndex2PadGroupIndex[catPadIndex]); }
 
 const PadGroupType& CathodeSegmentation::padGroupType(int catPadIndex) const
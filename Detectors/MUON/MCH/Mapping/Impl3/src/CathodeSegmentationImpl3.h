@@ -51,10 +51,22 @@ class CathodeSegmentation
   /// Return the list of catPadIndexs of the pads which are neighbours to catPadIndex
   std::vector<int> getNeighbouringCatPadIndexs(int catPadIndex) const;
 
+  /// Call func(neighbourCatPadIndex) for each of the pads which are neighbours to catPadIndex
+  template <typename CALLABLE>
+  void forEachNeighbouringCatPadIndex(int catPadIndex, CALLABLE&& func) const
+  {
+    for (auto i = mNeighbourOffsets[catPadIndex]; i < mNeighbourOffsets[catPadIndex + 1]; ++i) {
+      func(mNeighbours[i]);
+    }
+  }
+
   std::set<int> dualSampaIds() const { return mDualSampaIds; }
 
   int findPadByPosition(double x, double y) const;
 
+  /// Find the pads at positions (x[i],y[i]) and store them in catPadIndexs[i], for i in [0,npoints)
+  void findPadsByPositions(int npoints, const double* x, const double* y, int* catPadIndexs) const;
+
   int findPadByFEE(int dualSampaId, int dualSampaChannel) const;
 
   bool hasPadByPosition(double x, double y) const { return findPadByPosition(x, y) != InvalidCatPadIndex; }
@@ -83,15 +95,39 @@ class CathodeSegmentation
 
   void fillRtree();
 
+  void fillPadGrids();
+
+  void fillNeighbours();
+
   std::ostream& showPad(std::ostream& out, int index) const;
 
   const PadGroup& padGroup(int catPadIndex) const;
 
   const PadGroupType& padGroupType(int catPadIndex) const;
 
-  double squaredDistance(int catPadIndex, double x, double y) const;
-
  private:
+  /// Uniform grid covering the pads of one given size, with cells of the size of those pads.
+  /// Each cell holds the (at most a few) pads overlapping it, stored in CSR form :
+  /// the pads of cell i are mCatPadIndexs[mCellOffsets[i]..mCellOffsets[i+1]-1]
+  struct PadGrid {
+    double mXmin;
+    double mYmin;
+    double mCellSizeX;
+    double mCellSizeY;
+    int mNofCellsX;
+    int mNofCellsY;
+    std::vector<int> mCellOffsets;
+    std::vector<int> mCatPadIndexs;
+  };
+
+  /// Bounding box of one pad
+  struct PadBox {
+    double xmin;
+    double ymin;
+    double xmax;
+    double ymax;
+  };
+
   int mSegType;
   bool mIsBendingPlane;
   std::vector<PadGroup> mPadGroups;
@@ -102,6 +138,10 @@ class CathodeSegmentation
   std::vector<int> mCatPadIndex2PadGroupIndex;
   std::vector<int> mCatPadIndex2PadGroupTypeFastIndex;
   std::vector<int> mPadGroupIndex2CatPadIndexIndex;
+  std::vector<PadBox> mPadBoxes;
+  std::vector<PadGrid> mPadGrids;
+  std::vector<int> mNeighbourOffsets;
+  std::vector<int> mNeighbours;
 };
 
 CathodeSegmentation* createCathodeSegmentation(int detElemId, bool isBendingPlane);
@@ -143,6 +143,12 @@ class CathodeSegmentation
   /** Find the pad at position (x,y) (in cm). */
   int findPadByPosition(double x, double y) const { return mchCathodeSegmentationFindPadByPosition(mImpl, x, y); }
 
+  /** Find the pads at positions (x[i],y[i]) (in cm) and store them in catPadIndexs[i], for i in [0,npoints). */
+  void findPadsByPositions(int npoints, const double* x, const double* y, int* catPadIndexs) const
+  {
+    mchCathodeSegmentationFindPadsByPositions(mImpl, npoints, x, y, catPadIndexs);
+  }
+
   /** Find the pad connected to the given channel of the given dual sampa. */
   int findPadByFEE(int dualSampaId, int dualSampaChannel) const
   {
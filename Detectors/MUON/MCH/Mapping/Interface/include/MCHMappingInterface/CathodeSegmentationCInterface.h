@@ -76,6 +76,10 @@ int mchCathodeSegmentationIsPadValid(MchCathodeSegmentationHandle segHandle, int
 /// Find the pad at position (x,y) (in cm).
 int mchCathodeSegmentationFindPadByPosition(MchCathodeSegmentationHandle segHandle, double x, double y);
 
+/// Find the pads at positions (x[i],y[i]) (in cm) and store them in catPadIndexs[i], for i in [0,npoints).
+void mchCathodeSegmentationFindPadsByPositions(MchCathodeSegmentationHandle segHandle, int npoints, const double* x,
+                                               const double* y, int* catPadIndexs);
+
 /// Find the pad connected to the given channel of the given dual sampa.
 int mchCathodeSegmentationFindPadByFEE(MchCathodeSegmentationHandle segHandle, int dualSampaId, int dualSampaChannel);
 ///@}
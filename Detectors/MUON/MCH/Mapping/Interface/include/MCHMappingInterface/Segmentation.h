@@ -121,6 +121,12 @@ class Segmentation
   */
   bool findPadPairByPosition(double x, double y, int& bpad, int& nbpad) const;
 
+  /** Find the pads at positions (x[i],y[i]) (in cm), for i in [0,npoints).
+    @param bpads filled with the dePadIndex of the bending pad at each position, or -1 if there is none
+    @param nbpads filled with the dePadIndex of the non-bending pad at each position, or -1 if there is none
+  */
+  void findPadPairsByPositions(int npoints, const double* x, const double* y, int* bpads, int* nbpads) const;
+
   /** Find the pad connected to the given channel of the given dual sampa. */
   int findPadByFEE(int dualSampaId, int dualSampaChannel) const;
   ///@}
@@ -227,6 +233,17 @@ inline bool Segmentation::findPadPairByPosition(double x, double y, int& b, int&
   return true;
 }
 
+inline void Segmentation::findPadPairsByPositions(int npoints, const double* x, const double* y, int* bpads,
+                                                  int* nbpads) const
+{
+  mBending.findPadsByPositions(npoints, x, y, bpads);
+  mNonBending.findPadsByPositions(npoints, x, y, nbpads);
+  for (auto i = 0; i < npoints; ++i) {
+    bpads[i] = mBending.isValid(bpads[i]) ? padC2DE(bpads[i], true) : -1;
+    nbpads[i] = mNonBending.isValid(nbpads[i]) ? padC2DE(nbpads[i], false) : -1;
+  }
+}
+
 template <typename CALLABLE>
 void Segmentation::forEachPad(CALLABLE&& func) const
 {
@@ -108,10 +108,57 @@ BENCHMARK_DEFINE_F(BenchO2, findPadByPosition)
   state.counters["ntp"] = ntp;
 }
 
+BENCHMARK_DEFINE_F(BenchO2, findPadsByPositions)
+(benchmark::State& state)
+{
+  int detElemId = state.range(0);
+  bool isBendingPlane = state.range(1);
+  o2::mch::mapping::CathodeSegmentation seg{ detElemId, isBendingPlane };
+  auto bbox = o2::mch::mapping::getBBox(seg);
+
+  const int n = 100000;
+  auto testpoints = generateUniformTestPoints(n, bbox.xmin(), bbox.ymin(), bbox.xmax(), bbox.ymax());
+  std::vector<double> x;
+  std::vector<double> y;
+  for (auto& tp : testpoints) {
+    x.push_back(tp.x);
+    y.push_back(tp.y);
+  }
+  std::vector<int> pads(n);
+
+  for (auto _ : state) {
+    seg.findPadsByPositions(n, x.data(), y.data(), pads.data());
+    benchmark::DoNotOptimize(pads.data());
+  }
+  state.counters["ntp"] = n;
+}
+
+BENCHMARK_DEFINE_F(BenchO2, forEachNeighbouringPad)
+(benchmark::State& state)
+{
+  int detElemId = state.range(0);
+  bool isBendingPlane = state.range(1);
+  o2::mch::mapping::CathodeSegmentation seg{ detElemId, isBendingPlane };
+
+  int nn{ 0 };
+  for (auto _ : state) {
+    nn = 0;
+    seg.forEachPad([&seg, &nn](int catPadIndex) {
+      seg.forEachNeighbouringPad(catPadIndex, [&nn](int) { ++nn; });
+    });
+  }
+  state.counters["nofPads"] = seg.nofPads();
+  state.counters["nofNeighbours"] = nn;
+}
+
 BENCHMARK(benchCathodeSegmentationConstructionAll)->Unit(benchmark::kMillisecond);
 
 BENCHMARK_REGISTER_F(BenchO2, findPadByPosition)->Apply(segmentationList)->Unit(benchmark::kMillisecond);
 
+BENCHMARK_REGISTER_F(BenchO2, findPadsByPositions)->Apply(segmentationList)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(BenchO2, forEachNeighbouringPad)->Apply(segmentationList)->Unit(benchmark::kMillisecond);
+
 BENCHMARK_REGISTER_F(BenchO2, ctor)->Apply(segmentationList)->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_MAIN();
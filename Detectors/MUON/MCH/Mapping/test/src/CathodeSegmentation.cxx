@@ -25,6 +25,7 @@
 #include <boost/test/data/monomorphic.hpp>
 #include <boost/test/data/monomorphic/generators/xrange.hpp>
 #include <boost/test/data/test_case.hpp>
+#include <algorithm>
 #include <limits>
 #include <fstream>
 #include <iostream>
@@ -243,6 +244,59 @@ BOOST_AUTO_TEST_CASE(LoopOnCathodeSegmentations)
   BOOST_CHECK_EQUAL(n, 42);
 }
 
+BOOST_AUTO_TEST_CASE(FindPadsByPositionsMustMatchFindPadByPosition)
+{
+  forOneDetectionElementOfEachSegmentationType([](int detElemId) {
+    for (auto plane : { true, false }) {
+      CathodeSegmentation seg{ detElemId, plane };
+      std::vector<double> x;
+      std::vector<double> y;
+      seg.forEachPad([&seg, &x, &y](int catPadIndex) {
+        // pad center, and one corner which is shared with other pads
+        x.push_back(seg.padPositionX(catPadIndex));
+        y.push_back(seg.padPositionY(catPadIndex));
+        x.push_back(seg.padPositionX(catPadIndex) + seg.padSizeX(catPadIndex) / 2.0);
+        y.push_back(seg.padPositionY(catPadIndex) + seg.padSizeY(catPadIndex) / 2.0);
+      });
+      // and one position far away from any pad
+      x.push_back(1000.0);
+      y.push_back(1000.0);
+      std::vector<int> pads(x.size());
+      seg.findPadsByPositions(x.size(), x.data(), y.data(), pads.data());
+      int nbad{ 0 };
+      for (auto i = 0; i < pads.size(); ++i) {
+        if (pads[i] != seg.findPadByPosition(x[i], y[i]) || (i % 2 == 0 && i < pads.size() - 1 && pads[i] != i / 2)) {
+          ++nbad;
+        }
+      }
+      BOOST_CHECK(seg.isValid(pads.back()) == false);
+      BOOST_CHECK_EQUAL(nbad, 0);
+    }
+  });
+}
+
+BOOST_AUTO_TEST_CASE(NeighbouringPadsMustBeSymmetric)
+{
+  forOneDetectionElementOfEachSegmentationType([](int detElemId) {
+    for (auto plane : { true, false }) {
+      CathodeSegmentation seg{ detElemId, plane };
+      std::vector<std::vector<int>> neighbours(seg.nofPads());
+      seg.forEachPad([&seg, &neighbours](int catPadIndex) {
+        seg.forEachNeighbouringPad(catPadIndex, [&neighbours, catPadIndex](int n) { neighbours[catPadIndex].push_back(n); });
+      });
+      int nbad{ 0 };
+      for (auto i = 0; i < neighbours.size(); ++i) {
+        for (auto n : neighbours[i]) {
+          if (n == i || std::find(neighbours[n].begin(), neighbours[n].end(), i) == neighbours[n].end()) {
+            ++nbad;
+          }
+        }
+      }
+      BOOST_CHECK_EQUAL(nbad, 0);
+    }
+  });
+}
+
 BOOST_AUTO_TEST_CASE(DualSampasWithLessThan64Pads)
 {
   std::map<int, int> non64;
@@ -10,9 +10,12 @@
 
 #include "PreClusterFinder.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include <fairmq/Tools.h>
@@ -25,28 +28,58 @@ namespace mch
 
 using namespace std;
 
+//_________________________________________________________________________________________________
+PreClusterFinder::~PreClusterFinder()
+{
+  /// Destructor
+  stopThreads();
+}
+
 //_________________________________________________________________________________________________
 void PreClusterFinder::init(std::string& fileName)
 {
-  /// Load the mapping and prepare the internal structure
+  /// Load the mapping from the binary file and prepare the internal structure
+
+  auto tStart = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::unique_ptr<Mapping::MpDE>> mpDEs = Mapping::readMapping(fileName.c_str());
+
+  if (mpDEs.size() < SNDEs) {
+    LOG(ERROR) << "Invalid binary mapping file " << fileName;
+    throw runtime_error(fair::mq::tools::ToString("Invalid binary mapping file ", fileName));
+  }
+
+  auto tEnd = std::chrono::high_resolution_clock::now();
+  LOG(INFO) << "Read mapping in: " << std::chrono::duration<double, std::milli>(tEnd - tStart).count() << " ms\n";
+
+  init(std::move(mpDEs));
+}
+
+//_________________________________________________________________________________________________
+void PreClusterFinder::init(std::vector<std::unique_ptr<Mapping::MpDE>> mapping)
+{
+  /// Take the given mapping, prepare the internal structure and start the worker threads
 
-  try {
-    readMapping(fileName.c_str());
-  } catch (exception const&) {
-    throw;
+  if (mapping.size() < SNDEs) {
+    throw runtime_error(fair::mq::tools::ToString("Invalid mapping with ", mapping.size(), " DEs"));
   }
 
+  setMapping(std::move(mapping));
+
   for (int iDE = 0; iDE < SNDEs; ++iDE) {
     for (int iPlane = 0; iPlane < 2; ++iPlane) {
       mPreClusters[iDE][iPlane].reserve(100);
     }
   }
+
+  startThreads();
 }
 
 //_________________________________________________________________________________________________
 void PreClusterFinder::deinit()
 {
-  /// clear the internal structure
+  /// clear the internal structure and stop the worker threads
+  stopThreads();
   reset();
   mDEIndices.clear();
 }
@@ -134,57 +167,160 @@ void PreClusterFinder::loadDigits(const DigitStruct* digits, uint32_t nDigits)
 }
 
 //_________________________________________________________________________________________________
-int PreClusterFinder::run()
+void PreClusterFinder::setNumberOfThreads(int nThreads)
 {
-  /// preclusterize each cathod separately then merge them
-  preClusterizeRecursive();
-  return mergePreClusters();
+  /// set the number of threads used to process the detection elements in parallel
+  /// use all available cores if nThreads <= 0
+  /// it takes effect when the worker threads are started in init
+  mNThreads = (nThreads > 0) ? nThreads : std::max(1u, std::thread::hardware_concurrency());
 }
 
 //_________________________________________________________________________________________________
-void PreClusterFinder::preClusterizeRecursive()
+void PreClusterFinder::startThreads()
 {
-  /// preclusterize both planes of every DE using recursive algorithm
+  /// start the worker threads, the thread calling run is the last one
+  stopThreads();
+  for (int iThread = 1; iThread < mNThreads; ++iThread) {
+    mThreads.emplace_back(&PreClusterFinder::processDEsInThread, this, mEvent);
+  }
+}
 
-  PreCluster* cluster(nullptr);
-  uint16_t iPad(0);
+//_________________________________________________________________________________________________
+void PreClusterFinder::stopThreads()
+{
+  /// stop the worker threads and wait for them to finish
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopThreads = true;
+  }
+  mStartWork.notify_all();
+  for (auto& thread : mThreads) {
+    thread.join();
+  }
+  mThreads.clear();
+  mStopThreads = false;
+}
 
-  // loop over DEs
+//_________________________________________________________________________________________________
+int PreClusterFinder::run()
+{
+  /// preclusterize each cathod separately then merge them
+  /// the DEs with fired pads are distributed among the threads
+  /// return the total number of preclusters after merging
+
+  mFiredDEs.clear();
   for (int iDE = 0; iDE < SNDEs; ++iDE) {
+    if (mDEs[iDE].nFiredPads[0] + mDEs[iDE].nFiredPads[1] > 0) {
+      mFiredDEs.push_back(iDE);
+    }
+  }
 
-    DetectionElement& de(mDEs[iDE]);
+  mNextFiredDE = 0;
 
-    // loop over planes
-    for (int iPlane = 0; iPlane < 2; ++iPlane) {
+  if (mThreads.empty() || mFiredDEs.size() < 2) {
+    return processDEs();
+  }
 
-      // loop over fired pads
-      for (int iFiredPad = 0; iFiredPad < de.nFiredPads[iPlane]; ++iFiredPad) {
+  // wake up the workers, then the current thread takes its share of the work
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mNPreClustersInThreads = 0;
+    mNBusyThreads = mThreads.size();
+    ++mEvent;
+  }
+  mStartWork.notify_all();
 
-        iPad = de.firedPads[iPlane][iFiredPad];
+  int nPreClusters = processDEs();
 
-        if (de.mapping->pads[iPad].useMe) {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mWorkDone.wait(lock, [this] { return mNBusyThreads == 0; });
 
-          // create the precluster if needed
-          if (mNPreClusters[iDE][iPlane] >= mPreClusters[iDE][iPlane].size()) {
-            mPreClusters[iDE][iPlane].push_back(std::make_unique<PreCluster>());
-          }
+  return nPreClusters + mNPreClustersInThreads;
+}
 
-          // get the precluster
-          cluster = mPreClusters[iDE][iPlane][mNPreClusters[iDE][iPlane]].get();
-          ++mNPreClusters[iDE][iPlane];
+//_________________________________________________________________________________________________
+int PreClusterFinder::processDEs()
+{
+  /// process the DEs with fired pads not taken yet by another thread
+  /// return the number of preclusters after merging in these DEs
+  int nPreClusters(0);
+  for (size_t i = mNextFiredDE++; i < mFiredDEs.size(); i = mNextFiredDE++) {
+    nPreClusters += processDE(mFiredDEs[i]);
+  }
+  return nPreClusters;
+}
 
-          // reset its content
-          cluster->area[0][0] = 1.e6;
-          cluster->area[0][1] = -1.e6;
-          cluster->area[1][0] = 1.e6;
-          cluster->area[1][1] = -1.e6;
-          cluster->useMe = true;
-          cluster->storeMe = false;
+//_________________________________________________________________________________________________
+void PreClusterFinder::processDEsInThread(uint64_t event)
+{
+  /// loop of the worker threads: wait for the event following the given one, take part in its processing and report
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true) {
+    mStartWork.wait(lock, [this, &event] { return mStopThreads || mEvent != event; });
+    if (mStopThreads) {
+      return;
+    }
+    event = mEvent;
+    lock.unlock();
+    int nPreClusters = processDEs();
+    lock.lock();
+    mNPreClustersInThreads += nPreClusters;
+    if (--mNBusyThreads == 0) {
+      mWorkDone.notify_one();
+    }
+  }
+}
 
-          // add the pad and its fired neighbours recusively
-          cluster->firstPad = de.nOrderedPads[0];
-          addPad(de, iPad, *cluster);
+//_________________________________________________________________________________________________
+int PreClusterFinder::processDE(int iDE)
+{
+  /// preclusterize both planes of the given DE then merge them
+  /// only the data of this DE are modified so that DEs can be processed in parallel
+  /// return the number of preclusters after merging
+  preClusterize(iDE);
+  return mergePreClusters(iDE);
+}
+
+//_________________________________________________________________________________________________
+void PreClusterFinder::preClusterize(int iDE)
+{
+  /// preclusterize both planes of the given DE
+
+  PreCluster* cluster(nullptr);
+  uint16_t iPad(0);
+
+  DetectionElement& de(mDEs[iDE]);
+
+  // loop over planes
+  for (int iPlane = 0; iPlane < 2; ++iPlane) {
+
+    // loop over fired pads
+    for (int iFiredPad = 0; iFiredPad < de.nFiredPads[iPlane]; ++iFiredPad) {
+
+      iPad = de.firedPads[iPlane][iFiredPad];
+
+      if (de.mapping->pads[iPad].useMe) {
+
+        // create the precluster if needed
+        if (mNPreClusters[iDE][iPlane] >= mPreClusters[iDE][iPlane].size()) {
+          mPreClusters[iDE][iPlane].push_back(std::make_unique<PreCluster>());
         }
+
+        // get the precluster
+        cluster = mPreClusters[iDE][iPlane][mNPreClusters[iDE][iPlane]].get();
+        ++mNPreClusters[iDE][iPlane];
+
+        // reset its content
+        cluster->area[0][0] = 1.e6;
+        cluster->area[0][1] = -1.e6;
+        cluster->area[1][0] = 1.e6;
+        cluster->area[1][1] = -1.e6;
+        cluster->useMe = true;
+        cluster->storeMe = false;
+
+        // add the pad and all its fired neighbours
+        cluster->firstPad = de.nOrderedPads[0];
+        addPad(de, iPad, *cluster);
       }
     }
   }
@@ -193,132 +329,156 @@ void PreClusterFinder::preClusterizeRecursive()
 //_________________________________________________________________________________________________
 void PreClusterFinder::addPad(DetectionElement& de, uint16_t iPad, PreCluster& cluster)
 {
-  /// add the given MpPad and its fired neighbours (recursive method)
+  /// add the given MpPad and its fired neighbours, recursively
+  /// the recursion is unrolled on an explicit stack to bound the memory used on the program stack
+  /// whatever the size of the precluster. The pads are added in depth-first order.
 
   Mapping::MpPad* pads(de.mapping->pads.get());
 
+  auto add = [&de, &cluster, pads](uint16_t iPadToAdd) {
+    Mapping::MpPad& pad(pads[iPadToAdd]);
+    if (de.nOrderedPads[0] < de.orderedPads[0].size()) {
+      de.orderedPads[0][de.nOrderedPads[0]] = iPadToAdd;
+    } else {
+      de.orderedPads[0].push_back(iPadToAdd);
+    }
+    cluster.lastPad = de.nOrderedPads[0];
+    ++de.nOrderedPads[0];
+    if (pad.area[0][0] < cluster.area[0][0])
+      cluster.area[0][0] = pad.area[0][0];
+    if (pad.area[0][1] > cluster.area[0][1])
+      cluster.area[0][1] = pad.area[0][1];
+    if (pad.area[1][0] < cluster.area[1][0])
+      cluster.area[1][0] = pad.area[1][0];
+    if (pad.area[1][1] > cluster.area[1][1])
+      cluster.area[1][1] = pad.area[1][1];
+    pad.useMe = false;
+  };
+
   // add the given pad
-  Mapping::MpPad& pad(pads[iPad]);
-  if (de.nOrderedPads[0] < de.orderedPads[0].size()) {
-    de.orderedPads[0][de.nOrderedPads[0]] = iPad;
-  } else {
-    de.orderedPads[0].push_back(iPad);
-  }
-  cluster.lastPad = de.nOrderedPads[0];
-  ++de.nOrderedPads[0];
-  if (pad.area[0][0] < cluster.area[0][0])
-    cluster.area[0][0] = pad.area[0][0];
-  if (pad.area[0][1] > cluster.area[0][1])
-    cluster.area[0][1] = pad.area[0][1];
-  if (pad.area[1][0] < cluster.area[1][0])
-    cluster.area[1][0] = pad.area[1][0];
-  if (pad.area[1][1] > cluster.area[1][1])
-    cluster.area[1][1] = pad.area[1][1];
-
-  pad.useMe = false;
-
-  // loop over its neighbours
-  for (int iNeighbour = 0; iNeighbour < pad.nNeighbours; ++iNeighbour) {
-
-    if (pads[pad.neighbours[iNeighbour]].useMe) {
-
-      // add the pad to the precluster
-      addPad(de, pad.neighbours[iNeighbour], cluster);
+  add(iPad);
+  de.padStack.clear();
+  de.padStack.emplace_back(iPad, 0);
+
+  while (!de.padStack.empty()) {
+
+    // look for the next fired neighbour of the last added pad
+    auto& current = de.padStack.back();
+    Mapping::MpPad& pad(pads[current.first]);
+    while (current.second < pad.nNeighbours && !pads[pad.neighbours[current.second]].useMe) {
+      ++current.second;
     }
+
+    if (current.second == pad.nNeighbours) {
+      // all its neighbours have been added
+      de.padStack.pop_back();
+      continue;
+    }
+
+    // add this neighbour and continue with its own neighbours
+    uint16_t iNeighbour = pad.neighbours[current.second++];
+    add(iNeighbour);
+    de.padStack.emplace_back(iNeighbour, 0);
   }
 }
 
 //_________________________________________________________________________________________________
-int PreClusterFinder::mergePreClusters()
+int PreClusterFinder::mergePreClusters(int iDE)
 {
-  /// merge overlapping preclusters on every DE
-  /// return the total number of preclusters after merging
+  /// merge overlapping preclusters of the given DE
+  /// return the number of preclusters after merging
 
   PreCluster* cluster(nullptr);
   int nPreClusters(0);
 
-  // loop over DEs
-  for (int iDE = 0; iDE < SNDEs; ++iDE) {
+  DetectionElement& de(mDEs[iDE]);
 
-    DetectionElement& de(mDEs[iDE]);
+  // loop over preclusters of one plane
+  for (int iCluster = 0; iCluster < mNPreClusters[iDE][0]; ++iCluster) {
 
-    // loop over preclusters of one plane
-    for (int iCluster = 0; iCluster < mNPreClusters[iDE][0]; ++iCluster) {
+    if (!mPreClusters[iDE][0][iCluster]->useMe) {
+      continue;
+    }
 
-      if (!mPreClusters[iDE][0][iCluster]->useMe) {
-        continue;
-      }
+    cluster = mPreClusters[iDE][0][iCluster].get();
+    cluster->useMe = false;
 
-      cluster = mPreClusters[iDE][0][iCluster].get();
-      cluster->useMe = false;
+    // merge it with all the preclusters overlapping with it, directly or not
+    mergePreClusters(*cluster, iDE);
 
-      // look for overlapping preclusters in the other plane
-      PreCluster* mergedCluster(nullptr);
-      mergePreClusters(*cluster, mPreClusters[iDE], mNPreClusters[iDE], de, 1, mergedCluster);
+    ++nPreClusters;
+  }
 
-      // add the current one
-      if (!mergedCluster) {
-        mergedCluster = usePreClusters(cluster, de);
-      } else {
-        mergePreClusters(*mergedCluster, *cluster, de);
-      }
+  // loop over preclusters of the other plane
+  for (int iCluster = 0; iCluster < mNPreClusters[iDE][1]; ++iCluster) {
 
-      ++nPreClusters;
+    if (!mPreClusters[iDE][1][iCluster]->useMe) {
+      continue;
     }
 
-    // loop over preclusters of the other plane
-    for (int iCluster = 0; iCluster < mNPreClusters[iDE][1]; ++iCluster) {
-
-      if (!mPreClusters[iDE][1][iCluster]->useMe) {
-        continue;
-      }
-
-      // all remaining preclusters have to be stored
-      usePreClusters(mPreClusters[iDE][1][iCluster].get(), de);
+    // all remaining preclusters have to be stored
+    usePreClusters(mPreClusters[iDE][1][iCluster].get(), de);
 
-      ++nPreClusters;
-    }
+    ++nPreClusters;
   }
 
   return nPreClusters;
 }
 
 //_________________________________________________________________________________________________
-void PreClusterFinder::mergePreClusters(PreCluster& cluster, std::vector<std::unique_ptr<PreCluster>> preClusters[2],
-                                        int nPreClusters[2], DetectionElement& de, int iPlane,
-                                        PreCluster*& mergedCluster)
+PreClusterFinder::PreCluster* PreClusterFinder::mergePreClusters(PreCluster& cluster, int iDE)
 {
-  /// merge preclusters on the given plane overlapping with the given one (recursive method)
+  /// merge the given precluster of the first plane with the preclusters of the other plane overlapping with it,
+  /// then with the preclusters of the first plane overlapping with those, and so on.
+  /// The recursion is unrolled on an explicit stack. The pads are moved in the same order as with the
+  /// recursive algorithm: the preclusters found while looking from a given one are merged before it.
+  /// return the merged precluster
 
   // overlap precision in cm: positive(negative) = increase(decrease) precluster size
   constexpr float overlapPrecision = -1.e-4;
 
-  PreCluster* cluster2(nullptr);
+  DetectionElement& de(mDEs[iDE]);
+  std::vector<std::unique_ptr<PreCluster>>* preClusters(mPreClusters[iDE]);
+  int* nPreClusters(mNPreClusters[iDE]);
 
-  // loop over preclusters in the given plane
-  for (int iCluster = 0; iCluster < nPreClusters[iPlane]; ++iCluster) {
+  PreCluster* mergedCluster(nullptr);
 
-    if (!preClusters[iPlane][iCluster]->useMe) {
-      continue;
-    }
+  de.mergeStack.clear();
+  de.mergeStack.push_back({ &cluster, 1, 0 });
 
-    cluster2 = preClusters[iPlane][iCluster].get();
-    if (Mapping::areOverlapping(cluster.area, cluster2->area, overlapPrecision) &&
-        areOverlapping(cluster, *cluster2, de, overlapPrecision)) {
+  while (!de.mergeStack.empty()) {
 
-      cluster2->useMe = false;
+    // look for the next precluster overlapping with the current one in the given plane
+    MergeStep& step = de.mergeStack.back();
+    PreCluster* cluster2(nullptr);
+    for (; step.iCluster < nPreClusters[step.iPlane]; ++step.iCluster) {
+      PreCluster* candidate = preClusters[step.iPlane][step.iCluster].get();
+      if (candidate->useMe && Mapping::areOverlapping(step.cluster->area, candidate->area, overlapPrecision) &&
+          areOverlapping(*step.cluster, *candidate, de, overlapPrecision)) {
+        cluster2 = candidate;
+        ++step.iCluster;
+        break;
+      }
+    }
 
+    if (cluster2) {
       // look for new overlapping preclusters in the other plane
-      mergePreClusters(*cluster2, preClusters, nPreClusters, de, (iPlane + 1) % 2, mergedCluster);
+      cluster2->useMe = false;
+      de.mergeStack.push_back({ cluster2, (step.iPlane + 1) % 2, 0 });
+      continue;
+    }
 
-      // store overlapping preclusters and merge them
-      if (!mergedCluster) {
-        mergedCluster = usePreClusters(cluster2, de);
-      } else {
-        mergePreClusters(*mergedCluster, *cluster2, de);
-      }
+    // no more overlapping preclusters: store the current one and merge it
+    PreCluster* current = step.cluster;
+    de.mergeStack.pop_back();
+    if (!mergedCluster) {
+      mergedCluster = usePreClusters(current, de);
+    } else {
+      mergePreClusters(*mergedCluster, *current, de);
     }
   }
+
+  return mergedCluster;
 }
 
 //_________________________________________________________________________________________________
@@ -377,6 +537,11 @@ bool PreClusterFinder::areOverlapping(PreCluster& cluster1, PreCluster& cluster2
   // loop over all pads of the precluster1
   for (int iOrderPad1 = cluster1.firstPad; iOrderPad1 <= cluster1.lastPad; ++iOrderPad1) {
 
+    // skip the pads not overlapping with the area of the precluster2, which contains all its pads
+    if (!Mapping::areOverlapping(de.mapping->pads[de.orderedPads[0][iOrderPad1]].area, cluster2.area, precision)) {
+      continue;
+    }
+
     // loop over all pads of the precluster2
     for (int iOrderPad2 = cluster2.firstPad; iOrderPad2 <= cluster2.lastPad; ++iOrderPad2) {
 
@@ -391,19 +556,10 @@ bool PreClusterFinder::areOverlapping(PreCluster& cluster1, PreCluster& cluster2
 }
 
 //_________________________________________________________________________________________________
-void PreClusterFinder::readMapping(const char* fileName)
+void PreClusterFinder::setMapping(std::vector<std::unique_ptr<Mapping::MpDE>> mpDEs)
 {
   /// Fill the internal mapping structures
 
-  auto tStart = std::chrono::high_resolution_clock::now();
-
-  std::vector<std::unique_ptr<Mapping::MpDE>> mpDEs = Mapping::readMapping(fileName);
-
-  if (mpDEs.size() < SNDEs) {
-    LOG(ERROR) << "Invalid binary mapping file " << fileName;
-    throw runtime_error(fair::mq::tools::ToString("Invalid binary mapping file ", fileName));
-  }
-
   mDEIndices.reserve(SNDEs);
 
   for (int iDE = 0; iDE < SNDEs; ++iDE) {
@@ -427,9 +583,6 @@ void PreClusterFinder::readMapping(const char* fileName)
       de.firedPads[iPlane].reserve(de.mapping->nPads[iPlane] / 10); // 10% occupancy
     }
   }
-
-  auto tEnd = std::chrono::high_resolution_clock::now();
-  LOG(INFO) << "Read mapping in: " << std::chrono::duration<double, std::milli>(tEnd - tStart).count() << " ms\n";
 }
 
 } // namespace mch
@@ -15,9 +15,16 @@
 #ifndef ALICEO2_MCH_PRECLUSTERFINDER_H_
 #define ALICEO2_MCH_PRECLUSTERFINDER_H_
 
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "MCHBase/DigitBlock.h"
@@ -40,7 +47,7 @@ class PreClusterFinder
   };
 
   PreClusterFinder() = default;
-  ~PreClusterFinder() = default;
+  ~PreClusterFinder();
 
   PreClusterFinder(const PreClusterFinder&) = delete;
   PreClusterFinder& operator=(const PreClusterFinder&) = delete;
@@ -48,6 +55,7 @@ class PreClusterFinder
   PreClusterFinder& operator=(PreClusterFinder&&) = delete;
 
   void init(std::string& fileName);
+  void init(std::vector<std::unique_ptr<Mapping::MpDE>> mapping);
   void deinit();
   void reset();
 
@@ -55,6 +63,11 @@ class PreClusterFinder
 
   int run();
 
+  /// set the number of threads used to process the detection elements in parallel (<= 0 = all available cores)
+  /// the worker threads are started by init, so this must be called before
+  void setNumberOfThreads(int nThreads);
+  int getNumberOfThreads() const { return mNThreads; }
+
   int getNDEWithPreClusters(int& nUsedDigits);
   bool hasPreClusters(int iDE);
   int getNPreClusters(int iDE, int iPlane);
@@ -66,13 +79,21 @@ class PreClusterFinder
   int getDEId(int iDE);
 
  private:
+  struct MergeStep {
+    PreCluster* cluster; // precluster looking for overlapping preclusters
+    int iPlane;          // plane in which to look for them
+    int iCluster;        // next precluster to check in this plane
+  };
+
   struct DetectionElement {
-    std::unique_ptr<Mapping::MpDE> mapping; // mapping of this DE including the list of pads
-    std::vector<const DigitStruct*> digits; // list of pointers to digits (not owner)
-    uint16_t nFiredPads[2];                 // number of fired pads on each plane
-    std::vector<uint16_t> firedPads[2];     // indices of fired pads on each plane
-    uint16_t nOrderedPads[2];               // current number of fired pads in the following arrays
-    std::vector<uint16_t> orderedPads[2];   // indices of fired pads ordered after preclustering and merging
+    std::unique_ptr<Mapping::MpDE> mapping;             // mapping of this DE including the list of pads
+    std::vector<const DigitStruct*> digits;             // list of pointers to digits (not owner)
+    uint16_t nFiredPads[2];                             // number of fired pads on each plane
+    std::vector<uint16_t> firedPads[2];                 // indices of fired pads on each plane
+    uint16_t nOrderedPads[2];                           // current number of fired pads in the following arrays
+    std::vector<uint16_t> orderedPads[2];               // indices of fired pads ordered after preclustering and merging
+    std::vector<std::pair<uint16_t, uint8_t>> padStack; // work space: pads being added and next neighbour to check
+    std::vector<MergeStep> mergeStack;                  // work space: preclusters being merged
   };
 
   /// Return detection element ID part of the unique ID
@@ -81,18 +102,24 @@ class PreClusterFinder
   /// Return the cathode part of the unique ID
   int cathode(uint32_t uid) { return (uid & 0x40000000) >> 30; }
 
-  void preClusterizeRecursive();
+  int processDE(int iDE);
+  int processDEs();
+  void processDEsInThread(uint64_t event);
+
+  void startThreads();
+  void stopThreads();
+
+  void preClusterize(int iDE);
   void addPad(DetectionElement& de, uint16_t iPad, PreCluster& cluster);
 
-  int mergePreClusters();
-  void mergePreClusters(PreCluster& cluster, std::vector<std::unique_ptr<PreCluster>> preClusters[2],
-                        int nPreClusters[2], DetectionElement& de, int iPlane, PreCluster*& mergedCluster);
+  int mergePreClusters(int iDE);
+  PreCluster* mergePreClusters(PreCluster& cluster, int iDE);
   PreCluster* usePreClusters(PreCluster* cluster, DetectionElement& de);
   void mergePreClusters(PreCluster& cluster1, PreCluster& cluster2, DetectionElement& de);
 
   bool areOverlapping(PreCluster& cluster1, PreCluster& cluster2, DetectionElement& de, float precision);
 
-  void readMapping(const char* fileName);
+  void setMapping(std::vector<std::unique_ptr<Mapping::MpDE>> mpDEs);
 
   static constexpr int SNDEs = 156; ///< number of DEs
 
@@ -101,6 +128,18 @@ class PreClusterFinder
 
   int mNPreClusters[SNDEs][2]{}; ///< number of preclusters in each cathods of each DE
   std::vector<std::unique_ptr<PreCluster>> mPreClusters[SNDEs][2]{}; ///< preclusters in each cathods of each DE
+
+  int mNThreads = 1;                      ///< number of threads processing the DEs
+  std::vector<int> mFiredDEs{};           ///< indices of the DEs with fired pads in the current event
+  std::atomic<size_t> mNextFiredDE{0};    ///< next element of mFiredDEs to be processed
+  std::vector<std::thread> mThreads{};    ///< worker threads, helping the thread calling run
+  std::mutex mMutex{};                    ///< protects the following members
+  std::condition_variable mStartWork{};   ///< signals the workers that an event is ready or that they must stop
+  std::condition_variable mWorkDone{};    ///< signals run that all workers are done
+  uint64_t mEvent = 0;                    ///< number of events given to the workers
+  int mNBusyThreads = 0;                  ///< number of workers still processing the current event
+  int mNPreClustersInThreads = 0;         ///< number of preclusters found by the workers in the current event
+  bool mStopThreads = false;              ///< whether the workers must stop
 };
 
 //_________________________________________________________________________________________________
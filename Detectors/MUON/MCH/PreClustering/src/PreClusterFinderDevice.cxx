@@ -47,6 +47,9 @@ void PreClusterFinderDevice::InitTask()
   // Get the binary mapping file from the command line option (via fConfig)
   auto fileName = fConfig->GetValue<std::string>("binmapfile");
 
+  // Set the number of threads processing the DEs in parallel, they are started with the mapping
+  mPreClusterFinder.setNumberOfThreads(fConfig->GetValue<int>("nthreads"));
+
   // Load the mapping from the binary file
   try {
     mPreClusterFinder.init(fileName);
@@ -55,6 +58,8 @@ void PreClusterFinderDevice::InitTask()
     ChangeState(ERROR_FOUND);
     return;
   }
+
+  LOG(INFO) << "PreClusterFinder running with " << mPreClusterFinder.getNumberOfThreads() << " thread(s)";
 }
 
 //_________________________________________________________________________________________________
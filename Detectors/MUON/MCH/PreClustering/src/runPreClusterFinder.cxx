@@ -20,6 +20,8 @@ namespace bpo = boost::program_options;
 void addCustomOptions(bpo::options_description& options)
 {
   options.add_options()("binmapfile", bpo::value<std::string>(), "binary mapping file");
+  options.add_options()("nthreads", bpo::value<int>()->default_value(1),
+                        "number of threads processing the detection elements in parallel (0 = all available cores)");
 }
 
 FairMQDevicePtr getDevice(const FairMQProgOptions& /*config*/) { return new o2::mch::PreClusterFinderDevice(); }
@@ -0,0 +1,84 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @author P. Pillot
+/// @brief Benchmark of the preclusterizer on recorded digit blocks
+///
+/// The binary mapping file and the file of recorded events are given by the environment variables
+/// O2_MCH_BINMAPFILE and O2_MCH_DIGITFILE. The latter contains the digit blocks of consecutive events,
+/// each of them made of a DigitBlock header followed by its DigitStruct records.
+
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "MCHBase/DigitBlock.h"
+#include "../src/PreClusterFinder.h"
+
+using namespace o2::mch;
+
+namespace
+{
+std::vector<std::vector<DigitStruct>> readEvents(const char* fileName)
+{
+  std::vector<std::vector<DigitStruct>> events{};
+  std::ifstream in(fileName, std::ios::binary);
+  DigitBlock block{};
+  while (in.read(reinterpret_cast<char*>(&block), sizeof(block))) {
+    std::vector<DigitStruct> digits(block.header.fNrecords);
+    if (!in.read(reinterpret_cast<char*>(digits.data()), digits.size() * sizeof(DigitStruct))) {
+      break;
+    }
+    events.emplace_back(std::move(digits));
+  }
+  return events;
+}
+} // namespace
+
+static void BM_PreClusterFinder(benchmark::State& state)
+{
+  const char* mapFile = std::getenv("O2_MCH_BINMAPFILE");
+  const char* digitFile = std::getenv("O2_MCH_DIGITFILE");
+  if (!mapFile || !digitFile) {
+    state.SkipWithError("O2_MCH_BINMAPFILE and O2_MCH_DIGITFILE must be set");
+    return;
+  }
+
+  static auto events = readEvents(digitFile);
+  if (events.empty()) {
+    state.SkipWithError("no digit block found");
+    return;
+  }
+
+  auto preClusterFinder = std::make_unique<PreClusterFinder>();
+  std::string fileName(mapFile);
+  preClusterFinder->setNumberOfThreads(state.range(0));
+  preClusterFinder->init(fileName);
+
+  size_t nDigits(0);
+  for (auto _ : state) {
+    for (const auto& digits : events) {
+      preClusterFinder->reset();
+      preClusterFinder->loadDigits(digits.data(), digits.size());
+      benchmark::DoNotOptimize(preClusterFinder->run());
+      nDigits += digits.size();
+    }
+  }
+  state.SetItemsProcessed(nDigits);
+
+  preClusterFinder->deinit();
+}
+
+BENCHMARK(BM_PreClusterFinder)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
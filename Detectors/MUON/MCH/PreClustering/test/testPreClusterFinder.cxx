@@ -0,0 +1,220 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @author P. Pillot
+/// @brief Test of the preclusterizer against preclusters recorded with the recursive implementation
+///
+/// The mapping is a synthetic one: every DE has two planes of rectangular pads of different sizes,
+/// each pad having its 8 neighbours on the same plane.
+
+#define BOOST_TEST_MODULE Test MCH PreClusterFinder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "MCHBase/DigitBlock.h"
+#include "MCHBase/Mapping.h"
+#include "../src/PreClusterFinder.h"
+
+using namespace o2::mch;
+
+namespace
+{
+const int NX[2] = { 16, 11 };
+const int NY[2] = { 8, 12 };
+const float DX[2] = { 1.f, 1.5f };
+const float DY[2] = { 1.f, 0.65f };
+
+int deUID(int iDE) { return 100 + iDE; }
+
+/// unique ID of the pad (ix, iy) of plane iPlane of DE iDE
+uint32_t padUID(int iDE, int iPlane, int ix, int iy)
+{
+  int offset = (iPlane == 0) ? 0 : NX[0] * NY[0];
+  uint32_t cathode = (iDE % 2) ^ iPlane;
+  return (cathode << 30) | (uint32_t(offset + ix * NY[iPlane] + iy) << 12) | deUID(iDE);
+}
+
+std::vector<std::unique_ptr<Mapping::MpDE>> createMapping()
+{
+  std::vector<std::unique_ptr<Mapping::MpDE>> mapping{};
+  for (int iDE = 0; iDE < PreClusterFinder::getNDEs(); ++iDE) {
+    auto de = std::make_unique<Mapping::MpDE>();
+    de->uid = deUID(iDE);
+    de->iCath[0] = iDE % 2;
+    de->iCath[1] = 1 - iDE % 2;
+    de->pads = std::make_unique<Mapping::MpPad[]>(NX[0] * NY[0] + NX[1] * NY[1]);
+    int offset(0);
+    for (int iPlane = 0; iPlane < 2; ++iPlane) {
+      de->nPads[iPlane] = NX[iPlane] * NY[iPlane];
+      for (int ix = 0; ix < NX[iPlane]; ++ix) {
+        for (int iy = 0; iy < NY[iPlane]; ++iy) {
+          int iPad = offset + ix * NY[iPlane] + iy;
+          Mapping::MpPad& pad(de->pads[iPad]);
+          pad.iDigit = 0;
+          pad.useMe = false;
+          pad.nNeighbours = 0;
+          pad.area[0][0] = ix * DX[iPlane];
+          pad.area[0][1] = (ix + 1) * DX[iPlane];
+          pad.area[1][0] = iy * DY[iPlane];
+          pad.area[1][1] = (iy + 1) * DY[iPlane];
+          for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+              if ((dx == 0 && dy == 0) || ix + dx < 0 || ix + dx >= NX[iPlane] || iy + dy < 0 || iy + dy >= NY[iPlane]) {
+                continue;
+              }
+              pad.neighbours[pad.nNeighbours++] = offset + (ix + dx) * NY[iPlane] + iy + dy;
+            }
+          }
+          de->padIndices[iPlane].Add(padUID(iDE, iPlane, ix, iy), iPad + 1);
+        }
+      }
+      offset += de->nPads[iPlane];
+    }
+    mapping.push_back(std::move(de));
+  }
+  return mapping;
+}
+
+/// fire each pad with the given probability (in %), the digits are then shuffled
+std::vector<DigitStruct> createDigits(unsigned int occupancy, std::mt19937& gen)
+{
+  std::vector<DigitStruct> digits{};
+  for (int iDE = 0; iDE < PreClusterFinder::getNDEs(); ++iDE) {
+    for (int iPlane = 0; iPlane < 2; ++iPlane) {
+      for (int ix = 0; ix < NX[iPlane]; ++ix) {
+        for (int iy = 0; iy < NY[iPlane]; ++iy) {
+          if (gen() % 100 < occupancy) {
+            digits.push_back({ padUID(iDE, iPlane, ix, iy), uint16_t(digits.size()), 0 });
+          }
+        }
+      }
+    }
+  }
+  for (size_t i = digits.size(); i > 1; --i) {
+    std::swap(digits[i - 1], digits[gen() % i]);
+  }
+  return digits;
+}
+
+/// hash of the stored preclusters, made of the DE IDs and of the IDs of their pads in order
+uint64_t hashPreClusters(PreClusterFinder& finder, int& nPreClusters)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  auto add = [&hash](uint32_t value) { hash = (hash ^ value) * 1099511628211ULL; };
+  nPreClusters = 0;
+  for (int iDE = 0; iDE < PreClusterFinder::getNDEs(); ++iDE) {
+    if (!finder.hasPreClusters(iDE)) {
+      continue;
+    }
+    for (int iPlane = 0; iPlane < 2; ++iPlane) {
+      for (int iCluster = 0; iCluster < finder.getNPreClusters(iDE, iPlane); ++iCluster) {
+        auto cluster = finder.getPreCluster(iDE, iPlane, iCluster);
+        if (!cluster->storeMe) {
+          continue;
+        }
+        ++nPreClusters;
+        add(finder.getDEId(iDE));
+        for (uint16_t iPad = cluster->firstPad; iPad <= cluster->lastPad; ++iPad) {
+          add(finder.getDigit(iDE, iPad)->uid);
+        }
+      }
+    }
+  }
+  return hash;
+}
+
+struct Reference {
+  unsigned int occupancy; // probability to fire a pad (%)
+  int nPreClusters;       // number of preclusters after merging
+  uint64_t hash;          // hash of the stored preclusters
+};
+
+// recorded with the recursive implementation, on the events generated with a std::mt19937 seeded with 42
+const Reference references[] = {
+  { 2, 713, 17434123414342526757ULL },
+  { 10, 2309, 12996523944902039967ULL },
+  { 30, 1103, 5817882755585597963ULL },
+  { 60, 181, 9872762308811206811ULL },
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SmallEvent)
+{
+  PreClusterFinder finder;
+  finder.init(createMapping());
+
+  // two pads next to each other and an isolated one on the first plane of DE 100, and a pad on the
+  // second plane overlapping the isolated one
+  std::vector<DigitStruct> digits{
+    { padUID(0, 0, 2, 2), 0, 0 },
+    { padUID(0, 0, 3, 3), 1, 0 },
+    { padUID(0, 0, 8, 2), 2, 0 },
+    { padUID(0, 1, 5, 3), 3, 0 },
+  };
+  finder.loadDigits(digits.data(), digits.size());
+  BOOST_CHECK_EQUAL(finder.run(), 2);
+
+  int nUsedDigits(0);
+  BOOST_CHECK_EQUAL(finder.getNDEWithPreClusters(nUsedDigits), 1);
+  BOOST_CHECK_EQUAL(nUsedDigits, 4);
+  BOOST_REQUIRE(finder.hasPreClusters(0));
+
+  std::vector<std::vector<uint32_t>> preClusters{};
+  for (int iPlane = 0; iPlane < 2; ++iPlane) {
+    for (int iCluster = 0; iCluster < finder.getNPreClusters(0, iPlane); ++iCluster) {
+      auto cluster = finder.getPreCluster(0, iPlane, iCluster);
+      if (cluster->storeMe) {
+        preClusters.emplace_back();
+        for (uint16_t iPad = cluster->firstPad; iPad <= cluster->lastPad; ++iPad) {
+          preClusters.back().push_back(finder.getDigit(0, iPad)->uid);
+        }
+      }
+    }
+  }
+  BOOST_REQUIRE_EQUAL(preClusters.size(), 2);
+  BOOST_CHECK(preClusters[0] == (std::vector<uint32_t>{ padUID(0, 0, 2, 2), padUID(0, 0, 3, 3) }));
+  // the merged precluster starts with the pads of the second plane
+  BOOST_CHECK(preClusters[1] == (std::vector<uint32_t>{ padUID(0, 1, 5, 3), padUID(0, 0, 8, 2) }));
+
+  finder.deinit();
+}
+
+BOOST_AUTO_TEST_CASE(RecordedPreClusters)
+{
+  for (int nThreads : { 1, 4 }) {
+    PreClusterFinder finder;
+    finder.setNumberOfThreads(nThreads);
+    finder.init(createMapping());
+    BOOST_CHECK_EQUAL(finder.getNumberOfThreads(), nThreads);
+
+    std::mt19937 gen(42);
+    for (const auto& reference : references) {
+      auto digits = createDigits(reference.occupancy, gen);
+      finder.reset();
+      finder.loadDigits(digits.data(), digits.size());
+      BOOST_TEST_CONTEXT("occupancy " << reference.occupancy << "%, " << nThreads << " thread(s)")
+      {
+        BOOST_CHECK_EQUAL(finder.run(), reference.nPreClusters);
+        int nStored(0);
+        uint64_t hash = hashPreClusters(finder, nStored);
+        BOOST_CHECK_EQUAL(nStored, reference.nPreClusters);
+        BOOST_CHECK_EQUAL(hash, reference.hash);
+      }
+    }
+
+    finder.deinit();
+  }
+}
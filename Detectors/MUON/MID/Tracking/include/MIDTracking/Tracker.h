@@ -16,6 +16,7 @@
 #ifndef O2_MID_TRACKER_H
 #define O2_MID_TRACKER_H
 
+#include <utility>
 #include <vector>
 #include "DataFormatsMID/Cluster2D.h"
 #include "DataFormatsMID/Cluster3D.h"
@@ -46,6 +47,10 @@ class Tracker
   void setSigmaCut(float sigmaCut) { mImpactParamCut = mSigmaCut; }
   /// Gets number of sigmas for cuts
   inline float getSigmaCut() const { return mSigmaCut; }
+  /// Sets the number of threads sharing the four side/direction passes
+  void setNumberOfThreads(int nThreads) { mNThreads = (nThreads > 0) ? nThreads : 1; }
+  /// Gets the number of threads sharing the four side/direction passes
+  inline int getNumberOfThreads() const { return mNThreads; }
 
   bool process(const std::vector<Cluster2D>& clusters);
   bool init();
@@ -57,11 +62,23 @@ class Tracker
   unsigned long int getNTracks() { return mNTracks; }
 
  private:
-  bool processSide(bool isRight, bool isInward);
+  /// Clusters of one detection element sorted along the non-bending direction
+  struct ClusterIndex {
+    std::vector<std::pair<float, int>> clusters; ///< Non-bending coordinate and index of the clusters
+    float zMin;                                  ///< Minimum z of the clusters
+    float zMax;                                  ///< Maximum z of the clusters
+    float maxSigmaX2;                            ///< Maximum dispersion along x of the clusters
+  };
+
+  void processSide(bool isRight, bool isInward, std::vector<Track>& candidates) const;
   bool addTrack(const Track& track);
-  bool followTrack(const Track& track, bool isRight, bool isInward);
+  bool followTrack(const Track& track, bool isRight, bool isInward, Track& bestTrack) const;
   bool findNextCluster(const Track& track, bool isRight, bool isInward, int chamber, int firstRPC, int lastRPC,
                        int& nFiredChambers, double& bestChi2, Track& bestTrack, double chi2 = 0., int depth = 1) const;
+  void getClusters(int deId, double xMin, double xMax, std::vector<int>& clusters) const;
+  void getSeedWindow(const Cluster3D& cl1, int deId2, double& xMin, double& xMax) const;
+  void getNextClusterWindow(const Track& track, int deId, double& xMin, double& xMax) const;
+  void indexClusters();
   int getClusterId(int id, int deId) const;
   int getFirstNeighbourRPC(int rpc) const;
   int getLastNeighbourRPC(int rpc) const;
@@ -70,14 +87,20 @@ class Tracker
   void reset();
   double runKalmanFilter(Track& track, const Cluster3D& cluster) const;
   double tryOneCluster(const Track& track, const Cluster3D& cluster, Track& newTrack) const;
-  void finalizeTrack(Track& track);
+  void finalizeTrack(Track& track) const;
 
   float mImpactParamCut; ///< Cut on impact parameter
   float mSigmaCut;       ///< Number of sigmas cut
   float mMaxChi2;        ///< Maximum cut on chi2
 
+  static constexpr double sWindowMargin = 0.1; ///< Safety margin (cm) of the cluster search windows
+
   std::vector<Cluster3D> mClusters[72]; ///< Ordered arrays of clusters
   unsigned long int mNClusters[72];     ///< Number of clusters per RPC
+  ClusterIndex mClusterIndex[72];       ///< Clusters per RPC sorted along x
+
+  std::vector<Track> mCandidates[4]; ///< Track candidates of each side/direction pass
+  int mNThreads;                     ///< Number of threads
 
   std::vector<Track> mTracks; ///< Array of tracks
   unsigned long int mNTracks; ///< Number of tracks
@@ -14,7 +14,9 @@
 /// \date   09 May 2017
 #include "MIDTracking/Tracker.h"
 
+#include <algorithm>
 #include <cmath>
+#include <future>
 #include "FairLogger.h"
 #include "MIDBase/Constants.h"
 
@@ -24,7 +26,7 @@ namespace mid
 {
 
 //______________________________________________________________________________
-Tracker::Tracker() : mImpactParamCut(210.), mSigmaCut(5.), mMaxChi2(1.e6), mNTracks(0)
+Tracker::Tracker() : mImpactParamCut(210.), mSigmaCut(5.), mMaxChi2(1.e6), mNThreads(1), mNTracks(0)
 {
   /// Default constructor
 }
@@ -101,9 +103,102 @@ bool Tracker::loadClusters(const std::vector<Cluster2D>& clusters)
                << "," << cl.position.z() << ")";
   }
 
+  indexClusters();
+
   return (clusters.size() > 0);
 }
 
+//______________________________________________________________________________
+void Tracker::indexClusters()
+{
+  /// Sorts the clusters of each detection element along x
+  /// and computes the ranges needed to define the search windows
+  for (int deId = 0; deId < 72; ++deId) {
+    ClusterIndex& index(mClusterIndex[deId]);
+    index.clusters.clear();
+    for (int icl = 0; icl < mNClusters[deId]; ++icl) {
+      const Cluster3D& cl(mClusters[deId][icl]);
+      if (icl == 0) {
+        index.zMin = index.zMax = cl.position.z();
+        index.maxSigmaX2 = cl.sigmaX2;
+      } else {
+        index.zMin = std::min(index.zMin, cl.position.z());
+        index.zMax = std::max(index.zMax, cl.position.z());
+        index.maxSigmaX2 = std::max(index.maxSigmaX2, cl.sigmaX2);
+      }
+      index.clusters.emplace_back(cl.position.x(), icl);
+    }
+    std::sort(index.clusters.begin(), index.clusters.end());
+  }
+}
+
+//______________________________________________________________________________
+void Tracker::getClusters(int deId, double xMin, double xMax, std::vector<int>& clusters) const
+{
+  /// Gets the indexes of the clusters of the detection element in the range [xMin, xMax]
+  /// The indexes are returned in the order in which the clusters were loaded,
+  /// so that the result of the tracking does not depend on the search windows
+  clusters.clear();
+  if (!(xMin <= xMax)) {
+    // Invalid window: take all clusters
+    for (int icl = 0; icl < mNClusters[deId]; ++icl) {
+      clusters.push_back(icl);
+    }
+    return;
+  }
+  const auto& index = mClusterIndex[deId].clusters;
+  auto first = std::lower_bound(index.begin(), index.end(), xMin,
+                                [](const std::pair<float, int>& cl, double x) { return cl.first < x; });
+  for (auto it = first; it != index.end() && it->first <= xMax; ++it) {
+    clusters.push_back(it->second);
+  }
+  std::sort(clusters.begin(), clusters.end());
+}
+
+//______________________________________________________________________________
+void Tracker::getSeedWindow(const Cluster3D& cl1, int deId2, double& xMin, double& xMax) const
+{
+  /// Gets the range in x containing all the clusters of deId2
+  /// that can make a track seed with cl1 (see makeTrackSeed).
+  /// The seed is accepted if |z2 x1 - z1 x2| < mImpactParamCut |z2 - z1| + mSigmaCut sqrt(z1^2 s2 + z2^2 s1),
+  /// which is bounded using the z range and the maximum dispersion of the clusters of deId2
+  const ClusterIndex& index(mClusterIndex[deId2]);
+  double x1 = cl1.position.x();
+  double z1 = cl1.position.z();
+  double dZMax = std::max(std::abs(index.zMin - z1), std::abs(index.zMax - z1));
+  double z2Max2 = std::max(index.zMin * index.zMin, index.zMax * index.zMax);
+  double maxDist = mImpactParamCut * dZMax + mSigmaCut * std::sqrt(z1 * z1 * index.maxSigmaX2 + z2Max2 * cl1.sigmaX2);
+  double low = std::min(index.zMin * x1, index.zMax * x1) - maxDist;
+  double high = std::max(index.zMin * x1, index.zMax * x1) + maxDist;
+  xMin = std::min(low / z1, high / z1) - sWindowMargin;
+  xMax = std::max(low / z1, high / z1) + sWindowMargin;
+}
+
+//______________________________________________________________________________
+void Tracker::getNextClusterWindow(const Track& track, int deId, double& xMin, double& xMax) const
+{
+  /// Gets the range in x containing all the clusters of deId
+  /// that can be compatible with the track (see tryOneCluster).
+  /// The extrapolated position and its uncertainty are bounded using the z range
+  /// and the maximum dispersion of the clusters of deId
+  const ClusterIndex& index(mClusterIndex[deId]);
+  const std::array<float, 6> covParams = track.getCovarianceParameters();
+  double pos = track.getPosition().x();
+  double dir = track.getDirection().x();
+  double dZ[2] = { index.zMin - track.getPosition().z(), index.zMax - track.getPosition().z() };
+  double newPos[2] = { pos + dir * dZ[0], pos + dir * dZ[1] };
+  auto getErr2 = [&covParams](double dz) { return covParams[0] + dz * dz * covParams[2] + 2. * dz * covParams[4]; };
+  // The uncertainty is a quadratic function of dZ: its maximum is at one edge,
+  // unless the parabola is concave
+  double maxErr2 = std::max(getErr2(dZ[0]), getErr2(dZ[1]));
+  if (covParams[2] < 0.) {
+    maxErr2 = std::max(maxErr2, getErr2(std::min(std::max(-covParams[4] / static_cast<double>(covParams[2]), dZ[0]), dZ[1])));
+  }
+  double distMax = mSigmaCut * std::sqrt(2. * (maxErr2 + index.maxSigmaX2)) + 4.;
+  xMin = std::min(newPos[0], newPos[1]) - distMax - sWindowMargin;
+  xMax = std::max(newPos[0], newPos[1]) + distMax + sWindowMargin;
+}
+
 //______________________________________________________________________________
 bool Tracker::process(const std::vector<Cluster2D>& clusters)
 {
@@ -115,31 +210,49 @@ bool Tracker::process(const std::vector<Cluster2D>& clusters)
 
   // Load the digits to get the fired pads
   if (loadClusters(clusters)) {
-    // Right and left side can be processed in parallel
-    // Right inward
-    processSide(true, true);
-    // Right outward
-    processSide(true, false);
-    // Left inward
-    processSide(false, true);
-    // left outward
-    processSide(false, false);
+    // The four passes (right inward, right outward, left inward, left outward)
+    // only read the clusters: they can be processed in parallel
+    auto processSides = [this](int firstPass, int step) {
+      for (int ipass = firstPass; ipass < 4; ipass += step) {
+        processSide(ipass < 2, ipass % 2 == 0, mCandidates[ipass]);
+      }
+    };
+    int nThreads = std::min(mNThreads, 4);
+    std::vector<std::future<void>> futures;
+    for (int ithread = 1; ithread < nThreads; ++ithread) {
+      futures.emplace_back(std::async(std::launch::async, processSides, ithread, nThreads));
+    }
+    processSides(0, nThreads);
+    for (auto& future : futures) {
+      future.get();
+    }
+
+    // The candidates are added in the same order as if the passes were run one after the other
+    for (auto& candidates : mCandidates) {
+      for (auto& track : candidates) {
+        addTrack(track);
+      }
+    }
   }
 
   return true;
 }
 
 //______________________________________________________________________________
-bool Tracker::processSide(bool isRight, bool isInward)
+void Tracker::processSide(bool isRight, bool isInward, std::vector<Track>& candidates) const
 {
-  /// Make tracks on one side of the detector
+  /// Make track candidates on one side of the detector
   int firstCh = (isInward) ? 3 : 0;
   int secondCh = (isInward) ? 2 : 1;
   int rpcOffset1 = Constants::getDEId(isRight, firstCh, 0);
   int rpcOffset2 = Constants::getDEId(isRight, secondCh, 0);
 
+  candidates.clear();
+
   // loop on RPCs in first plane
-  Track track;
+  Track track, bestTrack;
+  std::vector<int> clusters;
+  double xMin = 0., xMax = 0.;
   for (int irpc = 0; irpc < 9; ++irpc) {
     int deId1 = rpcOffset1 + irpc;
     for (int icl1 = 0; icl1 < mNClusters[deId1]; ++icl1) {
@@ -150,8 +263,13 @@ bool Tracker::processSide(bool isRight, bool isInward)
       for (int irpc2 = firstRpc; irpc2 <= lastRpc; ++irpc2) {
         // loop on (neighbour) RPCs in second plane
         int deId2 = rpcOffset2 + irpc2;
-        for (int icl2 = 0; icl2 < mNClusters[deId2]; ++icl2) {
-          // loop on clusters of the RPC in the second plane
+        if (mNClusters[deId2] == 0) {
+          continue;
+        }
+        getSeedWindow(cl1, deId2, xMin, xMax);
+        getClusters(deId2, xMin, xMax, clusters);
+        for (int icl2 : clusters) {
+          // loop on compatible clusters of the RPC in the second plane
           auto& cl2 = mClusters[deId2][icl2];
 
           if (!makeTrackSeed(track, cl1, cl2)) {
@@ -165,12 +283,13 @@ bool Tracker::processSide(bool isRight, bool isInward)
           LOG(DEBUG) << deId1 << " - " << deId2;
           LOG(DEBUG) << "Position: " << track.getPosition();
           // LOG(DEBUG) << "Covariance: " << track.getCovarianceParameters();
-          followTrack(track, isRight, isInward);
+          if (followTrack(track, isRight, isInward, bestTrack)) {
+            candidates.push_back(bestTrack);
+          }
         } // loop on clusters in second plane
       }   // loop on RPCs in second plane
     }     // loop on clusters in first plane
   }       // loop on RPCs in first plane
-  return true;
 }
 
 //______________________________________________________________________________
@@ -205,21 +324,16 @@ bool Tracker::makeTrackSeed(Track& track, const Cluster3D& cl1, const Cluster3D&
 }
 
 //______________________________________________________________________________
-bool Tracker::followTrack(const Track& track, bool isRight, bool isInward)
+bool Tracker::followTrack(const Track& track, bool isRight, bool isInward, Track& bestTrack) const
 {
   /// Follows the track segment in the other station
+  /// and fills bestTrack with the best track candidate
   double bestChi2 = 2. * mSigmaCut * mSigmaCut;
   int nFiredChambers = 0;
   int chamberOrder[2];
   chamberOrder[0] = isInward ? 1 : 2;
   chamberOrder[1] = isInward ? 0 : 3;
 
-  // Add the track to the list
-  if (mNTracks >= static_cast<unsigned long int>(mTracks.size())) {
-    mTracks.emplace_back(Track());
-  }
-  Track& bestTrack(mTracks[mNTracks]);
-
   // loop on next two chambers
   for (int ich = 0; ich < 2; ++ich) {
     findNextCluster(track, isRight, isInward, chamberOrder[ich], 0, 8, nFiredChambers, bestChi2, bestTrack);
@@ -238,8 +352,7 @@ bool Tracker::followTrack(const Track& track, bool isRight, bool isInward)
   // Extrapolate to first cluster in MT11 and compute the chi2
   finalizeTrack(bestTrack);
 
-  // Add the track if it is not compatible or better than the ones we already have
-  return addTrack(bestTrack);
+  return true;
 }
 
 //______________________________________________________________________________
@@ -250,9 +363,16 @@ bool Tracker::findNextCluster(const Track& track, bool isRight, bool isInward, i
   int nextChamber = (isInward) ? chamber - 1 : chamber + 1;
   int rpcOffset = Constants::getDEId(isRight, chamber, 0);
   Track newTrack;
+  std::vector<int> clusters;
+  double xMin = 0., xMax = 0.;
   for (int irpc = firstRPC; irpc <= lastRPC; ++irpc) {
     int deId = rpcOffset + irpc;
-    for (int icl = 0; icl < mNClusters[deId]; ++icl) {
+    if (mNClusters[deId] == 0) {
+      continue;
+    }
+    getNextClusterWindow(track, deId, xMin, xMax);
+    getClusters(deId, xMin, xMax, clusters);
+    for (int icl : clusters) {
       auto& cl = mClusters[deId][icl];
       double addChi2AtCluster = tryOneCluster(track, cl, newTrack);
       double sumChi2 = chi2 + addChi2AtCluster;
@@ -368,7 +488,7 @@ double Tracker::runKalmanFilter(Track& track, const Cluster3D& cluster) const
 }
 
 //______________________________________________________________________________
-void Tracker::finalizeTrack(Track& track)
+void Tracker::finalizeTrack(Track& track) const
 {
   /// Computes the chi2 of the track
   /// and extrapolate it to the first cluster
@@ -382,7 +502,7 @@ void Tracker::finalizeTrack(Track& track)
     ++ndf;
     int deId = matchedClusterIdx / 1000;
     int icl = matchedClusterIdx % 1000 - 1;
-    Cluster3D& cl(mClusters[deId][icl]);
+    const Cluster3D& cl(mClusters[deId][icl]);
     track.propagateToZ(cl.position.z());
     double clPos[2] = { cl.position.x(), cl.position.y() };
     double clErr2[2] = { cl.sigmaX2, cl.sigmaY2 };
@@ -440,6 +560,11 @@ bool Tracker::addTrack(const Track& track)
   }
 
   // The new track is not compatible with the previous ones: add the track to the list
+  if (mNTracks >= static_cast<unsigned long int>(mTracks.size())) {
+    mTracks.emplace_back(track);
+  } else {
+    mTracks[mNTracks] = track;
+  }
   ++mNTracks;
   return true;
 }
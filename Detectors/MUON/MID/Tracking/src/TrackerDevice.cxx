@@ -64,5 +64,15 @@ bool TrackerDevice::handleData(FairMQMessagePtr& msg, int /*index*/)
   return true;
 }
 
+//______________________________________________________________________________
+void TrackerDevice::InitTask()
+{
+  /// Initializes the task
+  mTracker.setNumberOfThreads(fConfig->GetValue<int>("nthreads"));
+  if (!mTracker.init()) {
+    LOG(ERROR) << "Initialization of MID tracker device failed";
+  }
+}
+
 } // namespace mid
 } // namespace o2
@@ -35,6 +35,9 @@ class TrackerDevice : public FairMQDevice
   TrackerDevice(TrackerDevice&&) = delete;
   TrackerDevice& operator=(TrackerDevice&&) = delete;
 
+ protected:
+  void InitTask() override;
+
  private:
   bool handleData(FairMQMessagePtr&, int);
   Tracker mTracker; ///< Tracking class
@@ -18,6 +18,10 @@
 
 namespace bpo = boost::program_options;
 
-void addCustomOptions(bpo::options_description& options) {}
+void addCustomOptions(bpo::options_description& options)
+{
+  options.add_options()("nthreads", bpo::value<int>()->default_value(1),
+                        "number of threads sharing the four side/direction tracking passes");
+}
 
 FairMQDevicePtr getDevice(const FairMQProgOptions&) { return new o2::mid::TrackerDevice(); }
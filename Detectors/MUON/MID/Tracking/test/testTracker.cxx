@@ -19,6 +19,7 @@
 
 #include <boost/test/data/monomorphic/generators/xrange.hpp>
 #include <boost/test/data/test_case.hpp>
+#include <algorithm>
 #include <cstdint>
 #include <sstream>
 #include <vector>
@@ -175,5 +176,30 @@ BOOST_DATA_TEST_CASE_F(MyFixture, TestMultipleTracks, boost::unit_test::data::xr
   BOOST_TEST_MESSAGE("Fraction of fake tracks: " << (double)nTotFakes / (double)nTotReconstructible);
 }
 
+BOOST_DATA_TEST_CASE_F(MyFixture, TestParallelPasses, boost::unit_test::data::xrange(1, 9), nTracksPerEvent)
+{
+  // The side/direction passes processed in parallel must give the same tracks
+  Tracker parallelTracker;
+  parallelTracker.setNumberOfThreads(4);
+  parallelTracker.init();
+  for (int ievt = 0; ievt < 100; ++ievt) {
+    std::vector<Cluster2D> clusters;
+    for (auto& trCl : getTrackClusters(nTracksPerEvent)) {
+      clusters.insert(clusters.end(), trCl.clusters.begin(), trCl.clusters.end());
+    }
+    tracker.process(clusters);
+    parallelTracker.process(clusters);
+    BOOST_TEST(parallelTracker.getNTracks() == tracker.getNTracks());
+    for (unsigned long int ireco = 0; ireco < std::min(tracker.getNTracks(), parallelTracker.getNTracks()); ++ireco) {
+      const Track& track = tracker.getTracks()[ireco];
+      const Track& parallelTrack = parallelTracker.getTracks()[ireco];
+      for (int ich = 0; ich < 4; ++ich) {
+        BOOST_TEST(parallelTrack.getClusterMatched(ich) == track.getClusterMatched(ich));
+      }
+      BOOST_TEST(parallelTrack.getChi2() == track.getChi2());
+    }
+  }
+}
+
 } // namespace mid
 } // namespace o2
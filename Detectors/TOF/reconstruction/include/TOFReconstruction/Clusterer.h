@@ -13,6 +13,7 @@
 #ifndef ALICEO2_TOF_CLUSTERER_H
 #define ALICEO2_TOF_CLUSTERER_H
 
+#include <array>
 #include <utility>
 #include <vector>
 #include "DataFormatsTOF/Cluster.h"
@@ -44,18 +45,37 @@ class Clusterer
 
   void setMCTruthContainer(o2::dataformats::MCTruthContainer<o2::MCCompLabel>* truth) { mClsLabels = truth; }
 
+  /// set the number of threads clusterizing the strips in parallel
+  void setNumberOfThreads(int n) { mNumberOfThreads = (n > 0) ? n : 1; }
+  int getNumberOfThreads() const { return mNumberOfThreads; }
+
  private:
-  void processStrip(std::vector<Cluster>& clusters, MCLabelContainer const* digitMCTruth);
+  /// work space of one thread
+  struct Worker {
+    std::vector<Cluster> clusters;          ///< clusters of the strips processed by this thread (but the first)
+    MCLabelContainer labels;                ///< their MC labels
+    std::array<int, Geo::NPADS> firstDigit; ///< index of the first digit not yet used in each channel of the strip
+    std::vector<int> nextDigit;             ///< index of the next digit in the same channel
+    std::vector<int> candidates;            ///< indices of the digits to be merged with the current one
+    Digit* contributingDigit[6];            ///< array of digits contributing to the cluster, temporary to build the final cluster
+    int numberOfContributingDigits = 0;     ///< number of digits contributing to the cluster
+  };
+
+  void processStrip(StripData& strip, Worker& worker, std::vector<Cluster>& clusters, MCLabelContainer* clsLabels,
+                    MCLabelContainer const* digitMCTruth);
   //void fetchMCLabels(const Digit* dig, std::array<Label, Cluster::maxLabels>& labels, int& nfilled) const;
 
-  StripData mStripData; ///< single strip data provided by the reader
+  std::vector<StripData> mStripData; //! data of the strips provided by the reader
+  int mNumberOfStrips = 0;           //! number of strips read in the current event
 
   o2::dataformats::MCTruthContainer<o2::MCCompLabel>* mClsLabels = nullptr; // Cluster MC labels
 
-  Digit* mContributingDigit[6];    //! array of digits contributing to the cluster; this will not be stored, it is temporary to build the final cluster
-  int mNumberOfContributingDigits; //! number of digits contributing to the cluster; this will not be stored, it is temporary to build the final cluster
-  void addContributingDigit(Digit* dig);
-  void buildCluster(Cluster& c, MCLabelContainer const* digitMCTruth);
+  int mNumberOfThreads = 1;     ///< number of threads clusterizing the strips
+  std::vector<Worker> mWorkers; //! work space of each thread
+
+  void addContributingDigit(Worker& worker, Digit* dig);
+  void buildCluster(Worker& worker, Cluster& c, MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth);
+  void setPosition(Cluster& c);
 };
 
 } // namespace tof
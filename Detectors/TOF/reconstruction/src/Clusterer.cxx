@@ -11,6 +11,8 @@
 /// \file Clusterer.cxx
 /// \brief Implementation of the TOF cluster finder
 #include <algorithm>
+#include <functional>
+#include <future>
 #include "FairLogger.h" // for LOG
 #include "DataFormatsTOF/Cluster.h"
 #include "TOFReconstruction/Clusterer.h"
@@ -24,110 +26,172 @@ void Clusterer::process(DataReader& reader, std::vector<Cluster>& clusters, MCLa
 {
   reader.init();
   int totNumDigits = 0;
+  size_t firstCluster = clusters.size();
 
-  while (reader.getNextStripData(mStripData)) {
-    LOG(DEBUG) << "TOFClusterer got Strip " << mStripData.stripID << " with Ndigits "
-               << mStripData.digits.size();
-    totNumDigits += mStripData.digits.size();
+  // first read all the strips, so that they can be clusterized in parallel
+  mNumberOfStrips = 0;
+  while (true) {
+    if (mNumberOfStrips == static_cast<int>(mStripData.size())) {
+      mStripData.emplace_back();
+    }
+    StripData& stripData = mStripData[mNumberOfStrips];
+    if (!reader.getNextStripData(stripData)) {
+      break;
+    }
+    LOG(DEBUG) << "TOFClusterer got Strip " << stripData.stripID << " with Ndigits " << stripData.digits.size();
+    totNumDigits += stripData.digits.size();
+    ++mNumberOfStrips;
+  }
+
+  // each thread clusterizes a contiguous block of strips; the first thread fills directly the output,
+  // the clusters of the others are appended in the order of the blocks, so that the output
+  // does not depend on the number of threads
+  int nThreads = std::max(1, std::min(mNumberOfThreads, mNumberOfStrips));
+  if (static_cast<int>(mWorkers.size()) < nThreads) {
+    mWorkers.resize(nThreads);
+  }
+  auto processStrips = [this, nThreads, digitMCTruth](int iThread, std::vector<Cluster>& threadClusters,
+                                                      MCLabelContainer* threadLabels) {
+    int lastStrip = mNumberOfStrips * (iThread + 1) / nThreads;
+    for (int iStrip = mNumberOfStrips * iThread / nThreads; iStrip < lastStrip; ++iStrip) {
+      processStrip(mStripData[iStrip], mWorkers[iThread], threadClusters, threadLabels, digitMCTruth);
+    }
+  };
+  std::vector<std::future<void>> futures;
+  for (int iThread = 1; iThread < nThreads; ++iThread) {
+    Worker& worker = mWorkers[iThread];
+    worker.clusters.clear();
+    worker.labels.clear();
+    futures.emplace_back(std::async(std::launch::async, processStrips, iThread, std::ref(worker.clusters), &worker.labels));
+  }
+  processStrips(0, clusters, mClsLabels);
+  for (auto& future : futures) {
+    future.get();
+  }
+  for (int iThread = 1; iThread < nThreads; ++iThread) {
+    Worker& worker = mWorkers[iThread];
+    clusters.insert(clusters.end(), worker.clusters.begin(), worker.clusters.end());
+    if (digitMCTruth != nullptr) {
+      mClsLabels->mergeAtBack(worker.labels);
+    }
+  }
 
-    processStrip(clusters, digitMCTruth);
+  // the navigation in the geometry is not thread safe, the positions are set once all the clusters are built
+  for (size_t iCluster = firstCluster; iCluster < clusters.size(); ++iCluster) {
+    setPosition(clusters[iCluster]);
   }
 
   LOG(DEBUG) << "We had " << totNumDigits << " digits in this event";
 }
 
 //__________________________________________________
-void Clusterer::processStrip(std::vector<Cluster>& clusters, MCLabelContainer const* digitMCTruth)
+void Clusterer::processStrip(StripData& strip, Worker& worker, std::vector<Cluster>& clusters,
+                             MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth)
 {
-  // method to clusterize the current strip
+  // method to clusterize the given strip
+  // The digits are ordered in time: each digit not yet used seeds a cluster, to which are added the digits
+  // not yet used coming later within 500 ps in the same or in a neighbouring pad. Since all the digits
+  // before the seed are already used, only the digits of the neighbouring pads are looked at, following
+  // per channel lists that skip the used digits.
+
+  std::vector<Digit>& digits = strip.digits;
+  int nDigits = digits.size();
 
-  Int_t detId[5];
-  Int_t chan, chan2, chan3;
-  Int_t strip1, strip2;
-  Int_t iphi, iphi2, iphi3;
-  Int_t ieta, ieta2, ieta3; // it is the number of padz-row increasing along the various strips
+  // build the list of digits of each channel, in time order
+  worker.firstDigit.fill(-1);
+  worker.nextDigit.resize(nDigits);
+  for (int idig = nDigits - 1; idig >= 0; --idig) {
+    int chan = digits[idig].getChannel() % Geo::NPADS;
+    worker.nextDigit[idig] = worker.firstDigit[chan];
+    worker.firstDigit[chan] = idig;
+  }
 
-  for (int idig = 0; idig < mStripData.digits.size(); idig++) {
-    //    LOG(DEBUG) << "Checking digit " << idig;
-    Digit* dig = &mStripData.digits[idig];
+  for (int idig = 0; idig < nDigits; idig++) {
+    Digit* dig = &digits[idig];
     if (dig->isUsedInCluster())
       continue; // the digit was already used to build a cluster
 
-    mNumberOfContributingDigits = 0;
-    dig->getPhiAndEtaIndex(iphi, ieta);
-    if (mStripData.digits.size() > 1)
+    worker.numberOfContributingDigits = 0;
+    if (nDigits > 1)
       LOG(DEBUG) << "idig = " << idig;
 
     // first we make a cluster out of the digit
-    int noc = clusters.size();
-    //    LOG(DEBUG) << "noc = " << noc << "\n";
     clusters.emplace_back();
-    Cluster& c = clusters[noc];
-    addContributingDigit(dig);
+    Cluster& c = clusters.back();
+    addContributingDigit(worker, dig);
     float timeDig = dig->getTDC() * Geo::TDCBIN;
 
-    for (int idigNext = idig + 1; idigNext < mStripData.digits.size(); idigNext++) {
-      Digit* digNext = &mStripData.digits[idigNext];
-      if (digNext->isUsedInCluster())
-        continue; // the digit was already used to build a cluster
-      // check if the TOF time are close enough to be merged; if not, it means that nothing else will contribute to the cluster (since digits are ordered in time)
-      float timeDigNext = digNext->getTDC() * Geo::TDCBIN; // we assume it calibrated (for now); in ps
-      LOG(DEBUG) << "Time difference = " << timeDigNext - timeDig;
-      if (timeDigNext - timeDig > 500 /*in ps*/)
-        break;
-      digNext->getPhiAndEtaIndex(iphi2, ieta2);
-
-      // check if the fired pad are close in space
-      LOG(DEBUG) << "phi difference = " << iphi - iphi2;
-      LOG(DEBUG) << "eta difference = " << ieta - ieta2;
-      if ((TMath::Abs(iphi - iphi2) > 1) || (TMath::Abs(ieta - ieta2) > 1))
-        continue;
-
-      // if we are here, the digit contributes to the cluster
-      addContributingDigit(digNext);
+    // look for the digits close in time in the same pad and in the neighbouring ones:
+    // within a strip, they have a pad x differing by at most one, with any pad z
+    int chan = dig->getChannel() % Geo::NPADS;
+    int padX = chan % Geo::NPADX;
+    worker.candidates.clear();
+    for (int padZ = 0; padZ < Geo::NPADZ; ++padZ) {
+      for (int padX2 = std::max(padX - 1, 0); padX2 <= std::min(padX + 1, Geo::NPADX - 1); ++padX2) {
+        int& first = worker.firstDigit[padZ * Geo::NPADX + padX2];
+        while (first >= 0 && digits[first].isUsedInCluster()) {
+          first = worker.nextDigit[first];
+        }
+        for (int idigNext = first; idigNext >= 0; idigNext = worker.nextDigit[idigNext]) {
+          Digit* digNext = &digits[idigNext];
+          if (digNext->isUsedInCluster())
+            continue; // the digit was already used to build a cluster
+          // check if the TOF time are close enough to be merged; if not, nothing else in this pad will contribute
+          float timeDigNext = digNext->getTDC() * Geo::TDCBIN; // we assume it calibrated (for now); in ps
+          if (timeDigNext - timeDig > 500 /*in ps*/)
+            break;
+          worker.candidates.push_back(idigNext);
+        }
+      }
+    }
 
-    } // loop on the second digit
+    // the digits contribute to the cluster in time order
+    std::sort(worker.candidates.begin(), worker.candidates.end());
+    for (int idigNext : worker.candidates) {
+      addContributingDigit(worker, &digits[idigNext]);
+    }
 
-    buildCluster(c, digitMCTruth);
+    buildCluster(worker, c, clsLabels, digitMCTruth);
 
   } // loop on the first digit
 }
 //______________________________________________________________________
-void Clusterer::addContributingDigit(Digit* dig)
+void Clusterer::addContributingDigit(Worker& worker, Digit* dig)
 {
 
   // adding a digit to the array that stores the contributing ones
 
-  if (mNumberOfContributingDigits == 6) {
+  if (worker.numberOfContributingDigits == 6) {
     LOG(ERROR) << "The cluster has already 6 digits associated to it, we cannot add more; returning without doing anything";
+    return;
   }
-  mContributingDigit[mNumberOfContributingDigits] = dig;
-  mNumberOfContributingDigits++;
+  worker.contributingDigit[worker.numberOfContributingDigits] = dig;
+  worker.numberOfContributingDigits++;
   dig->setIsUsedInCluster();
 
   return;
 }
 
 //_____________________________________________________________________
-void Clusterer::buildCluster(Cluster& c, MCLabelContainer const* digitMCTruth)
+void Clusterer::buildCluster(Worker& worker, Cluster& c, MCLabelContainer* clsLabels, MCLabelContainer const* digitMCTruth)
 {
 
   // here we finally build the cluster from all the digits contributing to it
 
   Digit* temp;
-  for (int idig = 1; idig < mNumberOfContributingDigits; idig++) {
+  for (int idig = 1; idig < worker.numberOfContributingDigits; idig++) {
     // the digit[0] will be the main one
-    if (mContributingDigit[idig]->getTOT() > mContributingDigit[0]->getTOT()) {
-      temp = mContributingDigit[0];
-      mContributingDigit[0] = mContributingDigit[idig];
-      mContributingDigit[idig] = temp;
+    if (worker.contributingDigit[idig]->getTOT() > worker.contributingDigit[0]->getTOT()) {
+      temp = worker.contributingDigit[0];
+      worker.contributingDigit[0] = worker.contributingDigit[idig];
+      worker.contributingDigit[idig] = temp;
     }
   }
 
-  c.setMainContributingChannel(mContributingDigit[0]->getChannel());
-  c.setTime(mContributingDigit[0]->getTDC() * Geo::TDCBIN + double(mContributingDigit[0]->getBC() * 25000.)); // time in ps (for now we assume it calibrated)
+  c.setMainContributingChannel(worker.contributingDigit[0]->getChannel());
+  c.setTime(worker.contributingDigit[0]->getTDC() * Geo::TDCBIN + double(worker.contributingDigit[0]->getBC() * 25000.)); // time in ps (for now we assume it calibrated)
 
-  c.setTot(mContributingDigit[0]->getTOT() * Geo::TOTBIN * 1E-3); // TOT in ns (for now we assume it calibrated)
+  c.setTot(worker.contributingDigit[0]->getTOT() * Geo::TOTBIN * 1E-3); // TOT in ns (for now we assume it calibrated)
   //setL0L1Latency(); // to be filled (maybe)
   //setDeltaBC(); // to be filled (maybe)
 
@@ -137,12 +201,13 @@ void Clusterer::buildCluster(Cluster& c, MCLabelContainer const* digitMCTruth)
   int deltaPhi, deltaEta;
   int mask;
 
-  mContributingDigit[0]->getPhiAndEtaIndex(phi1, eta1);
+  worker.contributingDigit[0]->getPhiAndEtaIndex(phi1, eta1);
   // now set the mask with the secondary digits
-  for (int idig = 1; idig < mNumberOfContributingDigits; idig++) {
-    mContributingDigit[idig]->getPhiAndEtaIndex(phi2, eta2);
+  for (int idig = 1; idig < worker.numberOfContributingDigits; idig++) {
+    worker.contributingDigit[idig]->getPhiAndEtaIndex(phi2, eta2);
     deltaPhi = phi1 - phi2;
     deltaEta = eta1 - eta2;
+    mask = 0;
     if (deltaPhi == 1) {   // the digit is to the LEFT of the cluster; let's check about UP/DOWN/Same Line
       if (deltaEta == 1) { // the digit is DOWN LEFT wrt the cluster
         mask = Cluster::kDownLeft;
@@ -175,28 +240,24 @@ void Clusterer::buildCluster(Cluster& c, MCLabelContainer const* digitMCTruth)
 
   // filling the MC labels of this cluster; the first will be those of the main digit; then the others
   if (digitMCTruth != nullptr) {
-    int lbl = mClsLabels->getIndexedSize(); // this should correspond to the number of digits also;
-    printf("lbl = %d\n", lbl);
-    for (int i = 0; i < mNumberOfContributingDigits; i++) {
-      printf("contributing digit = %d\n", i);
-      int digitLabel = mContributingDigit[i]->getLabel();
-      printf("digitLabel = %d\n", digitLabel);
-      gsl::span<const o2::MCCompLabel> mcArray = digitMCTruth->getLabels(digitLabel);
-      for (int j = 0; j < static_cast<int>(mcArray.size()); j++) {
-        printf("checking element %d in the array of labels\n", j);
-        auto label = digitMCTruth->getElement(digitMCTruth->getMCTruthHeader(digitLabel).index + j);
-        printf("EventID = %d\n", label.getEventID());
-        mClsLabels->addElement(lbl, label);
+    int lbl = clsLabels->getIndexedSize(); // this should correspond to the number of clusters also;
+    for (int i = 0; i < worker.numberOfContributingDigits; i++) {
+      for (auto const& label : digitMCTruth->getLabels(worker.contributingDigit[i]->getLabel())) {
+        clsLabels->addElement(lbl, label);
       }
     }
   }
 
+  return;
+}
+
+//_____________________________________________________________________
+void Clusterer::setPosition(Cluster& c)
+{
   // set geometrical variables
   int det[5];
   Geo::getVolumeIndices(c.getMainContributingChannel(), det);
   float pos[3];
   Geo::getPos(det, pos);
   c.setBaseData(c.getMainContributingChannel(), pos[0], pos[1], pos[2], 0, 0, 0); // error on position set to zero
-
-  return;
 }
@@ -0,0 +1,137 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test TOFClusterer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <vector>
+#include <TGeoManager.h>
+#include <TGeoMaterial.h>
+#include <TGeoMatrix.h>
+#include <TGeoMedium.h>
+#include "DataFormatsTOF/Cluster.h"
+#include "TOFBase/Digit.h"
+#include "TOFBase/Geo.h"
+#include "TOFReconstruction/Clusterer.h"
+#include "TOFReconstruction/DataReader.h"
+
+using namespace o2::tof;
+
+namespace
+{
+const int NStrips = 16; // strips of the first plate of sector 0 used in the test
+
+/// Builds the volumes Geo::getPos navigates to for the strips of the first plate of sector 0. The pads
+/// are placed at x = 2 * (pad x + 1), y = 10 * strip, z = 3 * (pad z + 1).
+void buildGeometry()
+{
+  new TGeoManager("TOFClustererTest", "TOF pads for the clusterer test");
+  auto medium = new TGeoMedium("Vacuum", 1, new TGeoMaterial("Vacuum", 0, 0, 0));
+  auto box = [medium](const char* name) { return gGeoManager->MakeBox(name, medium, 1000, 1000, 1000); };
+  auto cave = box("cave");
+  gGeoManager->SetTopVolume(cave);
+  TGeoVolume* mother = cave;
+  for (auto name : { "B077", "BSEGMO0", "BTOF0" }) {
+    auto volume = box(name);
+    mother->AddNode(volume, 1);
+    mother = volume;
+  }
+  for (auto name : { "FTOA", "FLTA" }) {
+    auto volume = box(name);
+    mother->AddNode(volume, 0);
+    mother = volume;
+  }
+  auto strip = box("FSTR");
+  for (int iStrip = 0; iStrip < NStrips; ++iStrip) {
+    mother->AddNode(strip, iStrip + 1, new TGeoTranslation(0, 10 * iStrip, 0));
+  }
+  auto pcb = box("FPCB");
+  auto sensitive = box("FSEN");
+  auto row = box("FSEZ");
+  auto pad = box("FPAD");
+  strip->AddNode(pcb, 1);
+  pcb->AddNode(sensitive, 1);
+  for (int padZ = 1; padZ <= Geo::NPADZ; ++padZ) {
+    sensitive->AddNode(row, padZ, new TGeoTranslation(0, 0, 3 * padZ));
+  }
+  for (int padX = 1; padX <= Geo::NPADX; ++padX) {
+    row->AddNode(pad, padX, new TGeoTranslation(2 * padX, 0, 0));
+  }
+  gGeoManager->CloseGeometry();
+}
+
+struct ExpectedCluster {
+  int channel;   // main channel in the strip
+  int tdc;       // TDC of the main digit
+  int tot;       // TOT of the main digit
+  int nChannels; // number of contributing channels
+};
+
+/// digits of one strip: channel in the strip, TDC, TOT
+const int StripDigits[][3] = {
+  { 10, 1000, 100 },
+  { 11, 1005, 200 },             // neighbour of the first one in x, 122 ps later
+  { Geo::NPADX + 10, 1010, 50 }, // neighbour of the first one in z, 244 ps later
+  { 10, 1100, 80 },              // same pad as the first one, 2.4 ns later
+  { 20, 1002, 30 },
+  { 21, 1027, 40 },              // neighbour of the previous one, 610 ps later
+};
+
+/// clusters of one strip, in the order they are built, i.e. by time of their seed
+const ExpectedCluster StripClusters[] = {
+  { 11, 1005, 200, 3 }, // the main digit is the one with the largest TOT
+  { 20, 1002, 30, 1 },
+  { 21, 1027, 40, 1 },
+  { 10, 1100, 80, 1 },
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(testTOFClusterer)
+{
+  buildGeometry();
+
+  std::vector<Digit> digits;
+  for (int iStrip = 0; iStrip < NStrips; ++iStrip) {
+    for (auto& digit : StripDigits) {
+      digits.emplace_back(iStrip * Geo::NPADS + digit[0], digit[1], digit[2], 0);
+    }
+  }
+  DigitDataReader reader;
+  reader.setDigitArray(&digits);
+
+  for (int nThreads : { 1, 4 }) {
+    Clusterer clusterer;
+    clusterer.setNumberOfThreads(nThreads);
+    std::vector<Cluster> clusters;
+    clusterer.process(reader, clusters, nullptr);
+
+    BOOST_TEST_CONTEXT(nThreads << " thread(s)")
+    {
+      BOOST_REQUIRE_EQUAL(clusters.size(), NStrips * std::size(StripClusters));
+      for (int iStrip = 0; iStrip < NStrips; ++iStrip) {
+        for (size_t i = 0; i < std::size(StripClusters); ++i) {
+          auto const& expected = StripClusters[i];
+          auto const& cluster = clusters[iStrip * std::size(StripClusters) + i];
+          int channel = iStrip * Geo::NPADS + expected.channel;
+          BOOST_CHECK_EQUAL(cluster.getMainContributingChannel(), channel);
+          BOOST_CHECK_EQUAL(cluster.getNumOfContributingChannels(), expected.nChannels);
+          BOOST_CHECK_CLOSE(cluster.getTime(), expected.tdc * Geo::TDCBIN, 1e-3);
+          BOOST_CHECK_CLOSE(cluster.getTot(), expected.tot * Geo::TOTBIN * 1e-3, 1e-3);
+          BOOST_CHECK_SMALL(cluster.getX() - 2 * (expected.channel % Geo::NPADX + 1), 1e-3f);
+          BOOST_CHECK_SMALL(cluster.getY() - 10 * iStrip, 1e-3f);
+          BOOST_CHECK_SMALL(cluster.getZ() - 3 * (expected.channel / Geo::NPADX + 1), 1e-3f);
+        }
+      }
+    }
+  }
+}
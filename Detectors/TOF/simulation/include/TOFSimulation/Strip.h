@@ -19,11 +19,11 @@
 #include <TOFBase/Digit.h>
 #include <TObject.h>
 #include <exception>
-#include <map>
 #include <sstream>
 #include <vector>
 #include "MathUtils/Cartesian3D.h"
 #include "TOFSimulation/Detector.h" // for HitType
+#include "SimulationDataFormat/DigitAccumulator.h"
 
 namespace o2
 {
@@ -100,16 +100,15 @@ class Strip
  protected:
   Int_t mStripIndex = -1;                      ///< Strip ID
   std::vector<const o2::tof::HitType*> mHits;  ///< Hits connected to the given strip
-  std::map<ULong64_t, o2::tof::Digit> mDigits; ///< Map of fired digits, possibly in multiple frames
+  o2::dataformats::DigitAccumulator<o2::tof::Digit> mDigits; //! fired digits by ordering key, possibly in multiple frames
 
-  ClassDefNV(Strip, 1);
+  ClassDefNV(Strip, 2);
 };
 
 inline o2::tof::Digit* Strip::findDigit(ULong64_t key)
 {
   // finds the digit corresponding to global key
-  auto digitentry = mDigits.find(key);
-  return digitentry != mDigits.end() ? &(digitentry->second) : nullptr;
+  return mDigits.find(key);
 }
 
 } // close namespace tof
@@ -63,12 +63,10 @@ Int_t Strip::addDigit(Int_t channel, Int_t tdc, Int_t tot, Int_t bc, Int_t lbl)
   // case the digit was merged
 
   auto key = Digit::getOrderingKey(channel, bc, tdc); // the digits are ordered first per channel, then inside the channel per BC, then per time
-  auto dig = findDigit(key);
-  if (dig) {
-    lbl = dig->getLabel();      // getting the label from the already existing digit
-    dig->merge(tdc, tot);       // merging to the existing digit
-  } else {
-    auto digIter = mDigits.emplace(std::make_pair(key, Digit(channel, tdc, tot, bc, lbl)));
+  auto dig = mDigits.emplace(key, channel, tdc, tot, bc, lbl);
+  if (!dig.second) {
+    lbl = dig.first->getLabel(); // getting the label from the already existing digit
+    dig.first->merge(tdc, tot);  // merging to the existing digit
   }
 
   return lbl;
@@ -83,14 +81,7 @@ void Strip::fillOutputContainer(std::vector<Digit>& digits)
 
   if (mDigits.empty())
     return;
-  auto itBeg = mDigits.begin();
-  auto iter = itBeg;
-  for (; iter != mDigits.end(); ++iter) {
-    Digit& dig = iter->second;
-    digits.emplace_back(dig);
-  }
-
-  //  if (iter!=mDigits.end()) iter--;
-  mDigits.erase(itBeg, iter);
+  // flushed in the order of the key, as before with the map
+  mDigits.flush(digits);
   clearHits();
 }
@@ -55,7 +55,7 @@ class ROC
     /// constructor from sector and ROC type
     /// @param [in] sec sector
     /// @param [in] type ROC type
-    ROC(const Sector &sec, const RocType type) : mROC(sec.getSector() + (type == RocType::OROC) * SECTORSPERSIDE) {}
+    ROC(const Sector &sec, const RocType type) : mROC(sec.getSector() + (type == RocType::OROC) * Sector::MAXSECTOR) {}
 
     /// comparison operator
     bool operator==(const ROC &other) { return mROC == other.mROC; }
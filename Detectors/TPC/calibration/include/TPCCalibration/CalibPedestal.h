@@ -42,6 +42,12 @@ class CalibPedestal : public CalibRawBase
   public:
     using vectorType = std::vector<float>;
 
+    /// how pedestal and noise are extracted from the ADC spectra
+    enum class StatisticsType : char {
+      GausFit,   ///< Gaussian fit
+      MeanStdDev ///< mean and standard deviation
+    };
+
     /// default constructor
     CalibPedestal(PadSubset padSubset = PadSubset::ROC);
 
@@ -70,9 +76,27 @@ class CalibPedestal : public CalibRawBase
 
     /// set the time bin range to analyse
     void setTimeBinRange(int first, int last) { mFirstTimeBin=first; mLastTimeBin=last; }
-    /// Analyse the buffered adc values and calculate noise and pedestal
+    /// set how pedestal and noise are extracted
+    void setStatisticsType(StatisticsType type) { mStatisticsType = type; }
+
+    /// Analyse the buffered adc values and calculate noise and pedestal,
+    /// the ROCs are analysed in parallel, see setNumberOfThreads
     void analyse();
 
+    /// Merge the ADC spectra accumulated by another instance, e.g. another
+    /// processing lane, into this one
+    /// \param other calibration object with the same ADC range
+    void merge(const CalibPedestal& other);
+
+    /// The accumulated ADC spectra in a flat buffer, to be sent to the process
+    /// merging the partial results
+    std::vector<char> getPartialData() const;
+
+    /// Add the ADC spectra of a buffer created by getPartialData
+    /// \param data buffer
+    /// \param size size of the buffer in bytes
+    void mergePartialData(const char* data, size_t size);
+
     /// Get the pedestal calibration object
     ///
     /// \return pedestal calibration object
@@ -95,6 +119,7 @@ class CalibPedestal : public CalibRawBase
     int        mADCMin;       ///< minimum adc value
     int        mADCMax;       ///< maximum adc value
     int        mNumberOfADCs; ///< number of adc values (mADCMax-mADCMin+1)
+    StatisticsType mStatisticsType; ///< how pedestal and noise are extracted
     CalPad     mPedestal;     ///< CalDet object with pedestal information
     CalPad     mNoise;        ///< CalDet object with noise
 
@@ -106,6 +131,12 @@ class CalibPedestal : public CalibRawBase
     /// \param create if to create the vector if it does not exist
     vectorType* getVector(ROC roc, bool create=kFALSE);
 
+    /// add the ADC spectra of all pads of a readout chamber
+    void addVector(ROC roc, const float* data, size_t size);
+
+    /// extract pedestal and noise of all pads of a readout chamber
+    void analyseROC(ROC roc);
+
     /// dummy reset
     void resetEvent() final {}
 };
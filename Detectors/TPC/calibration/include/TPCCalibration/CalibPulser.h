@@ -15,10 +15,9 @@
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
 
 #include <vector>
+#include <map>
 #include <memory>
 
-#include "TH2S.h"
-
 #include "DataFormatsTPC/Defs.h"
 #include "TPCBase/CalDet.h"
 #include "TPCBase/CRU.h"
@@ -35,6 +34,10 @@ namespace TPC
 ///
 /// This class is used to produce pad wise pulser calibration information
 ///
+/// For each pulse the T0, width and Qtot are extracted, and their sums are
+/// accumulated per pad. The accumulated sums of different instances, e.g.
+/// running in parallel on different data, can be merged.
+///
 /// origin: TPC
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
 
@@ -42,7 +45,6 @@ class CalibPulser : public CalibRawBase
 {
   public:
     using VectorType    = std::vector<float>;
-    using PtrVectorType = std::vector<std::unique_ptr<TH2S>>;
 
     /// default constructor
     CalibPulser(PadSubset padSubset = PadSubset::ROC);
@@ -76,25 +78,39 @@ class CalibPulser : public CalibRawBase
       mLastTimeBin=last;
       //TODO: until automatic T0 calibration is done we use the same time range
       //      as for the time bin selection
-      mXminT0 = mFirstTimeBin;
-      mXmaxT0 = mLastTimeBin;
+      mMinT0 = mFirstTimeBin;
+      mMaxT0 = mLastTimeBin;
     }
 
     /// set noise and pedestal calibration objects
     void setPedestalAndNoise(const CalPad* pedestal, const CalPad* noise) { mPedestal=pedestal; mNoise=noise; }
 
-    /// set T0 Binning
-    void setT0Binning(int nbins, float min, float max) { mNbinsT0=nbins; mXminT0=min; mXmaxT0=max; }
+    /// set range of accepted T0 values
+    void setT0Range(float min, float max) { mMinT0=min; mMaxT0=max; }
 
-    /// set Width Binning
-    void setWidthBinning(int nbins, float min, float max) { mNbinsWidth=nbins; mXminWidth=min; mXmaxWidth=max; }
+    /// set range of accepted width values
+    void setWidthRange(float min, float max) { mMinWidth=min; mMaxWidth=max; }
 
-    /// set Qtot Binning
-    void setQtotBinning(int nbins, float min, float max) { mNbinsQtot=nbins; mXminQtot=min; mXmaxQtot=max; }
+    /// set range of accepted Qtot values
+    void setQtotRange(float min, float max) { mMinQtot=min; mMaxQtot=max; }
 
     /// Analyse the buffered pulser information
     void analyse();
 
+    /// Merge the pulser information accumulated by another instance, e.g.
+    /// another processing lane, into this one
+    /// \param other calibration object with the same value ranges
+    void merge(const CalibPulser& other);
+
+    /// The accumulated pulser information in a flat buffer, to be sent to
+    /// the process merging the partial results
+    std::vector<char> getPartialData() const;
+
+    /// Add the pulser information of a buffer created by getPartialData
+    /// \param data buffer
+    /// \param size size of the buffer in bytes
+    void mergePartialData(const char* data, size_t size);
+
     /// Get the pulser mean time calibration object
     /// \return pedestal calibration object
     const CalPad& getT0() const { return mT0; }
@@ -117,16 +133,48 @@ class CalibPulser : public CalibRawBase
     void endEvent() final {};
 
   private:
-    // reference histogram ranges
-    int   mNbinsT0;           ///< Number of bins for T0 reference histogram
-    float mXminT0;            ///< xmin   of T0 reference histogram
-    float mXmaxT0;            ///< xmax   of T0 reference histogram
-    int   mNbinsQtot;         ///< Number of bins for Qtot reference histogram
-    float mXminQtot;          ///< xmin   of Qtot reference histogram
-    float mXmaxQtot;          ///< xmax   of Qtot reference histogram
-    int   mNbinsWidth;        ///< Number of bins for width reference histogram
-    float mXminWidth;         ///< xmin   of width reference histogram
-    float mXmaxWidth;         ///< xmax   of width reference histogram
+    /// sums to calculate the mean of one quantity of a pad
+    struct Moments {
+      double mEntries{0.}; ///< number of accepted values
+      double mSum{0.};     ///< sum of the accepted values
+      double mSum2{0.};    ///< sum of the squares of the accepted values
+
+      /// add a value if it is in [min, max)
+      void fill(float value, float min, float max)
+      {
+        if (value < min || value >= max) return;
+        mEntries += 1.;
+        mSum += value;
+        mSum2 += double(value) * value;
+      }
+
+      /// add the sums of other
+      void merge(const Moments& other)
+      {
+        mEntries += other.mEntries;
+        mSum += other.mSum;
+        mSum2 += other.mSum2;
+      }
+
+      /// mean of the accepted values, def if there are none
+      double getMean(double def) const { return mEntries > 0. ? mSum / mEntries : def; }
+    };
+
+    /// accumulated pulser information of one pad
+    struct PadStatistics {
+      Moments mT0;    ///< T0 of the pulses
+      Moments mWidth; ///< width of the pulses
+      Moments mQtot;  ///< Qtot of the pulses
+    };
+    using StatisticsVector = std::vector<PadStatistics>;
+
+    // accepted value ranges
+    float mMinT0;             ///< minimum accepted T0
+    float mMaxT0;             ///< maximum accepted T0
+    float mMinQtot;           ///< minimum accepted Qtot
+    float mMaxQtot;           ///< maximum accepted Qtot
+    float mMinWidth;          ///< minimum accepted width
+    float mMaxWidth;          ///< maximum accepted width
 
     int        mFirstTimeBin; ///< first time bin used in analysis
     int        mLastTimeBin;  ///< first time bin used in analysis
@@ -145,9 +193,7 @@ class CalibPulser : public CalibRawBase
 
     std::map<PadROCPos, VectorType> mPulserData; //!< ADC data to calculate pulser information
 
-    PtrVectorType mT0Histograms;    //!< T0 histogramgs per ROC and pad
-    PtrVectorType mWidthHistograms; //!< Width histogramgs per ROC and pad
-    PtrVectorType mQtotHistograms;  //!< Qtot histogramgs per ROC and pad
+    std::vector<std::unique_ptr<StatisticsVector>> mPadStatistics; //!< accumulated pulser information per ROC and pad
 
     /// pulser data object
     struct PulserData {
@@ -156,33 +202,14 @@ class CalibPulser : public CalibRawBase
       float mQtot{0.f};
     };
 
-    /// create or return a histogram for a specific ROC
-    /// \param roc ROC
-    /// \param rocVector vector of histograms to choose from
-    /// \param nbins number of bins
-    /// \param min minimum value of the histogram
-    /// \param max maximum value of the histogram
-    TH2S* getHistogram(ROC roc, CalibPulser::PtrVectorType& rocVector,
-                       int nbins, float min, float max,
-                       std::string_view type, bool create/*=kFALSE*/);
-
-    /// return pointer to T0 histogram
-    TH2S* getHistoT0(ROC roc, Bool_t force)
-    {
-      return getHistogram(roc, mT0Histograms, mNbinsT0, mXminT0, mXmaxT0, "T0", force);
-    }
-
-    /// return pointer to Qtot histogram
-    TH2S* getHistoQtot(ROC roc, Bool_t force)
-    {
-      return getHistogram(roc, mQtotHistograms, mNbinsQtot, mXminQtot, mXmaxQtot, "Qtot", force);
-    }
+    /// return the pulser information of a ROC
+    ///
+    /// \param roc readout chamber
+    /// \param create if to create the vector if it does not exist
+    StatisticsVector* getStatistics(ROC roc, bool create = false);
 
-    /// return pointer to Q histogram
-    TH2S* getHistoSigma(ROC roc, Bool_t force)
-    {
-      return getHistogram(roc, mWidthHistograms, mNbinsWidth, mXminWidth, mXmaxWidth, "Width", force);
-    }
+    /// extract the mean T0, width and Qtot of all pads of a ROC
+    void analyseROC(ROC roc);
 
     /// process the adc values of one pad
     /// extract the T0, width, qmax and qtot
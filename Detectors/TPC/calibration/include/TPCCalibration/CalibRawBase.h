@@ -17,12 +17,14 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <thread>
 
 #include "TString.h"
 #include "Rtypes.h"
 
 #include "DataFormatsTPC/Defs.h"
 #include "TPCBase/Mapper.h"
+#include "TPCBase/Digit.h"
 
 #include "TPCReconstruction/GBTFrameContainer.h"
 #include "TPCReconstruction/RawReader.h"
@@ -55,7 +57,7 @@ class CalibRawBase
       NoReaders   ///< No raw reader configures
     };
 
-    CalibRawBase(PadSubset padSubset = PadSubset::ROC) : mMapper(Mapper::instance()), mDebugLevel(0), mNevents(0), mTimeBinsPerCall(500), mProcessedTimeBins(0), mPresentEventNumber(0), mPadSubset(padSubset), mGBTFrameContainers(), mRawReaders() {;}
+    CalibRawBase(PadSubset padSubset = PadSubset::ROC) : mMapper(Mapper::instance()), mDebugLevel(0), mNevents(0), mTimeBinsPerCall(500), mProcessedTimeBins(0), mPresentEventNumber(0), mPadSubset(padSubset), mNumberOfThreads(std::max(1u, std::thread::hardware_concurrency())), mGBTFrameContainers(), mRawReaders() {;}
 
     virtual ~CalibRawBase() = default;
 
@@ -100,6 +102,11 @@ class CalibRawBase
 
     void setupContainers(TString fileInfo);
 
+    /// Process the digits of one sector for one event, e.g. as received
+    /// by a DPL processor, instead of reading them from raw data
+    /// \param digits digits of one sector, with the row being the row in the sector
+    void processDigits(const std::vector<Digit>& digits);
+
     /// Set the debug level
     /// \param debugLevel debug level
     void setDebugLevel(int debugLevel=1) { mDebugLevel = debugLevel; }
@@ -122,6 +129,15 @@ class CalibRawBase
     /// Debug level
     int getDebugLevel() const { return mDebugLevel; }
 
+    /// Set the number of threads used to load the events of the raw readers
+    /// and to analyse the ROCs
+    /// \param nThreads number of threads, 1 does everything sequentially
+    void setNumberOfThreads(int nThreads) { mNumberOfThreads = std::max(1, nThreads); }
+
+    /// Number of threads used to load the events of the raw readers and to
+    /// analyse the ROCs
+    int getNumberOfThreads() const { return mNumberOfThreads; }
+
   protected:
     const Mapper&  mMapper;            //!< TPC mapper
     int   mDebugLevel;                 //!< debug level
@@ -133,6 +149,7 @@ class CalibRawBase
     size_t    mPresentEventNumber;     //!< present event number
 
     PadSubset mPadSubset;              //!< pad subset type used
+    int       mNumberOfThreads;        //!< number of threads used to load the events of the raw readers
     std::vector<std::unique_ptr<GBTFrameContainer>> mGBTFrameContainers; //! raw reader pointer
     std::vector<std::unique_ptr<RawReader>> mRawReaders; //! raw reader pointer
 
@@ -146,6 +163,10 @@ class CalibRawBase
     /// Process one event using RawReader
     ProcessStatus processEventRawReader(int eventNumber=-1);
 
+    /// Load the event in all raw readers, in parallel
+    /// \param eventNumber: Either number >=0 or -1 (next event) or -2 (previous event)
+    void loadRawReaderEvents(int eventNumber);
+
 };
 
 //----------------------------------------------------------------
@@ -261,28 +282,21 @@ inline CalibRawBase::ProcessStatus CalibRawBase::processEventRawReader(int event
   int processedReaders = 0;
   bool hasData = false;
 
+  // the readers are independent, so that their events can be decoded in
+  // parallel. Filling the calibration objects is done sequentially.
+  loadRawReaderEvents(eventNumber);
+
   uint64_t lastEvent = 0;
   for (auto& reader_ptr : mRawReaders) {
     auto reader = reader_ptr.get();
 
     lastEvent = std::max(lastEvent, reader->getLastEvent());
 
-    if (eventNumber>=0) {
-      reader->loadEvent(eventNumber);
-      mPresentEventNumber = eventNumber;
-    }
-    else if (eventNumber==-1) {
-      mPresentEventNumber = reader->loadNextEvent();
-    }
-    else if (eventNumber==-2) {
-      mPresentEventNumber = reader->loadPreviousEvent();
-    }
-
     o2::TPC::PadPos padPos;
-    while (std::shared_ptr<std::vector<uint16_t>> data = reader->getNextData(padPos)) {
-      if (!data) continue;
+    size_t nTimeBins = 0;
+    while (const uint16_t* data = reader->getNextData(padPos, nTimeBins)) {
 
-      mProcessedTimeBins = std::max(mProcessedTimeBins, data->size());
+      mProcessedTimeBins = std::max(mProcessedTimeBins, nTimeBins);
 
       CRU cru(reader->getRegion());
       const int roc = cru.roc();
@@ -296,7 +310,7 @@ inline CalibRawBase::ProcessStatus CalibRawBase::processEventRawReader(int event
       if (row==255 || pad==255) continue;
 
       int timeBin=0;
-      for (const auto& signalI : *data) {
+      for (const uint16_t* signalI = data; signalI != data + nTimeBins; ++signalI) {
 
         int rowOffset = 0;
         switch (mPadSubset) {
@@ -316,7 +330,7 @@ inline CalibRawBase::ProcessStatus CalibRawBase::processEventRawReader(int event
         }
 
         // modify row depending on the calibration type used
-        const float signal = float(signalI);
+        const float signal = float(*signalI);
         //const FECInfo& fecInfo = mTPCmapper.getFECInfo(PadSecPos(roc, row, pad));
         //printf("Call update: %d, %d, %d, %d (%d), %.3f -- reg: %02d -- FEC: %02d, Chip: %02d, Chn: %02d\n", roc, row, pad, timeBin, i, signal, cru.region(), fecInfo.getIndex(), fecInfo.getSampaChip(), fecInfo.getSampaChannel());
         updateCRU(cru, row, pad, timeBin, signal );
@@ -11,13 +11,21 @@
 /// \file   CalibPedestal.cxx
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
 
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
 #include "TFile.h"
 #include "TPCBase/ROC.h"
 #include "MathUtils/MathBase.h"
 #include "TPCCalibration/CalibPedestal.h"
 
 using namespace o2::TPC;
-using o2::mathUtils::mathBase::fitGaus;
+using o2::mathUtils::mathBase::fitGausBatch;
+using o2::mathUtils::mathBase::GausFitResult;
+using o2::mathUtils::mathBase::StatisticsData;
+using o2::mathUtils::mathBase::getStatisticsData;
 
 CalibPedestal::CalibPedestal(PadSubset padSubset)
   : CalibRawBase(padSubset),
@@ -26,6 +34,7 @@ CalibPedestal::CalibPedestal(PadSubset padSubset)
     mADCMin(0),
     mADCMax(120),
     mNumberOfADCs(mADCMax-mADCMin+1),
+    mStatisticsType(StatisticsType::GausFit),
     mPedestal(padSubset),
     mNoise(padSubset),
     mADCdata()
@@ -73,38 +82,144 @@ CalibPedestal::vectorType* CalibPedestal::getVector(ROC roc, bool create/*=kFALS
 //______________________________________________________________________________
 void CalibPedestal::analyse()
 {
-  ROC roc;
-
-  std::vector<float> fitValues;
+  const size_t nThreads = getNumberOfThreads();
 
-  for (auto& vecPtr : mADCdata) {
-    auto vec = vecPtr.get();
-    if (!vec) {
-      ++roc;
-      continue;
+  auto analyseROCs = [this, nThreads](size_t first) {
+    for (size_t iroc = first; iroc < mADCdata.size(); iroc += nThreads) {
+      if (mADCdata[iroc]) {
+        analyseROC(ROC(iroc));
+      }
     }
+  };
 
-    CalROC& calROCPedestal = mPedestal.getCalArray(roc);
-    CalROC& calROCNoise = mNoise.getCalArray(roc);
+  std::vector<std::future<void>> workers;
+  for (size_t thread = 1; thread < nThreads; ++thread) {
+    workers.emplace_back(std::async(std::launch::async, analyseROCs, thread));
+  }
+  analyseROCs(0);
+  for (auto& worker : workers) {
+    worker.get();
+  }
+}
 
-    float *array = vec->data();
+//______________________________________________________________________________
+void CalibPedestal::analyseROC(ROC roc)
+{
+  std::vector<GausFitResult> fitResults;
 
-    const size_t numberOfPads = (roc.rocType() == RocType::IROC) ? mMapper.getPadsInIROC() : mMapper.getPadsInOROC();
+  CalROC& calROCPedestal = mPedestal.getCalArray(roc);
+  CalROC& calROCNoise = mNoise.getCalArray(roc);
 
-    for (Int_t ichannel=0; ichannel<numberOfPads; ++ichannel) {
-      size_t offset = ichannel * mNumberOfADCs;
-      fitGaus(mNumberOfADCs, array+offset, float(mADCMin), float(mADCMax+1), fitValues);
+  const float* array = mADCdata[roc]->data();
 
-      const float pedestal = fitValues[1];
-      const float noise    = fitValues[2];
-      calROCPedestal.setValue(ichannel, pedestal);
-      calROCNoise.setValue(ichannel, noise);
+  const size_t numberOfPads = (roc.rocType() == RocType::IROC) ? mMapper.getPadsInIROC() : mMapper.getPadsInOROC();
 
-      //printf("roc: %2d, channel: %4d, pedestal: %.2f, noise: %.2f\n", roc.getRoc(), ichannel, pedestal, noise);
+  if (mStatisticsType == StatisticsType::GausFit) {
+    fitResults.resize(numberOfPads);
+    fitGausBatch(array, numberOfPads, mNumberOfADCs, double(mADCMin), double(mADCMax + 1), fitResults.data());
+  }
 
+  for (size_t ichannel = 0; ichannel < numberOfPads; ++ichannel) {
+    const float* spectrum = array + ichannel * mNumberOfADCs;
+    float pedestal = 0.f;
+    float noise = 0.f;
+    if (mStatisticsType == StatisticsType::GausFit) {
+      pedestal = fitResults[ichannel].mMean;
+      noise = fitResults[ichannel].mSigma;
+    } else {
+      // same binning as for the fit
+      const StatisticsData data = getStatisticsData(spectrum, mNumberOfADCs, double(mADCMin), double(mADCMax + 1));
+      if (data.mSum > 0) {
+        pedestal = data.mCOG;
+        noise = data.mStdDev;
+      }
     }
+    calROCPedestal.setValue(ichannel, pedestal);
+    calROCNoise.setValue(ichannel, noise);
+  }
+}
+
+//______________________________________________________________________________
+void CalibPedestal::addVector(ROC roc, const float* data, size_t size)
+{
+  vectorType& vec = *getVector(roc, kTRUE);
+  if (size != vec.size()) {
+    throw std::runtime_error("ADC data of ROC " + std::to_string(int(roc)) + " has the wrong size");
+  }
+  for (size_t i = 0; i < size; ++i) {
+    vec[i] += data[i];
+  }
+}
 
-    ++roc;
+//______________________________________________________________________________
+void CalibPedestal::merge(const CalibPedestal& other)
+{
+  if (other.mADCMin != mADCMin || other.mADCMax != mADCMax) {
+    throw std::runtime_error("Cannot merge pedestal data with different ADC ranges");
+  }
+  for (ROC roc; !roc.looped(); ++roc) {
+    if (auto vec = other.mADCdata[roc].get()) {
+      addVector(roc, vec->data(), vec->size());
+    }
+  }
+}
+
+//______________________________________________________________________________
+// The layout of the buffer is
+//   int adcMin, int adcMax
+// followed for each ROC with data by
+//   int roc, uint32_t number of values, float values[number of values]
+std::vector<char> CalibPedestal::getPartialData() const
+{
+  std::vector<char> buffer;
+  auto append = [&buffer](const void* data, size_t size) {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  };
+  const int range[2] = { mADCMin, mADCMax };
+  append(range, sizeof(range));
+  for (size_t iroc = 0; iroc < mADCdata.size(); ++iroc) {
+    auto vec = mADCdata[iroc].get();
+    if (!vec) {
+      continue;
+    }
+    const int roc = iroc;
+    const uint32_t nValues = vec->size();
+    append(&roc, sizeof(roc));
+    append(&nValues, sizeof(nValues));
+    append(vec->data(), nValues * sizeof(float));
+  }
+  return buffer;
+}
+
+//______________________________________________________________________________
+void CalibPedestal::mergePartialData(const char* data, size_t size)
+{
+  size_t pos = 0;
+  auto read = [data, size, &pos](void* target, size_t n) {
+    if (pos + n > size) {
+      throw std::runtime_error("Truncated partial pedestal data");
+    }
+    memcpy(target, data + pos, n);
+    pos += n;
+  };
+  int range[2];
+  read(range, sizeof(range));
+  if (range[0] != mADCMin || range[1] != mADCMax) {
+    throw std::runtime_error("Cannot merge pedestal data with different ADC ranges");
+  }
+  std::vector<float> values;
+  while (pos < size) {
+    int roc;
+    uint32_t nValues;
+    read(&roc, sizeof(roc));
+    read(&nValues, sizeof(nValues));
+    if (roc < 0 || roc >= ROC::MaxROC) {
+      throw std::runtime_error("Invalid ROC in partial pedestal data");
+    }
+    values.resize(nValues);
+    read(values.data(), nValues * sizeof(float));
+    addVector(ROC(roc), values.data(), nValues);
   }
 }
 
@@ -116,7 +231,7 @@ void CalibPedestal::resetData()
     if (!vec) {
       continue;
     }
-    vec->clear();
+    std::fill(vec->begin(), vec->end(), 0.f);
   }
 }
 
@@ -14,8 +14,10 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
 
-#include "TObjArray.h"
 #include "TFile.h"
 
 #include "TPCBase/ROC.h"
@@ -23,19 +25,13 @@
 #include "TPCCalibration/CalibPulser.h"
 
 using namespace o2::TPC;
-using o2::mathUtils::mathBase::StatisticsData;
-using o2::mathUtils::mathBase::getStatisticsData;
-
 CalibPulser::CalibPulser(PadSubset padSubset)
-  : mNbinsT0{200},
-    mXminT0{-2},
-    mXmaxT0{2},
-    mNbinsQtot{200},
-    mXminQtot{10},
-    mXmaxQtot{40},
-    mNbinsWidth{100},
-    mXminWidth{0.1},
-    mXmaxWidth{5.1},
+  : mMinT0{-2},
+    mMaxT0{2},
+    mMinQtot{10},
+    mMaxQtot{40},
+    mMinWidth{0.1},
+    mMaxWidth{5.1},
     mFirstTimeBin{10},
     mLastTimeBin{490},
     mADCMin{5},
@@ -50,18 +46,14 @@ CalibPulser::CalibPulser(PadSubset padSubset)
     mPedestal{nullptr},
     mNoise{nullptr},
     mPulserData{},
-    mT0Histograms{},
-    mWidthHistograms{},
-    mQtotHistograms{}
+    mPadStatistics{}
 {
-  mT0Histograms.resize(ROC::MaxROC);
-  mWidthHistograms.resize(ROC::MaxROC);
-  mQtotHistograms.resize(ROC::MaxROC);
+  mPadStatistics.resize(ROC::MaxROC);
 
   //TODO: until automatic T0 calibration is done we use the same time range
   //      as for the time bin selection
-  mXminT0 = mFirstTimeBin;
-  mXmaxT0 = mLastTimeBin;
+  mMinT0 = mFirstTimeBin;
+  mMaxT0 = mLastTimeBin;
 }
 
 //______________________________________________________________________________
@@ -109,10 +101,11 @@ void CalibPulser::endReader()
     const auto data = processPadData(padROCPos, adcData);
     //std::cout << data.mT0+mFirstTimeBin << " : " << data.mQtot << " : " << data.mWidth << "\n";
 
-    // fill histograms
-    getHistoT0   (padROCPos.getROC(), true)->Fill(data.mT0+mFirstTimeBin,    currentChannel);
-    getHistoQtot (padROCPos.getROC(), true)->Fill(data.mQtot,  currentChannel);
-    getHistoSigma(padROCPos.getROC(), true)->Fill(data.mWidth, currentChannel);
+    // accumulate the pad information
+    auto& statistics = (*getStatistics(padROCPos.getROC(), true))[currentChannel];
+    statistics.mT0.fill(data.mT0 + mFirstTimeBin, mMinT0, mMaxT0);
+    statistics.mQtot.fill(data.mQtot, mMinQtot, mMaxQtot);
+    statistics.mWidth.fill(data.mWidth, mMinWidth, mMaxWidth);
   }
 
   // reset the adc data to free space
@@ -120,20 +113,13 @@ void CalibPulser::endReader()
 }
 
 //______________________________________________________________________________
-TH2S* CalibPulser::getHistogram(ROC roc, CalibPulser::PtrVectorType& rocVector,
-                                int nbins, float min, float max,
-                                std::string_view type, bool create/*=kFALSE*/)
+CalibPulser::StatisticsVector* CalibPulser::getStatistics(ROC roc, bool create /*=false*/)
 {
-  TH2S* vec = rocVector[roc].get();
+  StatisticsVector* vec = mPadStatistics[roc].get();
   if (vec || !create) return vec;
 
-  const size_t nChannels = mMapper.getNumberOfPads(roc);
-  rocVector[roc] = std::make_unique<TH2S>(Form("hCalib%s%02d",type.data(),roc.getRoc()),
-                                          Form("%s calibration histogram ROC %02d",type.data(),roc.getRoc()),
-                                          nbins, min, max,
-                                          nChannels, 0, nChannels);
-  //printf("new histogram %s for ROC %2d\n", type.data(), int(roc));
-  return rocVector[roc].get();
+  mPadStatistics[roc] = std::make_unique<StatisticsVector>(mMapper.getNumberOfPads(roc));
+  return mPadStatistics[roc].get();
 }
 
 //______________________________________________________________________________
@@ -175,11 +161,9 @@ void CalibPulser::resetData()
 {
   mPulserData.clear();
 
-  std::vector<PtrVectorType*> v{&mT0Histograms, &mWidthHistograms, &mQtotHistograms};
-  for (auto histArray : v) {
-    for (auto& histPtr : *histArray) {
-      auto ptr = histPtr.get();
-      if (ptr) ptr->Reset();
+  for (auto& vec : mPadStatistics) {
+    if (vec) {
+      std::fill(vec->begin(), vec->end(), PadStatistics{});
     }
   }
 }
@@ -187,31 +171,114 @@ void CalibPulser::resetData()
 //______________________________________________________________________________
 void CalibPulser::analyse()
 {
-  for (ROC roc; !roc.looped(); ++roc) {
-    auto histT0    = mT0Histograms.at(roc).get();
-    auto histWidth = mWidthHistograms.at(roc).get();
-    auto histQtot  = mQtotHistograms.at(roc).get();
-
-    if (!histT0 || !histWidth || !histQtot) continue;
-
-    // array pointer
-    const auto arrT0    = histT0   ->GetArray();
-    const auto arrWidth = histWidth->GetArray();
-    const auto arrQtot  = histQtot ->GetArray();
-
-    const auto numberOfPads = mMapper.getNumberOfPads(roc);
-    for (auto iChannel=0; iChannel<numberOfPads; ++iChannel) {
-      const int offsetT0   = (mNbinsT0   +2)*(iChannel+1)+1;
-      const int offsetQtot = (mNbinsQtot +2)*(iChannel+1)+1;
-      const int offsetWidth= (mNbinsWidth+2)*(iChannel+1)+1;
-
-      StatisticsData dataT0    = getStatisticsData(arrT0    + offsetT0,    mNbinsT0,    mXminT0,    mXmaxT0);
-      StatisticsData dataWidth = getStatisticsData(arrWidth + offsetWidth, mNbinsWidth, mXminWidth, mXmaxWidth);
-      StatisticsData dataQtot  = getStatisticsData(arrQtot  + offsetQtot,  mNbinsQtot,  mXminQtot,  mXmaxQtot);
-
-      mT0.   getCalArray(roc).setValue(iChannel, dataT0.mCOG);
-      mWidth.getCalArray(roc).setValue(iChannel, dataWidth.mCOG);
-      mQtot. getCalArray(roc).setValue(iChannel, dataQtot.mCOG);
+  // the ROCs are independent, so they are analysed in parallel
+  const size_t nThreads = getNumberOfThreads();
+  auto analyseROCs = [this, nThreads](size_t first) {
+    for (size_t iroc = first; iroc < mPadStatistics.size(); iroc += nThreads) {
+      if (mPadStatistics[iroc]) {
+        analyseROC(ROC(iroc));
+      }
+    }
+  };
+
+  std::vector<std::future<void>> workers;
+  for (size_t thread = 1; thread < nThreads; ++thread) {
+    workers.emplace_back(std::async(std::launch::async, analyseROCs, thread));
+  }
+  analyseROCs(0);
+  for (auto& worker : workers) {
+    worker.get();
+  }
+}
+
+//______________________________________________________________________________
+void CalibPulser::analyseROC(ROC roc)
+{
+  const auto& statistics = *mPadStatistics[roc];
+  auto& calROCT0 = mT0.getCalArray(roc);
+  auto& calROCWidth = mWidth.getCalArray(roc);
+  auto& calROCQtot = mQtot.getCalArray(roc);
+
+  // in case there is no data, the lower limit is used
+  for (size_t iChannel = 0; iChannel < statistics.size(); ++iChannel) {
+    const auto& pad = statistics[iChannel];
+    calROCT0.setValue(iChannel, pad.mT0.getMean(mMinT0));
+    calROCWidth.setValue(iChannel, pad.mWidth.getMean(mMinWidth));
+    calROCQtot.setValue(iChannel, pad.mQtot.getMean(mMinQtot));
+  }
+}
+
+//______________________________________________________________________________
+void CalibPulser::merge(const CalibPulser& other)
+{
+  const std::vector<char> partial = other.getPartialData();
+  mergePartialData(partial.data(), partial.size());
+}
+
+//______________________________________________________________________________
+// The layout of the buffer is
+//   float ranges[6] (T0, width and Qtot minimum and maximum)
+// followed for each ROC with data by
+//   int roc, uint32_t number of pads, PadStatistics statistics[number of pads]
+std::vector<char> CalibPulser::getPartialData() const
+{
+  std::vector<char> buffer;
+  auto append = [&buffer](const void* data, size_t size) {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  };
+  const float ranges[6] = { mMinT0, mMaxT0, mMinWidth, mMaxWidth, mMinQtot, mMaxQtot };
+  append(ranges, sizeof(ranges));
+  for (size_t iroc = 0; iroc < mPadStatistics.size(); ++iroc) {
+    auto vec = mPadStatistics[iroc].get();
+    if (!vec) {
+      continue;
+    }
+    const int roc = iroc;
+    const uint32_t nPads = vec->size();
+    append(&roc, sizeof(roc));
+    append(&nPads, sizeof(nPads));
+    append(vec->data(), nPads * sizeof(PadStatistics));
+  }
+  return buffer;
+}
+
+//______________________________________________________________________________
+void CalibPulser::mergePartialData(const char* data, size_t size)
+{
+  size_t pos = 0;
+  auto read = [data, size, &pos](void* target, size_t n) {
+    if (pos + n > size) {
+      throw std::runtime_error("Truncated partial pulser data");
+    }
+    memcpy(target, data + pos, n);
+    pos += n;
+  };
+  float ranges[6];
+  read(ranges, sizeof(ranges));
+  const float ownRanges[6] = { mMinT0, mMaxT0, mMinWidth, mMaxWidth, mMinQtot, mMaxQtot };
+  if (memcmp(ranges, ownRanges, sizeof(ranges)) != 0) {
+    throw std::runtime_error("Cannot merge pulser data with different value ranges");
+  }
+  StatisticsVector statistics;
+  while (pos < size) {
+    int roc;
+    uint32_t nPads;
+    read(&roc, sizeof(roc));
+    read(&nPads, sizeof(nPads));
+    if (roc < 0 || roc >= ROC::MaxROC) {
+      throw std::runtime_error("Invalid ROC in partial pulser data");
+    }
+    auto& vec = *getStatistics(ROC(roc), true);
+    if (nPads != vec.size()) {
+      throw std::runtime_error("Pulser data of ROC " + std::to_string(roc) + " has the wrong size");
+    }
+    statistics.resize(nPads);
+    read(statistics.data(), nPads * sizeof(PadStatistics));
+    for (size_t iPad = 0; iPad < nPads; ++iPad) {
+      vec[iPad].mT0.merge(statistics[iPad].mT0);
+      vec[iPad].mWidth.merge(statistics[iPad].mWidth);
+      vec[iPad].mQtot.merge(statistics[iPad].mQtot);
     }
   }
 }
@@ -226,17 +293,22 @@ void CalibPulser::dumpToFile(const std::string filename)
 
   if (mDebugLevel) {
     printf("dump debug info\n");
-    // temporary arrays for writing the objects
-    TObjArray vT0;
-    for (auto& val : mT0Histograms) vT0.Add(val.get());
-    TObjArray vWidth;
-    for (auto& val : mWidthHistograms) vWidth.Add(val.get());
-    TObjArray vQtot;
-    for (auto& val : mQtotHistograms) vQtot.Add(val.get());
-
-    vT0.Write("T0Histograms", TObject::kSingleKey);
-    vWidth.Write("WidthHistograms", TObject::kSingleKey);
-    vQtot.Write("QtotHistograms", TObject::kSingleKey);
+    // number of accepted pulses per pad
+    CalPad entriesT0{ "PulserEntriesT0" };
+    CalPad entriesWidth{ "PulserEntriesWidth" };
+    CalPad entriesQtot{ "PulserEntriesQtot" };
+    for (ROC roc; !roc.looped(); ++roc) {
+      auto vec = mPadStatistics[roc].get();
+      if (!vec) continue;
+      for (size_t iChannel = 0; iChannel < vec->size(); ++iChannel) {
+        entriesT0.getCalArray(roc).setValue(iChannel, (*vec)[iChannel].mT0.mEntries);
+        entriesWidth.getCalArray(roc).setValue(iChannel, (*vec)[iChannel].mWidth.mEntries);
+        entriesQtot.getCalArray(roc).setValue(iChannel, (*vec)[iChannel].mQtot.mEntries);
+      }
+    }
+    f->WriteObject(&entriesT0, "EntriesT0");
+    f->WriteObject(&entriesWidth, "EntriesWidth");
+    f->WriteObject(&entriesQtot, "EntriesQtot");
   }
 
   f->Close();
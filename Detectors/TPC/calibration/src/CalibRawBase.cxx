@@ -11,6 +11,8 @@
 /// \file   CalibRawBase.cxx
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
 
+#include <future>
+
 #include "TObjString.h"
 #include "TObjArray.h"
 
@@ -89,9 +91,83 @@ void CalibRawBase::setupContainers(TString fileInfo)
   delete arrData;
 }
 
+void CalibRawBase::loadRawReaderEvents(int eventNumber)
+{
+  const size_t nThreads = std::min(size_t(mNumberOfThreads), mRawReaders.size());
+  std::vector<size_t> loadedEvents(mRawReaders.size(), mPresentEventNumber);
+
+  auto loadEvents = [this, eventNumber, nThreads, &loadedEvents](size_t first) {
+    for (size_t i = first; i < mRawReaders.size(); i += nThreads) {
+      auto reader = mRawReaders[i].get();
+      if (eventNumber >= 0) {
+        reader->loadEvent(eventNumber);
+        loadedEvents[i] = eventNumber;
+      } else if (eventNumber == -1) {
+        loadedEvents[i] = reader->loadNextEvent();
+      } else if (eventNumber == -2) {
+        loadedEvents[i] = reader->loadPreviousEvent();
+      }
+    }
+  };
+
+  std::vector<std::future<void>> workers;
+  for (size_t thread = 1; thread < nThreads; ++thread) {
+    workers.emplace_back(std::async(std::launch::async, loadEvents, thread));
+  }
+  loadEvents(0);
+  for (auto& worker : workers) {
+    worker.get();
+  }
+
+  if (!loadedEvents.empty()) {
+    mPresentEventNumber = loadedEvents.back();
+  }
+}
+
 void CalibRawBase::rewindEvents()
 {
   for (auto& c : mGBTFrameContainers) {
     c.get()->reProcessAllFrames();
   }
 }
+
+void CalibRawBase::processDigits(const std::vector<Digit>& digits)
+{
+  resetEvent();
+  const int nRowIROC = mMapper.getNumberOfRowsROC(0);
+
+  for (auto& digi : digits) {
+    CRU cru(digi.getCRU());
+    const int roc = cru.roc();
+    const PadRegionInfo& regionInfo = mMapper.getPadRegionInfo(cru.region());
+    const PartitionInfo& partInfo = mMapper.getPartitionInfo(cru.partition());
+
+    // the digit row is the global row in the sector
+    const int row = digi.getRow();
+    const int pad = digi.getPad();
+    int rowInSubset = row;
+    switch (mPadSubset) {
+      case PadSubset::ROC: {
+        rowInSubset -= (cru.rocType() == RocType::OROC) * nRowIROC;
+        break;
+      }
+      case PadSubset::Region: {
+        rowInSubset -= regionInfo.getGlobalRowOffset();
+        break;
+      }
+      case PadSubset::Partition: {
+        rowInSubset -= partInfo.getGlobalRowOffset();
+        break;
+      }
+    }
+
+    const int timeBin = digi.getTimeStamp();
+    const float signal = digi.getChargeFloat();
+    updateCRU(cru, row - regionInfo.getGlobalRowOffset(), pad, timeBin, signal);
+    updateROC(roc, rowInSubset, pad, timeBin, signal);
+  }
+
+  endReader();
+  endEvent();
+  ++mNevents;
+}
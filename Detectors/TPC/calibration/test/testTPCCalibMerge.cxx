@@ -0,0 +1,137 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test TPC merging of partial calibrations
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "TPCBase/Digit.h"
+#include "TPCBase/Mapper.h"
+#include "TPCCalibration/CalibPedestal.h"
+#include "TPCCalibration/CalibPulser.h"
+
+namespace o2
+{
+namespace TPC
+{
+
+/// digits of one sector on a few pads of the first IROC and OROC region
+/// \param signal function returning the ADC value for a given time bin
+template <typename F>
+std::vector<Digit> makeDigits(int sector, int firstTimeBin, int lastTimeBin, F signal)
+{
+  const auto& mapper = Mapper::instance();
+  std::vector<Digit> digits;
+  for (int region : { 0, 4 }) {
+    const int cru = sector * CRU::CRUperSector + region;
+    const int rowOffset = mapper.getPadRegionInfo(region).getGlobalRowOffset();
+    for (int row = rowOffset; row < rowOffset + 2; ++row) {
+      for (int pad = 0; pad < 10; ++pad) {
+        for (int timeBin = firstTimeBin; timeBin <= lastTimeBin; ++timeBin) {
+          digits.emplace_back(cru, signal(timeBin), row, pad, timeBin);
+        }
+      }
+    }
+  }
+  return digits;
+}
+
+BOOST_AUTO_TEST_CASE(CalibPedestal_merge)
+{
+  std::mt19937 generator(1);
+  std::normal_distribution<float> noise(50.f, 2.f);
+  auto signal = [&noise, &generator](int) { return std::round(noise(generator)); };
+
+  CalibPedestal all;
+  CalibPedestal lanes[2];
+  CalibPedestal merged;
+  all.setStatisticsType(CalibPedestal::StatisticsType::MeanStdDev);
+  merged.setStatisticsType(CalibPedestal::StatisticsType::MeanStdDev);
+  merged.setNumberOfThreads(4);
+
+  for (int event = 0; event < 10; ++event) {
+    for (int sector = 0; sector < 4; ++sector) {
+      const auto digits = makeDigits(sector, 0, 100, signal);
+      all.processDigits(digits);
+      lanes[sector % 2].processDigits(digits);
+    }
+  }
+  for (auto& lane : lanes) {
+    const auto partial = lane.getPartialData();
+    merged.mergePartialData(partial.data(), partial.size());
+  }
+  all.analyse();
+  merged.analyse();
+
+  for (ROC roc; !roc.looped(); ++roc) {
+    const auto& pedestal = merged.getPedestal().getCalArray(roc);
+    const auto& expected = all.getPedestal().getCalArray(roc);
+    for (size_t channel = 0; channel < pedestal.getData().size(); ++channel) {
+      BOOST_CHECK_EQUAL(pedestal.getValue(channel), expected.getValue(channel));
+      BOOST_CHECK_EQUAL(merged.getNoise().getCalArray(roc).getValue(channel), all.getNoise().getCalArray(roc).getValue(channel));
+    }
+  }
+  // +0.5 is the bin centre
+  BOOST_CHECK_CLOSE(merged.getPedestal().getCalArray(ROC(1)).getValue(0), 50.5f, 1.f);
+  BOOST_CHECK_CLOSE(merged.getNoise().getCalArray(ROC(37)).getValue(0), 2.f, 20.f);
+
+  CalibPedestal otherRange;
+  otherRange.setADCRange(0, 10);
+  const auto partial = lanes[0].getPartialData();
+  BOOST_CHECK_THROW(otherRange.mergePartialData(partial.data(), partial.size()), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(CalibPulser_merge)
+{
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> time(100, 110);
+
+  CalibPulser all;
+  CalibPulser lanes[2];
+  CalibPulser merged;
+  all.setQtotRange(10, 1000);
+  merged.setQtotRange(10, 1000);
+  merged.setNumberOfThreads(4);
+  for (auto& lane : lanes) {
+    lane.setQtotRange(10, 1000);
+  }
+
+  for (int event = 0; event < 10; ++event) {
+    for (int sector = 0; sector < 4; ++sector) {
+      const int t0 = time(generator);
+      const auto digits = makeDigits(sector, t0 - 5, t0 + 5, [t0](int timeBin) { return std::max(0, 100 - 20 * std::abs(timeBin - t0)); });
+      all.processDigits(digits);
+      lanes[sector % 2].processDigits(digits);
+    }
+  }
+  for (auto& lane : lanes) {
+    merged.merge(lane);
+  }
+  all.analyse();
+  merged.analyse();
+
+  for (ROC roc; !roc.looped(); ++roc) {
+    for (size_t channel = 0; channel < merged.getT0().getCalArray(roc).getData().size(); ++channel) {
+      BOOST_CHECK_CLOSE(merged.getT0().getCalArray(roc).getValue(channel), all.getT0().getCalArray(roc).getValue(channel), 1e-4);
+      BOOST_CHECK_CLOSE(merged.getWidth().getCalArray(roc).getValue(channel), all.getWidth().getCalArray(roc).getValue(channel), 1e-4);
+      BOOST_CHECK_CLOSE(merged.getQtot().getCalArray(roc).getValue(channel), all.getQtot().getCalArray(roc).getValue(channel), 1e-4);
+    }
+  }
+  // 100 + 2 * 80 + 2 * 60 within the integration window
+  BOOST_CHECK_CLOSE(merged.getQtot().getCalArray(ROC(0)).getValue(0), 380.f, 1e-4);
+}
+
+} // namespace TPC
+} // namespace o2
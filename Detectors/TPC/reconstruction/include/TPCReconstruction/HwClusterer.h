@@ -87,6 +87,17 @@ class HwClusterer : public Clusterer
   void finishProcess(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth) override;
   void finishProcess(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth, bool clearContainerFirst);
 
+  /// Process a range of digits of this sector, taken out of a larger digit stream
+  /// \param first Pointer to the first digit of the range
+  /// \param last Pointer behind the last digit of the range
+  /// \param mcDigitTruth MC Digit Truth container of the whole stream, it is shared as long as digits of it are buffered
+  /// \param firstDigitIndex Index of the first digit of the range in mcDigitTruth
+  /// \param clearContainerFirst Clears the outpcontainer for clusters and MC labels first, before processing
+  void process(Digit const* first, Digit const* last, std::shared_ptr<MCLabelContainer const> const& mcDigitTruth, int firstDigitIndex, bool clearContainerFirst);
+
+  /// Finish processing a range of digits of this sector, see process
+  void finishProcess(Digit const* first, Digit const* last, std::shared_ptr<MCLabelContainer const> const& mcDigitTruth, int firstDigitIndex, bool clearContainerFirst);
+
   /// Switch for triggered / continuous readout
   /// \param isContinuous - false for triggered readout, true for continuous readout
   void setContinuousReadout(bool isContinuous);
@@ -150,7 +161,7 @@ class HwClusterer : public Clusterer
   /// \param sigmaPad2      Weighted sigma pad ^2 parameter
   /// \param sigmaTime2     Weighted sigma time ^2 parameter
   /// \param mcLabel        Vector with MClabel-counter-pairs
-  void updateCluster(const Vc::uint_m selectionMask, int row, short centerPad, int centerTime, short dp, short dt, Vc::uint_v& qTot, Vc::int_v& pad, Vc::int_v& time, Vc::int_v& sigmaPad2, Vc::int_v& sigmaTime2, std::vector<std::unique_ptr<std::vector<std::pair<MCCompLabel, unsigned>>>>& mcLabels, Vc::uint_m splitMask = Vc::Mask<uint>(false));
+  void updateCluster(const Vc::uint_m selectionMask, int row, short centerPad, int centerTime, short dp, short dt, Vc::uint_v& qTot, Vc::int_v& pad, Vc::int_v& time, Vc::int_v& sigmaPad2, Vc::int_v& sigmaTime2, std::vector<std::vector<std::pair<MCCompLabel, unsigned>>>& mcLabels, Vc::uint_m splitMask = Vc::Mask<uint>(false));
 
   /// Writes clusters from temporary storage to cluster output
   /// \param timeOffset   Time offset of cluster container
@@ -172,10 +183,6 @@ class HwClusterer : public Clusterer
   /// \param timebin  Timebin to be cleared
   void clearBuffer(int timebin);
 
-  /// Returns least significant set bit of mCurrentMcContainerInBuffer, only the mTimebinsInBuffer LSBs are checked
-  /// \return LSB index which is set
-  short getFirstSetBitOfField();
-
   /// Maps the given time into the available range of the stored buffer
   /// \param time   time to be maped
   /// \return (mTimebinsInBuffer + (time % mTimebinsInBuffer)) % mTimebinsInBuffer which is always in range [0, mTimebinsInBuffer-1] even if time < 0
@@ -192,7 +199,6 @@ class HwClusterer : public Clusterer
 
   unsigned short mNumRows;               ///< Number of rows in this sector
   unsigned short mNumRowSets;            ///< Number of row sets (Number of rows / Vc::Size) in this sector
-  short mCurrentMcContainerInBuffer;     ///< Bit field, where to find the current MC container in buffer
   short mSplittingMode;                  ///< Cluster splitting mode, 0 no splitting, 1 for minimum contributes half to both, 2 for miminum corresponds to left/older cluster
   int mClusterSector;                    ///< Sector to be processed
   int mLastTimebin;                      ///< Last time bin of previous event
@@ -215,6 +221,7 @@ class HwClusterer : public Clusterer
   std::vector<std::vector<Vc::int_v>> mIndexBuffer;              ///< Buffer with digits indices for MC labels
   std::vector<std::shared_ptr<MCLabelContainer const>> mMCtruth; ///< MC truth information of timebins in buffer
 
+  std::vector<std::vector<std::pair<MCCompLabel, unsigned>>> mTmpMcLabels;                                 ///< MC labels of the clusters in the current row set, reused for each peak
   std::vector<std::unique_ptr<std::vector<ClusterHardware>>> mTmpClusterArray;                             ///< Temporary cluster storage for each region to accumulate cluster before filling output container
   std::vector<std::unique_ptr<std::vector<std::vector<std::pair<MCCompLabel, unsigned>>>>> mTmpLabelArray; ///< Temporary cluster storage for each region to accumulate cluster before filling output container
 
@@ -278,15 +285,6 @@ inline Vc::uint_v HwClusterer::getFpOfADC(const Vc::uint_v value)
   return value & 0x3FFF;
 }
 
-inline short HwClusterer::getFirstSetBitOfField()
-{
-  for (short i = 0; i < mTimebinsInBuffer; ++i) {
-    if ((mCurrentMcContainerInBuffer >> i) & 0x1)
-      return i;
-  }
-  return -1;
-}
-
 }
 }
 
@@ -0,0 +1,126 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file HwClustererDriver.h
+/// \brief Runs the TPC HW cluster finder of all sectors in parallel
+
+#ifndef ALICEO2_TPC_HWClustererDriver_H_
+#define ALICEO2_TPC_HWClustererDriver_H_
+
+#include "TPCReconstruction/Clusterer.h"
+#include "TPCReconstruction/HwClusterer.h"
+#include "TPCBase/Sector.h"
+#include "DataFormatsTPC/Helpers.h"
+
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include "SimulationDataFormat/MCCompLabel.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace o2
+{
+namespace TPC
+{
+
+class Digit;
+
+/// \class HwClustererDriver
+/// \brief Runs one HwClusterer per sector on a single digit stream
+///
+/// The digits of all sectors are given in one container, sorted by sector
+/// and, within a sector, by time. Each sector is clusterized by its own
+/// HwClusterer into its own cluster and label containers, the sectors being
+/// distributed over setNumberOfThreads() threads. The results are then copied
+/// into the common output in sector order, each sector into its own range,
+/// so the output is identical to processing the sectors one after the other.
+class HwClustererDriver : public Clusterer
+{
+ public:
+  /// Constructor
+  /// \param clusterOutput is pointer to vector to be filled with ClusterHardwareContainers of all sectors
+  /// \param labelOutput is pointer to storage to be filled with MC labels
+  HwClustererDriver(std::vector<ClusterHardwareContainer8kb>* clusterOutput, MCLabelContainer* labelOutput = nullptr);
+
+  /// Destructor
+  ~HwClustererDriver() override = default;
+
+  /// The sector clusterers point to the containers of this instance
+  HwClustererDriver(HwClustererDriver const& other) = delete;
+  HwClustererDriver& operator=(HwClustererDriver const& other) = delete;
+
+  /// Process digits
+  /// \param digits Container with TPC digits of all sectors, sorted by sector and time
+  /// \param mcDigitTruth MC Digit Truth container
+  void process(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth) override;
+
+  /// Finish processing digits, the remaining timebins of all sectors are clusterized
+  /// \param digits Container with TPC digits of all sectors, sorted by sector and time
+  /// \param mcDigitTruth MC Digit Truth container
+  void finishProcess(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth) override;
+
+  /// Set the number of threads processing the sectors
+  /// \param nThreads Number of threads, 1 processes everything in the calling thread
+  void setNumberOfThreads(int nThreads) { mNThreads = std::max(1, std::min(nThreads, int(Sector::MAXSECTOR))); }
+  int getNumberOfThreads() const { return mNThreads; }
+
+  /// Settings of the sector clusterers, see HwClusterer, they are applied with the next call of process
+  void setContinuousReadout(bool isContinuous) { mIsContinuousReadout = isContinuous; }
+  void setPeakChargeThreshold(unsigned charge) { mPeakChargeThreshold = charge; }
+  void setContributionChargeThreshold(unsigned charge) { mContributionChargeThreshold = charge; }
+  void setRejectSinglePadClusters(bool doReject) { mRejectSinglePadClusters = doReject; }
+  void setRejectSingleTimeClusters(bool doReject) { mRejectSingleTimeClusters = doReject; }
+  void setRejectLaterTimebin(bool doReject) { mRejectLaterTimebin = doReject; }
+  void setSplittingMode(short mode) { mSplittingMode = mode; }
+
+ private:
+  /// Clusterer and output of one sector
+  struct SectorData {
+    std::unique_ptr<HwClusterer> clusterer;            ///< Clusterer of this sector, created with the first digits
+    std::vector<ClusterHardwareContainer8kb> clusters; ///< Cluster containers of the last call
+    MCLabelContainer labels;                           ///< MC labels of the clusters of the last call
+    size_t firstDigit = 0;                             ///< Index of the first digit of this sector in the stream
+    size_t lastDigit = 0;                              ///< Index behind the last digit of this sector in the stream
+    size_t firstContainer = 0;                         ///< Index of the first cluster container in the output
+  };
+
+  /// Clusterizes the digits of all sectors and merges the output
+  /// \param finish Also clusterize the remaining timebins of all sectors
+  void run(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth, bool finish);
+
+  /// Calls work for the indices [0, n) on up to mNThreads threads
+  void runParallel(size_t n, std::function<void(size_t)> const& work) const;
+
+  /// Apply the current settings to a sector clusterer
+  void configure(HwClusterer& clusterer);
+
+  int mNThreads;                         ///< Number of threads processing the sectors
+  bool mIsContinuousReadout;             ///< Switch for continuous readout
+  bool mRejectSinglePadClusters;         ///< Switch to reject single pad clusters
+  bool mRejectSingleTimeClusters;        ///< Switch to reject single time clusters
+  bool mRejectLaterTimebin;              ///< Switch to reject peaks in later timebins of the same pad
+  short mSplittingMode;                  ///< Cluster splitting mode
+  unsigned mPeakChargeThreshold;         ///< Charge threshold for the central peak in ADC counts
+  unsigned mContributionChargeThreshold; ///< Charge threshold for the contributing pads in ADC counts
+
+  std::array<SectorData, Sector::MAXSECTOR> mSectors; ///< Clusterers and outputs of all sectors
+  std::vector<int> mActiveSectors;                    ///< Sectors processed in the current call
+
+  std::vector<ClusterHardwareContainer8kb>* mClusterArray; ///< Pointer to output cluster container
+  MCLabelContainer* mClusterMcLabelArray;                  ///< Pointer to MC Label container
+};
+
+}
+}
+
+#endif
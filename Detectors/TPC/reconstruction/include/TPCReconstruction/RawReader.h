@@ -14,12 +14,14 @@
 /// \file RawReader.h
 /// \author Sebastian Klewin (Sebastian.Klewin@cern.ch)
 
+#include <array>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
 #include <utility>
 #include <tuple>
+#include <algorithm>
 
 #include "TPCBase/PadPos.h"
 #include "TPCBase/CalDet.h"
@@ -30,10 +32,20 @@ namespace TPC {
 
 /// \class RawReader
 /// \brief Reader for RAW TPC data
+///
+/// The ADC values of the loaded event are stored in a flat array with one
+/// row of time bins per pad, the rows being sorted by global pad number.
+/// When decoding GBT frames, the half words of all frames are extracted
+/// first, then the five half SAMPA streams are decoded independently,
+/// optionally in parallel (see setNumberOfThreads()).
 /// \author Sebastian Klewin (Sebastian.Klewin@cern.ch)
 class RawReader {
   public:
 
+    static constexpr int NumberOfHalfSampas = 5;    ///< half SAMPAs read out by one link
+    static constexpr int ChannelsPerHalfSampa = 16; ///< channels per half SAMPA
+    static constexpr int NumberOfChannels = NumberOfHalfSampas * ChannelsPerHalfSampa;
+
     /// Data header struct
     struct Header {
       uint16_t dataType;        ///< readout mode, 1: GBT frames, 2: decoded data, 3: both
@@ -162,6 +174,13 @@ class RawReader {
     /// @return shared pointer to data vector, each element is one time bin
     std::shared_ptr<std::vector<uint16_t>> getNextData(PadPos& padPos);
 
+    /// Get data of next pad position, without copying it
+    /// @param padPos local pad position (row starts with 0 in each region)
+    /// @param nTimeBins number of time bins of the pad
+    /// @return pointer to the first time bin, nullptr after the last pad.
+    ///         It is valid until the next event is loaded.
+    const uint16_t* getNextData(PadPos& padPos, size_t& nTimeBins);
+
     int getRegion() const { return mRegion; };
     int getLink() const { return mLink; };
     int getEventNumber() const { return mLastEvent; };
@@ -186,6 +205,11 @@ class RawReader {
     /// Set the SAMPA version
     /// @param sampaVersion Version to be set
     void setSampaVersion(int sampaVerson) { mSampaVersion = sampaVerson; };
+
+    /// Set the number of threads used to decode the half SAMPA streams of one event
+    /// @param nThreads Number of threads, 1 decodes everything in the calling thread
+    void setNumberOfThreads(int nThreads) { mNThreads = std::max(1, std::min(nThreads, NumberOfHalfSampas)); };
+
     /// Returns some information about the event, e.g. the header
     /// @param event Event number
     /// @return shared pointer to vector with event informations
@@ -204,6 +228,16 @@ class RawReader {
     bool decodeRawGBTFrames(EventInfo eventInfo);
     bool decodePreprocessedData(EventInfo eventInfo);
 
+    /// Computes the pad of each channel and the data row it is stored in
+    void setupChannelMapping();
+
+    /// Drops the data of the previous event and makes room for @a timeBins time bins per pad
+    void resetData(size_t timeBins);
+
+    /// Stores the ADC values of one time bin of half SAMPA @a halfSampa.
+    /// Time bins beyond mTimeBinsCapacity are dropped and counted in mDroppedTimeBins.
+    void addTimeBin(int halfSampa, const uint16_t* adcValues);
+
     bool mUseRawInMode3;                ///< in readout mode 3 decode GBT frames
     bool mApplyChannelMask;             ///< apply channel mask
     bool mCheckAdcClock;                ///< check the ADC clock
@@ -211,11 +245,19 @@ class RawReader {
     int mLink;                          ///< FEC of the data
     int mRun;                           ///< Run number
     int mSampaVersion;                  ///< Version of SAMPA chip
+    int mNThreads;                      ///< Number of threads used to decode the half SAMPA streams
     int64_t mLastEvent;                 ///< Number of last loaded event
     std::array<uint64_t,5> mTimestampOfFirstData;   ///< Time stamp of first decoded ADC value, individually for each half SAMPA
     std::map<uint64_t, std::shared_ptr<std::vector<EventInfo>>> mEvents;                ///< all "event data" - headers, file path, etc. NOT actual data
-    std::map<PadPos,std::shared_ptr<std::vector<uint16_t>>> mData;                      ///< ADC values of last loaded Event
-    std::map<PadPos,std::shared_ptr<std::vector<uint16_t>>>::iterator mDataIterator;    ///< Iterator to last requested data
+    std::vector<uint16_t> mData;                                                        ///< ADC values of last loaded Event, mTimeBinsCapacity per pad
+    size_t mTimeBinsCapacity;                                                           ///< Maximum number of time bins per pad in mData
+    std::array<size_t,NumberOfChannels> mTimeBins;                                      ///< Number of time bins stored for each row of mData
+    std::array<size_t,NumberOfHalfSampas> mDroppedTimeBins;                             ///< Time bins of each half SAMPA which did not fit in mData
+    std::array<PadPos,NumberOfChannels> mPadPos;                                        ///< Pad of each row of mData, sorted by global pad number
+    std::array<short,NumberOfChannels> mChannelRow;                                     ///< Row of mData of each channel (half SAMPA * 16 + channel)
+    bool mChannelMappingDone;                                                           ///< mPadPos and mChannelRow are filled
+    std::array<bool,NumberOfChannels> mRowMasked;                                       ///< Rows of mData masked by the channel mask
+    size_t mDataIterator;                                                               ///< Row of last requested data
     std::array<short,5> mSyncPos;                                                       ///< positions of the sync pattern (for readout mode 3)
 
     std::shared_ptr<CalDet<bool>> mChannelMask;                                         ///< Channel mask
@@ -236,21 +278,33 @@ std::shared_ptr<std::vector<RawReader::EventInfo>> RawReader::getEventInfo(uint6
 
 inline
 std::shared_ptr<std::vector<uint16_t>> RawReader::getData(const PadPos& padPos) {
-  mDataIterator = mData.find(padPos);
-  if (mDataIterator == mData.end()) {
+  mDataIterator = std::find(mPadPos.begin(), mPadPos.end(), padPos) - mPadPos.begin();
+  if (mDataIterator == NumberOfChannels || mTimeBins[mDataIterator] == 0) {
+    mDataIterator = NumberOfChannels;
     std::shared_ptr<std::vector<uint16_t>> emptyVecPtr(new std::vector<uint16_t>);
     return emptyVecPtr;
   }
-  return mDataIterator->second;
+  auto first = mData.begin() + mDataIterator * mTimeBinsCapacity;
+  return std::make_shared<std::vector<uint16_t>>(first, first + mTimeBins[mDataIterator]);
+};
+
+inline
+const uint16_t* RawReader::getNextData(PadPos& padPos, size_t& nTimeBins) {
+  // pads without data, e.g. masked ones, are skipped
+  while (mDataIterator < NumberOfChannels && mTimeBins[mDataIterator] == 0) ++mDataIterator;
+  if (mDataIterator >= NumberOfChannels) return nullptr;
+  const size_t row = mDataIterator++;
+  padPos = mPadPos[row];
+  nTimeBins = mTimeBins[row];
+  return mData.data() + row * mTimeBinsCapacity;
 };
 
 inline
 std::shared_ptr<std::vector<uint16_t>> RawReader::getNextData(PadPos& padPos) {
-  if (mDataIterator == mData.end()) return nullptr;
-  std::map<PadPos,std::shared_ptr<std::vector<uint16_t>>>::iterator last = mDataIterator;
-  mDataIterator++;
-  padPos = last->first;
-  return last->second;
+  size_t nTimeBins = 0;
+  const uint16_t* data = getNextData(padPos, nTimeBins);
+  if (data == nullptr) return nullptr;
+  return std::make_shared<std::vector<uint16_t>>(data, data + nTimeBins);
 };
 
 inline
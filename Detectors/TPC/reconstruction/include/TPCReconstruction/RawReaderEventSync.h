@@ -53,10 +53,11 @@ class RawReaderEventSync {
     /// \param time Offset
     void addEventOffset(int event, long time);
 
-    /// Returns the event ofset for a given link
+    /// Returns the event ofset for a given link. Does not modify the
+    /// synchronizer, so that it can be shared by readers decoding in parallel
     /// \param event Event number
-    /// \return Event offset
-    long getEventOffset(int event) { return mMaxOffset[event]; };
+    /// \return Event offset, 0 for unknown events
+    long getEventOffset(int event) const;
 
   private:
 
@@ -64,6 +65,12 @@ class RawReaderEventSync {
     std::map<int, long> mMaxOffset;     ///< maximum offset for each event, to be used by all links
 };
 
+inline
+long RawReaderEventSync::getEventOffset(int event) const {
+  const auto it = mMaxOffset.find(event);
+  return (it == mMaxOffset.end()) ? 0 : it->second;
+}
+
 inline
 void RawReaderEventSync::addEventOffset(int event, long time) {
 
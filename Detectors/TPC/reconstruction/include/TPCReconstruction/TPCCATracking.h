@@ -46,6 +46,8 @@ public:
   float getPseudoVDrift();                                            //Return artificial VDrift used to convert time to Z
   float getTFReferenceLength() {return sContinuousTFReferenceLength;} //Return reference time frame length used to obtain Z from T in continuous data
   int getNTracksASide() {return mNTracksASide;}
+  void setNumberOfThreads(int nThreads) {mNThreads = nThreads < 1 ? 1 : nThreads;} //Threads converting the tracker output, 1 converts in the calling thread
+  int getNumberOfThreads() const {return mNThreads;}
   void GetClusterErrors2(int row, float z, float sinPhi, float DzDs, float& ErrY2, float& ErrZ2) const;
 
  private:
@@ -59,6 +61,7 @@ public:
   static constexpr float sContinuousTFReferenceLength = 0.023 * 5e6;
   static constexpr float sTrackMCMaxFake = 0.1;
   int mNTracksASide = 0;
+  int mNThreads = 1;
 };
 
 }
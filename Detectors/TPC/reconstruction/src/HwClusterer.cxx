@@ -33,7 +33,6 @@ HwClusterer::HwClusterer(
   : Clusterer(),
     mNumRows(0),
     mNumRowSets(0),
-    mCurrentMcContainerInBuffer(0),
     mSplittingMode(0),
     mClusterSector(sectorid),
     mLastTimebin(-1),
@@ -110,6 +109,7 @@ HwClusterer::HwClusterer(
     }
   }
   mMCtruth.resize(mTimebinsInBuffer, nullptr);
+  mTmpMcLabels.resize(Vc::uint_v::Size);
 }
 
 //______________________________________________________________________________
@@ -130,6 +130,25 @@ HwClusterer::HwClusterer(
 
 //______________________________________________________________________________
 void HwClusterer::process(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth, bool clearContainerFirst)
+{
+  // The MC truth is only needed if labels are requested. In triggered mode
+  // the buffer is cleared at the end of this call, so the container is only
+  // referenced. In continuous mode the last timebins stay in the buffer until
+  // the next call, where the original container could already be gone, so it
+  // has to be copied.
+  std::shared_ptr<MCLabelContainer const> sharedTruth;
+  if (mcDigitTruth && mClusterMcLabelArray && digits.size() != 0) {
+    if (mIsContinuousReadout) {
+      sharedTruth = std::make_shared<MCLabelContainer const>(*mcDigitTruth);
+    } else {
+      sharedTruth = std::shared_ptr<MCLabelContainer const>(std::shared_ptr<MCLabelContainer const>(), mcDigitTruth);
+    }
+  }
+  process(digits.data(), digits.data() + digits.size(), sharedTruth, 0, clearContainerFirst);
+}
+
+//______________________________________________________________________________
+void HwClusterer::process(Digit const* first, Digit const* last, std::shared_ptr<MCLabelContainer const> const& mcDigitTruth, int firstDigitIndex, bool clearContainerFirst)
 {
   if (clearContainerFirst) {
     if (mClusterArray)
@@ -142,15 +161,15 @@ void HwClusterer::process(std::vector<o2::TPC::Digit> const& digits, MCLabelCont
     mClusterCounter = 0;
   }
 
-  int digitIndex = 0;
+  int digitIndex = firstDigitIndex;
   int index;
   unsigned HB;
-  mCurrentMcContainerInBuffer = 0;
 
   /*
    * Loop over all (time ordered) digits
    */
-  for (const auto& digit : digits) {
+  for (auto digitIt = first; digitIt != last; ++digitIt) {
+    const auto& digit = *digitIt;
     /*
      * This loop does the following:
      *  - add digits to the tmp storage
@@ -217,16 +236,10 @@ void HwClusterer::process(std::vector<o2::TPC::Digit> const& digits, MCLabelCont
         mLastHB = HB;
       }
 
-      // we have to copy the MC truth container because we need the information
-      // maybe only in the next events (we store permanently 5 timebins), where
-      // the original pointer could already point to the next container.
+      // all timebins of this call share the MC truth container, which is
+      // kept alive as long as one of them is in the buffer
       if (mcDigitTruth) {
-        if (mCurrentMcContainerInBuffer == 0)
-          mMCtruth[mapTimeInRange(digit.getTimeStamp())] = std::make_shared<MCLabelContainer const>(*mcDigitTruth);
-        else
-          mMCtruth[mapTimeInRange(digit.getTimeStamp())] = std::shared_ptr<MCLabelContainer const>(mMCtruth[getFirstSetBitOfField()]);
-
-        mCurrentMcContainerInBuffer |= (0x1 << (mapTimeInRange(digit.getTimeStamp())));
+        mMCtruth[mapTimeInRange(digit.getTimeStamp())] = mcDigitTruth;
       }
     }
 
@@ -263,8 +276,8 @@ void HwClusterer::process(std::vector<o2::TPC::Digit> const& digits, MCLabelCont
   if (!mIsContinuousReadout)
     finishFrame(true);
 
-  if (digits.size() != 0)
-    LOG(DEBUG) << "Event ranged from time bin " << digits.front().getTimeStamp() << " to " << digits.back().getTimeStamp() << "." << FairLogger::endl;
+  if (first != last)
+    LOG(DEBUG) << "Event ranged from time bin " << first->getTimeStamp() << " to " << (last - 1)->getTimeStamp() << "." << FairLogger::endl;
 }
 
 //______________________________________________________________________________
@@ -277,6 +290,13 @@ void HwClusterer::finishProcess(std::vector<o2::TPC::Digit> const& digits, MCLab
   finishFrame(false);
 }
 
+//______________________________________________________________________________
+void HwClusterer::finishProcess(Digit const* first, Digit const* last, std::shared_ptr<MCLabelContainer const> const& mcDigitTruth, int firstDigitIndex, bool clearContainerFirst)
+{
+  process(first, last, mcDigitTruth, firstDigitIndex, clearContainerFirst);
+  finishFrame(false);
+}
+
 //______________________________________________________________________________
 void HwClusterer::hwClusterProcessor(const Vc::uint_m peakMask, unsigned qMaxIndex, short centerPad, int centerTime, unsigned short row)
 {
@@ -288,9 +308,9 @@ void HwClusterer::hwClusterProcessor(const Vc::uint_m peakMask, unsigned qMaxInd
   Vc::int_v flags = 0;
 
   using labelPair = std::pair<MCCompLabel, unsigned>;
-  std::vector<std::unique_ptr<std::vector<labelPair>>> mcLabels(Vc::uint_v::Size);
-  for (int i = 0; i < Vc::uint_v::Size; ++i) {
-    mcLabels[i] = std::make_unique<std::vector<labelPair>>();
+  auto& mcLabels = mTmpMcLabels;
+  for (auto& labels : mcLabels) {
+    labels.clear();
   }
 
   const unsigned llttIndex = mapTimeInRange(centerTime - 2) * mPadsPerRowSet[row] + centerPad - 2;
@@ -599,8 +619,8 @@ void HwClusterer::hwClusterProcessor(const Vc::uint_m peakMask, unsigned qMaxInd
         mGlobalRowToLocalRow[row * Vc::uint_v::Size + i], // the hardware knows only about the local row
         flags[i]);
 
-      std::sort(mcLabels[i]->begin(), mcLabels[i]->end(), [](const labelPair& a, const labelPair& b) { return a.second > b.second; });
-      mTmpLabelArray[mGlobalRowToRegion[row * Vc::uint_v::Size + i]]->push_back(std::move(*mcLabels[i]));
+      std::sort(mcLabels[i].begin(), mcLabels[i].end(), [](const labelPair& a, const labelPair& b) { return a.second > b.second; });
+      mTmpLabelArray[mGlobalRowToRegion[row * Vc::uint_v::Size + i]]->push_back(std::move(mcLabels[i]));
     }
   }
 }
@@ -865,7 +885,6 @@ void HwClusterer::clearBuffer(int timebin)
 {
   const int wrappedTime = mapTimeInRange(timebin);
   mMCtruth[wrappedTime].reset();
-  mCurrentMcContainerInBuffer &= ~(0x1 << wrappedTime); // clear bit
   for (unsigned short row = 0; row < mNumRowSets; ++row) {
     // reset timebin which is not needed anymore
     std::fill(mDataBuffer[row].begin() + wrappedTime * mPadsPerRowSet[row],
@@ -879,7 +898,7 @@ void HwClusterer::clearBuffer(int timebin)
 void HwClusterer::updateCluster(
   const Vc::uint_m selectionMask, int row, short centerPad, int centerTime, short dp, short dt,
   Vc::uint_v& qTot, Vc::int_v& pad, Vc::int_v& time, Vc::int_v& sigmaPad2, Vc::int_v& sigmaTime2,
-  std::vector<std::unique_ptr<std::vector<std::pair<MCCompLabel, unsigned>>>>& mcLabels, const Vc::uint_m splitMask)
+  std::vector<std::vector<std::pair<MCCompLabel, unsigned>>>& mcLabels, const Vc::uint_m splitMask)
 {
   if (selectionMask.isEmpty())
     return;
@@ -905,14 +924,15 @@ void HwClusterer::updateCluster(
     if (selectionMask[i] && mMCtruth[mappedTime] != nullptr) {
       for (auto& label : mMCtruth[mappedTime]->getLabels(mIndexBuffer[row][index][i])) {
         bool isKnown = false;
-        for (auto& vecLabel : *mcLabels[i]) {
+        for (auto& vecLabel : mcLabels[i]) {
           if (label == vecLabel.first) {
             ++vecLabel.second;
             isKnown = true;
+            break;
           }
         }
         if (!isKnown) {
-          mcLabels[i]->emplace_back(label, 1);
+          mcLabels[i].emplace_back(label, 1);
         }
       }
     }
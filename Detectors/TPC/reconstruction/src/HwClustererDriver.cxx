@@ -0,0 +1,191 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file HwClustererDriver.cxx
+/// \brief Runs the TPC HW cluster finder of all sectors in parallel
+
+#include "TPCReconstruction/HwClustererDriver.h"
+#include "TPCBase/Digit.h"
+#include "TPCBase/CRU.h"
+
+#include "FairLogger.h"
+
+#include <atomic>
+#include <cassert>
+#include <future>
+
+using namespace o2::TPC;
+
+//______________________________________________________________________________
+HwClustererDriver::HwClustererDriver(std::vector<ClusterHardwareContainer8kb>* clusterOutput, MCLabelContainer* labelOutput)
+  : Clusterer(),
+    mNThreads(1),
+    mIsContinuousReadout(true),
+    mRejectSinglePadClusters(false),
+    mRejectSingleTimeClusters(false),
+    mRejectLaterTimebin(false),
+    mSplittingMode(0),
+    mPeakChargeThreshold(2),
+    mContributionChargeThreshold(0),
+    mSectors(),
+    mActiveSectors(),
+    mClusterArray(clusterOutput),
+    mClusterMcLabelArray(labelOutput)
+{
+}
+
+//______________________________________________________________________________
+void HwClustererDriver::process(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth)
+{
+  run(digits, mcDigitTruth, false);
+}
+
+//______________________________________________________________________________
+void HwClustererDriver::finishProcess(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth)
+{
+  run(digits, mcDigitTruth, true);
+}
+
+//______________________________________________________________________________
+void HwClustererDriver::run(std::vector<o2::TPC::Digit> const& digits, MCLabelContainer const* mcDigitTruth, bool finish)
+{
+  if (mClusterArray)
+    mClusterArray->clear();
+  if (mClusterMcLabelArray)
+    mClusterMcLabelArray->clear();
+
+  auto sectorOf = [](Digit const& digit) { return int(CRU(digit.getCRU()).sector()); };
+  assert(std::is_sorted(digits.begin(), digits.end(), [&sectorOf](Digit const& a, Digit const& b) { return sectorOf(a) < sectorOf(b); }));
+
+  /*
+   * Find the digits of each sector and create the clusterers of sectors
+   * seen for the first time. When finishing, the sectors without digits
+   * in this call may still have timebins in their buffer.
+   */
+  mActiveSectors.clear();
+  auto first = digits.begin();
+  for (int sector = 0; sector < Sector::MAXSECTOR; ++sector) {
+    auto last = std::partition_point(first, digits.end(), [sector, &sectorOf](Digit const& digit) { return sectorOf(digit) <= sector; });
+    auto& data = mSectors[sector];
+    data.firstDigit = first - digits.begin();
+    data.lastDigit = last - digits.begin();
+    first = last;
+
+    if (data.firstDigit == data.lastDigit && !(finish && data.clusterer)) {
+      continue;
+    }
+    if (!data.clusterer) {
+      data.clusterer = std::make_unique<HwClusterer>(mClusterArray ? &data.clusters : nullptr, sector, mClusterMcLabelArray ? &data.labels : nullptr);
+    }
+    configure(*data.clusterer);
+    mActiveSectors.emplace_back(sector);
+  }
+
+  // The MC truth is shared by all sectors, it has to be copied only once and
+  // only if the digits stay in the buffers after this call (see HwClusterer)
+  std::shared_ptr<MCLabelContainer const> sharedTruth;
+  if (mcDigitTruth && mClusterMcLabelArray && digits.size() != 0) {
+    if (mIsContinuousReadout) {
+      sharedTruth = std::make_shared<MCLabelContainer const>(*mcDigitTruth);
+    } else {
+      sharedTruth = std::shared_ptr<MCLabelContainer const>(std::shared_ptr<MCLabelContainer const>(), mcDigitTruth);
+    }
+  }
+
+  /*
+   * Clusterize the sectors, each into its own containers
+   */
+  runParallel(mActiveSectors.size(), [&](size_t iActive) {
+    auto& data = mSectors[mActiveSectors[iActive]];
+    auto firstDigit = digits.data() + data.firstDigit;
+    auto lastDigit = digits.data() + data.lastDigit;
+    if (finish) {
+      data.clusterer->finishProcess(firstDigit, lastDigit, sharedTruth, data.firstDigit, true);
+    } else {
+      data.clusterer->process(firstDigit, lastDigit, sharedTruth, data.firstDigit, true);
+    }
+  });
+
+  if (!mClusterArray) {
+    return;
+  }
+
+  /*
+   * Merge the output in sector order. Each sector gets its own range of the
+   * output, so the cluster containers are copied in parallel. The MC labels
+   * refer to the running cluster number and are appended one sector after
+   * the other.
+   */
+  size_t nContainers = 0;
+  for (auto sector : mActiveSectors) {
+    mSectors[sector].firstContainer = nContainers;
+    nContainers += mSectors[sector].clusters.size();
+  }
+  mClusterArray->resize(nContainers);
+
+  runParallel(mActiveSectors.size(), [this](size_t iActive) {
+    auto& data = mSectors[mActiveSectors[iActive]];
+    std::copy(data.clusters.begin(), data.clusters.end(), mClusterArray->begin() + data.firstContainer);
+  });
+
+  if (mClusterMcLabelArray) {
+    unsigned clusterOffset = 0;
+    for (auto sector : mActiveSectors) {
+      auto& data = mSectors[sector];
+      unsigned nClusters = 0;
+      for (auto const& container : data.clusters) {
+        nClusters += container.getContainer()->numberOfClusters;
+      }
+      for (unsigned cluster = 0; cluster < data.labels.getIndexedSize(); ++cluster) {
+        for (auto const& label : data.labels.getLabels(cluster)) {
+          mClusterMcLabelArray->addElement(clusterOffset + cluster, label);
+        }
+      }
+      clusterOffset += nClusters;
+    }
+  }
+
+  LOG(DEBUG) << "Hw clusterer driver delivered " << mClusterArray->size() << " cluster container of "
+             << mActiveSectors.size() << " sectors" << FairLogger::endl;
+}
+
+//______________________________________________________________________________
+void HwClustererDriver::runParallel(size_t n, std::function<void(size_t)> const& work) const
+{
+  std::atomic<size_t> next(0);
+  auto worker = [&next, n, &work]() {
+    for (size_t i = next++; i < n; i = next++) {
+      work(i);
+    }
+  };
+  const size_t nThreads = std::min(size_t(mNThreads), n);
+  std::vector<std::future<void>> workers;
+  for (size_t thread = 1; thread < nThreads; ++thread) {
+    workers.emplace_back(std::async(std::launch::async, worker));
+  }
+  worker();
+  for (auto& future : workers) {
+    future.get();
+  }
+}
+
+//______________________________________________________________________________
+void HwClustererDriver::configure(HwClusterer& clusterer)
+{
+  clusterer.setContinuousReadout(mIsContinuousReadout);
+  clusterer.setPeakChargeThreshold(mPeakChargeThreshold);
+  clusterer.setContributionChargeThreshold(mContributionChargeThreshold);
+  clusterer.setRejectSinglePadClusters(mRejectSinglePadClusters);
+  clusterer.setRejectSingleTimeClusters(mRejectSingleTimeClusters);
+  clusterer.setRejectLaterTimebin(mRejectLaterTimebin);
+  clusterer.setSplittingMode(mSplittingMode);
+  clusterer.setNoiseObject(mNoiseObject);
+  clusterer.setPedestalObject(mPedestalObject);
+}
@@ -13,7 +13,8 @@
 
 #include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
-#include <list>
+#include <future>
+#include <numeric>
 
 #include "TPCReconstruction/RawReader.h"
 #include "TPCReconstruction/GBTFrame.h"
@@ -26,6 +27,46 @@
 
 using namespace o2::TPC;
 
+namespace {
+/// Half words and ADC clocks of one GBT frame
+struct GBTFrameHalfWords {
+  std::array<std::array<uint8_t, 4>, RawReader::NumberOfHalfSampas> halfWords;
+  std::array<uint8_t, 3> adcClock;
+};
+
+/// First bit of each half SAMPA in the 128 bit GBT frame. Its half words are
+/// made of every 4th bit of the 20 bits starting there.
+constexpr std::array<int, RawReader::NumberOfHalfSampas> HalfSampaBitOffset{ { 0, 20, 44, 64, 88 } };
+
+/// Gathers the bits offset, offset + 4, ..., offset + 16 of the GBT frame
+/// into a 5 bit half word. Same as GBTFrame::calculateHalfWords, but
+/// working on all the bits at once rather than one by one.
+inline uint8_t gatherHalfWord(const std::array<uint32_t, 4>& words, int offset)
+{
+  const int word = offset / 32;
+  uint64_t bits = ((uint64_t(words[word + 1]) << 32) | words[word]) >> (offset % 32);
+  bits &= 0x11111;                       // bits 0, 4, 8, 12, 16
+  bits = (bits | (bits >> 3)) & 0x10303; // bits 0-1, 8-9, 16
+  bits = (bits | (bits >> 6)) & 0x1000f; // bits 0-3, 16
+  return (bits | (bits >> 12)) & 0x1f;
+}
+
+/// Extracts all the half words of the GBT frame starting at @a data
+inline void extractHalfWords(const uint32_t* data, GBTFrameHalfWords& frame)
+{
+  // the most significant word comes first in the data stream
+  const std::array<uint32_t, 4> words{ { data[3], data[2], data[1], data[0] } };
+  for (int halfSampa = 0; halfSampa < RawReader::NumberOfHalfSampas; ++halfSampa) {
+    for (int halfWord = 0; halfWord < 4; ++halfWord) {
+      frame.halfWords[halfSampa][halfWord] = gatherHalfWord(words, HalfSampaBitOffset[halfSampa] + 3 - halfWord);
+    }
+  }
+  frame.adcClock[0] = (words[1] >> 8) & 0xF;
+  frame.adcClock[1] = (words[2] >> 20) & 0xF;
+  frame.adcClock[2] = (words[3] >> 12) & 0xF;
+}
+} // namespace
+
 RawReader::RawReader(int region, int link, int run, int sampaVersion)
   : mUseRawInMode3(true),
     mApplyChannelMask(false),
@@ -34,17 +75,28 @@ RawReader::RawReader(int region, int link, int run, int sampaVersion)
     mLink(link),
     mRun(run),
     mSampaVersion(sampaVersion),
+    mNThreads(1),
     mLastEvent(-1),
     mTimestampOfFirstData({ 0, 0, 0, 0, 0 }),
     mEvents(),
     mData(),
-    mDataIterator(mData.end()),
+    mTimeBinsCapacity(0),
+    mTimeBins(),
+    mDroppedTimeBins(),
+    mPadPos(),
+    mChannelRow(),
+    mChannelMappingDone(false),
+    mRowMasked(),
+    mDataIterator(NumberOfChannels),
     mSyncPos(),
     mChannelMask(nullptr),
     mAdcError(std::make_shared<std::vector<std::tuple<short, short, short>>>()),
     mEventSynchronizer(std::make_shared<RawReaderEventSync>())
 {
   mSyncPos.fill(-1);
+  mTimeBins.fill(0);
+  mDroppedTimeBins.fill(0);
+  mRowMasked.fill(false);
 }
 
 bool RawReader::addInputFile(const std::vector<std::string>* infiles) {
@@ -191,13 +243,26 @@ bool RawReader::loadEvent(int64_t event) {
     loadEvent(getFirstEvent());
     LOG(DEBUG) << "Continue with event " << event << FairLogger::endl;
   }
-  mData.clear();
+  if (!mChannelMappingDone) setupChannelMapping();
 
   auto ev = mEvents.find(event);
 
-  if (ev == mEvents.end()) return false;
+  if (ev == mEvents.end()) {
+    resetData(0);
+    return false;
+  }
   mLastEvent = event;
 
+  size_t timeBins = 0;
+  for (auto &eventInfo : *(ev->second)) {
+    const int indexStep = (eventInfo.header.dataType == 3) ? 8 : 4;
+    const size_t nFrames = (eventInfo.header.nWords - 8) / indexStep + 1;
+    const bool rawFrames = (eventInfo.header.dataType == 1) || (eventInfo.header.dataType == 3 && mUseRawInMode3);
+    // GBT frames carry 2 ADC values per half SAMPA, so one time bin every 8 frames
+    timeBins += rawFrames ? nFrames / 8 + 1 : nFrames;
+  }
+  resetData(timeBins);
+
   for (auto &eventInfo : *(ev->second)) {
     switch (eventInfo.header.dataType) {
       case 1: // RAW GBT frames
@@ -231,7 +296,13 @@ bool RawReader::loadEvent(int64_t event) {
     }
   }
 
-  mDataIterator = mData.begin();
+  const size_t droppedTimeBins = std::accumulate(mDroppedTimeBins.begin(), mDroppedTimeBins.end(), size_t(0));
+  if (droppedTimeBins) {
+    LOG(WARNING) << "Event " << event << ": dropped " << droppedTimeBins << " time bins exceeding the "
+                 << mTimeBinsCapacity << " expected per pad" << FairLogger::endl;
+  }
+
+  mDataIterator = 0;
   LOG(DEBUG) << FairLogger::endl;
   LOG(DEBUG) << FairLogger::endl;
   return true;
@@ -245,22 +316,10 @@ bool RawReader::decodePreprocessedData(EventInfo eventInfo) {
   }
 
   int nWords = eventInfo.header.nWords-8;
-  uint32_t words[nWords];
+  std::vector<uint32_t> words(nWords);
   LOG(DEBUG) << "reading " << nWords << " words from position " << eventInfo.posInFile << " in file " << eventInfo.path << FairLogger::endl;
   file.seekg(eventInfo.posInFile);
-  file.read((char*)&words, nWords*sizeof(words[0]));
-
-  const Mapper& mapper = Mapper::instance();
-
-  std::array<char,5> sampas;
-  std::array<char,5> sampaChannelStart;
-  for (char i=0; i<5; ++i) {
-    sampas[i] = (i == 4) ? 2 : (mRegion%2) ? i/2+3 : i/2;
-    sampaChannelStart[i] = (i == 4) ?   // 5th half SAMPA corresponds to  SAMPA2
-      ((mRegion%2) ? 16 : 0) :          // every even CRU receives channel 0-15 from SAMPA 2, the odd ones channel 16-31
-      ((i%2) ? 16 : 0);                 // every even half SAMPA containes channel 0-15, the odd ones channel 16-31
-  }
-
+  file.read((char*)words.data(), nWords*sizeof(words[0]));
 
   std::array<uint32_t,5> ids;
   std::array<bool,5> writeValue;
@@ -313,20 +372,7 @@ bool RawReader::decodePreprocessedData(EventInfo eventInfo) {
 
     for (char j=0; j<5; ++j) {
       if (writeValue[j] & (ids[j] == 0xF)) {
-        for (int k=0; k<16; ++k) {
-          const PadPos padPos = mapper.padPosRegion(
-              mRegion, mLink,sampas[j],k+sampaChannelStart[j]);
-
-          if (mApplyChannelMask &&          // channel mask should be applied
-              (mChannelMask != nullptr) &&  // channel mask is available
-              !mChannelMask->getValue(CRU(mRegion),padPos.getPad(),padPos.getRow())) { // channel mask
-              continue;
-          }
-
-//          auto ins = mData.insert(std::make_pair(padPos, std::shared_ptr<std::vector<uint16_t>>(new std::vector<uint16_t>)));
-          auto ins = mData.insert(std::make_pair(padPos, std::make_shared<std::vector<uint16_t>>()));
-          ins.first->second->push_back(adcValues[j][k]);
-        }
+        addTimeBin(j, adcValues[j].data());
       }
     }
 
@@ -342,13 +388,11 @@ bool RawReader::decodeRawGBTFrames(EventInfo eventInfo) {
   }
 
   int nWords = eventInfo.header.nWords-8;
-  uint32_t words[nWords];
+  std::vector<uint32_t> words(nWords);
   LOG(DEBUG) << "reading " << nWords << " words from position " << eventInfo.posInFile << " in file " << eventInfo.path << FairLogger::endl;
   LOG(DEBUG) << "Header time stamp is " << eventInfo.header.timeStamp() << FairLogger::endl;
   file.seekg(eventInfo.posInFile);
-  file.read((char*)&words, nWords*sizeof(words[0]));
-
-  const Mapper& mapper = Mapper::instance();
+  file.read((char*)words.data(), nWords*sizeof(words[0]));
 
   std::array<char,5> sampas;
   std::array<char,5> sampaChannelStart;
@@ -359,22 +403,7 @@ bool RawReader::decodeRawGBTFrames(EventInfo eventInfo) {
       ((i%2) ? 16 : 0);                 // every even half SAMPA containes channel 0-15, the odd ones channel 16-31
   }
 
-  std::array<SyncPatternMonitor,5> syncMon{
-    SyncPatternMonitor((mRegion%2) ? 3 : 0,0),
-    SyncPatternMonitor((mRegion%2) ? 3 : 0,1),
-    SyncPatternMonitor((mRegion%2) ? 4 : 1,0),
-    SyncPatternMonitor((mRegion%2) ? 4 : 1,1),
-    SyncPatternMonitor(2,(mRegion%2) ? 1 : 0)};
-  std::array<AdcClockMonitor,3> adcClockMon{
-    AdcClockMonitor((mRegion%2) ? 3 : 0),
-    AdcClockMonitor((mRegion%2) ? 4 : 1),
-    AdcClockMonitor(2)};
-  std::array<bool,3> adcClockFound{false, false, false};
-
-  std::array<short,5> lastSyncPos;
-  std::array<std::list<uint16_t>,5> adcValues;
   mAdcError->clear();
-  uint64_t timebin = 0;
 
   int indexStep = (eventInfo.header.dataType == 3) ? 8 : 4;
 
@@ -391,58 +420,53 @@ bool RawReader::decodeRawGBTFrames(EventInfo eventInfo) {
 
   LOG(DEBUG) << "Start index for Event " << eventInfo.header.eventCount() << " is " << i_start << FairLogger::endl;
 
-  GBTFrame frame;
-  if (eventInfo.header.eventCount() > 0) frame.setData(words[i_start-indexStep],words[i_start-indexStep+1],words[i_start-indexStep+2],words[i_start-indexStep+3]);
-  GBTFrame lastFrame;
-
-  for (long i=i_start; i<nWords; i=i+indexStep) {
+  // Extract the half words of all the frames first. The first element is
+  // the frame preceding the first one to be decoded.
+  const long nFrames = (i_start < nWords) ? (nWords - 1 - i_start) / indexStep + 1 : 0;
+  std::vector<GBTFrameHalfWords> frames(nFrames + 1);
+  if (eventInfo.header.eventCount() > 0) extractHalfWords(&words[i_start-indexStep], frames[0]);
+  for (long f = 0; f < nFrames; ++f) {
+    extractHalfWords(&words[i_start + f*indexStep], frames[f+1]);
+  }
 
-    lastSyncPos = mSyncPos;
-    lastFrame = frame;
-    frame.setData(words[i],words[i+1],words[i+2],words[i+3]);
-
-    if (syncMon[0].addSequence(frame.getHalfWord(0,0,0), frame.getHalfWord(0,1,0), frame.getHalfWord(0,2,0), frame.getHalfWord(0,3,0))) mSyncPos[0] = syncMon[0].getPosition();
-    if (syncMon[1].addSequence(frame.getHalfWord(0,0,1), frame.getHalfWord(0,1,1), frame.getHalfWord(0,2,1), frame.getHalfWord(0,3,1))) mSyncPos[1] = syncMon[1].getPosition();
-    if (syncMon[2].addSequence(frame.getHalfWord(1,0,0), frame.getHalfWord(1,1,0), frame.getHalfWord(1,2,0), frame.getHalfWord(1,3,0))) mSyncPos[2] = syncMon[2].getPosition();
-    if (syncMon[3].addSequence(frame.getHalfWord(1,0,1), frame.getHalfWord(1,1,1), frame.getHalfWord(1,2,1), frame.getHalfWord(1,3,1))) mSyncPos[3] = syncMon[3].getPosition();
-    if (syncMon[4].addSequence(frame.getHalfWord(2,0),   frame.getHalfWord(2,1),   frame.getHalfWord(2,2),   frame.getHalfWord(2,3)))   mSyncPos[4] = syncMon[4].getPosition();
-
-    if (mCheckAdcClock) {
-
-      bool adcCheckErr0 = adcClockMon[0].addSequence(frame.getAdcClock(0));
-      bool adcCheckErr1 = adcClockMon[1].addSequence(frame.getAdcClock(1));
-      bool adcCheckErr2 = adcClockMon[2].addSequence(frame.getAdcClock(2));
-
-      if (mSyncPos[0] >= 0) adcClockFound[0] = adcClockFound[0] | !adcCheckErr0;
-      if (mSyncPos[2] >= 0) adcClockFound[1] = adcClockFound[1] | !adcCheckErr1;
-      if (mSyncPos[4] >= 0) adcClockFound[2] = adcClockFound[2] | !adcCheckErr2;
-      if(adcClockFound[0] & adcCheckErr0) {
-        adcClockFound[0] = false;
-        LOG(DEBUG) << "ADC clock error of SAMPA " << ((mRegion%2) ? 3 : 0) << " in frame [" << i/indexStep << "]"  << FairLogger::endl;
-        mAdcError->emplace_back(std::make_tuple((mRegion%2) ? 3 : 0,i,mSyncPos[0]));
-      };
-      if(adcClockFound[1] & adcCheckErr1) {
-        adcClockFound[1] = false;
-        LOG(DEBUG) << "ADC clock error of SAMPA " << ((mRegion%2) ? 4 : 1) << " in frame [" << i/indexStep << "]"  << FairLogger::endl;
-        mAdcError->emplace_back(std::make_tuple((mRegion%2) ? 4 : 1,i,mSyncPos[2]));
-      };
-      if(adcClockFound[2] & adcCheckErr2) {
-        adcClockFound[2] = false;
-        LOG(DEBUG) << "ADC clock error of SAMPA " << 2 << " in frame [" << i/indexStep << "]"  << FairLogger::endl;
-        mAdcError->emplace_back(std::make_tuple(2,i,mSyncPos[4]));
-      };
-    }
+  // Then decode the half SAMPA streams, which are independent of each
+  // other. The ADC clock of each SAMPA is checked together with its first
+  // half SAMPA.
+  auto decodeHalfSampa = [&](int iHalfSampa, std::vector<std::tuple<short,short,short>>& adcErrors) -> bool {
+    SyncPatternMonitor syncMon(sampas[iHalfSampa], sampaChannelStart[iHalfSampa] / 16);
+    AdcClockMonitor adcClockMon(sampas[iHalfSampa]);
+    const bool checkAdcClock = mCheckAdcClock && (iHalfSampa % 2 == 0);
+    const int adcClock = iHalfSampa / 2;
+    bool adcClockFound = false;
+
+    std::array<uint16_t,ChannelsPerHalfSampa> adcValues;
+    int nAdcValues = 0;
+    short syncPos = mSyncPos[iHalfSampa];
+
+    for (long f = 0; f < nFrames; ++f) {
+      const long i = i_start + f*indexStep;
+      const auto& lastFrame = frames[f].halfWords[iHalfSampa];
+      const auto& frame = frames[f+1].halfWords[iHalfSampa];
+
+      const short lastSyncPos = syncPos;
+      if (syncMon.addSequence(frame[0], frame[1], frame[2], frame[3])) syncPos = syncMon.getPosition();
+
+      if (checkAdcClock) {
+        bool adcCheckErr = adcClockMon.addSequence(frames[f+1].adcClock[adcClock]);
+        if (syncPos >= 0) adcClockFound = adcClockFound | !adcCheckErr;
+        if (adcClockFound & adcCheckErr) {
+          adcClockFound = false;
+          LOG(DEBUG) << "ADC clock error of SAMPA " << int(sampas[iHalfSampa]) << " in frame [" << i/indexStep << "]"  << FairLogger::endl;
+          adcErrors.emplace_back(std::make_tuple(sampas[iHalfSampa],i,syncPos));
+        }
+      }
 
-    short value1;
-    short value2;
-    for (short iHalfSampa = 0; iHalfSampa < 5; ++iHalfSampa) {
-      if (mSyncPos[iHalfSampa] < 0 ) {
+      if (syncPos < 0 ) {
         LOG(DEBUG1) << "Sync pattern for half SAMPA " << iHalfSampa << " not yet found" << FairLogger::endl;
         continue;
       }
-      if (lastSyncPos[iHalfSampa] < 0 ) {
+      if (lastSyncPos < 0 ) {
         LOG(DEBUG1) << "Sync pattern for half SAMPA " << iHalfSampa << " not yet found" << FairLogger::endl;
-        LOG(DEBUG1) << lastFrame << FairLogger::endl;
         continue;
       }
       if (mTimestampOfFirstData[iHalfSampa] == 0) {
@@ -450,61 +474,140 @@ bool RawReader::decodeRawGBTFrames(EventInfo eventInfo) {
         mTimestampOfFirstData[iHalfSampa] = eventInfo.header.timeStamp() + 1 + i/indexStep;
       }
 
-      switch(mSyncPos[iHalfSampa]) {
+      short value1;
+      short value2;
+      switch(syncPos) {
         case 0:
-          value1 = (frame.getHalfWord(iHalfSampa/2,1,iHalfSampa%2) << 5) | frame.getHalfWord(iHalfSampa/2,0,iHalfSampa%2);
-          value2 = (frame.getHalfWord(iHalfSampa/2,3,iHalfSampa%2) << 5) | frame.getHalfWord(iHalfSampa/2,2,iHalfSampa%2);
+          value1 = (frame[1] << 5) | frame[0];
+          value2 = (frame[3] << 5) | frame[2];
           break;
 
         case 1:
-          value1 = (lastFrame.getHalfWord(iHalfSampa/2,2,iHalfSampa%2) << 5) | lastFrame.getHalfWord(iHalfSampa/2,1,iHalfSampa%2);
-          value2 =     (frame.getHalfWord(iHalfSampa/2,0,iHalfSampa%2) << 5) | lastFrame.getHalfWord(iHalfSampa/2,3,iHalfSampa%2);
+          value1 = (lastFrame[2] << 5) | lastFrame[1];
+          value2 =     (frame[0] << 5) | lastFrame[3];
           break;
 
         case 2:
-          value1 = (lastFrame.getHalfWord(iHalfSampa/2,3,iHalfSampa%2) << 5) | lastFrame.getHalfWord(iHalfSampa/2,2,iHalfSampa%2);
-          value2 =     (frame.getHalfWord(iHalfSampa/2,1,iHalfSampa%2) << 5) |     frame.getHalfWord(iHalfSampa/2,0,iHalfSampa%2);
+          value1 = (lastFrame[3] << 5) | lastFrame[2];
+          value2 =     (frame[1] << 5) |     frame[0];
           break;
 
         case 3:
-          value1 = (frame.getHalfWord(iHalfSampa/2,0,iHalfSampa%2) << 5) | lastFrame.getHalfWord(iHalfSampa/2,3,iHalfSampa%2);
-          value2 = (frame.getHalfWord(iHalfSampa/2,2,iHalfSampa%2) << 5) |     frame.getHalfWord(iHalfSampa/2,1,iHalfSampa%2);
+          value1 = (frame[0] << 5) | lastFrame[3];
+          value2 = (frame[2] << 5) |     frame[1];
           break;
 
         default:
+          mSyncPos[iHalfSampa] = syncPos;
           return false;
       }
 
       if (mSampaVersion == 1 || mSampaVersion == 2) {
-        adcValues[iHalfSampa].emplace_back(value1 ^ (1 << 9)); // Invert bit 9 vor SAMPA v1 and v2
-        adcValues[iHalfSampa].emplace_back(value2 ^ (1 << 9)); // Invert bit 9 vor SAMPA v1 and v2
+        adcValues[nAdcValues++] = value1 ^ (1 << 9); // Invert bit 9 vor SAMPA v1 and v2
+        adcValues[nAdcValues++] = value2 ^ (1 << 9); // Invert bit 9 vor SAMPA v1 and v2
       } else {
-        adcValues[iHalfSampa].emplace_back(value1);
-        adcValues[iHalfSampa].emplace_back(value2);
+        adcValues[nAdcValues++] = value1;
+        adcValues[nAdcValues++] = value2;
+      }
+
+      if (nAdcValues == ChannelsPerHalfSampa) {
+        addTimeBin(iHalfSampa, adcValues.data());
+        nAdcValues = 0;
       }
     }
+    mSyncPos[iHalfSampa] = syncPos;
+    return true;
+  };
+
+  std::array<std::vector<std::tuple<short,short,short>>,NumberOfHalfSampas> adcErrors;
+  std::array<bool,NumberOfHalfSampas> decoded;
+  auto decodeHalfSampas = [&](int first) {
+    for (int iHalfSampa = first; iHalfSampa < NumberOfHalfSampas; iHalfSampa += mNThreads) {
+      decoded[iHalfSampa] = decodeHalfSampa(iHalfSampa, adcErrors[iHalfSampa]);
+    }
+  };
+  std::vector<std::future<void>> workers;
+  for (int thread = 1; thread < mNThreads; ++thread) {
+    workers.emplace_back(std::async(std::launch::async, decodeHalfSampas, thread));
+  }
+  decodeHalfSampas(0);
+  for (auto& worker : workers) worker.get();
 
-    for (char j=0; j<5; ++j) {
-      if (adcValues[j].size() == 16) {
-        for (int k=0; k<16; ++k) {
-          const PadPos padPos = mapper.padPosRegion(
-              mRegion, mLink,sampas[j],k+sampaChannelStart[j]);
-
-          if (mApplyChannelMask &&          // channel mask should be applied
-              (mChannelMask != nullptr) &&  // channel mask is available
-              !mChannelMask->getValue(CRU(mRegion),padPos.getPad(),padPos.getRow())) {     // channel mask
-            adcValues[j].pop_front();           // discard value
-            continue;
-          }
+  // keep the errors ordered by position in the data stream
+  for (auto& errors : adcErrors) {
+    mAdcError->insert(mAdcError->end(), errors.begin(), errors.end());
+  }
+  std::stable_sort(mAdcError->begin(), mAdcError->end(),
+                   [](const std::tuple<short,short,short>& a, const std::tuple<short,short,short>& b) { return std::get<1>(a) < std::get<1>(b); });
 
-          //          auto ins = mData.insert(std::make_pair(padPos, std::shared_ptr<std::vector<uint16_t>>(new std::vector<uint16_t>)));
-          auto ins = mData.insert(std::make_pair(padPos, std::make_shared<std::vector<uint16_t>>()));
-          ins.first->second->push_back(adcValues[j].front());
-          adcValues[j].pop_front();
-        }
-      }
+  return std::all_of(decoded.begin(), decoded.end(), [](bool ok) { return ok; });
+}
+
+void RawReader::setupChannelMapping()
+{
+  const Mapper& mapper = Mapper::instance();
+  const CRU cru(mRegion);
+  const PartitionInfo& partInfo = mapper.getPartitionInfo(cru.partition());
+  const int fecInSector = partInfo.getSectorFECOffset() + mLink;
+
+  // sort the channels by global pad number, i.e. by pad row and pad
+  std::array<std::pair<GlobalPadNumber,int>,NumberOfChannels> pads;
+  std::array<std::pair<int,int>,NumberOfChannels> sampaChannel;
+  for (int iHalfSampa = 0; iHalfSampa < NumberOfHalfSampas; ++iHalfSampa) {
+    const int sampa = (iHalfSampa == 4) ? 2 : (mRegion%2) ? iHalfSampa/2+3 : iHalfSampa/2;
+    const int channelStart = (iHalfSampa == 4) ? ((mRegion%2) ? 16 : 0) : ((iHalfSampa%2) ? 16 : 0);
+    for (int k = 0; k < ChannelsPerHalfSampa; ++k) {
+      const int channel = iHalfSampa * ChannelsPerHalfSampa + k;
+      sampaChannel[channel] = std::make_pair(sampa, channelStart + k);
+      pads[channel] = std::make_pair(mapper.globalPadNumber(fecInSector, sampa, channelStart + k), channel);
     }
   }
-  return true;
+  std::sort(pads.begin(), pads.end());
+
+  for (int row = 0; row < NumberOfChannels; ++row) {
+    const int channel = pads[row].second;
+    mChannelRow[channel] = row;
+    mPadPos[row] = mapper.padPosRegion(mRegion, mLink, sampaChannel[channel].first, sampaChannel[channel].second);
+  }
+  mChannelMappingDone = true;
+}
+
+void RawReader::resetData(size_t timeBins)
+{
+  // the buffer is never shrunk, to avoid reallocations from one event to the next
+  mTimeBinsCapacity = timeBins;
+  if (mData.size() < NumberOfChannels * timeBins) {
+    mData.resize(NumberOfChannels * timeBins);
+  }
+  mTimeBins.fill(0);
+  mDroppedTimeBins.fill(0);
+  mDataIterator = NumberOfChannels;
+
+  for (int row = 0; row < NumberOfChannels; ++row) {
+    mRowMasked[row] = mApplyChannelMask &&          // channel mask should be applied
+                      (mChannelMask != nullptr) &&  // channel mask is available
+                      !mChannelMask->getValue(CRU(mRegion),mPadPos[row].getPad(),mPadPos[row].getRow());
+  }
 }
 
+void RawReader::addTimeBin(int halfSampa, const uint16_t* adcValues)
+{
+  // The half SAMPAs are decoded in parallel, so the buffer can't be grown
+  // here. Its capacity is an upper bound computed from the size of the
+  // event, which only inconsistent data can exceed.
+  bool dropped = false;
+  for (int k = 0; k < ChannelsPerHalfSampa; ++k) {
+    const int row = mChannelRow[halfSampa * ChannelsPerHalfSampa + k];
+    if (mRowMasked[row]) {
+      continue;
+    }
+    if (mTimeBins[row] >= mTimeBinsCapacity) {
+      dropped = true;
+      continue;
+    }
+    mData[row * mTimeBinsCapacity + mTimeBins[row]++] = adcValues[k];
+  }
+  if (dropped) {
+    ++mDroppedTimeBins[halfSampa];
+  }
+}
@@ -31,6 +31,9 @@
 // This class is only a wrapper for the actual tracking contained in the HLT O2 CA Tracking library.
 #include "AliHLTTPCCAO2Interface.h"
 
+#include <algorithm>
+#include <future>
+
 using namespace o2::TPC;
 using namespace o2;
 using namespace o2::dataformats;
@@ -98,134 +101,164 @@ int TPCCATracking::runTracking(const ClusterNativeAccessFullTPC& clusters, std::
     nTracks = tmp;
 
     outputTracks->resize(nTracks);
+    std::vector<MCCompLabel> trackLabels(outputTracksMCTruth ? nTracks : 0);
+
+    // pad region of each global pad row, to get the CRU of the clusters
+    std::vector<int> regionOfRow(mapper.getNumberOfRows());
+    for (int region = 0; region < mapper.getNumberOfPadRegions(); region++) {
+      for (int row = 0; row < mapper.getNumberOfRowsRegion(region); row++) {
+        regionOfRow[mapper.getGlobalRowOffsetRegion(region) + row] = region;
+      }
+    }
+    const bool continuous = mTrackingCAO2Interface->GetParamContinuous();
 
-    for (int iTmp = 0; iTmp < nTracks; iTmp++) {
-      auto& oTrack = (*outputTracks)[iTmp];
-      const int i = trackSort[iTmp].first;
-      float time0 = 0.f, tFwd = 0.f, tBwd = 0.f;
+    // Each thread converts a contiguous block of tracks into the preallocated
+    // output. The MC label of a track is the most frequent one of its clusters,
+    // the votes are counted in a small table which is reused for all tracks.
+    auto convertTracks = [&](int firstTrack, int lastTrack) {
+      std::vector<std::pair<MCCompLabel, unsigned int>> labels;
+      for (int iTmp = firstTrack; iTmp < lastTrack; iTmp++) {
+        auto& oTrack = (*outputTracks)[iTmp];
+        const int i = trackSort[iTmp].first;
+        float time0 = 0.f, tFwd = 0.f, tBwd = 0.f;
 
-      float zHigh = 0, zLow = 0;
-      if (mTrackingCAO2Interface->GetParamContinuous()) {
-        float zoffset = tracks[i].CSide() ? -tracks[i].GetParam().GetZOffset() : tracks[i].GetParam().GetZOffset();
-        time0 = sContinuousTFReferenceLength - zoffset * vzbinInv;
+        float zHigh = 0, zLow = 0;
+        if (continuous) {
+          float zoffset = tracks[i].CSide() ? -tracks[i].GetParam().GetZOffset() : tracks[i].GetParam().GetZOffset();
+          time0 = sContinuousTFReferenceLength - zoffset * vzbinInv;
 
-        if (tracks[i].CCE()) {
-          bool lastSide = trackClusters[tracks[i].FirstClusterRef()].fSlice < Sector::MAXSECTOR / 2;
-          float delta = 0.f;
-          for (int iCl = 1; iCl < tracks[i].NClusters(); iCl++) {
-            if (lastSide ^ (trackClusters[tracks[i].FirstClusterRef() + iCl].fSlice < Sector::MAXSECTOR / 2)) {
-              auto& hltcl1 = trackClusters[tracks[i].FirstClusterRef() + iCl];
-              auto& hltcl2 = trackClusters[tracks[i].FirstClusterRef() + iCl - 1];
-              auto& cl1 = clusters.clusters[hltcl1.fSlice][hltcl1.fRow][hltcl1.fNum];
-              auto& cl2 = clusters.clusters[hltcl2.fSlice][hltcl2.fRow][hltcl2.fNum];
-              delta = fabs(cl1.getTime() - cl2.getTime()) * 0.5f;
-              break;
+          if (tracks[i].CCE()) {
+            bool lastSide = trackClusters[tracks[i].FirstClusterRef()].fSlice < Sector::MAXSECTOR / 2;
+            float delta = 0.f;
+            for (int iCl = 1; iCl < tracks[i].NClusters(); iCl++) {
+              if (lastSide ^ (trackClusters[tracks[i].FirstClusterRef() + iCl].fSlice < Sector::MAXSECTOR / 2)) {
+                auto& hltcl1 = trackClusters[tracks[i].FirstClusterRef() + iCl];
+                auto& hltcl2 = trackClusters[tracks[i].FirstClusterRef() + iCl - 1];
+                auto& cl1 = clusters.clusters[hltcl1.fSlice][hltcl1.fRow][hltcl1.fNum];
+                auto& cl2 = clusters.clusters[hltcl2.fSlice][hltcl2.fRow][hltcl2.fNum];
+                delta = fabs(cl1.getTime() - cl2.getTime()) * 0.5f;
+                break;
+              }
             }
-          }
-          tFwd = tBwd = delta;
-        } else {
-          // estimate max/min time increments which still keep track in the physical limits of the TPC
-          zHigh = trackClusters[tracks[i].FirstClusterRef()].fZ - tracks[i].GetParam().GetZOffset(); // high R cluster
-          zLow = trackClusters[tracks[i].FirstClusterRef() + tracks[i].NClusters() - 1].fZ -
-                 tracks[i].GetParam().GetZOffset(); // low R cluster
-
-          bool sideHighA = trackClusters[tracks[i].FirstClusterRef()].fSlice < Sector::MAXSECTOR / 2;
-          bool sideLowA =
-            trackClusters[tracks[i].FirstClusterRef() + tracks[i].NClusters() - 1].fSlice < Sector::MAXSECTOR / 2;
-
-          // calculate time bracket
-          float zLowAbs = zLow < 0.f ? -zLow : zLow;
-          float zHighAbs = zHigh < 0.f ? -zHigh : zHigh;
-          //
-          // tFwd = (Lmax - max(|zLow|,|zAbs|))/vzbin  = drift time from cluster current Z till endcap
-          // tBwd = min(|zLow|,|zAbs|))/vzbin          = drift time from CE till cluster current Z
-          //
-          if (zLowAbs < zHighAbs) {
-            tFwd = (detParam.getTPClength() - zHighAbs) * vzbinInv;
-            tBwd = zLowAbs * vzbinInv;
+            tFwd = tBwd = delta;
           } else {
-            tFwd = (detParam.getTPClength() - zLowAbs) * vzbinInv;
-            tBwd = zHighAbs * vzbinInv;
+            // estimate max/min time increments which still keep track in the physical limits of the TPC
+            zHigh = trackClusters[tracks[i].FirstClusterRef()].fZ - tracks[i].GetParam().GetZOffset(); // high R cluster
+            zLow = trackClusters[tracks[i].FirstClusterRef() + tracks[i].NClusters() - 1].fZ -
+                   tracks[i].GetParam().GetZOffset(); // low R cluster
+
+            bool sideHighA = trackClusters[tracks[i].FirstClusterRef()].fSlice < Sector::MAXSECTOR / 2;
+            bool sideLowA =
+              trackClusters[tracks[i].FirstClusterRef() + tracks[i].NClusters() - 1].fSlice < Sector::MAXSECTOR / 2;
+
+            // calculate time bracket
+            float zLowAbs = zLow < 0.f ? -zLow : zLow;
+            float zHighAbs = zHigh < 0.f ? -zHigh : zHigh;
+            //
+            // tFwd = (Lmax - max(|zLow|,|zAbs|))/vzbin  = drift time from cluster current Z till endcap
+            // tBwd = min(|zLow|,|zAbs|))/vzbin          = drift time from CE till cluster current Z
+            //
+            if (zLowAbs < zHighAbs) {
+              tFwd = (detParam.getTPClength() - zHighAbs) * vzbinInv;
+              tBwd = zLowAbs * vzbinInv;
+            } else {
+              tFwd = (detParam.getTPClength() - zLowAbs) * vzbinInv;
+              tBwd = zHighAbs * vzbinInv;
+            }
           }
         }
-      }
 
-      oTrack =
-        TrackTPC(tracks[i].GetParam().GetX(), tracks[i].GetAlpha(),
-                 { tracks[i].GetParam().GetY(), tracks[i].GetParam().GetZ(), tracks[i].GetParam().GetSinPhi(),
-                   tracks[i].GetParam().GetDzDs(), tracks[i].GetParam().GetQPt() },
-                 { tracks[i].GetParam().GetCov(0), tracks[i].GetParam().GetCov(1), tracks[i].GetParam().GetCov(2),
-                   tracks[i].GetParam().GetCov(3), tracks[i].GetParam().GetCov(4), tracks[i].GetParam().GetCov(5),
-                   tracks[i].GetParam().GetCov(6), tracks[i].GetParam().GetCov(7), tracks[i].GetParam().GetCov(8),
-                   tracks[i].GetParam().GetCov(9), tracks[i].GetParam().GetCov(10), tracks[i].GetParam().GetCov(11),
-                   tracks[i].GetParam().GetCov(12), tracks[i].GetParam().GetCov(13), tracks[i].GetParam().GetCov(14) });
-      oTrack.setTime0(time0);
-      oTrack.setDeltaTBwd(tBwd);
-      oTrack.setDeltaTFwd(tFwd);
-      if (tracks[i].CCE()) {
-        oTrack.setHasCSideClusters();
-        oTrack.setHasASideClusters();
-      } else if (tracks[i].CSide()) {
-        oTrack.setHasCSideClusters();
-      } else {
-        oTrack.setHasASideClusters();
-      }
+        oTrack =
+          TrackTPC(tracks[i].GetParam().GetX(), tracks[i].GetAlpha(),
+                   { tracks[i].GetParam().GetY(), tracks[i].GetParam().GetZ(), tracks[i].GetParam().GetSinPhi(),
+                     tracks[i].GetParam().GetDzDs(), tracks[i].GetParam().GetQPt() },
+                   { tracks[i].GetParam().GetCov(0), tracks[i].GetParam().GetCov(1), tracks[i].GetParam().GetCov(2),
+                     tracks[i].GetParam().GetCov(3), tracks[i].GetParam().GetCov(4), tracks[i].GetParam().GetCov(5),
+                     tracks[i].GetParam().GetCov(6), tracks[i].GetParam().GetCov(7), tracks[i].GetParam().GetCov(8),
+                     tracks[i].GetParam().GetCov(9), tracks[i].GetParam().GetCov(10), tracks[i].GetParam().GetCov(11),
+                     tracks[i].GetParam().GetCov(12), tracks[i].GetParam().GetCov(13), tracks[i].GetParam().GetCov(14) });
+        oTrack.setTime0(time0);
+        oTrack.setDeltaTBwd(tBwd);
+        oTrack.setDeltaTFwd(tFwd);
+        if (tracks[i].CCE()) {
+          oTrack.setHasCSideClusters();
+          oTrack.setHasASideClusters();
+        } else if (tracks[i].CSide()) {
+          oTrack.setHasCSideClusters();
+        } else {
+          oTrack.setHasASideClusters();
+        }
 
-      oTrack.setChi2(tracks[i].GetParam().GetChi2());
-      auto& outerPar = tracks[i].OuterParam();
-      oTrack.setOuterParam(o2::track::TrackParCov(
-        outerPar.fX, outerPar.fAlpha,
-        { outerPar.fP[0], outerPar.fP[1], outerPar.fP[2], outerPar.fP[3], outerPar.fP[4] },
-        { outerPar.fC[0], outerPar.fC[1], outerPar.fC[2], outerPar.fC[3], outerPar.fC[4], outerPar.fC[5],
-          outerPar.fC[6], outerPar.fC[7], outerPar.fC[8], outerPar.fC[9], outerPar.fC[10], outerPar.fC[11],
-          outerPar.fC[12], outerPar.fC[13], outerPar.fC[14] }));
-      oTrack.resetClusterReferences(tracks[i].NClusters());
-      std::vector<std::pair<MCCompLabel, unsigned int>> labels;
-      for (int j = 0; j < tracks[i].NClusters(); j++) {
-        int clusterId = trackClusters[tracks[i].FirstClusterRef() + j].fNum;
-        Sector sector = trackClusters[tracks[i].FirstClusterRef() + j].fSlice;
-        int globalRow = trackClusters[tracks[i].FirstClusterRef() + j].fRow;
-        const ClusterNative& cl = clusters.clusters[sector][globalRow][clusterId];
-        int regionNumber = 0;
-        while (globalRow > mapper.getGlobalRowOffsetRegion(regionNumber) + mapper.getNumberOfRowsRegion(regionNumber))
-          regionNumber++;
-        CRU cru(sector, regionNumber);
-        oTrack.addCluster(Cluster(cru, globalRow - mapper.getGlobalRowOffsetRegion(regionNumber), cl.qTot, cl.qMax,
-                                  cl.getPad(), cl.getSigmaPad(), cl.getTime(), cl.getSigmaTime()));
-        oTrack.setClusterReference(j, sector, globalRow, clusterId);
-        if (outputTracksMCTruth) {
-          for (const auto& element : clusters.clustersMCTruth[sector][globalRow]->getLabels(clusterId)) {
-            bool found = false;
-            for (int l = 0; l < labels.size(); l++) {
-              if (labels[l].first == element) {
-                labels[l].second++;
-                found = true;
-                break;
+        oTrack.setChi2(tracks[i].GetParam().GetChi2());
+        auto& outerPar = tracks[i].OuterParam();
+        oTrack.setOuterParam(o2::track::TrackParCov(
+          outerPar.fX, outerPar.fAlpha,
+          { outerPar.fP[0], outerPar.fP[1], outerPar.fP[2], outerPar.fP[3], outerPar.fP[4] },
+          { outerPar.fC[0], outerPar.fC[1], outerPar.fC[2], outerPar.fC[3], outerPar.fC[4], outerPar.fC[5],
+            outerPar.fC[6], outerPar.fC[7], outerPar.fC[8], outerPar.fC[9], outerPar.fC[10], outerPar.fC[11],
+            outerPar.fC[12], outerPar.fC[13], outerPar.fC[14] }));
+        oTrack.resetClusterReferences(tracks[i].NClusters());
+        labels.clear();
+        for (int j = 0; j < tracks[i].NClusters(); j++) {
+          int clusterId = trackClusters[tracks[i].FirstClusterRef() + j].fNum;
+          Sector sector = trackClusters[tracks[i].FirstClusterRef() + j].fSlice;
+          int globalRow = trackClusters[tracks[i].FirstClusterRef() + j].fRow;
+          const ClusterNative& cl = clusters.clusters[sector][globalRow][clusterId];
+          const int regionNumber = regionOfRow[globalRow];
+          CRU cru(sector, regionNumber);
+          oTrack.addCluster(Cluster(cru, globalRow - mapper.getGlobalRowOffsetRegion(regionNumber), cl.qTot, cl.qMax,
+                                    cl.getPad(), cl.getSigmaPad(), cl.getTime(), cl.getSigmaTime()));
+          oTrack.setClusterReference(j, sector, globalRow, clusterId);
+          if (outputTracksMCTruth) {
+            for (const auto& element : clusters.clustersMCTruth[sector][globalRow]->getLabels(clusterId)) {
+              bool found = false;
+              for (size_t l = 0; l < labels.size(); l++) {
+                if (labels[l].first == element) {
+                  labels[l].second++;
+                  found = true;
+                  break;
+                }
               }
+              if (!found)
+                labels.emplace_back(element, 1);
             }
-            if (!found)
-              labels.emplace_back(element, 1);
           }
         }
-      }
-      if (outputTracksMCTruth) {
-        if (labels.size() == 0) {
-          outputTracksMCTruth->addElement(iTmp, MCCompLabel()); //default constructor creates NotSet label
-        } else {
-          int bestLabelNum = 0, bestLabelCount = 0;
-          for (int j = 0; j < labels.size(); j++) {
-            if (labels[j].second > bestLabelCount) {
-              bestLabelNum = j;
-              bestLabelCount = labels[j].second;
+        if (outputTracksMCTruth) {
+          if (labels.size() == 0) {
+            trackLabels[iTmp] = MCCompLabel(); //default constructor creates NotSet label
+          } else {
+            int bestLabelNum = 0, bestLabelCount = 0;
+            for (size_t j = 0; j < labels.size(); j++) {
+              if (labels[j].second > bestLabelCount) {
+                bestLabelNum = j;
+                bestLabelCount = labels[j].second;
+              }
             }
+            MCCompLabel& bestLabel = labels[bestLabelNum].first;
+            if (bestLabelCount < (1.f - sTrackMCMaxFake) * tracks[i].NClusters())
+              bestLabel.set(-bestLabel.getTrackID(), bestLabel.getEventID(), bestLabel.getSourceID());
+            trackLabels[iTmp] = bestLabel;
           }
-          MCCompLabel& bestLabel = labels[bestLabelNum].first;
-          if (bestLabelCount < (1.f - sTrackMCMaxFake) * tracks[i].NClusters())
-            bestLabel.set(-bestLabel.getTrackID(), bestLabel.getEventID(), bestLabel.getSourceID());
-          outputTracksMCTruth->addElement(iTmp, bestLabel);
         }
       }
-      int lastSector = trackClusters[tracks[i].FirstClusterRef() + tracks[i].NClusters() - 1].fNum >> 24;
+    };
+    const int nThreads = std::max(1, std::min(mNThreads, nTracks));
+    const int tracksPerThread = (nTracks + nThreads - 1) / nThreads;
+    std::vector<std::future<void>> workers;
+    for (int thread = 1; thread < nThreads; ++thread) {
+      workers.emplace_back(std::async(std::launch::async, convertTracks, thread * tracksPerThread,
+                                      std::min(nTracks, (thread + 1) * tracksPerThread)));
+    }
+    convertTracks(0, std::min(nTracks, tracksPerThread));
+    for (auto& worker : workers) {
+      worker.get();
+    }
+
+    if (outputTracksMCTruth) {
+      for (int iTmp = 0; iTmp < nTracks; iTmp++) {
+        outputTracksMCTruth->addElement(iTmp, trackLabels[iTmp]);
+      }
     }
   }
   mTrackingCAO2Interface->Cleanup();
@@ -20,6 +20,7 @@
 #include "TPCBase/Digit.h"
 #include "TPCBase/Mapper.h"
 #include "TPCReconstruction/HwClusterer.h"
+#include "TPCReconstruction/HwClustererDriver.h"
 
 #include "SimulationDataFormat/MCTruthContainer.h"
 #include "SimulationDataFormat/MCCompLabel.h"
@@ -27,6 +28,7 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <cstring>
 
 namespace o2
 {
@@ -999,5 +1001,84 @@ BOOST_AUTO_TEST_CASE(HwClusterer_test6)
   std::cout << "##" << std::endl
             << std::endl;
 }
+
+/// @brief Test 7 all sectors processed in parallel by the driver
+BOOST_AUTO_TEST_CASE(HwClusterer_test7)
+{
+  std::cout << "##" << std::endl;
+  std::cout << "## Starting test 7, parallel processing of all sectors." << std::endl;
+  using MCLabelContainer = o2::dataformats::MCTruthContainer<o2::MCCompLabel>;
+
+  // one single pad cluster in every pad row of every other sector, with time
+  // bins in several HBs, sorted by sector and time
+  Mapper& mapper = Mapper::instance();
+  std::vector<Digit> digits;
+  MCLabelContainer labels;
+  for (int sector = 0; sector < Sector::MAXSECTOR; sector += 2) {
+    for (int time = 0; time < 1000; time += 50) {
+      for (int row = 0, region = 0; region < 10; ++region) {
+        for (int localRow = 0; localRow < mapper.getNumberOfRowsRegion(region); ++localRow, ++row) {
+          digits.emplace_back(sector * 10 + region, 10 + row % 20, row, (row + time) % mapper.getNumberOfPadsInRowSector(row), time);
+          labels.addElement(digits.size() - 1, o2::MCCompLabel(sector * 1000 + row));
+        }
+      }
+    }
+  }
+
+  // reference, the sectors one after the other
+  std::vector<ClusterHardwareContainer8kb> referenceClusters;
+  MCLabelContainer referenceLabels;
+  int clusterOffset = 0;
+  for (int sector = 0; sector < Sector::MAXSECTOR; sector += 2) {
+    std::vector<Digit> sectorDigits;
+    MCLabelContainer sectorDigitLabels;
+    for (size_t digit = 0; digit < digits.size(); ++digit) {
+      if (digits[digit].getCRU() / 10 == sector) {
+        sectorDigits.emplace_back(digits[digit]);
+        sectorDigitLabels.addElements(sectorDigits.size() - 1, labels.getLabels(digit));
+      }
+    }
+    std::vector<ClusterHardwareContainer8kb> sectorClusters;
+    MCLabelContainer sectorLabels;
+    HwClusterer clusterer(&sectorClusters, sector, &sectorLabels);
+    clusterer.setContinuousReadout(false);
+    clusterer.process(sectorDigits, &sectorDigitLabels);
+    int nClusters = 0;
+    for (auto& container : sectorClusters) {
+      referenceClusters.emplace_back(container);
+      nClusters += container.getContainer()->numberOfClusters;
+    }
+    for (size_t cluster = 0; cluster < sectorLabels.getIndexedSize(); ++cluster) {
+      referenceLabels.addElements(clusterOffset + cluster, sectorLabels.getLabels(cluster));
+    }
+    clusterOffset += nClusters;
+  }
+  BOOST_CHECK_EQUAL(clusterOffset, Sector::MAXSECTOR / 2 * 20 * mapper.getNumberOfRows());
+
+  for (int nThreads : { 1, 4 }) {
+    std::vector<ClusterHardwareContainer8kb> clusters;
+    MCLabelContainer clusterLabels;
+    HwClustererDriver driver(&clusters, &clusterLabels);
+    driver.setContinuousReadout(false);
+    driver.setNumberOfThreads(nThreads);
+    driver.process(digits, &labels);
+
+    BOOST_CHECK_EQUAL(clusters.size(), referenceClusters.size());
+    for (size_t container = 0; container < std::min(clusters.size(), referenceClusters.size()); ++container) {
+      BOOST_CHECK(std::memcmp(&clusters[container], &referenceClusters[container], sizeof(ClusterHardwareContainer8kb)) == 0);
+    }
+    BOOST_CHECK_EQUAL(clusterLabels.getIndexedSize(), referenceLabels.getIndexedSize());
+    BOOST_CHECK_EQUAL(clusterLabels.getNElements(), referenceLabels.getNElements());
+    for (size_t cluster = 0; cluster < std::min(clusterLabels.getIndexedSize(), referenceLabels.getIndexedSize()); ++cluster) {
+      auto found = clusterLabels.getLabels(cluster);
+      auto expected = referenceLabels.getLabels(cluster);
+      BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(), expected.end());
+    }
+  }
+
+  std::cout << "## Test 7 done." << std::endl;
+  std::cout << "##" << std::endl
+            << std::endl;
+}
 }
 }
@@ -0,0 +1,153 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCRawReader.cxx
+/// \brief This task tests the decoding of GBT frames in the RawReader
+
+#define BOOST_TEST_MODULE Test TPC RawReader
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCReconstruction/RawReader.h"
+#include "TPCReconstruction/SyncPatternMonitor.h"
+#include "TPCBase/Mapper.h"
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  const int NTimeBins = 50;
+
+  /// ADC value of a channel of a half SAMPA in a time bin
+  uint16_t adcValue(int halfSampa, int channel, int timeBin)
+  {
+    return (timeBin * 80 + halfSampa * 16 + channel * 7) % 1024;
+  }
+
+  /// Writes a single event in readout mode 1, with the sync pattern of each
+  /// half SAMPA at a different position, followed by NTimeBins time bins
+  void writeRawFile(const std::string& path)
+  {
+    SyncPatternMonitor mon;
+    const short A = mon.getPatternA();
+    const short B = mon.getPatternB();
+    const std::array<short, 30> syncPattern{ {
+      B, B, A, A, B, B, A, A, B, B, A, A, B, B,
+      A, A, A, A, B, B, B, B, A, A, A, A, B, B, B, B
+    } };
+
+    // half word stream of each half SAMPA
+    std::array<std::vector<uint8_t>, 5> halfWords;
+    size_t nHalfWords = 0;
+    for (int hs = 0; hs < 5; ++hs) {
+      halfWords[hs].assign(10 + hs, B);
+      halfWords[hs].insert(halfWords[hs].end(), syncPattern.begin(), syncPattern.end());
+      for (int t = 0; t < NTimeBins; ++t) {
+        for (int k = 0; k < 16; ++k) {
+          halfWords[hs].push_back(adcValue(hs, k, t) & 0x1F);
+          halfWords[hs].push_back(adcValue(hs, k, t) >> 5);
+        }
+      }
+      nHalfWords = std::max(nHalfWords, halfWords[hs].size());
+    }
+    // one more frame, for the values spanning two frames
+    const size_t nFrames = nHalfWords / 4 + 2;
+
+    const std::array<int, 5> bitOffset{ { 0, 20, 44, 64, 88 } };
+    std::vector<uint32_t> words;
+    for (size_t f = 0; f < nFrames; ++f) {
+      std::array<uint32_t, 4> frame{ { 0, 0, 0, 0 } }; // word 0 to 3
+      for (int hs = 0; hs < 5; ++hs) {
+        for (int hw = 0; hw < 4; ++hw) {
+          const size_t index = f * 4 + hw;
+          const uint8_t value = (index < halfWords[hs].size()) ? halfWords[hs][index] : 0;
+          for (int bit = 0; bit < 5; ++bit) {
+            const int pos = bitOffset[hs] + 3 - hw + 4 * bit;
+            frame[pos / 32] |= ((value >> bit) & 0x1) << (pos % 32);
+          }
+        }
+      }
+      words.insert(words.end(), frame.rbegin(), frame.rend());
+    }
+
+    RawReader::Header header;
+    header.dataType = 1;
+    header.reserved_01 = 0x0F;
+    header.headerVersion = 1;
+    header.nWords = 8 + words.size();
+    header.timeStamp_w = 0;
+    header.eventCount_w = 0;
+    header.reserved_2_w = (0x3fec2fec1fec0fecUL << 32) | (0x3fec2fec1fec0fecUL >> 32);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint32_t));
+  }
+
+  /// @brief Test decoding of GBT frames into the pad x time array
+  BOOST_AUTO_TEST_CASE(RawReader_test1)
+  {
+    const std::string path = "testTPCRawReader.raw";
+    writeRawFile(path);
+
+    const Mapper& mapper = Mapper::instance();
+    const int region = 0;
+    const int link = 0;
+
+    for (int nThreads : { 1, 5 }) {
+      RawReader reader;
+      reader.setNumberOfThreads(nThreads);
+      BOOST_REQUIRE(reader.addInputFile(region, link, 0, path));
+      BOOST_CHECK_EQUAL(reader.loadNextEvent(), 0);
+
+      PadPos padPos;
+      PadPos lastPadPos;
+      size_t nTimeBins = 0;
+      int nPads = 0;
+      while (const uint16_t* data = reader.getNextData(padPos, nTimeBins)) {
+        if (nPads > 0) {
+          BOOST_CHECK(lastPadPos < padPos);
+        }
+        lastPadPos = padPos;
+        ++nPads;
+
+        BOOST_REQUIRE_EQUAL(nTimeBins, NTimeBins);
+        // find the channel of the pad
+        int halfSampa = -1;
+        int channel = -1;
+        for (int hs = 0; hs < 5; ++hs) {
+          const int sampa = (hs == 4) ? 2 : hs / 2;
+          const int channelStart = (hs == 4) ? 0 : (hs % 2) * 16;
+          for (int k = 0; k < 16; ++k) {
+            if (mapper.padPosRegion(region, link, sampa, channelStart + k) == padPos) {
+              halfSampa = hs;
+              channel = k;
+            }
+          }
+        }
+        BOOST_REQUIRE(halfSampa >= 0);
+        for (int t = 0; t < NTimeBins; ++t) {
+          BOOST_CHECK_EQUAL(data[t], adcValue(halfSampa, channel, t));
+        }
+
+        auto copy = reader.getData(padPos);
+        BOOST_CHECK(std::equal(copy->begin(), copy->end(), data));
+        reader.getNextData(padPos, nTimeBins); // skip it, as getData rewinds to the pad
+      }
+      BOOST_CHECK_EQUAL(nPads, 80);
+    }
+    std::remove(path.c_str());
+  }
+}
+}
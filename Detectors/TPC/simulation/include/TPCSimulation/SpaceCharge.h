@@ -35,6 +35,9 @@
 
 #include <TMatrixT.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "AliTPCSpaceCharge3DCalc.h"
 #include "DataFormatsTPC/Defs.h"
 
@@ -82,6 +85,7 @@ class SpaceCharge
   void init();
 
   /// Calculate distortion and correction lookup tables using AliTPCSpaceChargeCalc class
+  /// The lookup tables for the local ion drift are filled in parallel over the phi slices
   void calculateLookupTables();
   /// Update distortion and correction lookup tables by current space-charge density
   /// \param eventTime time of current event
@@ -114,6 +118,12 @@ class SpaceCharge
   /// Distort electron position using distortion lookup tables
   /// \param point 3D coordinates of the electron
   void distortElectron(GlobalPosition3D& point);
+  /// Correct a batch of electron positions using correction lookup tables
+  /// \param points 3D coordinates of the electrons
+  void correctElectrons(std::vector<GlobalPosition3D>& points);
+  /// Distort a batch of electron positions using distortion lookup tables
+  /// \param points 3D coordinates of the electrons
+  void distortElectrons(std::vector<GlobalPosition3D>& points);
 
   /// Set the space-charge distortions model
   /// \param distortionType distortion type (constant or realistic)
@@ -121,7 +131,32 @@ class SpaceCharge
   /// Get the space-charge distortions model
   SCDistortionType getSCDistortionType() const { return mSCDistortionType; }
 
+  /// Set the number of threads used to calculate the lookup tables and to process batches of electrons
+  /// \param nThreads number of threads, 1 does everything sequentially
+  void setNumberOfThreads(int nThreads) { mNumberOfThreads = std::max(1, nThreads); }
+  /// Get the number of threads used to calculate the lookup tables and to process batches of electrons
+  int getNumberOfThreads() const { return mNumberOfThreads; }
+
  private:
+  /// Index of a grid point in the space-charge density arrays
+  /// \param iz z bin
+  /// \param iphi phi bin
+  /// \param ir r bin
+  size_t densityIndex(int iz, int iphi, int ir) const { return (static_cast<size_t>(iphi) * mNRBins + ir) * mNZSlices + iz; }
+
+  /// Copy the space-charge density into the input matrices of the lookup table calculator
+  /// \param spaceChargeA matrices (r, z) per phi slice for the A side
+  /// \param spaceChargeC matrices (r, z) per phi slice for the C side
+  void copyDensityToMatrices(TMatrixD** spaceChargeA, TMatrixD** spaceChargeC);
+
+  /// Run a function over the index range [0, n), split in contiguous chunks processed by mNumberOfThreads threads
+  /// \param n size of the index range
+  /// \param minChunkSize minimum number of indices per thread
+  /// \param function callable with signature (size_t begin, size_t end)
+  template <typename Function>
+  void parallelFor(size_t n, size_t minChunkSize, Function&& function) const;
+
+
   /// Convert amount of ions into charge density C/m^3
   /// \param nIons number of ions
   /// \return space-charge density (C/m^3)
@@ -140,6 +175,8 @@ class SpaceCharge
   static constexpr float RadiusInner = 85.;     //! inner radius of the TPC active area
   static constexpr float RadiusOuter = 245.;    //! outer radius of the TPC active area
 
+  static constexpr size_t MinElectronsPerThread = 4096; //! minimum number of electrons per thread when processing batches
+
   const int mInterpolationOrder; ///< order for interpolation of lookup tables: 2==quadratic, >2==cubic spline
 
   const int mNZSlices;          ///< number of z slices used in lookup tables
@@ -158,12 +195,14 @@ class SpaceCharge
   bool mInitLookUpTables;             ///< Flag to indicate if lookup tables have been calculated
   float mTimeInit;                    ///< time of last update of lookup tables
   SCDistortionType mSCDistortionType; ///< Type of space-charge distortions
+  int mNumberOfThreads;               ///< number of threads used to calculate the lookup tables and to process batches of electrons
 
   AliTPCSpaceCharge3DCalc mLookUpTableCalculator; ///< object to calculate and store correction and distortion lookup tables
 
-  /// TODO: check fastest way to order std::vectors
-  std::vector<std::vector<float>> mSpaceChargeDensityA; ///< space-charge density on the A side, stored in C/m^3 (z)(phi*r), ordering: z=[0,250], ir+iphi*nRBins
-  std::vector<std::vector<float>> mSpaceChargeDensityC; ///< space-charge density on the C side, stored in C/m^3 (z)(phi*r), ordering: z=[0,-250], ir+iphi*nRBins
+  /// The densities are stored contiguously with z running fastest, so that each phi slice maps one to one onto the
+  /// (r, z) matrices used by the lookup tables, see densityIndex
+  std::vector<float> mSpaceChargeDensityA; ///< space-charge density on the A side, stored in C/m^3 (phi)(r)(z), z=[0,250]
+  std::vector<float> mSpaceChargeDensityC; ///< space-charge density on the C side, stored in C/m^3 (phi)(r)(z), z=[0,-250]
 
   /// TODO: Eliminate the need for these matrices as members, they will be owned by AliTPCLookUpTable3DInterpolatorD. AliTPCLookUpTable3DInterpolatorD needs getters for the matrices and the constructor has to be modified.
   TMatrixD** mMatrixLocalIonDriftDzA;                                      ///< matrix to store local ion drift in z direction along E field on A side
@@ -12,6 +12,9 @@
 /// \brief Implementation of the interface for the ALICE TPC space-charge distortions calculations
 /// \author Ernst Hellbär, Goethe-Universität Frankfurt, ernst.hellbar@cern.ch
 
+#include <future>
+#include <thread>
+
 #include "TGeoGlobalMagField.h"
 #include "TH3.h"
 #include "TMath.h"
@@ -31,6 +34,23 @@ using namespace o2::TPC;
 
 const float o2::TPC::SpaceCharge::sEzField = (AliTPCPoissonSolver::fgkCathodeV - AliTPCPoissonSolver::fgkGG) / AliTPCPoissonSolver::fgkTPCZ0;
 
+template <typename Function>
+void SpaceCharge::parallelFor(size_t n, size_t minChunkSize, Function&& function) const
+{
+  const size_t nThreads = std::max(size_t(1), std::min(size_t(mNumberOfThreads), n / std::max(size_t(1), minChunkSize)));
+  const size_t chunkSize = (n + nThreads - 1) / nThreads;
+  std::vector<std::future<void>> workers;
+  for (size_t thread = 1; thread < nThreads; ++thread) {
+    const size_t begin = std::min(n, thread * chunkSize);
+    const size_t end = std::min(n, begin + chunkSize);
+    workers.emplace_back(std::async(std::launch::async, function, begin, end));
+  }
+  function(0, std::min(n, chunkSize));
+  for (auto& worker : workers) {
+    worker.get();
+  }
+}
+
 SpaceCharge::SpaceCharge()
   : mNZSlices(MaxZSlices),
     mNPhiBins(MaxPhiBins),
@@ -47,9 +67,8 @@ SpaceCharge::SpaceCharge()
     mInitLookUpTables(false),
     mTimeInit(-1),
     mSCDistortionType(SpaceCharge::SCDistortionType::SCDistortionsRealistic),
-    mLookUpTableCalculator(Constants::MAXGLOBALPADROW, MaxZSlices, MaxPhiBins, 2, 3, 0),
-    mSpaceChargeDensityA(MaxZSlices),
-    mSpaceChargeDensityC(MaxZSlices)
+    mNumberOfThreads(std::max(1u, std::thread::hardware_concurrency())),
+    mLookUpTableCalculator(Constants::MAXGLOBALPADROW, MaxZSlices, MaxPhiBins, 2, 3, 0)
 {
   allocateMemory();
 }
@@ -70,9 +89,8 @@ SpaceCharge::SpaceCharge(int nZSlices, int nPhiBins, int nRBins)
     mInitLookUpTables(false),
     mTimeInit(-1),
     mSCDistortionType(SpaceCharge::SCDistortionType::SCDistortionsRealistic),
-    mLookUpTableCalculator(nRBins, nZSlices, nPhiBins, 2, 3, 0),
-    mSpaceChargeDensityA(nZSlices),
-    mSpaceChargeDensityC(nZSlices)
+    mNumberOfThreads(std::max(1u, std::thread::hardware_concurrency())),
+    mLookUpTableCalculator(nRBins, nZSlices, nPhiBins, 2, 3, 0)
 {
   allocateMemory();
 }
@@ -93,19 +111,17 @@ SpaceCharge::SpaceCharge(int nZSlices, int nPhiBins, int nRBins, int interpolati
     mInitLookUpTables(false),
     mTimeInit(-1),
     mSCDistortionType(SpaceCharge::SCDistortionType::SCDistortionsRealistic),
-    mLookUpTableCalculator(nRBins, nZSlices, nPhiBins, interpolationOrder, 3, 0),
-    mSpaceChargeDensityA(nZSlices),
-    mSpaceChargeDensityC(nZSlices)
+    mNumberOfThreads(std::max(1u, std::thread::hardware_concurrency())),
+    mLookUpTableCalculator(nRBins, nZSlices, nPhiBins, interpolationOrder, 3, 0)
 {
   allocateMemory();
 }
 
 void SpaceCharge::allocateMemory()
 {
-  for (auto i = 0; i < mNZSlices; ++i) {
-    mSpaceChargeDensityA[i].resize(mNPhiBins * mNRBins);
-    mSpaceChargeDensityC[i].resize(mNPhiBins * mNRBins);
-  }
+  const size_t nGridPoints = static_cast<size_t>(mNZSlices) * mNPhiBins * mNRBins;
+  mSpaceChargeDensityA.assign(nGridPoints, 0.f);
+  mSpaceChargeDensityC.assign(nGridPoints, 0.f);
 
   for (int iz = 0; iz < mNZSlices; ++iz)
     mCoordZ[iz] = (iz + 1) * mLengthZSlice;
@@ -156,41 +172,44 @@ void SpaceCharge::calculateLookupTables()
   mLookUpTableCalculator.ForceInitSpaceCharge3DPoissonIntegralDz(mNRBins, mNZSlices, mNPhiBins, 300, 1e-8);
 
   // Lookup tables for local ion drift along E field
+  // The electric field lookup tables are only read here, so that the phi slices can be filled in parallel
   if (mSCDistortionType == SCDistortionType::SCDistortionsRealistic) {
-    for (int iphi = 0; iphi < mNPhiBins; ++iphi) {
-      float phi = mCoordPhi[iphi];
-      TMatrixD& matrixDzA = *mMatrixLocalIonDriftDzA[iphi];
-      TMatrixD& matrixDzC = *mMatrixLocalIonDriftDzC[iphi];
-      TMatrixD& matrixDrphiA = *mMatrixLocalIonDriftDrphiA[iphi];
-      TMatrixD& matrixDrphiC = *mMatrixLocalIonDriftDrphiC[iphi];
-      TMatrixD& matrixDrA = *mMatrixLocalIonDriftDrA[iphi];
-      TMatrixD& matrixDrC = *mMatrixLocalIonDriftDrC[iphi];
-      int roc = o2::utils::Angle2Sector(phi);
-      for (int ir = 0; ir < mNRBins; ++ir) {
-        float radius = mCoordR[ir];
-        for (int iz = 0; iz < mNZSlices; ++iz) {
-          // A side
-          float z = mCoordZ[iz];
-          float x0[3] = { radius, phi, z };
-          float x1[3] = { radius, phi, z - mLengthZSlice };
-          double eVector0[3] = { 0.f, 0.f, 0.f };
-          double eVector1[3] = { 0.f, 0.f, 0.f };
-          mLookUpTableCalculator.GetElectricFieldCyl(x0, roc, eVector0);
-          mLookUpTableCalculator.GetElectricFieldCyl(x1, roc, eVector1);
-          matrixDzA(ir, iz) = DvDEoverv0 * (mLengthZSlice / 2.f) * (eVector0[2] + eVector1[2]);
-          matrixDrphiA(ir, iz) = (mLengthZSlice / 2.f) * (eVector0[1] + eVector1[1]) / sEzField;
-          matrixDrA(ir, iz) = (mLengthZSlice / 2.f) * (eVector0[0] + eVector1[0]) / sEzField;
-          // C side
-          x0[2] *= -1;
-          x1[2] *= -1;
-          mLookUpTableCalculator.GetElectricFieldCyl(x0, roc + 18, eVector0);
-          mLookUpTableCalculator.GetElectricFieldCyl(x1, roc + 18, eVector1);
-          matrixDzC(ir, iz) = DvDEoverv0 * (mLengthZSlice / 2.f) * (eVector0[2] + eVector1[2]);
-          matrixDrphiC(ir, iz) = (mLengthZSlice / 2.f) * (eVector0[1] + eVector1[1]) / sEzField;
-          matrixDrC(ir, iz) = (mLengthZSlice / 2.f) * (eVector0[0] + eVector1[0]) / sEzField;
+    parallelFor(mNPhiBins, 1, [this](size_t firstPhiBin, size_t lastPhiBin) {
+      for (size_t iphi = firstPhiBin; iphi < lastPhiBin; ++iphi) {
+        float phi = mCoordPhi[iphi];
+        TMatrixD& matrixDzA = *mMatrixLocalIonDriftDzA[iphi];
+        TMatrixD& matrixDzC = *mMatrixLocalIonDriftDzC[iphi];
+        TMatrixD& matrixDrphiA = *mMatrixLocalIonDriftDrphiA[iphi];
+        TMatrixD& matrixDrphiC = *mMatrixLocalIonDriftDrphiC[iphi];
+        TMatrixD& matrixDrA = *mMatrixLocalIonDriftDrA[iphi];
+        TMatrixD& matrixDrC = *mMatrixLocalIonDriftDrC[iphi];
+        int roc = o2::utils::Angle2Sector(phi);
+        for (int ir = 0; ir < mNRBins; ++ir) {
+          float radius = mCoordR[ir];
+          for (int iz = 0; iz < mNZSlices; ++iz) {
+            // A side
+            float z = mCoordZ[iz];
+            float x0[3] = { radius, phi, z };
+            float x1[3] = { radius, phi, z - mLengthZSlice };
+            double eVector0[3] = { 0.f, 0.f, 0.f };
+            double eVector1[3] = { 0.f, 0.f, 0.f };
+            mLookUpTableCalculator.GetElectricFieldCyl(x0, roc, eVector0);
+            mLookUpTableCalculator.GetElectricFieldCyl(x1, roc, eVector1);
+            matrixDzA(ir, iz) = DvDEoverv0 * (mLengthZSlice / 2.f) * (eVector0[2] + eVector1[2]);
+            matrixDrphiA(ir, iz) = (mLengthZSlice / 2.f) * (eVector0[1] + eVector1[1]) / sEzField;
+            matrixDrA(ir, iz) = (mLengthZSlice / 2.f) * (eVector0[0] + eVector1[0]) / sEzField;
+            // C side
+            x0[2] *= -1;
+            x1[2] *= -1;
+            mLookUpTableCalculator.GetElectricFieldCyl(x0, roc + 18, eVector0);
+            mLookUpTableCalculator.GetElectricFieldCyl(x1, roc + 18, eVector1);
+            matrixDzC(ir, iz) = DvDEoverv0 * (mLengthZSlice / 2.f) * (eVector0[2] + eVector1[2]);
+            matrixDrphiC(ir, iz) = (mLengthZSlice / 2.f) * (eVector0[1] + eVector1[1]) / sEzField;
+            matrixDrC(ir, iz) = (mLengthZSlice / 2.f) * (eVector0[0] + eVector1[0]) / sEzField;
+          }
         }
       }
-    }
+    });
     mLookUpLocalIonDriftA->CopyFromMatricesToInterpolator();
     mLookUpLocalIonDriftC->CopyFromMatricesToInterpolator();
 
@@ -209,31 +228,34 @@ void SpaceCharge::updateLookupTables(float eventTime)
     return; // update only after one time bin has passed
   }
 
+  mTimeInit = eventTime;
+
   std::unique_ptr<std::unique_ptr<TMatrixD>[]> spaceChargeA = std::make_unique<std::unique_ptr<TMatrixD>[]>(mNPhiBins);
   std::unique_ptr<std::unique_ptr<TMatrixD>[]> spaceChargeC = std::make_unique<std::unique_ptr<TMatrixD>[]>(mNPhiBins);
   for (int iphi = 0; iphi < mNPhiBins; ++iphi) {
     spaceChargeA[iphi] = std::make_unique<TMatrixD>(mNRBins, mNZSlices);
     spaceChargeC[iphi] = std::make_unique<TMatrixD>(mNRBins, mNZSlices);
   }
-  for (int iside = 0; iside < 2; ++iside) {
-    for (int iphi = 0; iphi < mNPhiBins; ++iphi) {
-      TMatrixD& chargeDensity = iside == 0 ? *spaceChargeA[iphi] : *spaceChargeC[iphi];
-      for (int ir = 0; ir < mNRBins; ++ir) {
-        for (int iz = 0; iz < mNZSlices; ++iz) {
-          if (iside == 0) {
-            chargeDensity(ir, iz) = mSpaceChargeDensityA[iz][ir + iphi * mNRBins];
-          } else {
-            chargeDensity(ir, iz) = mSpaceChargeDensityC[iz][ir + iphi * mNRBins];
-          }
-        }
-      }
-    }
-  }
+  copyDensityToMatrices((TMatrixD**)spaceChargeA.get(), (TMatrixD**)spaceChargeC.get());
   mLookUpTableCalculator.SetInputSpaceChargeA((TMatrixD**)spaceChargeA.get());
   mLookUpTableCalculator.SetInputSpaceChargeC((TMatrixD**)spaceChargeC.get());
   calculateLookupTables();
 }
 
+void SpaceCharge::copyDensityToMatrices(TMatrixD** spaceChargeA, TMatrixD** spaceChargeC)
+{
+  // Both the density and the matrices have z running fastest, so each phi slice is a single contiguous copy
+  parallelFor(mNPhiBins, 1, [this, spaceChargeA, spaceChargeC](size_t firstPhiBin, size_t lastPhiBin) {
+    const size_t nSliceBins = static_cast<size_t>(mNRBins) * mNZSlices;
+    for (size_t iphi = firstPhiBin; iphi < lastPhiBin; ++iphi) {
+      const auto densityA = mSpaceChargeDensityA.begin() + densityIndex(0, iphi, 0);
+      const auto densityC = mSpaceChargeDensityC.begin() + densityIndex(0, iphi, 0);
+      std::copy(densityA, densityA + nSliceBins, spaceChargeA[iphi]->GetMatrixArray());
+      std::copy(densityC, densityC + nSliceBins, spaceChargeC[iphi]->GetMatrixArray());
+    }
+  });
+}
+
 void SpaceCharge::setOmegaTauT1T2(float omegaTau, float t1, float t2)
 {
   mLookUpTableCalculator.SetOmegaTauT1T2(omegaTau, t1, t2);
@@ -248,20 +270,15 @@ void SpaceCharge::setInitialSpaceChargeDensity(TH3* hisSCDensity)
     spaceChargeC[iphi] = std::make_unique<TMatrixD>(mNRBins, mNZSlices);
   }
   mLookUpTableCalculator.GetChargeDensity((TMatrixD**)spaceChargeA.get(), (TMatrixD**)spaceChargeC.get(), hisSCDensity, mNRBins, mNZSlices, mNPhiBins);
-  for (int iside = 0; iside < 2; ++iside) {
-    for (int iphi = 0; iphi < mNPhiBins; ++iphi) {
-      TMatrixD& chargeDensity = iside == 0 ? *spaceChargeA[iphi] : *spaceChargeC[iphi];
-      for (int ir = 0; ir < mNRBins; ++ir) {
-        for (int iz = 0; iz < mNZSlices; ++iz) {
-          if (iside == 0) {
-            mSpaceChargeDensityA[iz][ir + iphi * mNRBins] = chargeDensity(ir, iz);
-          } else {
-            mSpaceChargeDensityC[iz][ir + iphi * mNRBins] = chargeDensity(ir, iz);
-          }
-        }
-      }
+  parallelFor(mNPhiBins, 1, [this, &spaceChargeA, &spaceChargeC](size_t firstPhiBin, size_t lastPhiBin) {
+    const size_t nSliceBins = static_cast<size_t>(mNRBins) * mNZSlices;
+    for (size_t iphi = firstPhiBin; iphi < lastPhiBin; ++iphi) {
+      const double* chargeDensityA = spaceChargeA[iphi]->GetMatrixArray();
+      const double* chargeDensityC = spaceChargeC[iphi]->GetMatrixArray();
+      std::copy(chargeDensityA, chargeDensityA + nSliceBins, mSpaceChargeDensityA.begin() + densityIndex(0, iphi, 0));
+      std::copy(chargeDensityC, chargeDensityC + nSliceBins, mSpaceChargeDensityC.begin() + densityIndex(0, iphi, 0));
     }
-  }
+  });
   mLookUpTableCalculator.SetInputSpaceChargeA((TMatrixD**)spaceChargeA.get());
   mLookUpTableCalculator.SetInputSpaceChargeC((TMatrixD**)spaceChargeC.get());
   mUseInitialSCDensity = true;
@@ -273,9 +290,9 @@ void SpaceCharge::fillSCDensity(float zPos, float phiPos, float rPos, int nIons)
   const int phiBin = phiPos / mWidthPhiBin;
   const int rBin = rPos / mLengthRBin;
   if (zPos > 0) {
-    mSpaceChargeDensityA[zBin][rBin + phiBin * mNRBins] += ions2Charge(nIons);
+    mSpaceChargeDensityA[densityIndex(zBin, phiBin, rBin)] += ions2Charge(nIons);
   } else {
-    mSpaceChargeDensityC[zBin][rBin + phiBin * mNRBins] += ions2Charge(nIons);
+    mSpaceChargeDensityC[densityIndex(zBin, phiBin, rBin)] += ions2Charge(nIons);
   }
 }
 
@@ -330,6 +347,30 @@ void SpaceCharge::distortElectron(GlobalPosition3D& point)
   point = GlobalPosition3D(x[0] + dx[0], x[1] + dx[1], x[2] + dx[2]);
 }
 
+void SpaceCharge::correctElectrons(std::vector<GlobalPosition3D>& points)
+{
+  if (!mInitLookUpTables) {
+    return;
+  }
+  parallelFor(points.size(), MinElectronsPerThread, [this, &points](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      correctElectron(points[i]);
+    }
+  });
+}
+
+void SpaceCharge::distortElectrons(std::vector<GlobalPosition3D>& points)
+{
+  if (!mInitLookUpTables) {
+    return;
+  }
+  parallelFor(points.size(), MinElectronsPerThread, [this, &points](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      distortElectron(points[i]);
+    }
+  });
+}
+
 float SpaceCharge::ions2Charge(int nIons)
 {
   return 1.e6f * nIons * TMath::Qe() / (mLengthZSlice * (mWidthPhiBin * mLengthRBin) * mLengthRBin);
@@ -0,0 +1,90 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchmark_SpaceCharge.cxx
+/// \brief Benchmark of the space-charge lookup table calculation and of the electron distortions
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "TPCSimulation/SpaceCharge.h"
+
+using namespace o2::TPC;
+
+namespace
+{
+/// Space-charge handler with a random ion density filled in
+std::unique_ptr<SpaceCharge> createSpaceCharge(int nZSlices, int nPhiBins, int nRBins, int nThreads)
+{
+  auto spaceCharge = std::make_unique<SpaceCharge>(nZSlices, nPhiBins, nRBins);
+  spaceCharge->setOmegaTauT1T2(0.32, 1., 1.);
+  spaceCharge->setNumberOfThreads(nThreads);
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> z(-249.f, 249.f);
+  std::uniform_real_distribution<float> phi(0.f, 6.28f);
+  std::uniform_real_distribution<float> r(85.f, 245.f);
+  for (int i = 0; i < 100000; ++i) {
+    spaceCharge->fillSCDensity(z(generator), phi(generator), r(generator), 100);
+  }
+  return spaceCharge;
+}
+} // namespace
+
+// Update of the lookup tables after one time slice, on a (z, phi, r) grid of
+// (state.range(0), state.range(1), state.range(0)) with state.range(2) threads
+static void BM_updateLookupTables(benchmark::State& state)
+{
+  auto spaceCharge = createSpaceCharge(state.range(0), state.range(1), state.range(0), state.range(2));
+  float time = 0.f;
+  spaceCharge->updateLookupTables(time);
+  for (auto _ : state) {
+    time += 1.e5f;
+    spaceCharge->updateLookupTables(time);
+  }
+}
+
+// Distortion of state.range(0) electrons one by one
+static void BM_distortElectron(benchmark::State& state)
+{
+  auto spaceCharge = createSpaceCharge(65, 90, 65, 1);
+  spaceCharge->updateLookupTables(0.f);
+  spaceCharge->updateLookupTables(1.e5f);
+  std::vector<GlobalPosition3D> points(state.range(0), GlobalPosition3D(100.f, 20.f, 120.f));
+  for (auto _ : state) {
+    for (auto& point : points) {
+      spaceCharge->distortElectron(point);
+    }
+    benchmark::DoNotOptimize(points.data());
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+// Distortion of state.range(0) electrons as a batch with state.range(1) threads
+static void BM_distortElectrons(benchmark::State& state)
+{
+  auto spaceCharge = createSpaceCharge(65, 90, 65, state.range(1));
+  spaceCharge->updateLookupTables(0.f);
+  spaceCharge->updateLookupTables(1.e5f);
+  std::vector<GlobalPosition3D> points(state.range(0), GlobalPosition3D(100.f, 20.f, 120.f));
+  for (auto _ : state) {
+    spaceCharge->distortElectrons(points);
+    benchmark::DoNotOptimize(points.data());
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+BENCHMARK(BM_updateLookupTables)->Args({ 65, 90, 1 })->Args({ 65, 90, 4 })->Args({ 129, 180, 1 })->Args({ 129, 180, 4 })->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_distortElectron)->Arg(1 << 16);
+BENCHMARK(BM_distortElectrons)->Args({ 1 << 16, 1 })->Args({ 1 << 16, 4 })->UseRealTime();
+
+BENCHMARK_MAIN()
@@ -0,0 +1,42 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_TPC_CALIBWORKFLOW_H
+#define O2_TPC_CALIBWORKFLOW_H
+/// @file   CalibWorkflow.h
+/// @brief  Workflow definition for the TPC pedestal and pulser calibration
+
+#include "Framework/WorkflowSpec.h"
+#include <vector>
+#include <string>
+
+namespace o2
+{
+namespace TPC
+{
+
+namespace CalibWorkflow
+{
+/// the supported calibrations
+enum struct CalibType { Pedestal,
+                        Pulser };
+
+/// create the workflow for the TPC pedestal or pulser calibration
+/// the digits of @a tpcSectors are distributed among @a nLanes processes, the
+/// partial results of all lanes are merged in one process at the end of data
+framework::WorkflowSpec getWorkflow(std::vector<int> const& tpcSectors, //
+                                    unsigned nLanes,                    //
+                                    std::string const& cfgCalib         //
+                                    );
+
+} // end namespace CalibWorkflow
+} // end namespace TPC
+} // end namespace o2
+#endif //O2_TPC_CALIBWORKFLOW_H
@@ -65,6 +65,7 @@ DataProcessorSpec getCATrackerSpec(bool processMC, std::vector<int> const& input
 
   auto initFunction = [processMC, inputIds](InitContext& ic) {
     auto options = ic.options().get<std::string>("tracker-options");
+    auto nThreads = ic.options().get<int>("tracker-output-threads");
 
     auto processAttributes = std::make_shared<ProcessAttributes>();
     {
@@ -76,6 +77,7 @@ DataProcessorSpec getCATrackerSpec(bool processMC, std::vector<int> const& input
       if (tracker->initialize(options.c_str()) != 0) {
         throw std::invalid_argument("TPCCATracking initialization failed");
       }
+      tracker->setNumberOfThreads(nThreads);
       processAttributes->validInputs.reset();
       processAttributes->validMcInputs.reset();
     }
@@ -327,6 +329,7 @@ DataProcessorSpec getCATrackerSpec(bool processMC, std::vector<int> const& input
                             AlgorithmSpec(initFunction),
                             Options{
                               { "tracker-options", VariantType::String, "", { "Option string passed to tracker" } },
+                              { "tracker-output-threads", VariantType::Int, 1, { "Number of threads converting the tracker output" } },
                             } };
 }
 
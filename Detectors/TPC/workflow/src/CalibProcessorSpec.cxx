@@ -0,0 +1,190 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   CalibProcessorSpec.cxx
+/// @brief  spec definitions for the TPC pedestal and pulser calibration processes
+
+#include "CalibProcessorSpec.h"
+#include "Framework/ControlService.h"
+#include "Framework/ConfigParamRegistry.h"
+#include "Framework/DataRefUtils.h"
+#include "Headers/DataHeader.h"
+#include "TPCBase/Digit.h"
+#include "TPCCalibration/CalibPedestal.h"
+#include "TPCCalibration/CalibPulser.h"
+#include "DataFormatsTPC/TPCSectorHeader.h"
+#include <FairMQLogger.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace o2::framework;
+using namespace o2::header;
+
+namespace o2
+{
+namespace TPC
+{
+
+namespace
+{
+/// what is specific to each type of calibration
+template <typename Calib>
+struct CalibTraits;
+
+template <>
+struct CalibTraits<CalibPedestal> {
+  static constexpr const char* name = "pedestal";
+  static constexpr const char* defaultFileName = "pedestal.root";
+
+  static Options options()
+  {
+    return Options{
+      { "statistics-type", VariantType::String, "mean", { "how to extract pedestal and noise: mean or gaus (batched fit), both run per ROC in parallel" } },
+    };
+  }
+
+  static void configure(CalibPedestal& calib, ConfigParamRegistry const& options)
+  {
+    auto type = options.get<std::string>("statistics-type");
+    if (type == "gaus") {
+      calib.setStatisticsType(CalibPedestal::StatisticsType::GausFit);
+    } else if (type == "mean") {
+      calib.setStatisticsType(CalibPedestal::StatisticsType::MeanStdDev);
+    } else {
+      throw std::invalid_argument("invalid statistics type: " + type);
+    }
+  }
+};
+
+template <>
+struct CalibTraits<CalibPulser> {
+  static constexpr const char* name = "pulser";
+  static constexpr const char* defaultFileName = "pulser.root";
+
+  static Options options() { return Options{}; }
+
+  static void configure(CalibPulser&, ConfigParamRegistry const&) {}
+};
+
+template <typename Calib>
+DataProcessorSpec makeCalibProcessorSpec(int lane)
+{
+  std::string processorName = std::string("tpc-calib-") + CalibTraits<Calib>::name + "-" + std::to_string(lane);
+  DataHeader::SubSpecificationType subSpec = lane;
+
+  auto initFunction = [subSpec](InitContext& ic) {
+    auto calib = std::make_shared<Calib>();
+    auto finished = std::make_shared<bool>(false);
+
+    auto processingFct = [calib, finished, subSpec](ProcessingContext& pc) {
+      if (*finished) {
+        return;
+      }
+      auto dataref = pc.inputs().get("digits");
+      auto const* sectorHeader = DataRefUtils::getHeader<o2::TPC::TPCSectorHeader*>(dataref);
+      if (sectorHeader == nullptr) {
+        LOG(ERROR) << "sector header missing on header stack";
+        return;
+      }
+      // sector number -1 indicates end-of-data, -2 no-operation, see PublisherSpec.cxx
+      if (sectorHeader->sector == -1) {
+        // the partial result only contains the sums accumulated so far, so that
+        // it is cheap to send and the merging does not depend on the order
+        pc.outputs().snapshot(Output{ gDataOriginTPC, "CALIBPARTIAL", subSpec, Lifetime::Timeframe }, calib->getPartialData());
+        *finished = true;
+        pc.services().get<ControlService>().readyToQuit(false);
+        return;
+      } else if (sectorHeader->sector < 0) {
+        return;
+      }
+      auto digits = pc.inputs().get<const std::vector<o2::TPC::Digit>>("digits");
+      calib->processDigits(digits);
+    };
+    return processingFct;
+  };
+
+  return DataProcessorSpec{ processorName,
+                            Inputs{ InputSpec{ "digits", gDataOriginTPC, "DIGITS", subSpec, Lifetime::Timeframe } },
+                            Outputs{ OutputSpec{ gDataOriginTPC, "CALIBPARTIAL", subSpec, Lifetime::Timeframe } },
+                            AlgorithmSpec(initFunction) };
+}
+
+template <typename Calib>
+DataProcessorSpec makeCalibMergerSpec(std::vector<int> const& lanes)
+{
+  std::string processorName = std::string("tpc-calib-") + CalibTraits<Calib>::name + "-merger";
+
+  auto initFunction = [](InitContext& ic) {
+    auto outfile = ic.options().get<std::string>("outfile");
+    auto nThreads = ic.options().get<int>("nthreads");
+    auto calib = std::make_shared<Calib>();
+    CalibTraits<Calib>::configure(*calib, ic.options());
+    if (nThreads > 0) {
+      calib->setNumberOfThreads(nThreads);
+    }
+
+    auto processingFct = [calib, outfile](ProcessingContext& pc) {
+      size_t nPartials = 0;
+      for (auto const& ref : pc.inputs()) {
+        auto const* dataHeader = DataRefUtils::getHeader<o2::header::DataHeader*>(ref);
+        calib->mergePartialData(ref.payload, dataHeader->payloadSize);
+        ++nPartials;
+      }
+      // the ROCs are analysed in parallel by the calibration object
+      calib->analyse();
+      calib->dumpToFile(outfile);
+      LOG(INFO) << "calibration from " << nPartials << " lane(s) written to " << outfile;
+      pc.services().get<ControlService>().readyToQuit(true);
+    };
+    return processingFct;
+  };
+
+  Inputs inputs;
+  for (auto lane : lanes) {
+    DataHeader::SubSpecificationType subSpec = lane;
+    inputs.emplace_back(InputSpec{ "partial" + std::to_string(lane), gDataOriginTPC, "CALIBPARTIAL", subSpec, Lifetime::Timeframe });
+  }
+
+  Options options{
+    { "outfile", VariantType::String, CalibTraits<Calib>::defaultFileName, { "Name of the output file" } },
+    { "nthreads", VariantType::Int, 0, { "Number of threads to analyse the ROCs, 0 for all cores" } },
+  };
+  for (auto& option : CalibTraits<Calib>::options()) {
+    options.push_back(option);
+  }
+
+  return DataProcessorSpec{ processorName,
+                            inputs,
+                            Outputs{},
+                            AlgorithmSpec(initFunction),
+                            options };
+}
+} // namespace
+
+DataProcessorSpec getCalibProcessorSpec(CalibWorkflow::CalibType type, int lane)
+{
+  if (type == CalibWorkflow::CalibType::Pedestal) {
+    return makeCalibProcessorSpec<CalibPedestal>(lane);
+  }
+  return makeCalibProcessorSpec<CalibPulser>(lane);
+}
+
+DataProcessorSpec getCalibMergerSpec(CalibWorkflow::CalibType type, std::vector<int> const& lanes)
+{
+  if (type == CalibWorkflow::CalibType::Pedestal) {
+    return makeCalibMergerSpec<CalibPedestal>(lanes);
+  }
+  return makeCalibMergerSpec<CalibPulser>(lanes);
+}
+
+} // end namespace TPC
+} // end namespace o2
@@ -0,0 +1,34 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   CalibProcessorSpec.h
+/// @brief  spec definitions for the TPC pedestal and pulser calibration processes
+
+#include "Framework/DataProcessorSpec.h"
+#include "TPCWorkflow/CalibWorkflow.h"
+#include <vector>
+
+namespace o2
+{
+namespace TPC
+{
+
+/// create a processor spec
+/// accumulates the calibration data of the digits published on subspecification
+/// @a lane, and sends the partial result at the end of data
+framework::DataProcessorSpec getCalibProcessorSpec(CalibWorkflow::CalibType type, int lane);
+
+/// create a processor spec
+/// merges the partial results of all @a lanes, extracts the calibration and
+/// writes it to file
+framework::DataProcessorSpec getCalibMergerSpec(CalibWorkflow::CalibType type, std::vector<int> const& lanes);
+
+} // end namespace TPC
+} // end namespace o2
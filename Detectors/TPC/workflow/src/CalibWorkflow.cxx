@@ -0,0 +1,77 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   CalibWorkflow.cxx
+/// @brief  Workflow definition for the TPC pedestal and pulser calibration
+
+#include "Framework/WorkflowSpec.h"
+#include "TPCWorkflow/CalibWorkflow.h"
+#include "PublisherSpec.h"
+#include "CalibProcessorSpec.h"
+
+#include <numeric> // std::iota
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace o2
+{
+namespace TPC
+{
+namespace CalibWorkflow
+{
+
+using namespace framework;
+
+const std::unordered_map<std::string, CalibType> CalibMap{
+  { "pedestal", CalibType::Pedestal },
+  { "pulser", CalibType::Pulser },
+};
+
+framework::WorkflowSpec getWorkflow(std::vector<int> const& tpcSectors, unsigned nLanes, std::string const& cfgCalib)
+{
+  CalibType calibType;
+  try {
+    calibType = CalibMap.at(cfgCalib);
+  } catch (std::out_of_range&) {
+    throw std::invalid_argument(std::string("invalid calibration type: ") + cfgCalib);
+  }
+  if (nLanes == 0) {
+    throw std::invalid_argument("need at least one processing lane");
+  }
+
+  // the publisher distributes the sectors round robin among the lanes
+  std::vector<int> lanes(nLanes);
+  std::iota(lanes.begin(), lanes.end(), 0);
+
+  WorkflowSpec specs;
+  specs.emplace_back(o2::TPC::getPublisherSpec(PublisherConf{
+                                                 "tpc-digit-reader",
+                                                 "o2sim",
+                                                 { "digitbranch", "TPCDigit", "Digit branch" },
+                                                 { "mcbranch", "TPCDigitMCTruth", "MC label branch" },
+                                                 OutputSpec{ "TPC", "DIGITS" },
+                                                 OutputSpec{ "TPC", "DIGITSMCTR" },
+                                                 tpcSectors,
+                                                 lanes,
+                                               },
+                                               false));
+
+  for (auto lane : lanes) {
+    specs.emplace_back(getCalibProcessorSpec(calibType, lane));
+  }
+  specs.emplace_back(getCalibMergerSpec(calibType, lanes));
+
+  return specs;
+}
+
+} // end namespace CalibWorkflow
+} // end namespace TPC
+} // end namespace o2
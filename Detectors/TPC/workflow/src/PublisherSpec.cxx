@@ -59,6 +59,8 @@ DataProcessorSpec getPublisherSpec(PublisherConf const& config, bool propagateMC
     auto clbrName = ic.options().get<std::string>(config.databranch.option.c_str());
     auto mcbrName = ic.options().get<std::string>(config.mcbranch.option.c_str());
     auto nofEvents = ic.options().get<int>("nevents");
+    auto readAhead = ic.options().get<int>("read-ahead");
+    auto readAheadThreads = ic.options().get<int>("read-ahead-threads");
 
     auto processAttributes = std::make_shared<ProcessAttributes>();
     {
@@ -113,6 +115,9 @@ DataProcessorSpec getPublisherSpec(PublisherConf const& config, bool propagateMC
                                                              clusterbranchname.c_str() // name of cluster branch
                                                              );
         }
+        if (readAhead > 0) {
+          readers[sector]->setReadAhead(readAhead, readAheadThreads);
+        }
         if (++outputId == outputIds.end()) {
           outputId = outputIds.begin();
         }
@@ -218,6 +223,8 @@ DataProcessorSpec getPublisherSpec(PublisherConf const& config, bool propagateMC
                               { mcb.option.c_str(), VariantType::String, mcb.defval.c_str(), { mcb.help.c_str() } },
                               { "nevents", VariantType::Int, -1, { "number of events to run" } },
                               { "terminate-on-eod", VariantType::Bool, true, { "terminate on end-of-data" } },
+                              { "read-ahead", VariantType::Int, 0, { "number of entries to prefetch in the background, 0 disables read-ahead" } },
+                              { "read-ahead-threads", VariantType::Int, 1, { "number of threads reading entries ahead" } },
                             } };
 }
 } // end namespace TPC
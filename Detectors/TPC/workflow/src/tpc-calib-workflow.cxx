@@ -0,0 +1,49 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   tpc-calib-workflow.cxx
+/// @brief  DPL workflow for the TPC pedestal and pulser calibration starting from digits
+
+#include "Framework/WorkflowSpec.h"
+#include "Framework/ConfigParamSpec.h"
+#include "TPCWorkflow/CalibWorkflow.h"
+#include "Algorithm/RangeTokenizer.h"
+
+#include <string>
+#include <vector>
+
+// add workflow options, note that customization needs to be declared before
+// including Framework/runDataProcessing
+void customize(std::vector<o2::framework::ConfigParamSpec>& workflowOptions)
+{
+  std::vector<o2::framework::ConfigParamSpec> options{
+    { "calib-type", o2::framework::VariantType::String, "pedestal", { "pedestal, pulser" } },
+    { "tpc-sectors", o2::framework::VariantType::String, "0-35", { "TPC sector range, e.g. 5-7,8,9" } },
+    { "tpc-lanes", o2::framework::VariantType::Int, 1, { "number of parallel lanes accumulating the calibration data" } },
+  };
+  std::swap(workflowOptions, options);
+}
+
+#include "Framework/runDataProcessing.h" // the main driver
+
+using namespace o2::framework;
+
+/// Defines the workflow for the TPC pedestal and pulser calibration
+/// - digit reader
+/// - calibration lanes, accumulating partial results
+/// - merger, extracting the calibration from the merged partial results
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  auto tpcSectors = o2::RangeTokenizer::tokenize<int>(cfgc.options().get<std::string>("tpc-sectors"));
+  return o2::TPC::CalibWorkflow::getWorkflow(tpcSectors,                                  //
+                                             cfgc.options().get<int>("tpc-lanes"),        //
+                                             cfgc.options().get<std::string>("calib-type") //
+                                             );
+}
@@ -12,6 +12,10 @@
 #define o2_framework_readers_AODReaderHelpers_INCLUDED_H
 
 #include "Framework/AlgorithmSpec.h"
+#include "Headers/DataHeader.h"
+
+#include <string>
+#include <vector>
 
 namespace o2
 {
@@ -20,8 +24,30 @@ namespace framework
 namespace readers
 {
 
+/// Description of a table which the AOD reader can provide, i.e.
+/// which tree of the AOD file and which of its branches make up the
+/// columns. The column types are taken from the branches.
+struct AODTableSpec {
+  header::DataDescription description;
+  std::string treeName;
+  /// branches to be read, all branches of the tree if empty
+  std::vector<std::string> columns;
+};
+
 struct AODReaderHelpers {
+  /// The reader sends the requested tables in chunks of at most
+  /// aod-chunk-size rows, one chunk of each table per timeslice. A table
+  /// which has been read completely is sent empty until all tables are
+  /// done, then the reader is ready to quit.
   static AlgorithmSpec rootFileReaderCallback();
+
+  /// Make a table known to the AOD reader, replacing an earlier
+  /// definition for the same description. Needs to happen before the
+  /// workflow is run.
+  static void registerTable(AODTableSpec const& spec);
+
+  /// @return the registered table for @a description, nullptr if unknown
+  static AODTableSpec const* findTable(header::DataDescription const& description);
 };
 
 } // namespace readers
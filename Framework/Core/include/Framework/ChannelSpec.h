@@ -32,13 +32,24 @@ enum struct ChannelType {
   Pull,
 };
 
+/// How the two ends of a channel talk to each other. Devices on the same
+/// host use IPC, with the payloads in shared memory, while TCP is only
+/// used for channels which cross hosts.
+enum struct ChannelProtocol {
+  Network,
+  IPC
+};
+
 /// This describes an input channel. Since they are point to 
 /// point connections, there is not much to say about them.
 struct InputChannelSpec {
   std::string name;
   enum ChannelType type;
   enum ChannelMethod method;
+  /// The host on which the port is bound
+  std::string hostname;
   unsigned short port;
+  enum ChannelProtocol protocol = ChannelProtocol::Network;
 };
 
 /// This describes an output channel. Output channels are semantically
@@ -50,8 +61,11 @@ struct OutputChannelSpec {
   std::string name;
   enum ChannelType type;
   enum ChannelMethod method;
+  /// The host on which the port is bound
+  std::string hostname;
   unsigned short port;
   size_t listeners;
+  enum ChannelProtocol protocol = ChannelProtocol::Network;
 };
 
 } // namespace framework
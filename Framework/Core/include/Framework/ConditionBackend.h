@@ -0,0 +1,89 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef FRAMEWORK_CONDITIONBACKEND_H
+#define FRAMEWORK_CONDITIONBACKEND_H
+
+#include "Headers/DataHeader.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace o2
+{
+namespace framework
+{
+
+/// A condition object as returned by a ConditionBackend: the serialised
+/// object, how it was serialised and the interval [validFrom, validUntil) in
+/// which it is valid, in milliseconds since epoch.
+struct ConditionBlob {
+  std::vector<char> data;
+  uint64_t validFrom = 0;
+  uint64_t validUntil = 0;
+  o2::header::SerializationMethod serialization = o2::header::gSerializationMethodROOT;
+};
+
+/// Where condition objects are fetched from when they are not in the
+/// ConditionCache.
+class ConditionBackend
+{
+public:
+  virtual ~ConditionBackend() = default;
+
+  /// Fetch the object at @a path which is valid at @a timestamp.
+  /// @return false if there is no such object.
+  virtual bool fetch(std::string const& path, uint64_t timestamp, ConditionBlob& blob) = 0;
+
+  /// Create the backend for @a url. "file://<directory>" gives a
+  /// FileConditionBackend, anything else is considered to be the URL of a
+  /// CCDB REST server. An empty @a url gives no backend, so that only what
+  /// is already in the cache can be used.
+  static std::unique_ptr<ConditionBackend> create(std::string const& url);
+};
+
+/// Fetches objects from a CCDB REST server, i.e. via
+/// GET <url>/<path>/<timestamp>. The validity is taken from the Valid-From
+/// and Valid-Until headers of the reply, the serialization method from the
+/// Serialization metadata of the object (ROOT if missing, which is what
+/// CcdbApi stores).
+class CCDBConditionBackend : public ConditionBackend
+{
+public:
+  CCDBConditionBackend(std::string const& url);
+  bool fetch(std::string const& path, uint64_t timestamp, ConditionBlob& blob) override;
+
+private:
+  std::string mUrl;
+};
+
+/// Local, file based, stand-in for a CCDB REST server. The object at
+/// <path> valid in [from, until) is the file <directory>/<path>/<from>_<until>.
+/// If more than one is valid, the one with the latest start of validity
+/// wins, like in CCDB. A non ROOT serialization method is stored in
+/// <from>_<until>.serialization.
+class FileConditionBackend : public ConditionBackend
+{
+public:
+  FileConditionBackend(std::string const& directory);
+  bool fetch(std::string const& path, uint64_t timestamp, ConditionBlob& blob) override;
+
+  /// Store @a blob at @a path, so that it can be fetched later on.
+  void store(std::string const& path, ConditionBlob const& blob);
+
+private:
+  std::string mDirectory;
+};
+
+} // namespace framework
+} // namespace o2
+
+#endif // FRAMEWORK_CONDITIONBACKEND_H
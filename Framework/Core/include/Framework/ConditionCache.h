@@ -0,0 +1,111 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef FRAMEWORK_CONDITIONCACHE_H
+#define FRAMEWORK_CONDITIONCACHE_H
+
+#include "Framework/ConditionBackend.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace o2
+{
+namespace framework
+{
+
+/// A read only, memory mapped, condition object in the cache. The mapping
+/// is released when the last reference to it goes away.
+class MappedCondition
+{
+public:
+  MappedCondition(std::string const& filename, uint64_t validFrom, uint64_t validUntil,
+                  o2::header::SerializationMethod serialization);
+  ~MappedCondition();
+
+  MappedCondition(MappedCondition const&) = delete;
+  MappedCondition& operator=(MappedCondition const&) = delete;
+
+  char const* data() const { return mData; }
+  size_t size() const { return mSize; }
+  uint64_t validFrom() const { return mValidFrom; }
+  uint64_t validUntil() const { return mValidUntil; }
+  /// How the object was serialised, as given by the metadata of the object.
+  o2::header::SerializationMethod serialization() const { return mSerialization; }
+  bool isValid(uint64_t timestamp) const { return timestamp >= mValidFrom && timestamp < mValidUntil; }
+
+private:
+  char const* mData = nullptr;
+  size_t mSize = 0;
+  uint64_t mValidFrom;
+  uint64_t mValidUntil;
+  o2::header::SerializationMethod mSerialization;
+};
+
+/// Per host cache for condition objects. Each object is stored in
+/// <directory>/objects/<hash>, where <hash> is a hash of its key, i.e. of
+/// its path and validity. The full key is stored next to it, in
+/// <directory>/objects/<hash>.key, and compared on lookup, so that a
+/// collision cannot hand out the wrong object. <directory>/index/<path>
+/// records which object is valid for which interval, so that different
+/// processes on the same host can share what has been fetched. Objects are
+/// memory mapped, so that they can be handed out without copies, and kept
+/// mapped as long as they are in use.
+class ConditionCache
+{
+public:
+  /// @a directory is where the cache is stored, the default one is used if
+  /// it is empty. It must belong to the current user and not be writable by
+  /// anybody else. @a backend is where objects not in the cache are fetched
+  /// from.
+  ConditionCache(std::string const& directory, std::unique_ptr<ConditionBackend> backend);
+
+  /// Get the object at @a path valid at @a timestamp, fetching it from the
+  /// backend only if no process on this host did so already.
+  /// @return nullptr if the object does not exist.
+  std::shared_ptr<MappedCondition> get(std::string const& path, uint64_t timestamp);
+
+  /// The directory of the cache, i.e. $O2_CONDITION_CACHE if set,
+  /// $XDG_RUNTIME_DIR/o2-condition-cache if that is set,
+  /// /tmp/o2-condition-cache-<uid> otherwise.
+  static std::string defaultDirectory();
+
+  std::string const& directory() const { return mDirectory; }
+
+private:
+  struct Entry {
+    uint64_t validFrom;
+    uint64_t validUntil;
+    std::string object; // the name of the object in <directory>/objects
+    o2::header::SerializationMethod serialization;
+    std::weak_ptr<MappedCondition> mapped;
+    bool mismatch = false; // the object turned out to have a different key
+  };
+
+  Entry* findEntry(std::string const& path, uint64_t timestamp);
+  void readIndex(std::string const& path);
+  std::string indexFilename(std::string const& path) const;
+  std::shared_ptr<MappedCondition> map(std::string const& path, Entry& entry);
+  std::string store(std::string const& key, ConditionBlob const& blob);
+
+  std::string mDirectory;
+  std::unique_ptr<ConditionBackend> mBackend;
+  std::map<std::string, std::vector<Entry>> mEntries;
+  std::mutex mMutex;
+};
+
+} // namespace framework
+} // namespace o2
+
+#endif // FRAMEWORK_CONDITIONCACHE_H
@@ -74,6 +74,11 @@ class DataAllocator
 
   DataChunk adoptChunk(const Output&, char*, size_t, fairmq_free_fn*, void*);
 
+  /// Send the content of an already existing @a payload message as @a spec.
+  /// If the transport of the output channel matches the one of @a payload,
+  /// the underlying buffer is shared (reference counted) rather than copied.
+  void forwardMessage(const Output& spec, FairMQMessage const& payload, o2::header::SerializationMethod method);
+
   // In case no extra argument is provided and the passed type is trivially
   // copyable and non polymorphic, the most likely wanted behavior is to create
   // a message with that type, and so we do.
@@ -285,12 +290,13 @@ class DataAllocator
   typename std::enable_if<has_root_dictionary<T>::value == true && is_messageable<T>::value == false, void>::type
     snapshot(const Output& spec, T& object)
   {
+    std::string channel = matchDataHeader(spec, mTimingInfo->timeslice);
     auto proxy = mContextRegistry->get<RootObjectContext>()->proxy();
-    FairMQMessagePtr payloadMessage(proxy.createMessage());
+    FairMQMessagePtr payloadMessage(proxy.createMessage(channel, 0));
     auto* cl = TClass::GetClass(typeid(T));
     TMessageSerializer().Serialize(*payloadMessage, &object, cl);
 
-    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodROOT);
+    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodROOT, channel);
   }
 
   /// Explicitely ROOT serialize a snapshot of @a object when called,
@@ -310,8 +316,9 @@ class DataAllocator
                     std::is_void<typename W::hint_type>::value,             //
                   "class hint must be of type TClass or const char");
 
+    std::string channel = matchDataHeader(spec, mTimingInfo->timeslice);
     auto proxy = mContextRegistry->get<RootObjectContext>()->proxy();
-    FairMQMessagePtr payloadMessage(proxy.createMessage());
+    FairMQMessagePtr payloadMessage(proxy.createMessage(channel, 0));
     const TClass* cl = nullptr;
     if (wrapper.getHint() == nullptr) {
       // get TClass info by wrapped type
@@ -333,7 +340,7 @@ class DataAllocator
       throw std::runtime_error(msg);
     }
     TMessageSerializer().Serialize(*payloadMessage, &wrapper(), cl);
-    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodROOT);
+    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodROOT, channel);
   }
 
   /// Serialize a snapshot of a trivially copyable, non-polymorphic @a object,
@@ -346,11 +353,12 @@ class DataAllocator
   typename std::enable_if<is_messageable<T>::value == true, void>::type
     snapshot(const Output& spec, T const& object)
   {
+    std::string channel = matchDataHeader(spec, mTimingInfo->timeslice);
     auto proxy = mContextRegistry->get<MessageContext>()->proxy();
-    FairMQMessagePtr payloadMessage(proxy.createMessage(sizeof(T)));
+    FairMQMessagePtr payloadMessage(proxy.createMessage(channel, 0, sizeof(T)));
     memcpy(payloadMessage->GetData(), &object, sizeof(T));
 
-    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodNone);
+    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodNone, channel);
   }
 
   /// Serialize a snapshot of a std::vector of trivially copyable, non-polymorphic
@@ -363,14 +371,15 @@ class DataAllocator
                           is_messageable<typename C::value_type>::value == true>::type
     snapshot(const Output& spec, C const& v)
   {
+    std::string channel = matchDataHeader(spec, mTimingInfo->timeslice);
     auto proxy = mContextRegistry->get<MessageContext>()->proxy();
     auto sizeInBytes = sizeof(typename C::value_type) * v.size();
-    FairMQMessagePtr payloadMessage(proxy.createMessage(sizeInBytes));
+    FairMQMessagePtr payloadMessage(proxy.createMessage(channel, 0, sizeInBytes));
 
     typename C::value_type* tmp = const_cast<typename C::value_type*>(v.data());
     memcpy(payloadMessage->GetData(), reinterpret_cast<void*>(tmp), sizeInBytes);
 
-    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodNone);
+    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodNone, channel);
   }
 
   /// Serialize a snapshot of a std::vector of pointers to trivially copyable,
@@ -387,8 +396,9 @@ class DataAllocator
     using ElementType = typename std::remove_pointer<typename C::value_type>::type;
     constexpr auto elementSizeInBytes = sizeof(ElementType);
     auto sizeInBytes = elementSizeInBytes * v.size();
+    std::string channel = matchDataHeader(spec, mTimingInfo->timeslice);
     auto proxy = mContextRegistry->get<MessageContext>()->proxy();
-    FairMQMessagePtr payloadMessage(proxy.createMessage(sizeInBytes));
+    FairMQMessagePtr payloadMessage(proxy.createMessage(channel, 0, sizeInBytes));
 
     auto target = reinterpret_cast<unsigned char*>(payloadMessage->GetData());
     for (auto const& pointer : v) {
@@ -396,7 +406,7 @@ class DataAllocator
       target += elementSizeInBytes;
     }
 
-    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodNone);
+    addPartToContext(std::move(payloadMessage), spec, o2::header::gSerializationMethodNone, channel);
   }
 
   /// specialization to catch unsupported types and throw a detailed compiler error
@@ -488,9 +498,11 @@ class DataAllocator
                                            size_t payloadSize);                                 //
 
   Output getOutputByBind(OutputRef&& ref);
+  /// @a channel is the one matching @a spec, where @a payload was created for
   void addPartToContext(FairMQMessagePtr&& payload,
                         const Output& spec,
-                        o2::header::SerializationMethod serializationMethod);
+                        o2::header::SerializationMethod serializationMethod,
+                        std::string const& channel);
 };
 
 } // namespace framework
@@ -64,6 +64,10 @@ struct DataProcessorSpec {
   /// put, but this is actually to be handled in the actual DeviceSpec.
   size_t inputTimeSliceId = 0;
   size_t maxInputTimeslices = 1;
+  /// Expected rate of messages sent by this DataProcessor, in Hz. This is
+  /// only a hint, used to keep the devices which exchange the most data
+  /// close to each other. 0 if unknown.
+  float messageRate = 0.f;
 };
 
 } // namespace framework
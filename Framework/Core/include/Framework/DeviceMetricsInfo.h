@@ -11,6 +11,8 @@
 #ifndef FRAMEWORK_DEVICEMETRICSINFO_H
 #define FRAMEWORK_DEVICEMETRICSINFO_H
 
+#include "Framework/MetricHistory.h"
+
 #include <array>
 #include <cstddef>
 #include <functional>
@@ -67,18 +69,25 @@ struct ParsedMetricMatch {
 /// This struct hold information about device metrics when running
 /// in standalone mode
 struct DeviceMetricsInfo {
-  // We keep the size of each metric to 4096 bytes. No need for more
-  // for the debug GUI
-  std::vector<std::array<int, 1024>> intMetrics;
+  // Only the most recent updates of each metric are kept uncompressed,
+  // older ones are found in the history below.
+  static constexpr size_t RECENT_METRICS_SIZE = 256;
+  std::vector<std::array<int, RECENT_METRICS_SIZE>> intMetrics;
   std::vector<std::array<StringMetric, 32>> stringMetrics; // We do not keep so many strings as metrics as history is less relevant.
-  std::vector<std::array<float, 1024>> floatMetrics;
-  std::vector<std::array<size_t, 1024>> timestamps;
+  std::vector<std::array<float, RECENT_METRICS_SIZE>> floatMetrics;
+  std::vector<std::array<size_t, RECENT_METRICS_SIZE>> timestamps;
   std::vector<float> max;
   std::vector<float> min;
   std::vector<size_t> minDomain;
   std::vector<size_t> maxDomain;
   std::vector<MetricLabelIndex> metricLabelsIdx;
   std::vector<MetricInfo> metrics;
+  // Longer term, compressed, history for numeric metrics, one entry per
+  // metric (empty for string metrics). The GUI uses its rollups to display
+  // what is older than the buffers above.
+  std::vector<MetricHistory> history;
+  // Retention and downsampling used for the history of new metrics.
+  MetricHistoryOptions historyOptions;
 };
 
 struct DeviceMetricsHelper {
@@ -51,6 +51,14 @@ struct DeviceSpec {
   size_t inputTimesliceId;
   /// The completion policy to use for this device.
   CompletionPolicy completionPolicy;
+  /// The host this device runs on. Empty if not known in advance.
+  std::string hostname;
+  /// Expected rate of messages sent by this device, in Hz. 0 if unknown.
+  float messageRate = 0.f;
+  /// The NUMA node the device was placed on, -1 if it was not placed.
+  int numaNode = -1;
+  /// The cores the device is pinned to. Empty if it is not pinned.
+  std::vector<int> cores;
 };
 
 } // namespace framework
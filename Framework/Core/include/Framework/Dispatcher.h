@@ -46,8 +46,9 @@ class Dispatcher : public Task
   Outputs getOutputSpecs();
 
  private:
-  void send(DataAllocator& dataAllocator, const DataRef& inputData, const Output& output) const;
-  void sendFairMQ(FairMQDevice* device, const DataRef& inputData, const std::string& fairMQChannel) const;
+  void send(DataAllocator& dataAllocator, const DataRef& inputData, FairMQMessage* payload, const Output& output) const;
+  void sendFairMQ(FairMQDevice* device, const DataRef& inputData, FairMQMessage* payload, const std::string& fairMQChannel) const;
+  void matchPolicies(const InputRecord& inputs);
 
   std::string mName;
   std::string mReconfigurationSource;
@@ -55,6 +56,8 @@ class Dispatcher : public Task
   Outputs outputs;
   // policies should be shared between all pipeline threads
   std::vector<std::shared_ptr<DataSamplingPolicy>> mPolicies;
+  // policies matching each of the input routes, computed once
+  std::vector<std::vector<DataSamplingPolicy*>> mPoliciesByRoute;
 };
 
 } // namespace framework
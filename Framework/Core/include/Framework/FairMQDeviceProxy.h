@@ -37,10 +37,11 @@ public:
   }
 
   /// Looks like what we really need in the headers is just the transport.
-  FairMQTransportFactory* getTransport();
+  /// Channels can use a different transport than the device, so messages
+  /// must always be created with the one of the channel they go to.
   FairMQTransportFactory* getTransport(const std::string& channel, int index);
-  std::unique_ptr<FairMQMessage> createMessage() const;
-  std::unique_ptr<FairMQMessage> createMessage(const size_t size) const;
+  std::unique_ptr<FairMQMessage> createMessage(const std::string& channel, int index) const;
+  std::unique_ptr<FairMQMessage> createMessage(const std::string& channel, int index, const size_t size) const;
 private:
   FairMQDevice* mDevice;
 };
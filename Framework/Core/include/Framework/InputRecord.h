@@ -158,6 +158,17 @@ class InputRecord
     }
   }
 
+  /// The message holding the payload at position @a pos, so that it can be
+  /// shared rather than copied. nullptr if the input is not available or if
+  /// the record is not backed by FairMQ messages.
+  FairMQMessage* getPayloadMessageByPos(int pos) const
+  {
+    if (pos * 2 + 1 > mSpan.size() || pos < 0) {
+      throw std::runtime_error("Unknown message requested at position " + std::to_string(pos));
+    }
+    return mSpan.getMessage(pos * 2 + 1);
+  }
+
   /// Generic function to extract a messageable type by reference
   /// Cast content of payload bound by @a binding to known type.
   /// Will not be used for types needing extra serialization
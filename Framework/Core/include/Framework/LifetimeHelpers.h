@@ -44,10 +44,17 @@ struct LifetimeHelpers {
   static ExpirationHandler::Handler doNothing();
 
   /// Build a fetcher for an object from CCDB when the record is expired.
-  /// @a prefix is the lookup prefix in CCDB.
-  /// FIXME: actually implement the fetching
+  /// @a prefix is the lookup prefix in CCDB, @a backend the URL of the CCDB
+  /// (or file://<directory> for a local one) and @a cacheDirectory where
+  /// the objects are cached on this host (the default one if empty). The
+  /// created messages match @a matcher and use the transport of @a sourceChannel.
+  /// Throws std::runtime_error if @a backend is empty.
   /// FIXME: provide a way to customize the namespace from the ProcessingContext
-  static ExpirationHandler::Handler fetchFromCCDBCache(std::string const& prefix);
+  static ExpirationHandler::Handler fetchFromCCDBCache(ConcreteDataMatcher const& matcher,
+                                                       std::string const& prefix,
+                                                       std::string const& backend,
+                                                       std::string const& cacheDirectory,
+                                                       std::string const& sourceChannel);
 
   /// Create an entry in the registry for histograms on the first
   /// FIXME: actually implement this
@@ -0,0 +1,239 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef FRAMEWORK_METRICHISTORY_H
+#define FRAMEWORK_METRICHISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+namespace o2
+{
+namespace framework
+{
+
+/// Configuration of the long term history kept for each metric.
+/// All the intervals are expressed in the same unit as the metric
+/// timestamps (i.e. milliseconds).
+struct MetricHistoryOptions {
+  /// How long compressed samples are kept around
+  size_t retention = 4 * 3600 * 1000;
+  /// How many samples are encoded in a single block before
+  /// sealing it. Retention is applied on a block basis.
+  size_t samplesPerBlock = 512;
+  /// Width of the buckets used for the downsampled view
+  size_t rollupInterval = 10 * 1000;
+  /// How many rollup buckets are kept. Oldest ones get overwritten.
+  size_t rollupCapacity = 4 * 360;
+};
+
+/// A downsampled summary of all the samples falling in
+/// [timestamp, timestamp + MetricHistoryOptions::rollupInterval)
+struct MetricRollup {
+  size_t timestamp;
+  float min;
+  float max;
+  float sum;
+  uint32_t count;
+};
+
+/// Append only bitstream. Bits are packed starting from the least
+/// significant one of each word.
+struct MetricBitWriter {
+  std::vector<uint64_t> words;
+  size_t size = 0;
+
+  void write(uint64_t value, unsigned int nBits)
+  {
+    if (nBits == 0) {
+      return;
+    }
+    if (nBits < 64) {
+      value &= (uint64_t(1) << nBits) - 1;
+    }
+    size_t offset = size & 63;
+    if (offset == 0) {
+      words.push_back(0);
+    }
+    words.back() |= value << offset;
+    if (offset + nBits > 64) {
+      words.push_back(value >> (64 - offset));
+    }
+    size += nBits;
+  }
+};
+
+struct MetricBitReader {
+  uint64_t const* words;
+  size_t pos = 0;
+
+  uint64_t read(unsigned int nBits)
+  {
+    if (nBits == 0) {
+      return 0;
+    }
+    size_t offset = pos & 63;
+    uint64_t const* word = words + (pos >> 6);
+    uint64_t value = word[0] >> offset;
+    if (offset + nBits > 64) {
+      value |= word[1] << (64 - offset);
+    }
+    if (nBits < 64) {
+      value &= (uint64_t(1) << nBits) - 1;
+    }
+    pos += nBits;
+    return value;
+  }
+
+  bool readBit() { return read(1) != 0; }
+};
+
+/// A sequence of samples compressed using delta-of-delta encoding for
+/// the timestamps and XOR encoding for the (32 bits) value, as
+/// described in the Facebook Gorilla paper. The first sample is kept
+/// uncompressed in the block header.
+struct MetricHistoryBlock {
+  size_t firstTimestamp = 0;
+  size_t lastTimestamp = 0;
+  size_t minTimestamp = 0; // Timestamps are not guaranteed to be monotonic
+  size_t maxTimestamp = 0;
+  uint32_t firstValue = 0;
+  uint32_t lastValue = 0;
+  int64_t lastDelta = 0;
+  uint32_t count = 0;
+  uint8_t leading = 0xff; // leading zeros of the last XOR window, 0xff if none
+  uint8_t trailing = 0;
+  MetricBitWriter bits;
+
+  void append(size_t timestamp, uint32_t value);
+
+  /// Invoke @a callback(timestamp, value) for every sample in the block.
+  template <typename F>
+  void decode(F&& callback) const;
+};
+
+/// Columnar, compressed, time series storage for a single metric. Samples
+/// are appended in O(1) to the current block, sealed blocks older than
+/// the configured retention are dropped. A ring of fixed size rollups
+/// is kept at the same time so that long ranges can be displayed without
+/// decoding the whole history.
+class MetricHistory
+{
+ public:
+  MetricHistory(MetricHistoryOptions const& options = MetricHistoryOptions{});
+
+  void append(size_t timestamp, int value);
+  void append(size_t timestamp, float value);
+
+  /// Invoke @a callback(timestamp, value) for every sample which is still
+  /// retained and whose timestamp is in [begin, end]. @a T must be the
+  /// same type (int or float) which was used when appending.
+  template <typename T, typename F>
+  void forEach(size_t begin, size_t end, F&& callback) const;
+
+  /// Number of samples currently retained
+  size_t size() const { return mSize; }
+  /// Approximate memory used by the compressed samples and the rollups, in bytes
+  size_t bytes() const;
+  /// Timestamp of the oldest retained sample
+  size_t firstTimestamp() const { return mBlocks.empty() ? 0 : mBlocks.front().firstTimestamp; }
+  /// Timestamp of the last appended sample
+  size_t lastTimestamp() const { return mBlocks.empty() ? 0 : mBlocks.back().lastTimestamp; }
+
+  /// Number of valid rollups
+  size_t rollupsSize() const { return mRollupsSize; }
+  /// @return the @a i-th rollup, starting from the oldest one
+  MetricRollup const& rollup(size_t i) const
+  {
+    return mRollups[(mRollupsHead + mRollups.size() - mRollupsSize + i) % mRollups.size()];
+  }
+
+  MetricHistoryOptions const& options() const { return mOptions; }
+
+ private:
+  void appendBits(size_t timestamp, uint32_t bits, float value);
+  void updateRollups(size_t timestamp, float value);
+
+  MetricHistoryOptions mOptions;
+  std::deque<MetricHistoryBlock> mBlocks;
+  size_t mSize = 0;
+  std::vector<MetricRollup> mRollups;
+  size_t mRollupsHead = 0; // Where the next rollup will be created
+  size_t mRollupsSize = 0;
+};
+
+template <typename F>
+void MetricHistoryBlock::decode(F&& callback) const
+{
+  if (count == 0) {
+    return;
+  }
+  size_t timestamp = firstTimestamp;
+  uint32_t value = firstValue;
+  int64_t delta = 0;
+  unsigned int blockLeading = 0;
+  unsigned int blockTrailing = 0;
+  callback(timestamp, value);
+
+  MetricBitReader reader{ bits.words.data() };
+  for (uint32_t i = 1; i < count; ++i) {
+    // Timestamp
+    int64_t dod = 0;
+    if (reader.readBit()) {
+      if (!reader.readBit()) {
+        dod = int64_t(reader.read(7)) - 63;
+      } else if (!reader.readBit()) {
+        dod = int64_t(reader.read(9)) - 255;
+      } else if (!reader.readBit()) {
+        dod = int64_t(reader.read(12)) - 2047;
+      } else {
+        dod = int64_t(reader.read(64));
+      }
+    }
+    delta += dod;
+    timestamp += delta;
+    // Value
+    if (reader.readBit()) {
+      if (reader.readBit()) {
+        blockLeading = reader.read(5);
+        unsigned int length = reader.read(5) + 1;
+        blockTrailing = 32 - blockLeading - length;
+      }
+      value ^= uint32_t(reader.read(32 - blockLeading - blockTrailing)) << blockTrailing;
+    }
+    callback(timestamp, value);
+  }
+}
+
+template <typename T, typename F>
+void MetricHistory::forEach(size_t begin, size_t end, F&& callback) const
+{
+  static_assert(sizeof(T) == sizeof(uint32_t), "Only 32 bits metrics are supported");
+  for (auto& block : mBlocks) {
+    if (block.maxTimestamp < begin || block.minTimestamp > end) {
+      continue;
+    }
+    block.decode([begin, end, &callback](size_t timestamp, uint32_t bits) {
+      if (timestamp < begin || timestamp > end) {
+        return;
+      }
+      T value;
+      memcpy(&value, &bits, sizeof(T));
+      callback(timestamp, value);
+    });
+  }
+}
+
+} // namespace framework
+} // namespace o2
+
+#endif // FRAMEWORK_METRICHISTORY_H
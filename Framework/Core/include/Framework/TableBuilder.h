@@ -198,7 +198,7 @@ class TableBuilder
     if (nColumns != columnNames.size()) {
       throw std::runtime_error("Mismatching number of column types and names");
     }
-    if (mBuilders != nullptr) {
+    if (mBuilders != nullptr || mFinalizer) {
       throw std::runtime_error("TableBuilder::persist can only be invoked once per instance");
     }
     mArrays.resize(nColumns);
@@ -229,6 +229,22 @@ class TableBuilder
     };
   }
 
+  /// Use columns which have been built outside of the TableBuilder, e.g.
+  /// because their types are only known at runtime. The arrays must
+  /// match the fields of the schema.
+  void adopt(std::shared_ptr<arrow::Schema> schema, std::vector<std::shared_ptr<arrow::Array>>&& arrays)
+  {
+    if (mBuilders != nullptr || mFinalizer) {
+      throw std::runtime_error("TableBuilder::adopt can not be combined with persist");
+    }
+    if (static_cast<size_t>(schema->num_fields()) != arrays.size()) {
+      throw std::runtime_error("Mismatching number of fields and arrays");
+    }
+    mSchema = schema;
+    mArrays = std::move(arrays);
+    mFinalizer = []() {};
+  }
+
   /// Actually creates the arrow::Table from the builders
   std::shared_ptr<arrow::Table> finalize();
 
@@ -9,15 +9,242 @@
 // or submit itself to any jurisdiction.
 
 #include "Framework/AODReaderHelpers.h"
-#include "Framework/RootTableBuilderHelpers.h"
+#include "Framework/TableBuilder.h"
 #include "Framework/AlgorithmSpec.h"
+#include "Framework/ControlService.h"
 #include "Framework/DeviceSpec.h"
-#include <ROOT/RDataFrame.hxx>
+
+#include <arrow/builder.h>
+#include <arrow/type.h>
+
+#include <TBranch.h>
 #include <TFile.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
 
 namespace o2::framework::readers
 {
 
+namespace
+{
+
+std::vector<AODTableSpec>& tableRegistry()
+{
+  static std::vector<AODTableSpec> registry{
+    { header::DataDescription{ "TRACKPAR" },
+      "O2tracks",
+      { "fID4Tracks", "fX", "fAlpha", "fY", "fZ", "fSnp", "fTgl", "fSigned1Pt" } },
+    { header::DataDescription{ "TRACKPARCOV" },
+      "O2tracks",
+      { "fCYY", "fCZY", "fCZZ", "fCSnpY", "fCSnpZ", "fCSnpSnp", "fCTglSnp", "fCTglTgl",
+        "fC1PtY", "fC1PtZ", "fC1PtSnp", "fC1PtTgl", "fC1Pt21Pt2" } },
+    { header::DataDescription{ "TRACKEXTRA" },
+      "O2tracks",
+      { "fTPCinnerP", "fFlags", "fITSClusterMap", "fTPCncls", "fTRDntracklets", "fITSchi2Ncl",
+        "fTPCchi2Ncl", "fTRDchi2", "fTOFchi2", "fTPCsignal", "fTRDsignal", "fTOFsignal" } },
+    { header::DataDescription{ "CALO" },
+      "O2calo",
+      { "fID4Calo", "fCellNumber", "fAmplitude", "fTime", "fType" } },
+    { header::DataDescription{ "MUON" },
+      "O2mu",
+      { "fID4mu", "fInverseBendingMomentum", "fThetaX", "fThetaY", "fZmu", "fBendingCoor",
+        "fNonBendingCoor", "fCovariances", "fChi2", "fChi2MatchTrigger", "fID4vz" } },
+    { header::DataDescription{ "VZERO" },
+      "O2vz",
+      { "fAdcVZ", "fTimeVZ", "fWidthVZ" } },
+  };
+  return registry;
+}
+
+void checkStatus(arrow::Status const& status)
+{
+  if (status.ok() == false) {
+    throw std::runtime_error(status.ToString());
+  }
+}
+
+/// Reads one branch of a tree into arrow arrays. Single values are
+/// mapped to the corresponding arrow type, fixed and variable size
+/// arrays to lists.
+class ColumnReader
+{
+ public:
+  virtual ~ColumnReader() = default;
+  virtual std::shared_ptr<arrow::Field> field() const = 0;
+  /// read the entries [first, last) of the branch
+  virtual std::shared_ptr<arrow::Array> read(Long64_t first, Long64_t last) = 0;
+};
+
+template <typename T>
+class TypedColumnReader : public ColumnReader
+{
+ public:
+  using ArrowType = typename detail::ConversionTraits<T>::ArrowType;
+  using BuilderType = typename arrow::TypeTraits<ArrowType>::BuilderType;
+
+  TypedColumnReader(TBranch* branch, TLeaf* leaf)
+    : mBranch{ branch },
+      mLeaf{ leaf },
+      mIsArray{ leaf->GetLeafCount() != nullptr || leaf->GetLenStatic() > 1 }
+  {
+    size_t maxLength = leaf->GetLenStatic();
+    if (leaf->GetLeafCount() != nullptr) {
+      maxLength *= leaf->GetLeafCount()->GetMaximum();
+    }
+    // the branch is read directly into the buffer, from which the
+    // values are appended to the arrow builder
+    mBuffer.resize(std::max<size_t>(maxLength, 1));
+  }
+
+  std::shared_ptr<arrow::Field> field() const override
+  {
+    auto type = arrow::TypeTraits<ArrowType>::type_singleton();
+    return arrow::field(mBranch->GetName(), mIsArray ? arrow::list(type) : type);
+  }
+
+  std::shared_ptr<arrow::Array> read(Long64_t first, Long64_t last) override
+  {
+    // the same branch can be a column of several tables, each with its
+    // own reader, so we point it to our buffer every time we read it
+    mBranch->SetAddress(mBuffer.data());
+    std::shared_ptr<arrow::Array> result;
+    auto builder = std::make_shared<BuilderType>(arrow::default_memory_pool());
+    if (mIsArray == false) {
+      checkStatus(builder->Reserve(last - first));
+      for (Long64_t entry = first; entry < last; ++entry) {
+        readEntry(entry);
+        checkStatus(builder->Append(mBuffer[0]));
+      }
+      checkStatus(builder->Finish(&result));
+      return result;
+    }
+    arrow::ListBuilder listBuilder(arrow::default_memory_pool(), builder);
+    checkStatus(listBuilder.Reserve(last - first));
+    for (Long64_t entry = first; entry < last; ++entry) {
+      readEntry(entry);
+      checkStatus(listBuilder.Append());
+      checkStatus(builder->AppendValues(mBuffer.data(), mLeaf->GetLen()));
+    }
+    checkStatus(listBuilder.Finish(&result));
+    return result;
+  }
+
+ private:
+  void readEntry(Long64_t entry)
+  {
+    if (auto count = mLeaf->GetLeafCount()) {
+      // the length of a variable size array comes from the counter branch
+      count->GetBranch()->GetEntry(entry);
+    }
+    if (mBranch->GetEntry(entry) < 0) {
+      throw std::runtime_error(std::string("Unable to read entry ") + std::to_string(entry) + " of branch " + mBranch->GetName());
+    }
+  }
+
+  TBranch* mBranch;
+  TLeaf* mLeaf;
+  bool mIsArray;
+  std::vector<T> mBuffer;
+};
+
+std::unique_ptr<ColumnReader> makeColumnReader(TBranch* branch)
+{
+  auto leaves = branch->GetListOfLeaves();
+  if (leaves->GetEntriesFast() != 1) {
+    throw std::runtime_error(std::string("Branch ") + branch->GetName() + " does not describe a single column");
+  }
+  auto leaf = static_cast<TLeaf*>(leaves->At(0));
+  std::string type = leaf->GetTypeName();
+  if (type == "Char_t") {
+    return std::make_unique<TypedColumnReader<int8_t>>(branch, leaf);
+  } else if (type == "UChar_t" || type == "Bool_t") {
+    return std::make_unique<TypedColumnReader<uint8_t>>(branch, leaf);
+  } else if (type == "Short_t") {
+    return std::make_unique<TypedColumnReader<int16_t>>(branch, leaf);
+  } else if (type == "UShort_t") {
+    return std::make_unique<TypedColumnReader<uint16_t>>(branch, leaf);
+  } else if (type == "Int_t") {
+    return std::make_unique<TypedColumnReader<int32_t>>(branch, leaf);
+  } else if (type == "UInt_t") {
+    return std::make_unique<TypedColumnReader<uint32_t>>(branch, leaf);
+  } else if (type == "Long64_t") {
+    return std::make_unique<TypedColumnReader<int64_t>>(branch, leaf);
+  } else if (type == "ULong64_t") {
+    return std::make_unique<TypedColumnReader<uint64_t>>(branch, leaf);
+  } else if (type == "Float_t") {
+    return std::make_unique<TypedColumnReader<float>>(branch, leaf);
+  } else if (type == "Double_t") {
+    return std::make_unique<TypedColumnReader<double>>(branch, leaf);
+  }
+  throw std::runtime_error("Unsupported type " + type + " of branch " + branch->GetName());
+}
+
+/// The state of the reading of one table
+struct TableReader {
+  header::DataOrigin origin;
+  header::DataDescription description;
+  header::DataHeader::SubSpecificationType subSpec;
+  Long64_t entries = 0;
+  Long64_t next = 0;
+  std::shared_ptr<arrow::Schema> schema;
+  std::vector<std::unique_ptr<ColumnReader>> columns;
+};
+
+void setupTableReader(TableReader& reader, TFile& file, AODTableSpec const& table)
+{
+  auto tree = dynamic_cast<TTree*>(file.Get(table.treeName.c_str()));
+  if (tree == nullptr) {
+    throw std::runtime_error("Unable to find tree " + table.treeName + " for AOD type " + table.description.as<std::string>());
+  }
+  std::vector<TBranch*> branches;
+  if (table.columns.empty()) {
+    auto list = tree->GetListOfBranches();
+    for (int i = 0; i < list->GetEntriesFast(); ++i) {
+      branches.push_back(static_cast<TBranch*>(list->At(i)));
+    }
+  } else {
+    for (auto& column : table.columns) {
+      auto branch = tree->GetBranch(column.c_str());
+      if (branch == nullptr) {
+        throw std::runtime_error("Unable to find branch " + column + " in tree " + table.treeName);
+      }
+      branches.push_back(branch);
+    }
+  }
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (auto branch : branches) {
+    reader.columns.emplace_back(makeColumnReader(branch));
+    fields.emplace_back(reader.columns.back()->field());
+  }
+  reader.schema = arrow::schema(fields);
+  reader.entries = tree->GetEntries();
+}
+
+} // namespace
+
+void AODReaderHelpers::registerTable(AODTableSpec const& spec)
+{
+  auto& registry = tableRegistry();
+  auto it = std::find_if(registry.begin(), registry.end(), [&spec](AODTableSpec const& table) { return table.description == spec.description; });
+  if (it != registry.end()) {
+    *it = spec;
+  } else {
+    registry.push_back(spec);
+  }
+}
+
+AODTableSpec const* AODReaderHelpers::findTable(header::DataDescription const& description)
+{
+  auto& registry = tableRegistry();
+  auto it = std::find_if(registry.begin(), registry.end(), [&description](AODTableSpec const& table) { return table.description == description; });
+  return it != registry.end() ? &*it : nullptr;
+}
+
 AlgorithmSpec AODReaderHelpers::rootFileReaderCallback()
 {
   auto callback = AlgorithmSpec{ adaptStateful([](ConfigParamRegistry const& options,
@@ -29,142 +256,58 @@ AlgorithmSpec AODReaderHelpers::rootFileReaderCallback()
     } catch (...) {
       LOG(ERROR) << "Unable to open file";
     }
+    Long64_t chunkSize = options.get<int>("aod-chunk-size");
 
-    bool readTracks = false;
-    bool readTracksCov = false;
-    bool readTracksExtra = false;
-    bool readCalo = false;
-    bool readMuon = false;
-    bool readVZ = false;
-    // FIXME: bruteforce but effective.
+    auto tables = std::make_shared<std::vector<TableReader>>();
     for (auto& route : spec.outputs) {
       if (route.matcher.origin != header::DataOrigin{ "AOD" }) {
         continue;
       }
-      auto description = route.matcher.description;
-      if (description == header::DataDescription{ "TRACKPAR" }) {
-        readTracks = true;
-      } else if (description == header::DataDescription{ "TRACKPARCOV" }) {
-        readTracksCov = true;
-      } else if (description == header::DataDescription{ "TRACKEXTRA" }) {
-        readTracksExtra = true;
-      } else if (description == header::DataDescription{ "CALO" }) {
-        readCalo = true;
-      } else if (description == header::DataDescription{ "MUON" }) {
-        readMuon = true;
-      } else if (description == header::DataDescription{ "VZERO" }) {
-        readVZ = true;
-      } else {
+      auto table = findTable(route.matcher.description);
+      if (table == nullptr) {
         throw std::runtime_error(std::string("Unknown AOD type: ") + route.matcher.description.str);
       }
+      // the same output can be routed to more than one consumer
+      auto isSame = [&route](TableReader const& reader) {
+        return reader.description == route.matcher.description && reader.subSpec == route.matcher.subSpec;
+      };
+      if (std::find_if(tables->begin(), tables->end(), isSame) != tables->end()) {
+        continue;
+      }
+      tables->emplace_back();
+      auto& reader = tables->back();
+      reader.origin = route.matcher.origin;
+      reader.description = route.matcher.description;
+      reader.subSpec = route.matcher.subSpec;
+      if (infile.get() != nullptr && infile->IsOpen()) {
+        setupTableReader(reader, *infile, *table);
+      }
     }
 
-    return adaptStateless([readTracks,
-                           readTracksCov,
-                           readTracksExtra,
-                           readCalo,
-                           readMuon,
-                           readVZ,
-                           infile](DataAllocator& outputs) {
+    return adaptStateless([tables, chunkSize, infile](DataAllocator& outputs, ControlService& control) {
       if (infile.get() == nullptr || infile->IsOpen() == false) {
         LOG(ERROR) << "File not found: aod.root";
         return;
       }
 
-      /// FIXME: Substitute here the actual data you want to convert for the AODReader
-      if (readTracks) {
-        std::unique_ptr<TTreeReader> reader = std::make_unique<TTreeReader>("O2tracks", infile.get());
-        auto& trackParBuilder = outputs.make<TableBuilder>(Output{ "AOD", "TRACKPAR" });
-        TTreeReaderValue<int> c0(*reader, "fID4Tracks");
-        TTreeReaderValue<float> c1(*reader, "fX");
-        TTreeReaderValue<float> c2(*reader, "fAlpha");
-        TTreeReaderValue<float> c3(*reader, "fY");
-        TTreeReaderValue<float> c4(*reader, "fZ");
-        TTreeReaderValue<float> c5(*reader, "fSnp");
-        TTreeReaderValue<float> c6(*reader, "fTgl");
-        TTreeReaderValue<float> c7(*reader, "fSigned1Pt");
-        RootTableBuilderHelpers::convertTTree(trackParBuilder, *reader,
-                                              c0, c1, c2, c3, c4, c5, c6, c7);
+      // one chunk of every table per timeslice, so that memory stays bounded
+      // and consumers can start working before the whole file has been read
+      bool done = true;
+      for (auto& reader : *tables) {
+        auto first = reader.next;
+        auto last = chunkSize > 0 ? std::min(first + chunkSize, reader.entries) : reader.entries;
+        std::vector<std::shared_ptr<arrow::Array>> arrays;
+        arrays.reserve(reader.columns.size());
+        for (auto& column : reader.columns) {
+          arrays.emplace_back(column->read(first, last));
+        }
+        auto& builder = outputs.make<TableBuilder>(Output{ reader.origin, reader.description, reader.subSpec });
+        builder.adopt(reader.schema, std::move(arrays));
+        reader.next = last;
+        done = done && last == reader.entries;
       }
-
-      if (readTracksCov) {
-        std::unique_ptr<TTreeReader> covReader = std::make_unique<TTreeReader>("O2tracks", infile.get());
-        TTreeReaderValue<float> c0(*covReader, "fCYY");
-        TTreeReaderValue<float> c1(*covReader, "fCZY");
-        TTreeReaderValue<float> c2(*covReader, "fCZZ");
-        TTreeReaderValue<float> c3(*covReader, "fCSnpY");
-        TTreeReaderValue<float> c4(*covReader, "fCSnpZ");
-        TTreeReaderValue<float> c5(*covReader, "fCSnpSnp");
-        TTreeReaderValue<float> c6(*covReader, "fCTglSnp");
-        TTreeReaderValue<float> c7(*covReader, "fCTglTgl");
-        TTreeReaderValue<float> c8(*covReader, "fC1PtY");
-        TTreeReaderValue<float> c9(*covReader, "fC1PtZ");
-        TTreeReaderValue<float> c10(*covReader, "fC1PtSnp");
-        TTreeReaderValue<float> c11(*covReader, "fC1PtTgl");
-        TTreeReaderValue<float> c12(*covReader, "fC1Pt21Pt2");
-        auto& trackParCovBuilder = outputs.make<TableBuilder>(Output{ "AOD", "TRACKPARCOV" });
-        RootTableBuilderHelpers::convertTTree(trackParCovBuilder, *covReader,
-                                              c0, c1, c2, c3, c4, c5, c6, c7, c8, c9, c10, c11, c12);
-      }
-
-      if (readTracksExtra) {
-        std::unique_ptr<TTreeReader> extraReader = std::make_unique<TTreeReader>("O2tracks", infile.get());
-        TTreeReaderValue<float> c0(*extraReader, "fTPCinnerP");
-        TTreeReaderValue<uint64_t> c1(*extraReader, "fFlags");
-        TTreeReaderValue<unsigned char> c2(*extraReader, "fITSClusterMap");
-        TTreeReaderValue<unsigned short> c3(*extraReader, "fTPCncls");
-        TTreeReaderValue<unsigned char> c4(*extraReader, "fTRDntracklets");
-        TTreeReaderValue<float> c5(*extraReader, "fITSchi2Ncl");
-        TTreeReaderValue<float> c6(*extraReader, "fTPCchi2Ncl");
-        TTreeReaderValue<float> c7(*extraReader, "fTRDchi2");
-        TTreeReaderValue<float> c8(*extraReader, "fTOFchi2");
-        TTreeReaderValue<float> c9(*extraReader, "fTPCsignal");
-        TTreeReaderValue<float> c10(*extraReader, "fTRDsignal");
-        TTreeReaderValue<float> c11(*extraReader, "fTOFsignal");
-        TTreeReaderValue<float> c12(*extraReader, "fLength");
-        auto& extraBuilder = outputs.make<TableBuilder>(Output{ "AOD", "TRACKEXTRA" });
-        RootTableBuilderHelpers::convertTTree(extraBuilder, *extraReader,
-                                              c0, c1, c2, c3, c4, c5, c6, c7, c8, c9, c10, c11);
-      }
-
-      if (readCalo) {
-        std::unique_ptr<TTreeReader> extraReader = std::make_unique<TTreeReader>("O2calo", infile.get());
-        TTreeReaderValue<int> c0(*extraReader, "fID4Calo");
-        TTreeReaderValue<short> c1(*extraReader, "fCellNumber");
-        TTreeReaderValue<float> c2(*extraReader, "fAmplitude");
-        TTreeReaderValue<float> c3(*extraReader, "fTime");
-        TTreeReaderValue<int8_t> c4(*extraReader, "fType");
-        auto& extraBuilder = outputs.make<TableBuilder>(Output{ "AOD", "CALO" });
-        RootTableBuilderHelpers::convertTTree(extraBuilder, *extraReader,
-                                              c0, c1, c2, c3, c4);
-      }
-
-      if (readMuon) {
-        std::unique_ptr<TTreeReader> muReader = std::make_unique<TTreeReader>("O2mu", infile.get());
-        TTreeReaderValue<int> c0(*muReader, "fID4mu");
-        TTreeReaderValue<float> c1(*muReader, "fInverseBendingMomentum");
-        TTreeReaderValue<float> c2(*muReader, "fThetaX");
-        TTreeReaderValue<float> c3(*muReader, "fThetaY");
-        TTreeReaderValue<float> c4(*muReader, "fZmu");
-        TTreeReaderValue<float> c5(*muReader, "fBendingCoor");
-        TTreeReaderValue<float> c6(*muReader, "fNonBendingCoor");
-        TTreeReaderArray<float> c7(*muReader, "fCovariances");
-        TTreeReaderValue<float> c8(*muReader, "fChi2");
-        TTreeReaderValue<float> c9(*muReader, "fChi2MatchTrigger");
-        TTreeReaderValue<int> c10(*muReader, "fID4vz");
-        auto& muBuilder = outputs.make<TableBuilder>(Output{ "AOD", "MUON" });
-        RootTableBuilderHelpers::convertTTree(muBuilder, *muReader,
-                                              c0, c1, c2, c3, c4, c5, c6, c7, c8, c9, c10);
-      }
-
-      if (readVZ) {
-        std::unique_ptr<TTreeReader> vzReader = std::make_unique<TTreeReader>("O2vz", infile.get());
-        TTreeReaderArray<float> c0(*vzReader, "fAdcVZ"); // FIXME: we do not support arrays for now
-        TTreeReaderArray<float> c1(*vzReader, "fTimeVZ");
-        TTreeReaderArray<float> c2(*vzReader, "fWidthVZ");
-        auto& vzBuilder = outputs.make<TableBuilder>(Output{ "AOD", "VZERO" });
-        RootTableBuilderHelpers::convertTTree(vzBuilder, *vzReader,
-                                              c0, c1, c2);
+      if (done) {
+        control.readyToQuit(false);
       }
     });
   }) };
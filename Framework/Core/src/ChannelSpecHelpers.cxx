@@ -11,6 +11,7 @@
 #include <ostream>
 #include <cassert>
 #include <stdexcept>
+#include <unistd.h>
 
 namespace o2
 {
@@ -48,6 +49,48 @@ char const* ChannelSpecHelpers::methodAsUrl(enum ChannelMethod method)
   return (method == ChannelMethod::Bind ? "tcp://*:%d" : "tcp://127.0.0.1:%d");
 }
 
+namespace
+{
+std::string makeUrl(enum ChannelMethod method, enum ChannelProtocol protocol,
+                    std::string const& hostname, unsigned short port)
+{
+  // Ports are allocated uniquely within a workflow also for ipc channels,
+  // so we can use them to name the socket. The pid of the driver, which is
+  // where channels are configured, keeps workflows apart.
+  if (protocol == ChannelProtocol::IPC) {
+    return "ipc:///tmp/o2-dpl-" + std::to_string(getpid()) + "-" + std::to_string(port);
+  }
+  if (method == ChannelMethod::Bind) {
+    return "tcp://*:" + std::to_string(port);
+  }
+  if (hostname.empty() || hostname == "localhost") {
+    return "tcp://127.0.0.1:" + std::to_string(port);
+  }
+  return "tcp://" + hostname + ":" + std::to_string(port);
+}
+} // namespace
+
+std::string ChannelSpecHelpers::channelUrl(InputChannelSpec const& channel)
+{
+  return makeUrl(channel.method, channel.protocol, channel.hostname, channel.port);
+}
+
+std::string ChannelSpecHelpers::channelUrl(OutputChannelSpec const& channel)
+{
+  return makeUrl(channel.method, channel.protocol, channel.hostname, channel.port);
+}
+
+char const* ChannelSpecHelpers::transportAsString(enum ChannelProtocol protocol)
+{
+  switch (protocol) {
+    case ChannelProtocol::Network:
+      return "zeromq";
+    case ChannelProtocol::IPC:
+      return "shmem";
+  }
+  throw std::runtime_error("Unknown ChannelProtocol");
+}
+
 /// Stream operators so that we can use ChannelType with Boost.Test
 std::ostream& operator<<(std::ostream& s, ChannelType const& type)
 {
@@ -12,6 +12,7 @@
 
 #include "Framework/ChannelSpec.h"
 #include <iosfwd>
+#include <string>
 
 namespace o2
 {
@@ -30,6 +31,14 @@ struct ChannelSpecHelpers {
   /// FIXME: currently it only supports tcp://127.0.0.1 and tcp://*, we should
   ///        have the actual address customizable.
   static char const* methodAsUrl(enum ChannelMethod method);
+  /// return the address of the channel, depending on its protocol. IPC
+  /// sockets are specific to the workflow (i.e. the driver process).
+  static std::string channelUrl(InputChannelSpec const& channel);
+  /// return the address of the channel, depending on its protocol. IPC
+  /// sockets are specific to the workflow (i.e. the driver process).
+  static std::string channelUrl(OutputChannelSpec const& channel);
+  /// return the FairMQ transport to be used for the channel
+  static char const* transportAsString(enum ChannelProtocol protocol);
 };
 
 /// Stream operators so that we can use ChannelType with Boost.Test
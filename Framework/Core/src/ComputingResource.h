@@ -11,6 +11,7 @@
 #define FRAMEWORK_COMPUTINGRESOURCE_H
 
 #include <string>
+#include <vector>
 
 namespace o2
 {
@@ -21,10 +22,18 @@ namespace framework
 struct ComputingResource {
   float cpu;
   float memory;
+  /// The host providing the resource. Empty if where devices run is
+  /// decided by whoever deploys the topology (e.g. DDS).
   std::string hostname;
   unsigned short port;
 };
 
+/// A NUMA node of a host, with the cores which belong to it.
+struct NumaNode {
+  int id;
+  std::vector<int> cores;
+};
+
 } // namespace framework
 } // namespace o2
 
@@ -0,0 +1,192 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/ConditionBackend.h"
+#include "ConditionHelpers.h"
+
+#include <curl/curl.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <strings.h>
+
+namespace o2
+{
+namespace framework
+{
+
+namespace
+{
+size_t writeBlobCallback(void* contents, size_t size, size_t nmemb, void* userp)
+{
+  auto blob = reinterpret_cast<ConditionBlob*>(userp);
+  auto bytes = reinterpret_cast<char*>(contents);
+  blob->data.insert(blob->data.end(), bytes, bytes + size * nmemb);
+  return size * nmemb;
+}
+
+/// Picks the validity out of the headers of the reply.
+size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userp)
+{
+  auto blob = reinterpret_cast<ConditionBlob*>(userp);
+  std::string line(buffer, size * nitems);
+  auto colon = line.find(':');
+  if (colon != std::string::npos) {
+    auto key = line.substr(0, colon);
+    auto value = std::strtoull(line.c_str() + colon + 1, nullptr, 10);
+    if (strcasecmp(key.c_str(), "Valid-From") == 0) {
+      blob->validFrom = value;
+    } else if (strcasecmp(key.c_str(), "Valid-Until") == 0) {
+      blob->validUntil = value;
+    } else if (strcasecmp(key.c_str(), "Serialization") == 0) {
+      auto begin = line.find_first_not_of(" \t", colon + 1);
+      auto end = line.find_last_not_of(" \t\r\n");
+      if (begin != std::string::npos && end >= begin && end - begin < o2::header::gSizeSerializationMethodString) {
+        blob->serialization.runtimeInit(line.substr(begin, end - begin + 1).c_str());
+      }
+    }
+  }
+  return size * nitems;
+}
+} // namespace
+
+std::unique_ptr<ConditionBackend> ConditionBackend::create(std::string const& url)
+{
+  if (url.empty()) {
+    return nullptr;
+  }
+  std::string const fileScheme = "file://";
+  if (url.compare(0, fileScheme.size(), fileScheme) == 0) {
+    return std::make_unique<FileConditionBackend>(url.substr(fileScheme.size()));
+  }
+  return std::make_unique<CCDBConditionBackend>(url);
+}
+
+CCDBConditionBackend::CCDBConditionBackend(std::string const& url)
+  : mUrl{ url }
+{
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+bool CCDBConditionBackend::fetch(std::string const& path, uint64_t timestamp, ConditionBlob& blob)
+{
+  std::string fullUrl = mUrl + path + "/" + std::to_string(timestamp);
+  blob = ConditionBlob{};
+
+  CURL* curl = curl_easy_init();
+  if (curl == nullptr) {
+    throw std::runtime_error("Unable to initialise curl");
+  }
+  curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeBlobCallback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &blob);
+  curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+  curl_easy_setopt(curl, CURLOPT_HEADERDATA, &blob);
+  CURLcode res = curl_easy_perform(curl);
+  long responseCode = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+  curl_easy_cleanup(curl);
+
+  if (res != CURLE_OK) {
+    throw std::runtime_error("Unable to fetch " + fullUrl + ": " + curl_easy_strerror(res));
+  }
+  if (responseCode == 404) {
+    return false;
+  }
+  if (responseCode != 200) {
+    throw std::runtime_error("Unable to fetch " + fullUrl + ": HTTP " + std::to_string(responseCode));
+  }
+  // Without a validity, the object can only be trusted for the requested
+  // timestamp.
+  if (blob.validUntil <= blob.validFrom || timestamp < blob.validFrom || timestamp >= blob.validUntil) {
+    blob.validFrom = timestamp;
+    blob.validUntil = timestamp + 1;
+  }
+  return true;
+}
+
+FileConditionBackend::FileConditionBackend(std::string const& directory)
+  : mDirectory{ directory }
+{
+}
+
+bool FileConditionBackend::fetch(std::string const& path, uint64_t timestamp, ConditionBlob& blob)
+{
+  std::string directory = mDirectory + "/" + path;
+  DIR* dir = opendir(directory.c_str());
+  if (dir == nullptr) {
+    return false;
+  }
+  bool found = false;
+  std::string best;
+  uint64_t bestFrom = 0;
+  uint64_t bestUntil = 0;
+  while (auto entry = readdir(dir)) {
+    uint64_t from, until;
+    char trailing;
+    if (sscanf(entry->d_name, "%" SCNu64 "_%" SCNu64 "%c", &from, &until, &trailing) != 2) {
+      continue;
+    }
+    if (timestamp >= from && timestamp < until && (found == false || from > bestFrom)) {
+      found = true;
+      best = entry->d_name;
+      bestFrom = from;
+      bestUntil = until;
+    }
+  }
+  closedir(dir);
+  if (found == false) {
+    return false;
+  }
+
+  std::ifstream file(directory + "/" + best, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Unable to read " + directory + "/" + best);
+  }
+  blob.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  blob.validFrom = bestFrom;
+  blob.validUntil = bestUntil;
+  blob.serialization = o2::header::gSerializationMethodROOT;
+  std::ifstream serialization(directory + "/" + best + ".serialization");
+  std::string method;
+  if (serialization >> method) {
+    blob.serialization.runtimeInit(method.c_str());
+  }
+  return true;
+}
+
+void FileConditionBackend::store(std::string const& path, ConditionBlob const& blob)
+{
+  std::string directory = mDirectory + "/" + path;
+  ConditionHelpers::makeDirectories(directory);
+  std::string filename = directory + "/" + std::to_string(blob.validFrom) + "_" + std::to_string(blob.validUntil);
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  file.write(blob.data.data(), blob.data.size());
+  if (!file) {
+    throw std::runtime_error("Unable to write " + filename);
+  }
+  if (blob.serialization != o2::header::gSerializationMethodROOT) {
+    std::ofstream serialization(filename + ".serialization", std::ios::trunc);
+    serialization << blob.serialization.as<std::string>() << "\n";
+  } else {
+    std::remove((filename + ".serialization").c_str());
+  }
+}
+
+} // namespace framework
+} // namespace o2
@@ -0,0 +1,255 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/ConditionCache.h"
+#include "ConditionHelpers.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace o2
+{
+namespace framework
+{
+
+namespace
+{
+/// 64 bit FNV-1a of @a data, which is what we name objects after.
+std::string hash(std::string const& data)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  char result[17];
+  snprintf(result, sizeof(result), "%016llx", static_cast<unsigned long long>(hash));
+  return result;
+}
+
+/// What identifies an object in the cache.
+std::string objectKey(std::string const& path, uint64_t validFrom, uint64_t validUntil)
+{
+  return path + " " + std::to_string(validFrom) + " " + std::to_string(validUntil);
+}
+
+/// The content of @a filename, empty if it does not exist.
+std::string readFile(std::string const& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/// Files are written to a temporary file first, so that nobody can see
+/// them partially written.
+void writeFile(std::string const& filename, char const* data, size_t size)
+{
+  std::string tmpFilename = filename + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmpFilename, std::ios::binary | std::ios::trunc);
+    file.write(data, size);
+    if (!file) {
+      throw std::runtime_error("Unable to write " + tmpFilename);
+    }
+  }
+  if (rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+    std::remove(tmpFilename.c_str());
+    throw std::runtime_error("Unable to write " + filename);
+  }
+}
+} // namespace
+
+MappedCondition::MappedCondition(std::string const& filename, uint64_t validFrom, uint64_t validUntil,
+                                 o2::header::SerializationMethod serialization)
+  : mValidFrom{ validFrom },
+    mValidUntil{ validUntil },
+    mSerialization{ serialization }
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Unable to open " + filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("Unable to stat " + filename);
+  }
+  mSize = st.st_size;
+  if (mSize != 0) {
+    void* ptr = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Unable to map " + filename);
+    }
+    mData = reinterpret_cast<char const*>(ptr);
+  }
+  // The mapping stays valid after the file is closed.
+  close(fd);
+}
+
+MappedCondition::~MappedCondition()
+{
+  if (mData) {
+    munmap(const_cast<char*>(mData), mSize);
+  }
+}
+
+ConditionCache::ConditionCache(std::string const& directory, std::unique_ptr<ConditionBackend> backend)
+  : mDirectory{ directory.empty() ? defaultDirectory() : directory },
+    mBackend{ std::move(backend) }
+{
+  // Objects are mapped and handed out as they are, so nobody else must be
+  // able to tamper with them.
+  for (auto const& directory : { mDirectory, mDirectory + "/objects", mDirectory + "/index" }) {
+    ConditionHelpers::makeDirectories(directory);
+    ConditionHelpers::checkPrivateDirectory(directory);
+  }
+}
+
+std::string ConditionCache::defaultDirectory()
+{
+  if (auto env = getenv("O2_CONDITION_CACHE")) {
+    return env;
+  }
+  if (auto env = getenv("XDG_RUNTIME_DIR")) {
+    return std::string(env) + "/o2-condition-cache";
+  }
+  return "/tmp/o2-condition-cache-" + std::to_string(getuid());
+}
+
+std::string ConditionCache::indexFilename(std::string const& path) const
+{
+  std::string escaped = path;
+  for (auto& c : escaped) {
+    if (c == '/') {
+      c = '%';
+    }
+  }
+  return mDirectory + "/index/" + escaped;
+}
+
+/// The index of a path is only ever appended to, so we simply pick up
+/// the entries which we do not know about yet.
+void ConditionCache::readIndex(std::string const& path)
+{
+  auto& entries = mEntries[path];
+  std::ifstream index(indexFilename(path));
+  Entry entry;
+  std::string serialization;
+  while (index >> entry.validFrom >> entry.validUntil >> entry.object >> serialization) {
+    bool known = false;
+    for (auto& e : entries) {
+      known |= e.validFrom == entry.validFrom && e.validUntil == entry.validUntil && e.object == entry.object;
+    }
+    if (known == false && serialization.size() <= o2::header::gSizeSerializationMethodString) {
+      entry.serialization.runtimeInit(serialization.c_str());
+      entries.push_back(entry);
+    }
+  }
+}
+
+ConditionCache::Entry* ConditionCache::findEntry(std::string const& path, uint64_t timestamp)
+{
+  Entry* best = nullptr;
+  for (auto& entry : mEntries[path]) {
+    if (entry.mismatch == false && timestamp >= entry.validFrom && timestamp < entry.validUntil && (best == nullptr || entry.validFrom > best->validFrom)) {
+      best = &entry;
+    }
+  }
+  return best;
+}
+
+/// @return nullptr if the object on disk does not belong to @a entry.
+std::shared_ptr<MappedCondition> ConditionCache::map(std::string const& path, Entry& entry)
+{
+  if (auto mapped = entry.mapped.lock()) {
+    return mapped;
+  }
+  std::string objectFilename = mDirectory + "/objects/" + entry.object;
+  if (readFile(objectFilename + ".key") != objectKey(path, entry.validFrom, entry.validUntil)) {
+    entry.mismatch = true;
+    return nullptr;
+  }
+  auto mapped = std::make_shared<MappedCondition>(objectFilename, entry.validFrom, entry.validUntil, entry.serialization);
+  entry.mapped = mapped;
+  return mapped;
+}
+
+/// Store @a blob with @a key in the objects, unless some other process did
+/// it already. In case of a collision the next free name is used.
+/// @return the name of the object.
+std::string ConditionCache::store(std::string const& key, ConditionBlob const& blob)
+{
+  auto base = hash(key);
+  for (size_t attempt = 0;; ++attempt) {
+    auto name = attempt == 0 ? base : base + "." + std::to_string(attempt);
+    auto objectFilename = mDirectory + "/objects/" + name;
+    auto existingKey = readFile(objectFilename + ".key");
+    if (existingKey == key) {
+      return name;
+    }
+    if (existingKey.empty()) {
+      // The key goes last, so that whoever can read it finds the object.
+      writeFile(objectFilename, blob.data.data(), blob.data.size());
+      writeFile(objectFilename + ".key", key.data(), key.size());
+      return name;
+    }
+  }
+}
+
+std::shared_ptr<MappedCondition> ConditionCache::get(std::string const& path, uint64_t timestamp)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (auto entry = findEntry(path, timestamp)) {
+    if (auto mapped = map(path, *entry)) {
+      return mapped;
+    }
+  }
+  // Maybe some other process has fetched it already.
+  readIndex(path);
+  if (auto entry = findEntry(path, timestamp)) {
+    if (auto mapped = map(path, *entry)) {
+      return mapped;
+    }
+  }
+
+  ConditionBlob blob;
+  if (mBackend == nullptr || mBackend->fetch(path, timestamp, blob) == false) {
+    return nullptr;
+  }
+  Entry entry{ blob.validFrom, blob.validUntil, store(objectKey(path, blob.validFrom, blob.validUntil), blob), blob.serialization, {} };
+
+  // A single write of a line in append mode, so that concurrent writers
+  // do not interleave.
+  std::string line = std::to_string(entry.validFrom) + " " + std::to_string(entry.validUntil) + " " + entry.object + " " + entry.serialization.as<std::string>() + "\n";
+  int fd = open(indexFilename(path).c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+  if (fd < 0 || write(fd, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    throw std::runtime_error("Unable to update the index of " + path);
+  }
+  close(fd);
+
+  auto& entries = mEntries[path];
+  entries.push_back(entry);
+  return map(path, entries.back());
+}
+
+} // namespace framework
+} // namespace o2
@@ -0,0 +1,51 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "ConditionHelpers.h"
+
+#include <cerrno>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace o2
+{
+namespace framework
+{
+
+void ConditionHelpers::makeDirectories(std::string const& path)
+{
+  for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+    mkdir(path.substr(0, pos).c_str(), 0700);
+  }
+  if (mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+    throw std::runtime_error("Unable to create directory " + path);
+  }
+}
+
+void ConditionHelpers::checkPrivateDirectory(std::string const& path)
+{
+  struct stat st;
+  if (lstat(path.c_str(), &st) != 0) {
+    throw std::runtime_error("Unable to stat " + path);
+  }
+  if (S_ISDIR(st.st_mode) == false) {
+    throw std::runtime_error(path + " is not a directory");
+  }
+  if (st.st_uid != getuid()) {
+    throw std::runtime_error(path + " is not owned by the current user");
+  }
+  if (st.st_mode & (S_IWGRP | S_IWOTH)) {
+    throw std::runtime_error(path + " is writable by other users");
+  }
+}
+
+} // namespace framework
+} // namespace o2
@@ -0,0 +1,36 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef FRAMEWORK_CONDITIONHELPERS_H
+#define FRAMEWORK_CONDITIONHELPERS_H
+
+#include <string>
+
+namespace o2
+{
+namespace framework
+{
+
+/// Filesystem helpers shared by the ConditionBackend and the ConditionCache.
+struct ConditionHelpers {
+  /// Create @a path and all its parents, like mkdir -p, accessible only by
+  /// the current user.
+  /// Throws std::runtime_error if @a path cannot be created.
+  static void makeDirectories(std::string const& path);
+
+  /// Throws std::runtime_error unless @a path is a directory, not a symlink,
+  /// owned by the current user and not writable by anybody else, so that
+  /// what is read from it can be trusted.
+  static void checkPrivateDirectory(std::string const& path);
+};
+
+} // namespace framework
+} // namespace o2
+
+#endif // FRAMEWORK_CONDITIONHELPERS_H
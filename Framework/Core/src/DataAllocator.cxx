@@ -102,6 +102,20 @@ DataAllocator::adoptChunk(const Output& spec, char *buffer, size_t size, fairmq_
   return DataChunk{reinterpret_cast<char *>(dataPtr), dataSize};
 }
 
+void DataAllocator::forwardMessage(const Output& spec, FairMQMessage const& payload, o2::header::SerializationMethod method)
+{
+  std::string channel = matchDataHeader(spec, mTimingInfo->timeslice);
+  auto context = mContextRegistry->get<MessageContext>();
+  FairMQMessagePtr payloadMessage = context->proxy().getDevice()->NewMessageFor(channel, 0);
+  if (payloadMessage->GetType() == payload.GetType()) {
+    payloadMessage->Copy(payload);
+  } else {
+    payloadMessage->Rebuild(payload.GetSize());
+    memcpy(payloadMessage->GetData(), payload.GetData(), payload.GetSize());
+  }
+  addPartToContext(std::move(payloadMessage), spec, method, channel);
+}
+
 FairMQMessagePtr DataAllocator::headerMessageFromOutput(Output const& spec,                     //
                                                         std::string const& channel,             //
                                                         o2::header::SerializationMethod method, //
@@ -122,9 +136,9 @@ FairMQMessagePtr DataAllocator::headerMessageFromOutput(Output const& spec,
 }
 
 void DataAllocator::addPartToContext(FairMQMessagePtr&& payloadMessage, const Output& spec,
-                                     o2::header::SerializationMethod serializationMethod)
+                                     o2::header::SerializationMethod serializationMethod,
+                                     std::string const& channel)
 {
-  std::string channel = matchDataHeader(spec, mTimingInfo->timeslice);
   // the correct payload size is st later when sending the
   // RootObjectContext, see DataProcessor::doSend
   auto headerMessage = headerMessageFromOutput(spec, channel, serializationMethod, 0);
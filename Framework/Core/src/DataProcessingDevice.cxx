@@ -328,6 +328,9 @@ bool DataProcessingDevice::tryDispatchComputation()
     InputSpan span{ [&currentSetOfInputs](size_t i) -> char const* {
                      return currentSetOfInputs.at(i) ? static_cast<char const*>(currentSetOfInputs.at(i)->GetData()) : nullptr;
                    },
+                    [&currentSetOfInputs](size_t i) -> FairMQMessage* {
+                      return currentSetOfInputs.at(i).get();
+                    },
                     currentSetOfInputs.size() };
     return InputRecord{ inputsSchema, std::move(span) };
   };
@@ -47,7 +47,7 @@ void DataProcessor::doSend(FairMQDevice &device, RootObjectContext &context) {
   for (auto &messageRef : context) {
     assert(messageRef.payload.get());
     FairMQParts parts;
-    FairMQMessagePtr payload(device.NewMessage());
+    FairMQMessagePtr payload(device.NewMessageFor(messageRef.channel, 0));
     auto a = messageRef.payload.get();
     device.Serialize<TMessageSerializer>(*payload, a);
     const DataHeader* cdh = o2::header::get<DataHeader*>(messageRef.header->GetData());
@@ -65,7 +65,7 @@ void DataProcessor::doSend(FairMQDevice& device, StringContext& context)
 {
   for (auto& messageRef : context) {
     FairMQParts parts;
-    FairMQMessagePtr payload(device.NewMessage());
+    FairMQMessagePtr payload(device.NewMessageFor(messageRef.channel, 0));
     auto a = messageRef.payload.get();
     // Rebuild the message using the string as input. For now it involves a copy.
     payload->Rebuild(reinterpret_cast<void*>(const_cast<char*>(strdup(a->data()))), a->size(), nullptr, nullptr);
@@ -88,7 +88,7 @@ void DataProcessor::doSend(FairMQDevice& device, ArrowContext& context)
     auto tableBuilder = messageRef.payload.get();
     auto table = tableBuilder->finalize();
 
-    auto creator = [&device](size_t s) -> std::unique_ptr<FairMQMessage> { return device.NewMessage(s); };
+    auto creator = [&device, &messageRef](size_t s) -> std::unique_ptr<FairMQMessage> { return device.NewMessageFor(messageRef.channel, 0, s); };
     auto buffer = std::make_shared<FairMQResizableBuffer>(creator);
     /// Writing to a stream
     auto stream = std::make_shared<arrow::io::BufferOutputStream>(buffer);
@@ -116,7 +116,7 @@ void DataProcessor::doSend(FairMQDevice& device, RawBufferContext& context)
 {
   for (auto& messageRef : context) {
     FairMQParts parts;
-    FairMQMessagePtr payload(device.NewMessage());
+    FairMQMessagePtr payload(device.NewMessageFor(messageRef.channel, 0));
     auto buffer = messageRef.serializeMsg().str();
     // Rebuild the message using the serialized ostringstream as input. For now it involves a copy.
     size_t size = buffer.length();
@@ -149,7 +149,7 @@ bool DeviceMetricsHelper::processMetric(ParsedMetricMatch& match,
     switch (match.type) {
       case MetricType::Int:
         metricInfo.storeIdx = info.intMetrics.size();
-        info.intMetrics.emplace_back(std::array<int, 1024>{});
+        info.intMetrics.emplace_back(std::array<int, DeviceMetricsInfo::RECENT_METRICS_SIZE>{});
         break;
       case MetricType::String:
         metricInfo.storeIdx = info.stringMetrics.size();
@@ -157,13 +157,14 @@ bool DeviceMetricsHelper::processMetric(ParsedMetricMatch& match,
         break;
       case MetricType::Float:
         metricInfo.storeIdx = info.floatMetrics.size();
-        info.floatMetrics.emplace_back(std::array<float, 1024>{});
+        info.floatMetrics.emplace_back(std::array<float, DeviceMetricsInfo::RECENT_METRICS_SIZE>{});
         break;
       default:
         return false;
     };
     // Add the timestamp buffer for it
-    info.timestamps.emplace_back(std::array<size_t, 1024>{});
+    info.timestamps.emplace_back(std::array<size_t, DeviceMetricsInfo::RECENT_METRICS_SIZE>{});
+    info.history.emplace_back(info.historyOptions);
     info.max.push_back(std::numeric_limits<float>::lowest());
     info.min.push_back(std::numeric_limits<float>::max());
     info.maxDomain.push_back(std::numeric_limits<size_t>::lowest());
@@ -206,6 +207,7 @@ bool DeviceMetricsHelper::processMetric(ParsedMetricMatch& match,
       // Save the timestamp for the current metric we do it here
       // so that we do not update timestamps for broken metrics
       info.timestamps[metricIndex][metricInfo.pos] = match.timestamp;
+      info.history[metricIndex].append(match.timestamp, match.intValue);
       // Update the position where to write the next metric
       metricInfo.pos = (metricInfo.pos + 1) % info.intMetrics[metricInfo.storeIdx].size();
     } break;
@@ -223,6 +225,7 @@ bool DeviceMetricsHelper::processMetric(ParsedMetricMatch& match,
       // Save the timestamp for the current metric we do it here
       // so that we do not update timestamps for broken metrics
       info.timestamps[metricIndex][metricInfo.pos] = match.timestamp;
+      info.history[metricIndex].append(match.timestamp, match.floatValue);
       metricInfo.pos = (metricInfo.pos + 1) % info.floatMetrics[metricInfo.storeIdx].size();
     } break;
     default:
@@ -15,7 +15,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
 #include <unordered_set>
+#include <unistd.h>
 #include <vector>
 #include "Framework/ChannelConfigurationPolicy.h"
 #include "Framework/ChannelMatching.h"
@@ -52,17 +54,30 @@ struct ExpirationHandlerHelpers {
 
   static InputRoute::DanglingConfigurator danglingConditionConfigurator()
   {
-    // FIXME: this should really be expireAlways. However, since we do not have
-    //        a proper backend for conditions yet, I keep it behaving like it was
-    //        before.
-    return [](ConfigParamRegistry const&) { return LifetimeHelpers::expireNever(); };
+    // Without a backend there is nowhere to fetch conditions from.
+    return [](ConfigParamRegistry const& options) {
+      if (options.get<std::string>("condition-backend").empty()) {
+        return LifetimeHelpers::expireNever();
+      }
+      return LifetimeHelpers::expireAlways();
+    };
   }
 
-  static InputRoute::ExpirationConfigurator expiringConditionConfigurator(InputSpec const& matcher)
+  static InputRoute::ExpirationConfigurator expiringConditionConfigurator(InputSpec const& spec, std::string const& sourceChannel)
   {
-    return [matcher](ConfigParamRegistry const&) {
-      std::string prefix = DataSpecUtils::restEndpoint(matcher);
-      return LifetimeHelpers::fetchFromCCDBCache(prefix);
+    auto m = std::get_if<ConcreteDataMatcher>(&spec.matcher);
+    if (m == nullptr) {
+      throw std::runtime_error("InputSpec for Conditions must be fully qualified");
+    }
+    std::string prefix = DataSpecUtils::restEndpoint(spec);
+    return [ matcher = *m, prefix, sourceChannel ](ConfigParamRegistry const& options) {
+      auto backend = options.get<std::string>("condition-backend");
+      if (backend.empty()) {
+        LOG(WARN) << "condition-backend is not set, condition " << prefix << " will not be fetched";
+        return LifetimeHelpers::doNothing();
+      }
+      auto cacheDirectory = options.get<std::string>("condition-cache");
+      return LifetimeHelpers::fetchFromCCDBCache(matcher, prefix, backend, cacheDirectory, sourceChannel);
     };
   }
 
@@ -113,17 +128,17 @@ struct ExpirationHandlerHelpers {
 };
 
 /// This creates a string to configure channels of a FairMQDevice
-/// FIXME: support shared memory
 std::string inputChannel2String(const InputChannelSpec& channel)
 {
   std::string result;
-  char buffer[32];
-  auto addressFormat = ChannelSpecHelpers::methodAsUrl(channel.method);
 
   result += "name=" + channel.name;
   result += std::string(",type=") + ChannelSpecHelpers::typeAsString(channel.type);
   result += std::string(",method=") + ChannelSpecHelpers::methodAsString(channel.method);
-  result += std::string(",address=") + (snprintf(buffer, 32, addressFormat, channel.port), buffer);
+  result += std::string(",address=") + ChannelSpecHelpers::channelUrl(channel);
+  if (channel.protocol == ChannelProtocol::IPC) {
+    result += std::string(",transport=") + ChannelSpecHelpers::transportAsString(channel.protocol);
+  }
   result += std::string(",rateLogging=60");
 
   return result;
@@ -132,18 +147,69 @@ std::string inputChannel2String(const InputChannelSpec& channel)
 std::string outputChannel2String(const OutputChannelSpec& channel)
 {
   std::string result;
-  char buffer[32];
-  auto addressFormat = ChannelSpecHelpers::methodAsUrl(channel.method);
 
   result += "name=" + channel.name;
   result += std::string(",type=") + ChannelSpecHelpers::typeAsString(channel.type);
   result += std::string(",method=") + ChannelSpecHelpers::methodAsString(channel.method);
-  result += std::string(",address=") + (snprintf(buffer, 32, addressFormat, channel.port), buffer);
+  result += std::string(",address=") + ChannelSpecHelpers::channelUrl(channel);
+  if (channel.protocol == ChannelProtocol::IPC) {
+    result += std::string(",transport=") + ChannelSpecHelpers::transportAsString(channel.protocol);
+  }
   result += std::string(",rateLogging=60");
 
   return result;
 }
 
+namespace
+{
+bool usesSharedMemory(DeviceSpec const& spec)
+{
+  for (auto& channel : spec.inputChannels) {
+    if (channel.protocol == ChannelProtocol::IPC) {
+      return true;
+    }
+  }
+  for (auto& channel : spec.outputChannels) {
+    if (channel.protocol == ChannelProtocol::IPC) {
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
+std::map<std::string, size_t> DeviceSpecHelpers::sharedMemorySegmentSizes(std::vector<DeviceSpec> const& specs)
+{
+  constexpr size_t sizePerDevice = 256ULL << 20;
+  std::map<std::string, size_t> sizes;
+  for (auto& spec : specs) {
+    if (usesSharedMemory(spec)) {
+      sizes[spec.hostname] += sizePerDevice;
+    }
+  }
+  return sizes;
+}
+
+void DeviceSpecHelpers::useSharedMemoryChannels(std::vector<DeviceSpec>& devices)
+{
+  for (auto& consumer : devices) {
+    for (auto& input : consumer.inputChannels) {
+      // The hostname of an input channel is the one of the producer.
+      if (input.hostname.empty() || input.hostname != consumer.hostname) {
+        continue;
+      }
+      input.protocol = ChannelProtocol::IPC;
+      for (auto& producer : devices) {
+        for (auto& output : producer.outputChannels) {
+          if (output.name == input.name) {
+            output.protocol = ChannelProtocol::IPC;
+          }
+        }
+      }
+    }
+  }
+}
+
 void DeviceSpecHelpers::processOutEdgeActions(std::vector<DeviceSpec>& devices, std::vector<DeviceId>& deviceIndex,
                                               std::vector<DeviceConnectionId>& connections,
                                               std::vector<ComputingResource>& resources,
@@ -180,6 +246,7 @@ void DeviceSpecHelpers::processOutEdgeActions(std::vector<DeviceSpec>& devices,
     device.rank = processor.rank;
     device.nSlots = processor.nSlots;
     device.inputTimesliceId = edge.timeIndex;
+    device.messageRate = processor.messageRate;
     devices.push_back(device);
     return devices.size() - 1;
   };
@@ -224,9 +291,21 @@ void DeviceSpecHelpers::processOutEdgeActions(std::vector<DeviceSpec>& devices,
 
     deviceIndex.emplace_back(DeviceId{ edge.producer, edge.producerTimeIndex, di });
 
-    OutputChannelSpec channel = channelFromDeviceEdgeAndPort(device, edge, resources.back().port);
-    const DeviceConnectionId& id = connectionIdFromEdgeAndPort(edge, resources.back().port);
-    resources.pop_back();
+    // All the ports bound by a device must be on the host it runs on.
+    auto resource = resources.rbegin();
+    if (device.hostname.empty() == false) {
+      resource = std::find_if(resources.rbegin(), resources.rend(),
+                              [&device](ComputingResource const& r) { return r.hostname == device.hostname; });
+    }
+    if (resource == resources.rend()) {
+      throw std::runtime_error("No more ports available for " + device.id);
+    }
+    device.hostname = resource->hostname;
+
+    OutputChannelSpec channel = channelFromDeviceEdgeAndPort(device, edge, resource->port);
+    channel.hostname = resource->hostname;
+    const DeviceConnectionId& id = connectionIdFromEdgeAndPort(edge, resource->port);
+    resources.erase(std::next(resource).base());
 
     device.outputChannels.push_back(channel);
     return device.outputChannels.size() - 1;
@@ -360,6 +439,7 @@ void DeviceSpecHelpers::processInEdgeActions(std::vector<DeviceSpec>& devices,
     device.rank = processor.rank;
     device.nSlots = processor.nSlots;
     device.inputTimesliceId = edge.timeIndex;
+    device.messageRate = processor.messageRate;
     // FIXME: maybe I should use an std::map in the end
     //        but this is really not performance critical
     auto id = DeviceId{ edge.consumer, edge.timeIndex, devices.size() };
@@ -401,6 +481,7 @@ void DeviceSpecHelpers::processInEdgeActions(std::vector<DeviceSpec>& devices,
     auto& consumerDevice = devices[ci];
     InputChannelSpec channel;
     channel.name = "from_" + producerDevice.id + "_to_" + consumerDevice.id;
+    channel.hostname = producerDevice.hostname;
     channel.port = port;
     for (auto& policy : channelPolicies) {
       if (policy.match(producerDevice.id, consumerDevice.id)) {
@@ -442,7 +523,7 @@ void DeviceSpecHelpers::processInEdgeActions(std::vector<DeviceSpec>& devices,
         break;
       case Lifetime::Condition:
         danglingConfigurator = ExpirationHandlerHelpers::danglingConditionConfigurator();
-        expirationConfigurator = ExpirationHandlerHelpers::expiringConditionConfigurator(inputSpec);
+        expirationConfigurator = ExpirationHandlerHelpers::expiringConditionConfigurator(inputSpec, sourceChannel);
         break;
       case Lifetime::QA:
         danglingConfigurator = ExpirationHandlerHelpers::danglingQAConfigurator();
@@ -489,6 +570,11 @@ void DeviceSpecHelpers::processInEdgeActions(std::vector<DeviceSpec>& devices,
 
     size_t channel = -1;
     if (action.requiresNewChannel) {
+      // Devices which only consume data do not bind any port, so we can
+      // place them together with their first producer.
+      if (devices[consumerDevice].hostname.empty()) {
+        devices[consumerDevice].hostname = devices[producerDevice].hostname;
+      }
       int16_t port = findMatchingOutgoingPortForEdge(edge);
       channel = appendInputChannelForConsumerDevice(producerDevice, consumerDevice, port);
     } else {
@@ -570,6 +656,7 @@ void DeviceSpecHelpers::prepareArguments(int argc, char** argv, bool defaultQuie
   assert(argc > 0); // we require to have the program name as the first argument
   assert(deviceSpecs.size() == deviceExecutions.size());
   assert(deviceControls.size() == deviceExecutions.size());
+  auto segmentSizes = sharedMemorySegmentSizes(deviceSpecs);
   for (size_t si = 0; si < deviceSpecs.size(); ++si) {
     auto& spec = deviceSpecs[si];
     auto& control = deviceControls[si];
@@ -682,6 +769,18 @@ void DeviceSpecHelpers::prepareArguments(int argc, char** argv, bool defaultQuie
     // filter device options, and handle option groups
     filterArgsFct(argc, argv, od);
 
+    // All the devices sharing memory on a host need to agree on the size of
+    // the segment, unless it was given explicitly. The segment is specific
+    // to the workflow, like its ipc sockets.
+    if (usesSharedMemory(spec)) {
+      if (control.options.count("shm-segment-size") == 0) {
+        tmpArgs.emplace_back(std::string("--shm-segment-size"));
+        tmpArgs.emplace_back(std::to_string(segmentSizes[spec.hostname]));
+      }
+      tmpArgs.emplace_back(std::string("--session"));
+      tmpArgs.emplace_back("dpl-" + std::to_string(getpid()));
+    }
+
     // Add the channel configuration
     for (auto& channel : spec.outputChannels) {
       tmpArgs.emplace_back(std::string("--channel-config"));
@@ -724,6 +823,7 @@ boost::program_options::options_description DeviceSpecHelpers::getForwardedDevic
     ("monitoring-backend", bpo::value<std::string>(), "monitoring connection string")                           //
     ("infologger-mode", bpo::value<std::string>(), "INFOLOGGER_MODE override")                                  //
     ("infologger-severity", bpo::value<std::string>(), "minimun FairLogger severity which goes to info logger") //
+    ("shm-segment-size", bpo::value<std::string>(), "size of the shared memory segment in bytes")               //
     ("child-driver", bpo::value<std::string>(), "external driver to start childs with (e.g. valgrind)");        //
 
   return forwardedDeviceOptions;
@@ -94,6 +94,15 @@ struct DeviceSpecHelpers {
   /// return a description of all options to be forwarded to the device
   /// by default
   static boost::program_options::options_description getForwardedDeviceOptions();
+
+  /// Switch the channels between devices which run on the same host to
+  /// IPC, with the payloads in shared memory. Channels use TCP otherwise.
+  static void useSharedMemoryChannels(std::vector<DeviceSpec>& devices);
+
+  /// return the size of the shared memory segment for each of the hosts,
+  /// i.e. enough for each of the devices with shared memory channels on it
+  /// to have some data in flight.
+  static std::map<std::string, size_t> sharedMemorySegmentSizes(std::vector<DeviceSpec> const& specs);
 };
 
 }
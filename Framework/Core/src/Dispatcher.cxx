@@ -47,6 +47,7 @@ void Dispatcher::init(InitContext& ctx)
   std::unique_ptr<ConfigurationInterface> cfg = ConfigurationFactory::getConfiguration(mReconfigurationSource);
   auto policiesTree = cfg->getRecursive("dataSamplingPolicies");
   mPolicies.clear();
+  mPoliciesByRoute.clear();
 
   for (auto&& policyConfig : policiesTree) {
     mPolicies.emplace_back(std::make_shared<DataSamplingPolicy>(policyConfig.second));
@@ -55,26 +56,48 @@ void Dispatcher::init(InitContext& ctx)
 
 void Dispatcher::run(ProcessingContext& ctx)
 {
-  for (const auto& input : ctx.inputs()) {
-    if (input.header != nullptr && input.spec != nullptr) {
-
-      for (auto& policy : mPolicies) {
-        // todo: consider getting the outputSpec in match to improve performance
-        // todo: consider matching (and deciding) in completion policy to save some time
-        if (policy->match(*input.spec) && policy->decide(input)) {
-
-          if (!policy->getFairMQOutputChannel().empty()) {
-            sendFairMQ(ctx.services().get<RawDeviceService>().device(), input, policy->getFairMQOutputChannelName());
-          } else {
-            send(ctx.outputs(), input, policy->prepareOutput(*input.spec));
-          }
+  auto& inputs = ctx.inputs();
+  if (mPoliciesByRoute.size() != inputs.size()) {
+    matchPolicies(inputs);
+  }
+
+  for (size_t pos = 0; pos < inputs.size(); ++pos) {
+    const auto input = inputs.getByPos(pos);
+    if (input.header == nullptr || input.spec == nullptr) {
+      continue;
+    }
+
+    for (auto policy : mPoliciesByRoute[pos]) {
+      // todo: consider matching (and deciding) in completion policy to save some time
+      if (policy->decide(input)) {
+        FairMQMessage* payload = inputs.getPayloadMessageByPos(pos);
+        if (!policy->getFairMQOutputChannel().empty()) {
+          sendFairMQ(ctx.services().get<RawDeviceService>().device(), input, payload, policy->getFairMQOutputChannelName());
+        } else {
+          send(ctx.outputs(), input, payload, policy->prepareOutput(*input.spec));
         }
       }
     }
   }
 }
 
-void Dispatcher::send(DataAllocator& dataAllocator, const DataRef& inputData, const Output& output) const
+// The input routes do not change during the lifetime of the device, so we
+// look up which policies are interested in each of them only once.
+void Dispatcher::matchPolicies(const InputRecord& inputs)
+{
+  mPoliciesByRoute.clear();
+  mPoliciesByRoute.resize(inputs.size());
+  for (size_t pos = 0; pos < inputs.size(); ++pos) {
+    const auto input = inputs.getByPos(pos);
+    for (auto& policy : mPolicies) {
+      if (policy->match(*input.spec)) {
+        mPoliciesByRoute[pos].push_back(policy.get());
+      }
+    }
+  }
+}
+
+void Dispatcher::send(DataAllocator& dataAllocator, const DataRef& inputData, FairMQMessage* payload, const Output& output) const
 {
   //todo: support other serialization methods
   const auto* inputHeader = header::get<header::DataHeader*>(inputData.header);
@@ -82,17 +105,20 @@ void Dispatcher::send(DataAllocator& dataAllocator, const DataRef& inputData, co
     LOG(WARNING) << "DataSampling::dispatcherCallback: input of origin'" << inputHeader->dataOrigin.str
                  << "', description '" << inputHeader->dataDescription.str
                  << "' has gSerializationMethodInvalid.";
+  } else if (payload != nullptr) {
+    // The payload is already serialized, whatever the method is, so it can
+    // be shared as it is with the output.
+    dataAllocator.forwardMessage(output, *payload, inputHeader->payloadSerializationMethod);
   } else if (inputHeader->payloadSerializationMethod == header::gSerializationMethodROOT) {
     dataAllocator.adopt(output, DataRefUtils::as<TObject>(inputData).release());
   } else { // POD
-    // todo: do it non-copy, when API is available
     auto outputMessage = dataAllocator.newChunk(output, inputHeader->payloadSize);
     memcpy(outputMessage.data, inputData.payload, inputHeader->payloadSize);
   }
 }
 
 // ideally this should be in a separate proxy device or use Lifetime::External
-void Dispatcher::sendFairMQ(FairMQDevice* device, const DataRef& inputData, const std::string& fairMQChannel) const
+void Dispatcher::sendFairMQ(FairMQDevice* device, const DataRef& inputData, FairMQMessage* payload, const std::string& fairMQChannel) const
 {
   const auto* dh = header::get<header::DataHeader*>(inputData.header);
   assert(dh);
@@ -104,13 +130,17 @@ void Dispatcher::sendFairMQ(FairMQDevice* device, const DataRef& inputData, cons
   DataProcessingHeader dphout{ dph->startTime, dph->duration };
   o2::header::Stack headerStack{ dhout, dphout };
 
-  auto channelAlloc = o2::pmr::getTransportAllocator(device->Transport());
+  auto channelAlloc = o2::pmr::getTransportAllocator(device->GetChannel(fairMQChannel, 0).Transport());
   FairMQMessagePtr msgHeaderStack = o2::pmr::getMessage(std::move(headerStack), channelAlloc);
 
-  char* payloadCopy = new char[dh->payloadSize];
-  memcpy(payloadCopy, inputData.payload, dh->payloadSize);
-  auto cleanupFcn = [](void* data, void*) { delete[] reinterpret_cast<char*>(data); };
-  FairMQMessagePtr msgPayload(device->NewMessage(payloadCopy, dh->payloadSize, cleanupFcn, payloadCopy));
+  FairMQMessagePtr msgPayload = device->NewMessageFor(fairMQChannel, 0);
+  if (payload != nullptr && payload->GetType() == msgPayload->GetType()) {
+    // Same transport, we can simply share the underlying buffer
+    msgPayload->Copy(*payload);
+  } else {
+    msgPayload->Rebuild(dh->payloadSize);
+    memcpy(msgPayload->GetData(), inputData.payload, dh->payloadSize);
+  }
 
   FairMQParts message;
   message.AddPart(move(msgHeaderStack));
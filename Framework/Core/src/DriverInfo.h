@@ -116,6 +116,15 @@ struct DriverInfo {
   unsigned short startPort;
   /// The size of the port range to consider allocated
   unsigned short portRange;
+  /// Whether the topology is deployed by some external entity (e.g. DDS),
+  /// in which case we do not know which devices end up on the same host.
+  bool externalDeployment;
+  /// Whether devices on the same host should exchange data via shared
+  /// memory rather than TCP.
+  bool sharedMemory;
+  /// Whether devices should be pinned to the cores chosen by the
+  /// resource manager.
+  bool pinDevices;
   /// The current set of workflow options 
   std::vector<ConfigParamSpec> workflowOptions;
   /// The config context. We use a bare pointer because std::observer_ptr is not a thing, yet.
@@ -17,24 +17,19 @@ namespace o2
 {
 namespace framework
 {
-FairMQTransportFactory* FairMQDeviceProxy::getTransport()
-{
-  return mDevice->Transport();
-}
-
 FairMQTransportFactory* FairMQDeviceProxy::getTransport(const std::string& channel, int index)
 {
   return mDevice->GetChannel(channel, index).Transport();
 }
 
-std::unique_ptr<FairMQMessage> FairMQDeviceProxy::createMessage() const
+std::unique_ptr<FairMQMessage> FairMQDeviceProxy::createMessage(const std::string& channel, int index) const
 {
-  return mDevice->Transport()->CreateMessage();
+  return mDevice->GetChannel(channel, index).Transport()->CreateMessage();
 }
 
-std::unique_ptr<FairMQMessage> FairMQDeviceProxy::createMessage(const size_t size) const
+std::unique_ptr<FairMQMessage> FairMQDeviceProxy::createMessage(const std::string& channel, int index, const size_t size) const
 {
-  return mDevice->Transport()->CreateMessage(size);
+  return mDevice->GetChannel(channel, index).Transport()->CreateMessage(size);
 }
 
 } // namespace framework
@@ -164,22 +164,24 @@ enum struct MetricsDisplayStyle : int {
   Lines = 0,
   Histos = 1,
   Sparks = 2,
-  Table = 3
+  Table = 3,
+  History = 4
+};
+
+static std::vector<ImColor> const palette = {
+  ImColor{ 218, 124, 48 },
+  ImColor{ 62, 150, 81 },
+  ImColor{ 204, 37, 41 },
+  ImColor{ 83, 81, 84 },
+  ImColor{ 107, 76, 154 },
+  ImColor{ 146, 36, 40 },
+  ImColor{ 148, 139, 61 }
 };
 
 void displayDeviceMetrics(const char* label, ImVec2 canvasSize, std::string const& selectedMetricName,
                           size_t rangeBegin, size_t rangeEnd, size_t bins, MetricsDisplayStyle displayType,
                           std::vector<DeviceSpec> const& specs, std::vector<DeviceMetricsInfo> const& metricsInfos)
 {
-  static std::vector<ImColor> palette = {
-    ImColor{ 218, 124, 48 },
-    ImColor{ 62, 150, 81 },
-    ImColor{ 204, 37, 41 },
-    ImColor{ 83, 81, 84 },
-    ImColor{ 107, 76, 154 },
-    ImColor{ 146, 36, 40 },
-    ImColor{ 148, 139, 61 }
-  };
   std::vector<void const*> metricsToDisplay;
   std::vector<const char*> deviceNames;
   std::vector<MultiplotData> userData;
@@ -236,7 +238,7 @@ void displayDeviceMetrics(const char* label, ImVec2 canvasSize, std::string cons
     userData.emplace_back(data);
   }
 
-  maxDomain = std::max(minDomain + 1024, maxDomain);
+  maxDomain = std::max(minDomain + DeviceMetricsInfo::RECENT_METRICS_SIZE, maxDomain);
 
   for (size_t ui = 0; ui < userData.size(); ++ui) {
     metricsToDisplay.push_back(&(userData[ui]));
@@ -245,7 +247,7 @@ void displayDeviceMetrics(const char* label, ImVec2 canvasSize, std::string cons
     auto histoData = reinterpret_cast<const MultiplotData*>(hData);
     size_t pos = (histoData->first + static_cast<size_t>(idx)) % histoData->mod;
     // size_t pos = (static_cast<size_t>(idx)) % histoData->mod;
-    assert(pos >= 0 && pos < 1024);
+    assert(pos >= 0 && pos < DeviceMetricsInfo::RECENT_METRICS_SIZE);
     if (histoData->type == MetricType::Int) {
       return static_cast<const int*>(histoData->Y)[pos];
     } else if (histoData->type == MetricType::Float) {
@@ -258,7 +260,7 @@ void displayDeviceMetrics(const char* label, ImVec2 canvasSize, std::string cons
     auto histoData = reinterpret_cast<const MultiplotData*>(hData);
     size_t pos = (histoData->first + static_cast<size_t>(idx)) % histoData->mod;
     //size_t pos = (static_cast<size_t>(idx)) % histoData->mod;
-    assert(pos >= 0 && pos < 1024);
+    assert(pos >= 0 && pos < DeviceMetricsInfo::RECENT_METRICS_SIZE);
     return static_cast<const size_t*>(histoData->X)[pos];
   };
   switch (displayType) {
@@ -299,6 +301,82 @@ void displayDeviceMetrics(const char* label, ImVec2 canvasSize, std::string cons
   }
 }
 
+/// Display the downsampled long term history of the selected metric, as
+/// kept in the rollups of the MetricHistory of each device.
+void displayDeviceHistory(const char* label, ImVec2 canvasSize, std::string const& selectedMetricName,
+                          std::vector<DeviceSpec> const& specs, std::vector<DeviceMetricsInfo> const& metricsInfos)
+{
+  struct RollupData {
+    std::vector<size_t> timestamps;
+    std::vector<float> means;
+  };
+  std::vector<RollupData> userData;
+  std::vector<const char*> deviceNames;
+  std::vector<ImColor> colors;
+  size_t valuesCount = 0;
+  float maxValue = std::numeric_limits<float>::lowest();
+  float minValue = 0;
+  size_t maxDomain = std::numeric_limits<size_t>::lowest();
+  size_t minDomain = std::numeric_limits<size_t>::max();
+
+  for (int mi = 0; mi < metricsInfos.size(); ++mi) {
+    auto vi = DeviceMetricsHelper::metricIdxByName(selectedMetricName, metricsInfos[mi]);
+    if (vi == metricsInfos[mi].metricLabelsIdx.size()) {
+      continue;
+    }
+    auto& history = metricsInfos[mi].history[vi];
+    if (history.rollupsSize() == 0) {
+      continue;
+    }
+    RollupData data;
+    for (size_t ri = 0; ri < history.rollupsSize(); ++ri) {
+      auto& rollup = history.rollup(ri);
+      data.timestamps.push_back(rollup.timestamp);
+      data.means.push_back(rollup.sum / rollup.count);
+      minValue = std::min(minValue, rollup.min);
+      maxValue = std::max(maxValue, rollup.max);
+    }
+    minDomain = std::min(minDomain, data.timestamps.front());
+    maxDomain = std::max(maxDomain, data.timestamps.back() + history.options().rollupInterval);
+    valuesCount = std::max(valuesCount, data.timestamps.size());
+    deviceNames.push_back(specs[mi].name.c_str());
+    colors.push_back(palette[mi % palette.size()]);
+    userData.emplace_back(std::move(data));
+  }
+  if (userData.empty()) {
+    ImGui::TextUnformatted("No history available yet");
+    return;
+  }
+
+  std::vector<void const*> historiesToDisplay;
+  for (auto& data : userData) {
+    historiesToDisplay.push_back(&data);
+  }
+  // Devices with fewer rollups repeat their last one
+  auto getterY = [](const void* hData, int idx) -> float {
+    auto data = reinterpret_cast<const RollupData*>(hData);
+    return data->means[std::min(static_cast<size_t>(idx), data->means.size() - 1)];
+  };
+  auto getterX = [](const void* hData, int idx) -> size_t {
+    auto data = reinterpret_cast<const RollupData*>(hData);
+    return data->timestamps[std::min(static_cast<size_t>(idx), data->timestamps.size() - 1)];
+  };
+  ImGui::PlotMultiLines(
+    label,
+    userData.size(),
+    deviceNames.data(),
+    colors.data(),
+    getterY,
+    getterX,
+    historiesToDisplay.data(),
+    valuesCount,
+    minValue,
+    maxValue * 1.2f,
+    minDomain,
+    maxDomain,
+    canvasSize);
+}
+
 struct ColumnInfo {
   MetricType type;
   int index;
@@ -380,7 +458,7 @@ void historyBar(gui::WorkspaceGUIState& globalGUIState,
       auto getter = [](void* hData, int idx) -> float {
         auto histoData = reinterpret_cast<HistoData<int>*>(hData);
         size_t pos = (histoData->first + static_cast<size_t>(idx)) % histoData->mod;
-        assert(pos >= 0 && pos < 1024);
+        assert(pos >= 0 && pos < DeviceMetricsInfo::RECENT_METRICS_SIZE);
         return histoData->points[pos];
       };
       ImGui::PlotLines(("##" + currentMetricName).c_str(), getter, &data, data.size);
@@ -396,7 +474,7 @@ void historyBar(gui::WorkspaceGUIState& globalGUIState,
       auto getter = [](void* hData, int idx) -> float {
         auto histoData = reinterpret_cast<HistoData<float>*>(hData);
         size_t pos = (histoData->first + static_cast<size_t>(idx)) % histoData->mod;
-        assert(pos >= 0 && pos < 1024);
+        assert(pos >= 0 && pos < DeviceMetricsInfo::RECENT_METRICS_SIZE);
         return histoData->points[pos];
       };
       ImGui::PlotLines(("##" + currentMetricName).c_str(), getter, &data, data.size);
@@ -475,7 +553,8 @@ void displayDeviceHistograms(gui::WorkspaceGUIState& state,
     "lines",
     "histograms",
     "sparks",
-    "table"
+    "table",
+    "history"
   };
   ImGui::SameLine();
   static enum MetricsDisplayStyle currentStyle = MetricsDisplayStyle::Lines;
@@ -520,9 +599,14 @@ void displayDeviceHistograms(gui::WorkspaceGUIState& state,
       case MetricsDisplayStyle::Histos:
       case MetricsDisplayStyle::Lines: {
         displayDeviceMetrics("Metrics",
-                             ImVec2(ImGui::GetIO().DisplaySize.x - 10, state.bottomPaneSize - ImGui::GetItemRectSize().y - 20), currentMetricName, minTime, maxTime, 1024,
+                             ImVec2(ImGui::GetIO().DisplaySize.x - 10, state.bottomPaneSize - ImGui::GetItemRectSize().y - 20), currentMetricName, minTime, maxTime, DeviceMetricsInfo::RECENT_METRICS_SIZE,
                              currentStyle, devices, metricsInfos);
       } break;
+      case MetricsDisplayStyle::History: {
+        displayDeviceHistory("History",
+                             ImVec2(ImGui::GetIO().DisplaySize.x - 10, state.bottomPaneSize - ImGui::GetItemRectSize().y - 20), currentMetricName,
+                             devices, metricsInfos);
+      } break;
       case MetricsDisplayStyle::Sparks: {
         ImGui::BeginChild("##ScrollingRegion", ImVec2(ImGui::GetIO().DisplaySize.x + state.leftPaneSize + state.rightPaneSize - 10, -ImGui::GetItemsLineHeightWithSpacing()), false,
                           ImGuiWindowFlags_HorizontalScrollbar);
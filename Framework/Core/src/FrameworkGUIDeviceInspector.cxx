@@ -106,6 +106,13 @@ void displayDeviceInspector(DeviceSpec const& spec, DeviceInfo const& info, Devi
 {
   ImGui::Text("Name: %s", spec.name.c_str());
   ImGui::Text("Pid: %d", info.pid);
+  if (spec.cores.empty() == false) {
+    std::string cores;
+    for (auto core : spec.cores) {
+      cores += (cores.empty() ? "" : ",") + std::to_string(core);
+    }
+    ImGui::Text("NUMA node: %d, cores: %s", spec.numaNode, cores.c_str());
+  }
 
   deviceInfoTable(info, metrics);
   optionsTable(spec, control);
@@ -16,6 +16,7 @@
 #include "Headers/Stack.h"
 #include "MemoryResources/MemoryResources.h"
 #include "Framework/DataProcessingHeader.h"
+#include "Framework/ConditionCache.h"
 #include <fairmq/FairMQDevice.h>
 
 using namespace o2::header;
@@ -74,13 +75,54 @@ ExpirationHandler::Handler LifetimeHelpers::doNothing()
 ///
 /// "<namespace>/<InputRoute.origin>/<InputRoute.description>"
 ///
-/// FIXME: actually implement the fetching
+/// Objects go through the per host ConditionCache and are sent as they are
+/// mapped from it, with the serialization method recorded in their
+/// metadata. The timestamp of the timeslice is a counter, not a time, so
+/// the object valid at the time it is needed is used. It is looked up
+/// again only once the current one is not valid anymore.
 /// FIXME: provide a way to customize the namespace from the ProcessingContext
-ExpirationHandler::Handler LifetimeHelpers::fetchFromCCDBCache(std::string const& prefix)
+ExpirationHandler::Handler LifetimeHelpers::fetchFromCCDBCache(ConcreteDataMatcher const& matcher,
+                                                               std::string const& prefix,
+                                                               std::string const& backend,
+                                                               std::string const& cacheDirectory,
+                                                               std::string const& sourceChannel)
 {
-  return [](ServiceRegistry&, PartRef& ref, uint64_t) -> void {
-    throw std::runtime_error("fetchFromCCDBCache: Not yet implemented");
-    return;
+  if (backend.empty()) {
+    throw std::runtime_error("fetchFromCCDBCache: condition-backend is not set, cannot fetch " + prefix);
+  }
+  auto cache = std::make_shared<ConditionCache>(cacheDirectory, ConditionBackend::create(backend));
+  auto current = std::make_shared<std::shared_ptr<MappedCondition>>();
+  return [matcher, prefix, sourceChannel, cache, current](ServiceRegistry& services, PartRef& ref, uint64_t timestamp) -> void {
+    // We should invoke the handler only once.
+    assert(!ref.header);
+    assert(!ref.payload);
+    uint64_t now = getCurrentTime();
+    if (*current == nullptr || (*current)->isValid(now) == false) {
+      *current = cache->get(prefix, now);
+      if (*current == nullptr) {
+        throw std::runtime_error("fetchFromCCDBCache: no object for " + prefix + " at " + std::to_string(now));
+      }
+    }
+    auto& rawDeviceService = services.get<RawDeviceService>();
+
+    DataHeader dh;
+    dh.dataOrigin = matcher.origin;
+    dh.dataDescription = matcher.description;
+    dh.subSpecification = matcher.subSpec;
+    dh.payloadSize = (*current)->size();
+    dh.payloadSerializationMethod = (*current)->serialization();
+
+    DataProcessingHeader dph{ timestamp, 1 };
+
+    auto&& transport = rawDeviceService.device()->GetChannel(sourceChannel, 0).Transport();
+    auto channelAlloc = o2::pmr::getTransportAllocator(transport);
+    ref.header = o2::pmr::getMessage(o2::header::Stack{ channelAlloc, dh, dph });
+
+    // The message keeps the mapping alive until it is gone.
+    auto hint = new std::shared_ptr<MappedCondition>(*current);
+    ref.payload = transport->CreateMessage(const_cast<char*>((*current)->data()), (*current)->size(),
+                                           [](void*, void* hint) { delete reinterpret_cast<std::shared_ptr<MappedCondition>*>(hint); },
+                                           hint);
   };
 }
 
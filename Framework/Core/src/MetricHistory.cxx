@@ -0,0 +1,158 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/MetricHistory.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace o2
+{
+namespace framework
+{
+
+void MetricHistoryBlock::append(size_t timestamp, uint32_t value)
+{
+  if (count == 0) {
+    firstTimestamp = lastTimestamp = timestamp;
+    minTimestamp = maxTimestamp = timestamp;
+    firstValue = lastValue = value;
+    count = 1;
+    return;
+  }
+  // Timestamps are encoded as the difference between consecutive deltas,
+  // which is zero most of the time for metrics sent at regular intervals.
+  int64_t delta = int64_t(timestamp - lastTimestamp);
+  int64_t dod = delta - lastDelta;
+  if (dod == 0) {
+    bits.write(0, 1);
+  } else if (dod >= -63 && dod <= 64) {
+    bits.write(0b01, 2);
+    bits.write(uint64_t(dod + 63), 7);
+  } else if (dod >= -255 && dod <= 256) {
+    bits.write(0b011, 3);
+    bits.write(uint64_t(dod + 255), 9);
+  } else if (dod >= -2047 && dod <= 2048) {
+    bits.write(0b0111, 4);
+    bits.write(uint64_t(dod + 2047), 12);
+  } else {
+    bits.write(0b1111, 4);
+    bits.write(uint64_t(dod), 64);
+  }
+  lastDelta = delta;
+  lastTimestamp = timestamp;
+  minTimestamp = std::min(minTimestamp, timestamp);
+  maxTimestamp = std::max(maxTimestamp, timestamp);
+
+  // Values are encoded as the XOR with the previous one, reusing the
+  // previous window of meaningful bits whenever possible.
+  uint32_t xorValue = value ^ lastValue;
+  if (xorValue == 0) {
+    bits.write(0, 1);
+  } else {
+    unsigned int leadingZeros = __builtin_clz(xorValue);
+    unsigned int trailingZeros = __builtin_ctz(xorValue);
+    if (leading != 0xff && leadingZeros >= leading && trailingZeros >= trailing) {
+      bits.write(0b01, 2);
+      bits.write(xorValue >> trailing, 32 - leading - trailing);
+    } else {
+      unsigned int length = 32 - leadingZeros - trailingZeros;
+      bits.write(0b11, 2);
+      bits.write(leadingZeros, 5);
+      bits.write(length - 1, 5);
+      bits.write(xorValue >> trailingZeros, length);
+      leading = leadingZeros;
+      trailing = trailingZeros;
+    }
+  }
+  lastValue = value;
+  count++;
+}
+
+MetricHistory::MetricHistory(MetricHistoryOptions const& options)
+  : mOptions{ options }
+{
+  assert(mOptions.samplesPerBlock > 0);
+  assert(mOptions.rollupInterval > 0);
+  assert(mOptions.rollupCapacity > 0);
+}
+
+void MetricHistory::append(size_t timestamp, int value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  appendBits(timestamp, bits, static_cast<float>(value));
+}
+
+void MetricHistory::append(size_t timestamp, float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  appendBits(timestamp, bits, value);
+}
+
+void MetricHistory::appendBits(size_t timestamp, uint32_t bits, float value)
+{
+  if (mBlocks.empty() || mBlocks.back().count >= mOptions.samplesPerBlock) {
+    if (mBlocks.empty() == false) {
+      // Seal the previous block, giving back the slack of the bitstream.
+      mBlocks.back().bits.words.shrink_to_fit();
+    }
+    // Drop whatever is completely out of the retention window. Since we
+    // only do it when a new block is created, this is O(1) amortised.
+    while (mBlocks.empty() == false && mBlocks.front().maxTimestamp + mOptions.retention < timestamp) {
+      mSize -= mBlocks.front().count;
+      mBlocks.pop_front();
+    }
+    mBlocks.emplace_back();
+    mBlocks.back().bits.words.reserve((mOptions.samplesPerBlock * 4 + 63) / 64);
+  }
+  mBlocks.back().append(timestamp, bits);
+  mSize++;
+  updateRollups(timestamp, value);
+}
+
+void MetricHistory::updateRollups(size_t timestamp, float value)
+{
+  size_t bucket = timestamp - (timestamp % mOptions.rollupInterval);
+  if (mRollupsSize != 0) {
+    auto& current = mRollups[(mRollupsHead + mRollups.size() - 1) % mRollups.size()];
+    // Samples arriving late are accounted in the current bucket, to keep the
+    // rollups sorted.
+    if (bucket <= current.timestamp) {
+      current.min = std::min(current.min, value);
+      current.max = std::max(current.max, value);
+      current.sum += value;
+      current.count++;
+      return;
+    }
+  }
+  // The ring grows on demand, so that metrics which are updated rarely
+  // do not pay for the full capacity.
+  if (mRollups.size() < mOptions.rollupCapacity) {
+    mRollups.push_back(MetricRollup{ bucket, value, value, value, 1 });
+  } else {
+    mRollups[mRollupsHead] = MetricRollup{ bucket, value, value, value, 1 };
+  }
+  mRollupsHead = (mRollupsHead + 1) % mOptions.rollupCapacity;
+  mRollupsSize = std::min(mRollupsSize + 1, mOptions.rollupCapacity);
+}
+
+size_t MetricHistory::bytes() const
+{
+  size_t result = 0;
+  for (auto& block : mBlocks) {
+    result += sizeof(MetricHistoryBlock) + block.bits.words.capacity() * sizeof(uint64_t);
+  }
+  return result + mRollups.capacity() * sizeof(MetricRollup);
+}
+
+} // namespace framework
+} // namespace o2
@@ -9,8 +9,21 @@
 // or submit itself to any jurisdiction.
 #include "SimpleResourceManager.h"
 #include "ComputingResource.h"
+#include <fairlogger/Logger.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
 #include <exception>
+#include <fstream>
+#include <map>
 #include <stdexcept>
+#include <thread>
+
+#include <dirent.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 namespace o2
 {
@@ -31,12 +44,253 @@ std::vector<ComputingResource> SimpleResourceManager::getAvailableResources() {
     result.push_back(ComputingResource{
       1.0,
       1.0,
-      "localhost",
+      mHostname,
       static_cast<unsigned short>(i)
     });
   };
   return result;
 }
 
+std::vector<int> SimpleResourceManager::parseCoreList(std::string const& list)
+{
+  std::vector<int> cores;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    char* end = nullptr;
+    long first = strtol(list.c_str() + pos, &end, 10);
+    if (end == list.c_str() + pos) {
+      break;
+    }
+    long last = first;
+    pos = end - list.c_str();
+    if (pos < list.size() && list[pos] == '-') {
+      last = strtol(list.c_str() + pos + 1, &end, 10);
+      pos = end - list.c_str();
+    }
+    for (long core = first; core <= last; ++core) {
+      cores.push_back(core);
+    }
+    // Skip the separator
+    pos++;
+  }
+  return cores;
+}
+
+std::vector<int> SimpleResourceManager::allowedCores()
+{
+  std::vector<int> cores;
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if (sched_getaffinity(0, sizeof(cpuset), &cpuset) != 0) {
+    LOG(WARN) << "Unable to get the CPU affinity of the driver, devices will not be pinned";
+    return cores;
+  }
+  for (int core = 0; core < CPU_SETSIZE; ++core) {
+    if (CPU_ISSET(core, &cpuset)) {
+      cores.push_back(core);
+    }
+  }
+#else
+  for (int core = 0, n = std::thread::hardware_concurrency(); core < n; ++core) {
+    cores.push_back(core);
+  }
+#endif
+  return cores;
+}
+
+std::vector<NumaNode> SimpleResourceManager::discoverNumaNodes(std::string const& sysfs, std::vector<int> const& allowed)
+{
+  std::vector<NumaNode> nodes;
+  if (allowed.empty()) {
+    return nodes;
+  }
+  auto isAllowed = [&allowed](int core) { return std::find(allowed.begin(), allowed.end(), core) != allowed.end(); };
+  bool hasSysfs = false;
+  if (DIR* dir = opendir(sysfs.c_str())) {
+    while (auto entry = readdir(dir)) {
+      int id;
+      char trailing;
+      if (sscanf(entry->d_name, "node%d%c", &id, &trailing) != 1) {
+        continue;
+      }
+      hasSysfs = true;
+      std::ifstream cpulist(sysfs + "/" + entry->d_name + "/cpulist");
+      std::string list;
+      std::getline(cpulist, list);
+      auto cores = parseCoreList(list);
+      cores.erase(std::remove_if(cores.begin(), cores.end(), [&isAllowed](int core) { return isAllowed(core) == false; }), cores.end());
+      // Nodes with memory only, or whose cores we cannot use
+      if (cores.empty() == false) {
+        nodes.push_back(NumaNode{ id, cores });
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(nodes.begin(), nodes.end(), [](NumaNode const& a, NumaNode const& b) { return a.id < b.id; });
+
+  if (hasSysfs == false) {
+    nodes.push_back(NumaNode{ 0, allowed });
+  } else if (nodes.empty()) {
+    LOG(WARN) << "None of the allowed cores is on a NUMA node in " << sysfs << ", devices will not be pinned";
+  }
+  return nodes;
+}
+
+/// Devices are placed one by one, always picking next the one which
+/// exchanges the most data with the ones already placed, on the node
+/// where most of its peers are, as long as there is space there.
+/// Devices on the same node then get contiguous, disjoint, sets of cores.
+void SimpleResourceManager::placeDevices(std::vector<DeviceSpec>& devices)
+{
+  if (mHostname.empty()) {
+    return;
+  }
+  // The topology of the host is only needed when pinning devices
+  if (mNodes.empty()) {
+    mNodes = discoverNumaNodes();
+  }
+  if (mNodes.empty()) {
+    return;
+  }
+  std::vector<size_t> local;
+  for (size_t di = 0; di < devices.size(); ++di) {
+    if (devices[di].hostname == mHostname) {
+      local.push_back(di);
+    }
+  }
+  const size_t nDevices = local.size();
+  if (nDevices == 0) {
+    return;
+  }
+
+  // How much data goes between two devices. We count one for each route
+  // over the channels connecting them, scaled by the rate of messages, if
+  // known.
+  std::map<std::string, size_t> channelProducer;
+  for (size_t li = 0; li < nDevices; ++li) {
+    for (auto& channel : devices[local[li]].outputChannels) {
+      channelProducer[channel.name] = li;
+    }
+  }
+  std::vector<std::vector<float>> weights(nDevices, std::vector<float>(nDevices, 0.f));
+  std::vector<float> totalWeight(nDevices, 0.f);
+  for (size_t ci = 0; ci < nDevices; ++ci) {
+    for (auto& channel : devices[local[ci]].inputChannels) {
+      auto producerIt = channelProducer.find(channel.name);
+      if (producerIt == channelProducer.end()) {
+        continue;
+      }
+      size_t pi = producerIt->second;
+      auto& producer = devices[local[pi]];
+      size_t routes = 0;
+      for (auto& route : producer.outputs) {
+        routes += route.channel == channel.name;
+      }
+      for (auto& route : producer.forwards) {
+        routes += route.channel == channel.name;
+      }
+      float weight = std::max<size_t>(routes, 1) * (producer.messageRate > 0.f ? producer.messageRate : 1.f);
+      weights[pi][ci] += weight;
+      weights[ci][pi] += weight;
+      totalWeight[pi] += weight;
+      totalWeight[ci] += weight;
+    }
+  }
+
+  // Give each device as many cores as possible, as long as all of them fit
+  // on the nodes. If there are more devices than cores, devices on a node
+  // share all its cores.
+  size_t nCores = 0;
+  for (auto& node : mNodes) {
+    nCores += node.cores.size();
+  }
+  auto capacityFor = [this, nDevices, nCores](size_t coresPerDevice) {
+    std::vector<size_t> capacity;
+    for (auto& node : mNodes) {
+      if (coresPerDevice == 0) {
+        capacity.push_back((nDevices * node.cores.size() + nCores - 1) / nCores);
+      } else {
+        capacity.push_back(node.cores.size() / coresPerDevice);
+      }
+    }
+    return capacity;
+  };
+  size_t coresPerDevice = nCores / nDevices;
+  std::vector<size_t> capacity;
+  for (; coresPerDevice > 0; --coresPerDevice) {
+    capacity = capacityFor(coresPerDevice);
+    size_t total = 0;
+    for (auto c : capacity) {
+      total += c;
+    }
+    if (total >= nDevices) {
+      break;
+    }
+  }
+  if (coresPerDevice == 0) {
+    capacity = capacityFor(0);
+  }
+
+  std::vector<int> nodeOf(nDevices, -1);
+  std::vector<size_t> load(mNodes.size(), 0);
+  std::vector<std::vector<size_t>> placed(mNodes.size());
+  for (size_t step = 0; step < nDevices; ++step) {
+    // Pick the device most connected to the ones already placed.
+    size_t next = nDevices;
+    float nextAffinity = -1.f;
+    for (size_t li = 0; li < nDevices; ++li) {
+      if (nodeOf[li] >= 0) {
+        continue;
+      }
+      float affinity = 0.f;
+      for (size_t other = 0; other < nDevices; ++other) {
+        if (nodeOf[other] >= 0) {
+          affinity += weights[li][other];
+        }
+      }
+      if (next == nDevices || affinity > nextAffinity ||
+          (affinity == nextAffinity && totalWeight[li] > totalWeight[next])) {
+        next = li;
+        nextAffinity = affinity;
+      }
+    }
+    // Put it where most of its peers are, or on the least loaded node.
+    int best = -1;
+    float bestAffinity = 0.f;
+    for (size_t ni = 0; ni < mNodes.size(); ++ni) {
+      if (load[ni] >= capacity[ni]) {
+        continue;
+      }
+      float affinity = 0.f;
+      for (auto other : placed[ni]) {
+        affinity += weights[next][other];
+      }
+      if (best < 0 || affinity > bestAffinity ||
+          (affinity == bestAffinity && load[ni] * capacity[best] < load[best] * capacity[ni])) {
+        best = ni;
+        bestAffinity = affinity;
+      }
+    }
+    assert(best >= 0);
+    nodeOf[next] = best;
+    load[best]++;
+    placed[best].push_back(next);
+  }
+
+  for (size_t ni = 0; ni < mNodes.size(); ++ni) {
+    auto& cores = mNodes[ni].cores;
+    for (size_t pi = 0; pi < placed[ni].size(); ++pi) {
+      auto& device = devices[local[placed[ni][pi]]];
+      device.numaNode = mNodes[ni].id;
+      if (coresPerDevice == 0) {
+        device.cores = cores;
+      } else {
+        device.cores.assign(cores.begin() + pi * coresPerDevice, cores.begin() + (pi + 1) * coresPerDevice);
+      }
+    }
+  }
+}
+
 } // namespace framework
 } // namespace o2
@@ -11,6 +11,9 @@
 #define FRAMEWORK_SIMPLERESOURCEMANAGER_H
 
 #include "ResourceManager.h"
+#include "Framework/DeviceSpec.h"
+#include <string>
+#include <vector>
 
 namespace o2
 {
@@ -19,22 +22,54 @@ namespace framework
 
 /// A resource manager with infinite resources at its disposal.
 /// This is a trivial implementation which can be used to do
-/// laptop deploys.
+/// laptop deploys. Besides the ports, it knows about the NUMA nodes of
+/// the host, so that it can decide where each device should run.
 class SimpleResourceManager : public ResourceManager {
  public:
   /// @a initialPort is the first port which can be used
   ///              by this trivial resource manager.
   /// @a maxPorts is the maximum number of ports starting from
   ///             initialPort that this resource manager can allocate.
-  SimpleResourceManager(unsigned short initialPort, unsigned short maxPorts = 1000)
+  /// @a hostname is the host all the resources belong to, empty if
+  ///             devices are placed by some external entity.
+  /// @a nodes are the NUMA nodes of the host, discovered from the system
+  ///        when devices are placed if empty.
+  SimpleResourceManager(unsigned short initialPort, unsigned short maxPorts = 1000,
+                        std::string const& hostname = "localhost",
+                        std::vector<NumaNode> const& nodes = {})
     : mInitialPort{ initialPort },
-      mMaxPorts{ maxPorts }
+      mMaxPorts{ maxPorts },
+      mHostname{ hostname },
+      mNodes{ nodes }
   {}
   std::vector<ComputingResource> getAvailableResources() override;
 
+  /// Decide on which NUMA node and cores each of the @a devices running
+  /// on this host should run. Devices exchanging the most data, as
+  /// given by the number of routes between them and their message rate,
+  /// are kept on the same node, and each device gets its own cores, as long
+  /// as there are enough of them.
+  void placeDevices(std::vector<DeviceSpec>& devices);
+
+  /// The NUMA nodes of this host, as described in @a sysfs, restricted to
+  /// the @a allowed cores. If sysfs is not available, a single node with all
+  /// the allowed cores. Empty if no core is known to be allowed, in which
+  /// case devices are not pinned.
+  static std::vector<NumaNode> discoverNumaNodes(std::string const& sysfs = "/sys/devices/system/node",
+                                                 std::vector<int> const& allowed = allowedCores());
+
+  /// The cores this process is allowed to run on, e.g. because of taskset
+  /// or cgroups. Empty if they cannot be determined.
+  static std::vector<int> allowedCores();
+
+  /// Parse a list of cores in the Linux format, e.g. "0-3,8,10-11".
+  static std::vector<int> parseCoreList(std::string const& list);
+
  private:
   int mInitialPort;
   int mMaxPorts;
+  std::string mHostname;
+  std::vector<NumaNode> mNodes;
 };
 
 } // namespace framework
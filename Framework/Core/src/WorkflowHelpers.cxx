@@ -114,6 +114,23 @@ std::vector<TopoIndexInfo>
   return S;
 }
 
+namespace
+{
+/// Where a device with condition inputs gets them from.
+void addConditionOptions(Options& options)
+{
+  auto hasOption = [&options](std::string const& name) {
+    return std::find_if(options.begin(), options.end(), [&name](ConfigParamSpec const& spec) { return spec.name == name; }) != options.end();
+  };
+  if (hasOption("condition-backend") == false) {
+    options.push_back(ConfigParamSpec{ "condition-backend", VariantType::String, "", { "URL of the CCDB, file://<directory> for a local one, conditions are not fetched if empty" } });
+  }
+  if (hasOption("condition-cache") == false) {
+    options.push_back(ConfigParamSpec{ "condition-cache", VariantType::String, "", { "Directory of the per host condition cache, default if empty" } });
+  }
+}
+} // namespace
+
 void WorkflowHelpers::injectServiceDevices(WorkflowSpec& workflow)
 {
   auto fakeCallback = AlgorithmSpec{ [](InitContext&) {
@@ -153,7 +170,8 @@ void WorkflowHelpers::injectServiceDevices(WorkflowSpec& workflow)
     {},
     {},
     readers::AODReaderHelpers::rootFileReaderCallback(),
-    { ConfigParamSpec{ "aod-file", VariantType::String, "aod.root", { "Input AOD file" } } }
+    { ConfigParamSpec{ "aod-file", VariantType::String, "aod.root", { "Input AOD file" } },
+      ConfigParamSpec{ "aod-chunk-size", VariantType::Int, 0, { "Max number of rows per AOD table and timeslice, 0 for whole tables" } } }
   };
 
   for (size_t wi = 0; wi < workflow.size(); ++wi) {
@@ -165,7 +183,11 @@ void WorkflowHelpers::injectServiceDevices(WorkflowSpec& workflow)
           auto concrete = DataSpecUtils::asConcreteDataMatcher(input);
           timer.outputs.emplace_back(OutputSpec{ concrete.origin, concrete.description, concrete.subSpec, Lifetime::Timer });
         } break;
-        case Lifetime::Condition:
+        case Lifetime::Condition: {
+          auto concrete = DataSpecUtils::asConcreteDataMatcher(input);
+          ccdbBackend.outputs.emplace_back(OutputSpec{ concrete.origin, concrete.description, concrete.subSpec, Lifetime::Condition });
+          addConditionOptions(consumer.options);
+        } break;
         case Lifetime::QA:
         case Lifetime::Transient:
         case Lifetime::Timeframe:
@@ -63,6 +63,7 @@
 #include <map>
 #include <regex>
 #include <set>
+#include <sstream>
 #include <string>
 #include <type_traits>
 #include <chrono>
@@ -75,6 +76,9 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <netinet/ip.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 using namespace o2::monitoring;
 using namespace AliceO2::InfoLogger;
@@ -279,6 +283,21 @@ void spawnDevice(DeviceSpec const& spec, std::map<int, size_t>& socket2DeviceInf
     close(STDERR_FILENO);
     dup2(childstdout[1], STDOUT_FILENO);
     dup2(childstderr[1], STDERR_FILENO);
+#ifdef __linux__
+    // The affinity is inherited by the exec'd process. Since memory is
+    // allocated on the node where it is first touched, this also keeps the
+    // device memory on its NUMA node.
+    if (spec.cores.empty() == false) {
+      cpu_set_t cpuset;
+      CPU_ZERO(&cpuset);
+      for (auto core : spec.cores) {
+        CPU_SET(core, &cpuset);
+      }
+      if (sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0) {
+        LOG(WARN) << "Unable to pin " << spec.id << ": " << strerror(errno) << ", running it unpinned";
+      }
+    }
+#endif
     execvp(execution.args[0], execution.args.data());
   }
 
@@ -704,7 +723,8 @@ int runStateMachine(DataProcessorSpecs const& workflow, DriverControl& driverCon
   DeviceInfos infos;
   DeviceControls controls;
   DeviceExecutions deviceExecutions;
-  auto resourceManager = std::make_unique<SimpleResourceManager>(driverInfo.startPort, driverInfo.portRange);
+  auto resourceManager = std::make_unique<SimpleResourceManager>(driverInfo.startPort, driverInfo.portRange,
+                                                                 driverInfo.externalDeployment ? "" : "localhost");
 
   void* window = nullptr;
   decltype(gui::getGUIDebugger(infos, deviceSpecs, metricsInfos, driverInfo, controls, driverControl)) debugGUICallback;
@@ -790,6 +810,22 @@ int runStateMachine(DataProcessorSpecs const& workflow, DriverControl& driverCon
         try {
           std::vector<ComputingResource> resources = resourceManager->getAvailableResources();
           DeviceSpecHelpers::dataProcessorSpecs2DeviceSpecs(workflow, driverInfo.channelPolicies, driverInfo.completionPolicies, deviceSpecs, resources);
+          if (driverInfo.sharedMemory) {
+            DeviceSpecHelpers::useSharedMemoryChannels(deviceSpecs);
+          }
+          if (driverInfo.pinDevices && frameworkId.empty()) {
+            resourceManager->placeDevices(deviceSpecs);
+            for (auto& spec : deviceSpecs) {
+              if (spec.cores.empty()) {
+                continue;
+              }
+              std::ostringstream cores;
+              for (size_t ci = 0; ci < spec.cores.size(); ++ci) {
+                cores << (ci ? "," : "") << spec.cores[ci];
+              }
+              LOG(INFO) << "Placing " << spec.id << " on NUMA node " << spec.numaNode << ", cores " << cores.str();
+            }
+          }
           // This should expand nodes so that we can build a consistent DAG.
         } catch (std::runtime_error& e) {
           std::cerr << "Invalid workflow: " << e.what() << std::endl;
@@ -1027,6 +1063,8 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
     ("batch,b", bpo::value<bool>()->zero_tokens()->default_value(false), "batch processing mode")           //
     ("start-port,p", bpo::value<unsigned short>()->default_value(22000), "start port to allocate")          //
     ("port-range,pr", bpo::value<unsigned short>()->default_value(1000), "ports in range")                  //
+    ("pin-devices", bpo::value<bool>()->zero_tokens()->default_value(false), "pin devices to NUMA cores")   //
+    ("shm", bpo::value<bool>()->zero_tokens()->default_value(false), "shared memory between local devices") //
     ("completion-policy,c", bpo::value<TerminationPolicy>(&policy)->default_value(TerminationPolicy::QUIT), //
      "what to do when processing is finished")                                                              //
     ("graphviz,g", bpo::value<bool>()->zero_tokens()->default_value(false), "produce graph output")         //
@@ -1118,6 +1156,9 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
   driverInfo.timeout = varmap["timeout"].as<double>();
   driverInfo.startPort = varmap["start-port"].as<unsigned short>();
   driverInfo.portRange = varmap["port-range"].as<unsigned short>();
+  driverInfo.externalDeployment = varmap["dds"].as<bool>() || varmap["o2-control"].as<bool>();
+  driverInfo.sharedMemory = varmap["shm"].as<bool>();
+  driverInfo.pinDevices = varmap["pin-devices"].as<bool>();
   driverInfo.workflowOptions = workflowOptions;
   driverInfo.configContext = &configContext;
 
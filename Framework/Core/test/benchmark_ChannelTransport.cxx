@@ -0,0 +1,75 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include <benchmark/benchmark.h>
+
+#include "Framework/ChannelSpec.h"
+#include "../src/ChannelSpecHelpers.h"
+#include <fairmq/FairMQChannel.h>
+#include <fairmq/FairMQTransportFactory.h>
+#include <cstring>
+#include <thread>
+
+using namespace o2::framework;
+
+// Push state.range(1) messages of state.range(0) bytes from a producer
+// thread to a consumer, the way two co-located devices would do it, once
+// over TCP and once with the payloads in shared memory.
+static void BM_ChannelThroughput(benchmark::State& state, ChannelProtocol protocol)
+{
+  const size_t messageSize = state.range(0);
+  const size_t nMessages = state.range(1);
+
+  OutputChannelSpec output;
+  output.name = "benchmark";
+  output.method = ChannelMethod::Bind;
+  output.hostname = "localhost";
+  output.port = 22999;
+  output.protocol = protocol;
+  InputChannelSpec input;
+  input.name = "benchmark";
+  input.method = ChannelMethod::Connect;
+  input.hostname = "localhost";
+  input.port = 22999;
+  input.protocol = protocol;
+
+  auto transport = FairMQTransportFactory::CreateTransportFactory(ChannelSpecHelpers::transportAsString(protocol));
+  FairMQChannel push{ "push", "push", transport };
+  FairMQChannel pull{ "pull", "pull", transport };
+  // Keep the amount of data in flight within the shared memory segment.
+  push.UpdateSndBufSize(8);
+  pull.UpdateRcvBufSize(8);
+  push.Bind(ChannelSpecHelpers::channelUrl(output));
+  pull.Connect(ChannelSpecHelpers::channelUrl(input));
+  push.ValidateChannel();
+  pull.ValidateChannel();
+
+  for (auto _ : state) {
+    std::thread producer([&push, &transport, messageSize, nMessages]() {
+      for (size_t i = 0; i < nMessages; ++i) {
+        auto message = transport->CreateMessage(messageSize);
+        memset(message->GetData(), i, messageSize);
+        push.Send(message);
+      }
+    });
+    for (size_t i = 0; i < nMessages; ++i) {
+      auto message = transport->CreateMessage();
+      pull.Receive(message);
+      benchmark::DoNotOptimize(static_cast<char*>(message->GetData())[messageSize - 1]);
+    }
+    producer.join();
+  }
+  state.SetBytesProcessed(state.iterations() * messageSize * nMessages);
+}
+
+// 4GB per iteration, in messages of 1MB and 64MB
+BENCHMARK_CAPTURE(BM_ChannelThroughput, tcp, ChannelProtocol::Network)->Args({ 1 << 20, 4096 })->Args({ 64 << 20, 64 })->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ChannelThroughput, shmem, ChannelProtocol::IPC)->Args({ 1 << 20, 4096 })->Args({ 64 << 20, 64 })->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,134 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include <benchmark/benchmark.h>
+
+#include "Headers/DataHeader.h"
+#include "Headers/Stack.h"
+#include "Framework/ConfigParamRegistry.h"
+#include "Framework/ContextRegistry.h"
+#include "Framework/DataAllocator.h"
+#include "Framework/DataProcessingHeader.h"
+#include "Framework/Dispatcher.h"
+#include "Framework/InitContext.h"
+#include "Framework/InputRecord.h"
+#include "Framework/ProcessingContext.h"
+#include "Framework/ServiceRegistry.h"
+#include <fairmq/FairMQDevice.h>
+#include <fairmq/FairMQParts.h>
+#include <fairmq/FairMQTransportFactory.h>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+using namespace o2::framework;
+using DataHeader = o2::header::DataHeader;
+using Stack = o2::header::Stack;
+
+namespace
+{
+// Writes a configuration with a single policy sampling TST/RAWDATA with the
+// given fraction and returns its URI for the Dispatcher.
+std::string createConfiguration(double fraction)
+{
+  std::string path = "/tmp/benchmark_DataSampling_" + std::to_string(getpid()) + ".json";
+  std::ofstream file(path);
+  file << R"({ "dataSamplingPolicies": [ {
+      "id": "bench", "active": "true", "machines": [],
+      "dataHeaders": [ { "binding": "raw", "dataOrigin": "TST", "dataDescription": "RAWDATA" } ],
+      "subSpec": "0",
+      "samplingConditions": [ { "condition": "random", "fraction": ")"
+       << fraction << R"(", "seed": "2137" } ] } ] })";
+  return "json://" + path;
+}
+
+// Runs the Dispatcher on a 1MB payload, with the given sampling fraction in
+// percent. When @a shareMessages is false the inputs are not backed by the
+// FairMQ messages, so that the Dispatcher has to copy the sampled payloads.
+void dispatch(benchmark::State& state, bool shareMessages)
+{
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  FairMQDevice device;
+  device.SetTransport("zeromq");
+  device.fChannels["from_dispatcher_to_sink"].emplace_back("from_dispatcher_to_sink", "push", transport);
+
+  // The output of the policy is DS/bench-0, see DataSamplingPolicy.
+  std::vector<OutputRoute> routes{ OutputRoute{ 0, 1, OutputSpec{ "DS", "bench-0", 0 }, "from_dispatcher_to_sink" } };
+  TimingInfo timingInfo{ 0 };
+  MessageContext messageContext{ FairMQDeviceProxy{ &device } };
+  RootObjectContext rootContext{ FairMQDeviceProxy{ &device } };
+  StringContext stringContext{ FairMQDeviceProxy{ &device } };
+  ArrowContext arrowContext{ FairMQDeviceProxy{ &device } };
+  RawBufferContext rawContext{ FairMQDeviceProxy{ &device } };
+  ContextRegistry contextes{ { &messageContext, &rootContext, &stringContext, &arrowContext, &rawContext } };
+  DataAllocator allocator{ &timingInfo, &contextes, routes };
+  ServiceRegistry services;
+  ConfigParamRegistry options{ nullptr };
+
+  std::string configuration = createConfiguration(state.range(0) / 100.);
+  Dispatcher dispatcher{ "Dispatcher", configuration };
+  InitContext initContext{ options, services };
+  dispatcher.init(initContext);
+  std::remove(configuration.substr(strlen("json://")).c_str());
+
+  InputSpec spec{ "raw", "TST", "RAWDATA", 0 };
+  std::vector<InputRoute> schema{ InputRoute{ spec, "from_source_to_dispatcher", 0 } };
+
+  DataHeader dh;
+  dh.dataDescription = "RAWDATA";
+  dh.dataOrigin = "TST";
+  dh.subSpecification = 0;
+  dh.payloadSize = 1024 * 1024;
+  dh.payloadSerializationMethod = o2::header::gSerializationMethodNone;
+  FairMQMessagePtr payload = transport->CreateMessage(dh.payloadSize);
+  memset(payload->GetData(), 0xaa, dh.payloadSize);
+
+  size_t timeslice = 0;
+  for (auto _ : state) {
+    DataProcessingHeader dph{ timeslice++, 1 };
+    Stack stack{ dh, dph };
+    std::vector<char const*> buffers{ reinterpret_cast<char const*>(stack.data()), static_cast<char const*>(payload->GetData()) };
+    auto getter = [&buffers](size_t i) { return buffers[i]; };
+    InputSpan span = shareMessages ? InputSpan{ getter, [&payload](size_t i) { return i == 1 ? payload.get() : nullptr; }, buffers.size() }
+                                   : InputSpan{ getter, buffers.size() };
+    InputRecord record{ schema, std::move(span) };
+    ProcessingContext processingContext{ record, services, allocator };
+
+    dispatcher.run(processingContext);
+
+    // Drop what would have been sent, as the DataProcessingDevice does
+    // after the processing.
+    for (auto& message : messageContext) {
+      FairMQParts parts = std::move(message.parts);
+      benchmark::DoNotOptimize(parts.At(1)->GetData());
+    }
+    messageContext.clear();
+  }
+  state.SetBytesProcessed(state.iterations() * dh.payloadSize);
+}
+} // namespace
+
+// Sampled payloads are copied into new messages.
+static void BM_DispatchCopy(benchmark::State& state)
+{
+  dispatch(state, false);
+}
+
+BENCHMARK(BM_DispatchCopy)->Arg(1)->Arg(10)->Arg(50)->Arg(100);
+
+// Sampled payloads are shared with a reference counted copy of the message.
+static void BM_DispatchShared(benchmark::State& state)
+{
+  dispatch(state, true);
+}
+
+BENCHMARK(BM_DispatchShared)->Arg(1)->Arg(10)->Arg(50)->Arg(100);
+
+BENCHMARK_MAIN()
@@ -10,6 +10,7 @@
 #include "Framework/DeviceMetricsInfo.h"
 
 #include <benchmark/benchmark.h>
+#include <algorithm>
 #include <regex>
 
 // This is the fastest we could ever get.
@@ -162,4 +163,67 @@ static void BM_ProcessMismatchedMetric(benchmark::State& state)
 
 BENCHMARK(BM_ProcessMismatchedMetric);
 
+// Append to the compressed history, with metrics arriving at a regular
+// interval and slowly changing values.
+static void BM_MetricHistoryAppend(benchmark::State& state)
+{
+  using namespace o2::framework;
+  MetricHistory history;
+  size_t timestamp = 1789372894;
+  float value = 0;
+
+  for (auto _ : state) {
+    timestamp += 1000;
+    value += 0.5;
+    history.append(timestamp, value);
+  }
+  state.counters["bytesPerSample"] = (double)history.bytes() / history.size();
+}
+
+BENCHMARK(BM_MetricHistoryAppend);
+
+// Decode a window of the history. The argument is the number of samples
+// being read back.
+static void BM_MetricHistoryQuery(benchmark::State& state)
+{
+  using namespace o2::framework;
+  MetricHistory history;
+  size_t timestamp = 1789372894;
+  for (size_t i = 0; i < 100000; ++i) {
+    history.append(timestamp + i * 100, (float)(i % 100));
+  }
+  size_t begin = timestamp + (100000 - state.range(0)) * 100;
+
+  for (auto _ : state) {
+    float sum = 0;
+    history.forEach<float>(begin, -1, [&sum](size_t, float v) { sum += v; });
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_MetricHistoryQuery)->Arg(1024)->Arg(16384)->Arg(100000);
+
+// Read back the downsampled view, as the GUI would do.
+static void BM_MetricHistoryRollups(benchmark::State& state)
+{
+  using namespace o2::framework;
+  MetricHistory history;
+  size_t timestamp = 1789372894;
+  for (size_t i = 0; i < 100000; ++i) {
+    history.append(timestamp + i * 100, (float)(i % 100));
+  }
+
+  for (auto _ : state) {
+    float max = 0;
+    for (size_t ri = 0; ri < history.rollupsSize(); ++ri) {
+      max = std::max(max, history.rollup(ri).max);
+    }
+    benchmark::DoNotOptimize(max);
+  }
+  state.SetItemsProcessed(state.iterations() * history.rollupsSize());
+}
+
+BENCHMARK(BM_MetricHistoryRollups);
+
 BENCHMARK_MAIN()
@@ -14,6 +14,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include "../src/ChannelSpecHelpers.h"
+#include <unistd.h>
 
 using namespace o2::framework;
 
@@ -43,3 +44,30 @@ BOOST_AUTO_TEST_CASE(TestChannelType)
 
   BOOST_REQUIRE_EQUAL(oss.str(), "pubsubpushpull");
 }
+
+BOOST_AUTO_TEST_CASE(TestChannelUrl)
+{
+  OutputChannelSpec output;
+  output.method = ChannelMethod::Bind;
+  output.hostname = "localhost";
+  output.port = 22000;
+  InputChannelSpec input;
+  input.method = ChannelMethod::Connect;
+  input.hostname = "localhost";
+  input.port = 22000;
+
+  BOOST_CHECK_EQUAL(ChannelSpecHelpers::channelUrl(output), "tcp://*:22000");
+  BOOST_CHECK_EQUAL(ChannelSpecHelpers::channelUrl(input), "tcp://127.0.0.1:22000");
+  input.hostname = "flp001";
+  BOOST_CHECK_EQUAL(ChannelSpecHelpers::channelUrl(input), "tcp://flp001:22000");
+
+  // Both ends of an IPC channel refer to the same socket.
+  output.protocol = ChannelProtocol::IPC;
+  input.protocol = ChannelProtocol::IPC;
+  // The socket is specific to the workflow, i.e. to the driver process.
+  auto ipcUrl = "ipc:///tmp/o2-dpl-" + std::to_string(getpid()) + "-22000";
+  BOOST_CHECK_EQUAL(ChannelSpecHelpers::channelUrl(output), ipcUrl);
+  BOOST_CHECK_EQUAL(ChannelSpecHelpers::channelUrl(input), ipcUrl);
+  BOOST_CHECK_EQUAL(ChannelSpecHelpers::transportAsString(ChannelProtocol::IPC), std::string("shmem"));
+  BOOST_CHECK_EQUAL(ChannelSpecHelpers::transportAsString(ChannelProtocol::Network), std::string("zeromq"));
+}
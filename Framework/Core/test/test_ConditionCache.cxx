@@ -0,0 +1,281 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework ConditionCache
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "Framework/ConditionBackend.h"
+#include "Framework/ConditionCache.h"
+#include "Framework/ConcreteDataMatcher.h"
+#include "Framework/DataProcessingHeader.h"
+#include "Framework/LifetimeHelpers.h"
+#include "Framework/PartRef.h"
+#include "Framework/ServiceRegistry.h"
+#include "Framework/SimpleRawDeviceService.h"
+#include "Headers/DataHeader.h"
+
+#include <fairmq/FairMQDevice.h>
+#include <fairmq/FairMQTransportFactory.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace o2::framework;
+
+namespace
+{
+/// File based backend which counts how many times it was asked for
+/// something.
+class CountingBackend : public FileConditionBackend
+{
+public:
+  CountingBackend(std::string const& directory, int& fetches)
+    : FileConditionBackend(directory), mFetches{ fetches }
+  {
+  }
+
+  bool fetch(std::string const& path, uint64_t timestamp, ConditionBlob& blob) override
+  {
+    mFetches++;
+    return FileConditionBackend::fetch(path, timestamp, blob);
+  }
+
+private:
+  int& mFetches;
+};
+
+std::string makeTemporaryDirectory()
+{
+  char name[] = "/tmp/test_ConditionCache.XXXXXX";
+  BOOST_REQUIRE(mkdtemp(name) != nullptr);
+  return name;
+}
+
+ConditionBlob makeBlob(std::string const& content, uint64_t validFrom, uint64_t validUntil)
+{
+  ConditionBlob blob;
+  blob.data.assign(content.begin(), content.end());
+  blob.validFrom = validFrom;
+  blob.validUntil = validUntil;
+  return blob;
+}
+
+std::string asString(std::shared_ptr<MappedCondition> const& object)
+{
+  return std::string(object->data(), object->size());
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestFileConditionBackend)
+{
+  auto directory = makeTemporaryDirectory();
+  FileConditionBackend backend(directory);
+  backend.store("/TPC/GAIN/0", makeBlob("first", 0, 1000));
+  backend.store("/TPC/GAIN/0", makeBlob("second", 500, 2000));
+
+  ConditionBlob blob;
+  BOOST_REQUIRE(backend.fetch("/TPC/GAIN/0", 100, blob));
+  BOOST_CHECK_EQUAL(std::string(blob.data.begin(), blob.data.end()), "first");
+  // The latest start of validity wins.
+  BOOST_REQUIRE(backend.fetch("/TPC/GAIN/0", 600, blob));
+  BOOST_CHECK_EQUAL(std::string(blob.data.begin(), blob.data.end()), "second");
+  BOOST_CHECK_EQUAL(blob.validFrom, 500);
+  BOOST_CHECK_EQUAL(blob.validUntil, 2000);
+  BOOST_CHECK(backend.fetch("/TPC/GAIN/0", 2000, blob) == false);
+  BOOST_CHECK(backend.fetch("/TPC/PEDESTAL/0", 100, blob) == false);
+  system(("rm -rf " + directory).c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestConditionCache)
+{
+  auto backendDirectory = makeTemporaryDirectory();
+  auto cacheDirectory = makeTemporaryDirectory();
+  FileConditionBackend store(backendDirectory);
+  store.store("/TPC/GAIN/0", makeBlob("first", 0, 1000));
+  store.store("/TPC/GAIN/0", makeBlob("second", 1000, 2000));
+  // Same content, different validity.
+  store.store("/TPC/GAIN/0", makeBlob("first", 2000, 3000));
+
+  int fetches = 0;
+  ConditionCache cache(cacheDirectory, std::make_unique<CountingBackend>(backendDirectory, fetches));
+
+  auto object = cache.get("/TPC/GAIN/0", 10);
+  BOOST_REQUIRE(object);
+  BOOST_CHECK_EQUAL(asString(object), "first");
+  BOOST_CHECK_EQUAL(fetches, 1);
+  // No refetching as long as the object is valid, and the same mapping is
+  // used.
+  for (uint64_t t = 11; t < 1000; t += 100) {
+    BOOST_CHECK(cache.get("/TPC/GAIN/0", t) == object);
+  }
+  BOOST_CHECK_EQUAL(fetches, 1);
+
+  auto second = cache.get("/TPC/GAIN/0", 1500);
+  BOOST_REQUIRE(second);
+  BOOST_CHECK_EQUAL(asString(second), "second");
+  BOOST_CHECK_EQUAL(second->validFrom(), 1000);
+  BOOST_CHECK_EQUAL(second->validUntil(), 2000);
+  BOOST_CHECK_EQUAL(fetches, 2);
+
+  auto third = cache.get("/TPC/GAIN/0", 2500);
+  BOOST_REQUIRE(third);
+  BOOST_CHECK_EQUAL(asString(third), "first");
+  BOOST_CHECK(third->isValid(2500));
+  BOOST_CHECK(third->isValid(10) == false);
+  BOOST_CHECK_EQUAL(fetches, 3);
+
+  BOOST_CHECK(cache.get("/TPC/GAIN/0", 5000) == nullptr);
+  BOOST_CHECK(cache.get("/TPC/PEDESTAL/0", 10) == nullptr);
+
+  // Another process on the same host gets everything from the disk.
+  int otherFetches = 0;
+  ConditionCache other(cacheDirectory, std::make_unique<CountingBackend>(backendDirectory, otherFetches));
+  BOOST_CHECK_EQUAL(asString(other.get("/TPC/GAIN/0", 10)), "first");
+  BOOST_CHECK_EQUAL(asString(other.get("/TPC/GAIN/0", 1999)), "second");
+  BOOST_CHECK_EQUAL(asString(other.get("/TPC/GAIN/0", 2000)), "first");
+  BOOST_CHECK_EQUAL(otherFetches, 0);
+
+  system(("rm -rf " + backendDirectory + " " + cacheDirectory).c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestConditionCacheMetadata)
+{
+  auto backendDirectory = makeTemporaryDirectory();
+  auto cacheDirectory = makeTemporaryDirectory();
+  FileConditionBackend store(backendDirectory);
+  auto blob = makeBlob("flat", 0, 1000);
+  blob.serialization = o2::header::gSerializationMethodNone;
+  store.store("/TPC/MAP/0", blob);
+  store.store("/TPC/GAIN/0", makeBlob("root", 0, 1000));
+
+  {
+    ConditionCache cache(cacheDirectory, ConditionBackend::create("file://" + backendDirectory));
+    BOOST_CHECK(cache.get("/TPC/MAP/0", 10)->serialization() == o2::header::gSerializationMethodNone);
+    BOOST_CHECK(cache.get("/TPC/GAIN/0", 10)->serialization() == o2::header::gSerializationMethodROOT);
+  }
+  // The metadata is kept in the cache as well.
+  ConditionCache cache(cacheDirectory, ConditionBackend::create(""));
+  BOOST_CHECK(cache.get("/TPC/MAP/0", 10)->serialization() == o2::header::gSerializationMethodNone);
+  BOOST_CHECK(cache.get("/TPC/GAIN/0", 10)->serialization() == o2::header::gSerializationMethodROOT);
+  // Without a backend, only what is in the cache is there.
+  BOOST_CHECK(cache.get("/TPC/GAIN/0", 1000) == nullptr);
+
+  system(("rm -rf " + backendDirectory + " " + cacheDirectory).c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestConditionCacheKeyMismatch)
+{
+  auto backendDirectory = makeTemporaryDirectory();
+  auto cacheDirectory = makeTemporaryDirectory();
+  FileConditionBackend store(backendDirectory);
+  store.store("/TPC/GAIN/0", makeBlob("first", 0, 1000));
+
+  int fetches = 0;
+  {
+    ConditionCache cache(cacheDirectory, std::make_unique<CountingBackend>(backendDirectory, fetches));
+    BOOST_CHECK_EQUAL(asString(cache.get("/TPC/GAIN/0", 10)), "first");
+  }
+  BOOST_CHECK_EQUAL(fetches, 1);
+
+  // Pretend that the object on disk belongs to some other key, like in
+  // case of a hash collision.
+  std::string index = cacheDirectory + "/index/%TPC%GAIN%0";
+  std::ifstream indexFile(index);
+  uint64_t validFrom, validUntil;
+  std::string object;
+  BOOST_REQUIRE(indexFile >> validFrom >> validUntil >> object);
+  std::ofstream(cacheDirectory + "/objects/" + object + ".key") << "/TPC/OTHER/0 0 1000";
+
+  // The object is not handed out, but fetched again and stored under a
+  // different name.
+  ConditionCache cache(cacheDirectory, std::make_unique<CountingBackend>(backendDirectory, fetches));
+  BOOST_CHECK_EQUAL(asString(cache.get("/TPC/GAIN/0", 10)), "first");
+  BOOST_CHECK_EQUAL(fetches, 2);
+  BOOST_CHECK_EQUAL(asString(cache.get("/TPC/GAIN/0", 20)), "first");
+  BOOST_CHECK_EQUAL(fetches, 2);
+
+  system(("rm -rf " + backendDirectory + " " + cacheDirectory).c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestConditionCacheDirectory)
+{
+  auto directory = makeTemporaryDirectory();
+  auto backend = []() { return ConditionBackend::create(""); };
+
+  // Created only accessible by the current user.
+  ConditionCache cache(directory + "/cache", backend());
+  struct stat st;
+  BOOST_REQUIRE(lstat((directory + "/cache/objects").c_str(), &st) == 0);
+  BOOST_CHECK_EQUAL(st.st_mode & 0777, 0700);
+
+  // Somebody else could have put something in there.
+  chmod((directory + "/cache").c_str(), 0777);
+  BOOST_CHECK_THROW((ConditionCache{ directory + "/cache", backend() }), std::runtime_error);
+  chmod((directory + "/cache").c_str(), 0700);
+  BOOST_CHECK_NO_THROW((ConditionCache{ directory + "/cache", backend() }));
+
+  // Not following symlinks which could point anywhere.
+  BOOST_REQUIRE(symlink((directory + "/cache").c_str(), (directory + "/link").c_str()) == 0);
+  BOOST_CHECK_THROW((ConditionCache{ directory + "/link", backend() }), std::runtime_error);
+
+  system(("rm -rf " + directory).c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestFetchFromCCDBCache)
+{
+  auto backendDirectory = makeTemporaryDirectory();
+  auto cacheDirectory = makeTemporaryDirectory();
+  // The handler gets the timeslice, which is not a time: the object valid
+  // now has to be used, not the one valid at the timeslice.
+  uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  FileConditionBackend store(backendDirectory);
+  store.store("/TPC/GAIN/0", makeBlob("timeslice", 0, 1000));
+  store.store("/TPC/GAIN/0", makeBlob("now", now - 3600000, now + 3600000));
+
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  FairMQDevice device;
+  device.SetTransport("zeromq");
+  device.fChannels["from_ccdb"].emplace_back("from_ccdb", "pull", transport);
+  SimpleRawDeviceService rawDeviceService(&device);
+  ServiceRegistry services;
+  services.registerService<RawDeviceService>(&rawDeviceService);
+
+  auto handler = LifetimeHelpers::fetchFromCCDBCache(ConcreteDataMatcher{ "TPC", "GAIN", 0 }, "/TPC/GAIN/0",
+                                                     "file://" + backendDirectory, cacheDirectory, "from_ccdb");
+  for (uint64_t timeslice : { 1, 2 }) {
+    PartRef ref;
+    handler(services, ref, timeslice);
+    BOOST_REQUIRE(ref.header);
+    BOOST_REQUIRE(ref.payload);
+    BOOST_CHECK_EQUAL(std::string(static_cast<char*>(ref.payload->GetData()), ref.payload->GetSize()), "now");
+    auto dh = o2::header::get<o2::header::DataHeader*>(ref.header->GetData());
+    BOOST_REQUIRE(dh);
+    BOOST_CHECK(dh->dataDescription == o2::header::DataDescription("GAIN"));
+    BOOST_CHECK_EQUAL(dh->payloadSize, 3);
+    // The timeslice is still what the relayer matches the input with.
+    auto dph = o2::header::get<DataProcessingHeader*>(ref.header->GetData());
+    BOOST_REQUIRE(dph);
+    BOOST_CHECK_EQUAL(dph->startTime, timeslice);
+  }
+
+  // Not having a backend is a configuration error.
+  BOOST_CHECK_THROW(LifetimeHelpers::fetchFromCCDBCache(ConcreteDataMatcher{ "TPC", "GAIN", 0 }, "/TPC/GAIN/0",
+                                                        "", cacheDirectory, "from_ccdb"),
+                    std::runtime_error);
+
+  system(("rm -rf " + backendDirectory + " " + cacheDirectory).c_str());
+}
@@ -22,6 +22,7 @@
 #include <cstring>
 #include <vector>
 #include <map>
+#include <unistd.h>
 #include "../src/SimpleResourceManager.h"
 
 namespace o2
@@ -174,5 +175,77 @@ BOOST_AUTO_TEST_CASE(test_prepareArguments)
   matrix["processor1"] = { { "--depth", "2" }, { "--foo", "bar" }, { "--mode", "default" } };
   check({ "--depth", "2", "--processor0", "--mode silly" }, workflowOptions, deviceSpecs, matrix);
 }
+
+BOOST_AUTO_TEST_CASE(test_sharedMemoryChannels)
+{
+  auto algorithm = [](ProcessingContext& ctx) {};
+
+  WorkflowSpec workflow{
+    { "processor0",
+      {},
+      { OutputSpec{ { "output" }, "TST", "DUMMYDATA", 0, Lifetime::Timeframe } },
+      AlgorithmSpec(algorithm) },
+    { "processor1",
+      { InputSpec{ "input", "TST", "DUMMYDATA", 0, Lifetime::Timeframe } },
+      {},
+      AlgorithmSpec(algorithm) },
+  };
+
+  // Devices on the same host use TCP, unless shared memory is asked for.
+  std::vector<DeviceSpec> deviceSpecs;
+  auto resources = SimpleResourceManager(42000, 100).getAvailableResources();
+  DeviceSpecHelpers::dataProcessorSpecs2DeviceSpecs(workflow,
+                                                    ChannelConfigurationPolicy::createDefaultPolicies(),
+                                                    CompletionPolicy::createDefaultPolicies(),
+                                                    deviceSpecs,
+                                                    resources);
+  BOOST_REQUIRE_EQUAL(deviceSpecs.size(), 2);
+  BOOST_CHECK_EQUAL(deviceSpecs[0].hostname, "localhost");
+  BOOST_CHECK_EQUAL(deviceSpecs[1].hostname, "localhost");
+  BOOST_CHECK(deviceSpecs[0].outputChannels[0].protocol == ChannelProtocol::Network);
+  BOOST_CHECK(deviceSpecs[1].inputChannels[0].protocol == ChannelProtocol::Network);
+  BOOST_CHECK(DeviceSpecHelpers::sharedMemorySegmentSizes(deviceSpecs).empty());
+
+  DeviceSpecHelpers::useSharedMemoryChannels(deviceSpecs);
+  BOOST_CHECK(deviceSpecs[0].outputChannels[0].protocol == ChannelProtocol::IPC);
+  BOOST_CHECK(deviceSpecs[1].inputChannels[0].protocol == ChannelProtocol::IPC);
+
+  // A single segment for the host, shared by the two devices.
+  auto segmentSizes = DeviceSpecHelpers::sharedMemorySegmentSizes(deviceSpecs);
+  BOOST_REQUIRE_EQUAL(segmentSizes.size(), 1);
+  auto segmentSize = std::to_string(segmentSizes["localhost"]);
+  // Sockets and segment are specific to this workflow.
+  auto session = "dpl-" + std::to_string(getpid());
+  auto address = "ipc:///tmp/o2-dpl-" + std::to_string(getpid()) + "-42000";
+  CheckMatrix matrix;
+  matrix["processor0"] = { { "--shm-segment-size", segmentSize },
+                           { "--session", session },
+                           { "--channel-config", "name=from_processor0_to_processor1,type=push,method=bind,address=" + address + ",transport=shmem,rateLogging=60" } };
+  matrix["processor1"] = { { "--shm-segment-size", segmentSize },
+                           { "--session", session },
+                           { "--channel-config", "name=from_processor0_to_processor1,type=pull,method=connect,address=" + address + ",transport=shmem,rateLogging=60" } };
+  check({}, {}, deviceSpecs, matrix);
+
+  // An explicit size wins
+  matrix["processor0"] = { { "--shm-segment-size", "1000000" } };
+  matrix["processor1"] = matrix["processor0"];
+  check({ "--shm-segment-size", "1000000" }, {}, deviceSpecs, matrix);
+
+  // If we do not know where devices run, we stick to TCP.
+  deviceSpecs.clear();
+  resources = SimpleResourceManager(42000, 100, "").getAvailableResources();
+  DeviceSpecHelpers::dataProcessorSpecs2DeviceSpecs(workflow,
+                                                    ChannelConfigurationPolicy::createDefaultPolicies(),
+                                                    CompletionPolicy::createDefaultPolicies(),
+                                                    deviceSpecs,
+                                                    resources);
+  DeviceSpecHelpers::useSharedMemoryChannels(deviceSpecs);
+  BOOST_REQUIRE_EQUAL(deviceSpecs.size(), 2);
+  BOOST_CHECK(deviceSpecs[0].outputChannels[0].protocol == ChannelProtocol::Network);
+  BOOST_CHECK(deviceSpecs[1].inputChannels[0].protocol == ChannelProtocol::Network);
+  matrix["processor0"] = { { "--channel-config", "name=from_processor0_to_processor1,type=push,method=bind,address=tcp://*:42000,rateLogging=60" } };
+  matrix["processor1"] = { { "--channel-config", "name=from_processor0_to_processor1,type=pull,method=connect,address=tcp://127.0.0.1:42000,rateLogging=60" } };
+  check({}, {}, deviceSpecs, matrix);
+}
 }
 }
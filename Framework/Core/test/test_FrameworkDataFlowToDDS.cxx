@@ -68,7 +68,8 @@ BOOST_AUTO_TEST_CASE(TestGraphviz)
   std::ostringstream ss{ "" };
   auto channelPolicies = ChannelConfigurationPolicy::createDefaultPolicies();
   std::vector<DeviceSpec> devices;
-  SimpleResourceManager rm(22000, 1000);
+  // DDS decides where devices run, like when the driver exports to DDS.
+  SimpleResourceManager rm(22000, 1000, "");
   auto resources = rm.getAvailableResources();
   auto completionPolicies = CompletionPolicy::createDefaultPolicies();
   DeviceSpecHelpers::dataProcessorSpecs2DeviceSpecs(workflow, channelPolicies, completionPolicies, devices, resources);
@@ -0,0 +1,149 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework MetricHistory
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "Framework/MetricHistory.h"
+#include "Framework/DeviceMetricsInfo.h"
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <utility>
+
+using namespace o2::framework;
+
+BOOST_AUTO_TEST_CASE(TestMetricHistoryRoundtrip)
+{
+  MetricHistoryOptions options;
+  options.samplesPerBlock = 100;
+  MetricHistory history{ options };
+
+  std::vector<std::pair<size_t, float>> expected;
+  size_t timestamp = 1789372894;
+  for (size_t i = 0; i < 1000; ++i) {
+    // Mostly regular, with some jitter and a few large jumps.
+    timestamp += 1000 + (i % 7 == 0 ? 3 : 0) + (i % 101 == 0 ? 100000 : 0);
+    float value = (i % 13 == 0) ? -1.5f * i : 0.25f * (i / 10);
+    expected.emplace_back(timestamp, value);
+    history.append(timestamp, value);
+  }
+  BOOST_CHECK_EQUAL(history.size(), 1000);
+  BOOST_CHECK_EQUAL(history.firstTimestamp(), expected.front().first);
+  BOOST_CHECK_EQUAL(history.lastTimestamp(), expected.back().first);
+
+  size_t i = 0;
+  history.forEach<float>(0, -1, [&expected, &i](size_t t, float v) {
+    BOOST_REQUIRE(i < expected.size());
+    BOOST_CHECK_EQUAL(t, expected[i].first);
+    BOOST_CHECK_EQUAL(v, expected[i].second);
+    ++i;
+  });
+  BOOST_CHECK_EQUAL(i, expected.size());
+
+  // Query a subrange
+  size_t count = 0;
+  history.forEach<float>(expected[200].first, expected[299].first, [&count](size_t, float) { count++; });
+  BOOST_CHECK_EQUAL(count, 100);
+
+  // Compressed storage must be much smaller than the plain one.
+  BOOST_CHECK_LT(history.bytes(), expected.size() * (sizeof(size_t) + sizeof(float)) / 2);
+}
+
+BOOST_AUTO_TEST_CASE(TestMetricHistoryIntAndOutOfOrder)
+{
+  MetricHistory history;
+  std::vector<std::pair<size_t, int>> expected = {
+    { 100, 1 }, { 200, -5 }, { 150, 1 << 30 }, { 10000000000, 0 }, { 20, 7 }
+  };
+  for (auto& e : expected) {
+    history.append(e.first, e.second);
+  }
+  size_t i = 0;
+  history.forEach<int>(0, -1, [&expected, &i](size_t t, int v) {
+    BOOST_CHECK_EQUAL(t, expected[i].first);
+    BOOST_CHECK_EQUAL(v, expected[i].second);
+    ++i;
+  });
+  BOOST_CHECK_EQUAL(i, expected.size());
+}
+
+BOOST_AUTO_TEST_CASE(TestMetricHistoryRetentionAndRollups)
+{
+  MetricHistoryOptions options;
+  options.retention = 1000;
+  options.samplesPerBlock = 10;
+  options.rollupInterval = 100;
+  options.rollupCapacity = 5;
+  MetricHistory history{ options };
+
+  for (size_t t = 0; t < 10000; t += 10) {
+    history.append(t, int(t % 100));
+  }
+  // Only the blocks overlapping the last second (plus the one being
+  // filled) are retained.
+  BOOST_CHECK_LE(history.size(), 110);
+  BOOST_CHECK_GE(history.size(), 100);
+  BOOST_CHECK_GE(history.firstTimestamp() + options.retention + options.samplesPerBlock * 10, 9990);
+
+  BOOST_REQUIRE_EQUAL(history.rollupsSize(), 5);
+  for (size_t i = 0; i < history.rollupsSize(); ++i) {
+    auto& rollup = history.rollup(i);
+    BOOST_CHECK_EQUAL(rollup.timestamp, 9500 + i * 100);
+    BOOST_CHECK_EQUAL(rollup.count, 10);
+    BOOST_CHECK_EQUAL(rollup.min, 0);
+    BOOST_CHECK_EQUAL(rollup.max, 90);
+    BOOST_CHECK_EQUAL(rollup.sum, 450);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestDeviceMetricsHistory)
+{
+  std::string metric;
+  ParsedMetricMatch match;
+  DeviceMetricsInfo info;
+
+  metric = "[METRIC] bkey,0 12 1789372894 hostname=test.cern.ch";
+  BOOST_REQUIRE(DeviceMetricsHelper::parseMetric(metric, match));
+  BOOST_REQUIRE(DeviceMetricsHelper::processMetric(match, info));
+  metric = "[METRIC] bkey,0 13 1789372895 hostname=test.cern.ch";
+  BOOST_REQUIRE(DeviceMetricsHelper::parseMetric(metric, match));
+  BOOST_REQUIRE(DeviceMetricsHelper::processMetric(match, info));
+  metric = "[METRIC] key4,1 some_string 1789372895 hostname=test.cern.ch";
+  BOOST_REQUIRE(DeviceMetricsHelper::parseMetric(metric, match));
+  BOOST_REQUIRE(DeviceMetricsHelper::processMetric(match, info));
+
+  BOOST_REQUIRE_EQUAL(info.history.size(), 2);
+  BOOST_CHECK_EQUAL(info.history[0].size(), 2);
+  BOOST_CHECK_EQUAL(info.history[1].size(), 0);
+  std::vector<int> values;
+  info.history[0].forEach<int>(0, -1, [&values](size_t, int v) { values.push_back(v); });
+  BOOST_REQUIRE_EQUAL(values.size(), 2);
+  BOOST_CHECK_EQUAL(values[0], 12);
+  BOOST_CHECK_EQUAL(values[1], 13);
+}
+
+BOOST_AUTO_TEST_CASE(TestDeviceMetricsOlderThanRecent)
+{
+  ParsedMetricMatch match;
+  DeviceMetricsInfo info;
+
+  // Updates beyond the recent buffer are only found in the history
+  size_t nUpdates = 4 * DeviceMetricsInfo::RECENT_METRICS_SIZE;
+  for (size_t i = 0; i < nUpdates; ++i) {
+    auto metric = "[METRIC] bkey,0 " + std::to_string(i) + " " + std::to_string(1789372894 + i) + " hostname=test.cern.ch";
+    BOOST_REQUIRE(DeviceMetricsHelper::parseMetric(metric, match));
+    BOOST_REQUIRE(DeviceMetricsHelper::processMetric(match, info));
+  }
+  BOOST_CHECK_EQUAL(info.intMetrics[0][info.metrics[0].pos], static_cast<int>(nUpdates - DeviceMetricsInfo::RECENT_METRICS_SIZE));
+  BOOST_CHECK_EQUAL(info.history[0].size(), nUpdates);
+  int first = -1;
+  info.history[0].forEach<int>(0, -1, [&first](size_t, int v) { first = first == -1 ? v : first; });
+  BOOST_CHECK_EQUAL(first, 0);
+}
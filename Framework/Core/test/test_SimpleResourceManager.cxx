@@ -0,0 +1,172 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Framework SimpleResourceManager
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "../src/SimpleResourceManager.h"
+#include "../src/ComputingResource.h"
+#include "Framework/DeviceSpec.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace o2::framework;
+
+namespace
+{
+DeviceSpec makeDevice(std::string const& id, std::vector<std::string> const& inputs, std::vector<std::string> const& outputs)
+{
+  DeviceSpec device;
+  device.name = id;
+  device.id = id;
+  device.hostname = "localhost";
+  for (auto& name : inputs) {
+    InputChannelSpec channel;
+    channel.name = name;
+    device.inputChannels.push_back(channel);
+  }
+  for (auto& name : outputs) {
+    OutputChannelSpec channel;
+    channel.name = name;
+    device.outputChannels.push_back(channel);
+  }
+  return device;
+}
+
+bool disjoint(std::vector<int> const& a, std::vector<int> const& b)
+{
+  for (auto core : a) {
+    if (std::find(b.begin(), b.end(), core) != b.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestParseCoreList)
+{
+  BOOST_CHECK(SimpleResourceManager::parseCoreList("0-3,8,10-11") == (std::vector<int>{ 0, 1, 2, 3, 8, 10, 11 }));
+  BOOST_CHECK(SimpleResourceManager::parseCoreList("5\n") == (std::vector<int>{ 5 }));
+  BOOST_CHECK(SimpleResourceManager::parseCoreList("").empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestDiscoverNumaNodes)
+{
+  char name[] = "/tmp/test_SimpleResourceManager.XXXXXX";
+  BOOST_REQUIRE(mkdtemp(name) != nullptr);
+  std::string sysfs = name;
+  mkdir((sysfs + "/node1").c_str(), 0755);
+  mkdir((sysfs + "/node0").c_str(), 0755);
+  mkdir((sysfs + "/node2").c_str(), 0755);
+  mkdir((sysfs + "/power").c_str(), 0755);
+  std::ofstream(sysfs + "/node0/cpulist") << "0-3\n";
+  std::ofstream(sysfs + "/node1/cpulist") << "4-7\n";
+  // A node with memory but no cores.
+  std::ofstream(sysfs + "/node2/cpulist") << "\n";
+
+  auto nodes = SimpleResourceManager::discoverNumaNodes(sysfs, { 0, 1, 2, 3, 4, 5, 6, 7 });
+  BOOST_REQUIRE_EQUAL(nodes.size(), 2);
+  BOOST_CHECK_EQUAL(nodes[0].id, 0);
+  BOOST_CHECK(nodes[0].cores == (std::vector<int>{ 0, 1, 2, 3 }));
+  BOOST_CHECK_EQUAL(nodes[1].id, 1);
+  BOOST_CHECK(nodes[1].cores == (std::vector<int>{ 4, 5, 6, 7 }));
+
+  // Without sysfs we get a single node with all the cores.
+  auto fallback = SimpleResourceManager::discoverNumaNodes(sysfs + "/missing");
+  BOOST_REQUIRE_EQUAL(fallback.size(), 1);
+  BOOST_CHECK(fallback[0].cores.empty() == false);
+
+  // Only the cores we are allowed to run on are used.
+  auto restricted = SimpleResourceManager::discoverNumaNodes(sysfs, { 2, 3, 8 });
+  BOOST_REQUIRE_EQUAL(restricted.size(), 1);
+  BOOST_CHECK_EQUAL(restricted[0].id, 0);
+  BOOST_CHECK(restricted[0].cores == (std::vector<int>{ 2, 3 }));
+  auto restrictedFallback = SimpleResourceManager::discoverNumaNodes(sysfs + "/missing", { 1, 5 });
+  BOOST_REQUIRE_EQUAL(restrictedFallback.size(), 1);
+  BOOST_CHECK(restrictedFallback[0].cores == (std::vector<int>{ 1, 5 }));
+  // No usable core, no pinning.
+  BOOST_CHECK(SimpleResourceManager::discoverNumaNodes(sysfs, { 8, 9 }).empty());
+  BOOST_CHECK(SimpleResourceManager::discoverNumaNodes(sysfs, {}).empty());
+  system(("rm -rf " + sysfs).c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestPlaceDevices)
+{
+  std::vector<NumaNode> nodes{ { 0, { 0, 1, 2, 3 } }, { 1, { 4, 5, 6, 7 } } };
+  SimpleResourceManager rm(22000, 1000, "localhost", nodes);
+
+  // Two independent pipelines, A -> B and C -> D, interleaved.
+  std::vector<DeviceSpec> devices{
+    makeDevice("A", {}, { "from_A_to_B" }),
+    makeDevice("C", {}, { "from_C_to_D" }),
+    makeDevice("B", { "from_A_to_B" }, {}),
+    makeDevice("D", { "from_C_to_D" }, {}),
+  };
+  rm.placeDevices(devices);
+
+  for (auto& device : devices) {
+    BOOST_CHECK(device.numaNode == 0 || device.numaNode == 1);
+    BOOST_CHECK_EQUAL(device.cores.size(), 2);
+  }
+  BOOST_CHECK_EQUAL(devices[0].numaNode, devices[2].numaNode);
+  BOOST_CHECK_EQUAL(devices[1].numaNode, devices[3].numaNode);
+  BOOST_CHECK(devices[0].numaNode != devices[1].numaNode);
+  for (size_t i = 0; i < devices.size(); ++i) {
+    for (size_t j = i + 1; j < devices.size(); ++j) {
+      BOOST_CHECK(disjoint(devices[i].cores, devices[j].cores));
+    }
+  }
+  // The cores belong to the node the device was placed on.
+  for (auto& device : devices) {
+    auto& nodeCores = nodes[device.numaNode].cores;
+    for (auto core : device.cores) {
+      BOOST_CHECK(std::find(nodeCores.begin(), nodeCores.end(), core) != nodeCores.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestPlaceDevicesOversubscribed)
+{
+  SimpleResourceManager rm(22000, 1000, "localhost", { { 0, { 0, 1 } } });
+  std::vector<DeviceSpec> devices{
+    makeDevice("A", {}, { "from_A_to_B" }),
+    makeDevice("B", { "from_A_to_B" }, { "from_B_to_C" }),
+    makeDevice("C", { "from_B_to_C" }, { "from_C_to_D" }),
+    makeDevice("D", { "from_C_to_D" }, {}),
+  };
+  rm.placeDevices(devices);
+  // Not enough cores, so everyone shares them.
+  for (auto& device : devices) {
+    BOOST_CHECK_EQUAL(device.numaNode, 0);
+    BOOST_CHECK(device.cores == (std::vector<int>{ 0, 1 }));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestPlaceDevicesExternal)
+{
+  // Devices deployed by some external entity are left alone.
+  SimpleResourceManager rm(22000, 1000, "", { { 0, { 0, 1, 2, 3 } } });
+  std::vector<DeviceSpec> devices{ makeDevice("A", {}, {}) };
+  devices[0].hostname = "";
+  rm.placeDevices(devices);
+  BOOST_CHECK_EQUAL(devices[0].numaNode, -1);
+  BOOST_CHECK(devices[0].cores.empty());
+}
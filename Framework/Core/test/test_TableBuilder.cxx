@@ -81,6 +81,32 @@ BOOST_AUTO_TEST_CASE(TestTableBuilderMore)
   BOOST_REQUIRE_EQUAL(table->column(3)->type()->id(), arrow::boolean()->id());
 }
 
+BOOST_AUTO_TEST_CASE(TestTableBuilderAdopt)
+{
+  using namespace o2::framework;
+  arrow::Int32Builder xBuilder;
+  arrow::FloatBuilder yBuilder;
+  for (int i = 0; i < 8; ++i) {
+    BOOST_REQUIRE(xBuilder.Append(i).ok());
+    BOOST_REQUIRE(yBuilder.Append(i * 0.5f).ok());
+  }
+  std::vector<std::shared_ptr<arrow::Array>> arrays(2);
+  BOOST_REQUIRE(xBuilder.Finish(&arrays[0]).ok());
+  BOOST_REQUIRE(yBuilder.Finish(&arrays[1]).ok());
+  auto schema = arrow::schema({ arrow::field("x", arrow::int32()), arrow::field("y", arrow::float32()) });
+
+  TableBuilder builder;
+  builder.adopt(schema, std::move(arrays));
+  BOOST_CHECK_THROW(builder.persist<int>({ "z" }), std::runtime_error);
+  auto table = builder.finalize();
+  BOOST_REQUIRE_EQUAL(table->num_columns(), 2);
+  BOOST_REQUIRE_EQUAL(table->num_rows(), 8);
+  BOOST_REQUIRE_EQUAL(table->column(0)->name(), "x");
+  BOOST_REQUIRE_EQUAL(table->column(1)->name(), "y");
+  BOOST_REQUIRE_EQUAL(table->column(0)->type()->id(), arrow::int32()->id());
+  BOOST_REQUIRE_EQUAL(table->column(1)->type()->id(), arrow::float32()->id());
+}
+
 // Use RDataFrame to build the table
 BOOST_AUTO_TEST_CASE(TestRDataFrame)
 {
@@ -55,6 +55,8 @@ namespace framework
 ///   --treename
 ///   --nevents
 ///   --terminate
+///   --background-writer-depth
+///   --background-writer-memory
 ///
 /// In addition to that, a custom option can be added for every branch to configure the
 /// branch name, see below.
@@ -156,6 +158,12 @@ namespace framework
 /// callback calculates the index from another piece of information in the
 /// header stack.
 ///
+/// Background writing:
+/// With a non-zero --background-writer-depth, the inputs of up to this number of processing
+/// calls are queued and written to the tree by a dedicated thread, see RootTreeWriter. The
+/// processing call only extracts the data and blocks if the queue is full. Optionally, the
+/// queue is also limited by --background-writer-memory in MB.
+///
 /// Custom termination condition, either one of:
 ///     auto checkProcessing = [](o2::framework::DataRef const& ref, bool& isReady) {
 ///       // decide on the DataRef whether to terminate or not
@@ -289,6 +297,11 @@ class MakeRootTreeWriterSpec
         auto branchName = ic.options().get<std::string>(branchNameOptions[branchIndex].first.c_str());
         processAttributes->writer->setBranchName(branchIndex, branchName.c_str());
       }
+      auto backgroundWriterDepth = ic.options().get<int>("background-writer-depth");
+      if (backgroundWriterDepth > 0) {
+        size_t backgroundWriterMemory = ic.options().get<int>("background-writer-memory");
+        processAttributes->writer->setBackgroundWriting(backgroundWriterDepth, backgroundWriterMemory * 1024 * 1024);
+      }
       processAttributes->writer->init(filename.c_str(), treename.c_str());
 
       // the callback to be set as hook at stop of processing for the framework
@@ -367,6 +380,8 @@ class MakeRootTreeWriterSpec
       { "treename", VariantType::String, mDefaultTreeName.c_str(), { "Name of tree" } },
       { "nevents", VariantType::Int, mDefaultNofEvents, { "Number of events to execute" } },
       { "terminate", VariantType::String, mDefaultTerminationPolicy.c_str(), { "Terminate the 'process' or 'workflow'" } },
+      { "background-writer-depth", VariantType::Int, 0, { "Number of inputs to be queued for writing in a background thread, 0 writes inline" } },
+      { "background-writer-memory", VariantType::Int, 0, { "Max size of the queued inputs in MB, 0 for no limit" } },
     };
     for (size_t branchIndex = 0; branchIndex < mBranchNameOptions.size(); branchIndex++) {
       // adding option definitions for those ones defined in the branch definition
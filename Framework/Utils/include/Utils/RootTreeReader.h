@@ -21,6 +21,7 @@
 #include <TTree.h>
 #include <TBranch.h>
 #include <TClass.h>
+#include <TROOT.h> // ROOT::EnableThreadSafety
 #include <vector>
 #include <string>
 #include <stdexcept> // std::runtime_error
@@ -28,6 +29,11 @@
 #include <memory>     // std::make_unique
 #include <functional> // std::function
 #include <utility>    // std::forward
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
 
 namespace o2
 {
@@ -84,6 +90,12 @@ struct DefaultKey {
 /// be static there to persist. It can also be a shared_pointer, which then
 /// requires additional dereferencing in the syntax. The processing lambda has
 /// to capture the shared pointer instance by copy.
+///
+/// By default, the branches are read on the calling thread when an entry is
+/// processed. In the read-ahead mode, enabled by setReadAhead, the upcoming
+/// entries are read and decompressed by background threads, each using its
+/// own instance of the tree, and the processing only publishes the ready
+/// objects.
 template <typename KeyType>
 class GenericRootTreeReader
 {
@@ -129,9 +141,23 @@ class GenericRootTreeReader
   void addFile(const char* fileName)
   {
     mInput.AddFile(fileName);
+    mFileNames.emplace_back(fileName);
     mNEntries = mInput.GetEntries();
   }
 
+  /// enable the read-ahead mode, has to be called after the reader has been
+  /// fully set up and before the first entry is processed
+  /// @param depth    maximum number of entries read ahead of the published entry,
+  ///                 0 disables the read-ahead mode
+  /// @param nThreads number of threads reading entries in parallel
+  void setReadAhead(int depth, int nThreads = 1)
+  {
+    mReadAhead.reset();
+    if (depth > 0 && mBranchSpecs.size() > 0) {
+      mReadAhead = std::make_unique<ReadAhead>(*this, depth, std::max(1, nThreads));
+    }
+  }
+
   /// move to the next entry
   /// @return true if data is available
   bool next()
@@ -151,6 +177,9 @@ class GenericRootTreeReader
       return false;
     }
     ++mEntry;
+    if (mReadAhead) {
+      mReadAhead->release(mEntry);
+    }
     return true;
   }
 
@@ -193,16 +222,10 @@ class GenericRootTreeReader
       return false;
     }
 
-    for (auto& spec : mBranchSpecs) {
-      char* data = nullptr;
-      spec.second->branch->SetAddress(&data);
-      spec.second->branch->GetEntry(mEntry);
+    auto publish = [&snapshot](auto& spec, char* data, size_t datasize) {
       if (spec.second->sizebranch == nullptr) {
         snapshot(spec.first, ROOTSerializedByClass(*data, spec.second->classinfo));
       } else {
-        size_t datasize = 0;
-        spec.second->sizebranch->SetAddress(&datasize);
-        spec.second->sizebranch->GetEntry(mEntry);
         auto* buffer = reinterpret_cast<std::vector<char>*>(data);
         if (buffer->size() == datasize) {
           LOG(INFO) << "branch " << spec.second->name << ": publishing binary chunk of " << datasize << " bytes(s)";
@@ -214,6 +237,26 @@ class GenericRootTreeReader
           snapshot(spec.first, empty);
         }
       }
+    };
+
+    if (mReadAhead) {
+      auto& prefetched = mReadAhead->get(mEntry);
+      for (size_t i = 0; i < mBranchSpecs.size(); ++i) {
+        publish(mBranchSpecs[i], reinterpret_cast<char*>(prefetched[i].object), prefetched[i].datasize);
+      }
+      return true;
+    }
+
+    for (auto& spec : mBranchSpecs) {
+      char* data = nullptr;
+      size_t datasize = 0;
+      spec.second->branch->SetAddress(&data);
+      spec.second->branch->GetEntry(mEntry);
+      if (spec.second->sizebranch != nullptr) {
+        spec.second->sizebranch->SetAddress(&datasize);
+        spec.second->sizebranch->GetEntry(mEntry);
+      }
+      publish(spec, data, datasize);
       spec.second->branch->DropBaskets("all");
     }
     return true;
@@ -233,6 +276,138 @@ class GenericRootTreeReader
     TClass* classinfo = nullptr;
   };
 
+  /// the data of one branch read ahead of publishing
+  struct PrefetchedBranch {
+    void* object = nullptr; // the object read from the branch, owned by the entry
+    size_t datasize = 0;    // the size of the binary chunk for binary branches
+  };
+  using PrefetchedEntry = std::vector<PrefetchedBranch>;
+
+  /// Background reading of the entries ahead of the published one.
+  /// Every thread reads its own instance of the input tree, the entries are
+  /// distributed among the threads in ascending order and kept until they
+  /// have been released, at most depth entries are kept.
+  class ReadAhead
+  {
+   public:
+    ReadAhead(const self_type& reader, int depth, int nThreads)
+      : mReader(reader), mDepth(depth)
+    {
+      mEnd = mReader.mMaxEntries > 0 ? std::min(mReader.mNEntries, mReader.mMaxEntries) : mReader.mNEntries;
+      // the threads use separate trees and files, which ROOT supports only
+      // if thread safety is enabled
+      ROOT::EnableThreadSafety();
+      for (int i = 0; i < nThreads; ++i) {
+        mThreads.emplace_back([this]() { run(); });
+      }
+    }
+
+    ~ReadAhead()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+      }
+      mCondition.notify_all();
+      for (auto& thread : mThreads) {
+        thread.join();
+      }
+      for (auto& entry : mEntries) {
+        destroy(entry.second);
+      }
+    }
+
+    /// wait until an entry has been read and return it
+    const PrefetchedEntry& get(int entry)
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this, entry]() { return mEntries.find(entry) != mEntries.end(); });
+      return mEntries[entry];
+    }
+
+    /// release all entries before the given one, making room for the next ones
+    void release(int entry)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFirstEntry = entry;
+        while (mEntries.size() > 0 && mEntries.begin()->first < entry) {
+          destroy(mEntries.begin()->second);
+          mEntries.erase(mEntries.begin());
+        }
+      }
+      mCondition.notify_all();
+    }
+
+   private:
+    void destroy(PrefetchedEntry& entry)
+    {
+      for (size_t i = 0; i < entry.size(); ++i) {
+        mReader.mBranchSpecs[i].second->classinfo->Destructor(entry[i].object);
+      }
+    }
+
+    void run()
+    {
+      auto& specs = mReader.mBranchSpecs;
+      TChain input(mReader.mInput.GetName());
+      for (auto& fileName : mReader.mFileNames) {
+        input.AddFile(fileName.c_str());
+      }
+      input.SetBranchStatus("*", 0);
+      std::vector<void*> objects(specs.size(), nullptr);
+      std::vector<size_t> datasizes(specs.size(), 0);
+      for (size_t i = 0; i < specs.size(); ++i) {
+        input.SetBranchStatus(specs[i].second->name.c_str(), 1);
+        if (specs[i].second->sizebranch != nullptr) {
+          input.SetBranchStatus(specs[i].second->sizebranch->GetName(), 1);
+          input.SetBranchAddress(specs[i].second->sizebranch->GetName(), static_cast<void*>(&datasizes[i]));
+        }
+      }
+
+      while (true) {
+        int entry = 0;
+        {
+          std::unique_lock<std::mutex> lock(mMutex);
+          mCondition.wait(lock, [this]() { return mStop || mNextEntry >= mEnd || mNextEntry < mFirstEntry + mDepth; });
+          if (mStop || mNextEntry >= mEnd) {
+            return;
+          }
+          entry = mNextEntry++;
+        }
+        // every entry is read into new objects, which are handed over to the publisher
+        PrefetchedEntry prefetched(specs.size());
+        for (size_t i = 0; i < specs.size(); ++i) {
+          objects[i] = specs[i].second->classinfo->New();
+          input.SetBranchAddress(specs[i].second->name.c_str(), static_cast<void*>(&objects[i]));
+        }
+        if (input.GetEntry(entry) <= 0) {
+          LOG(ERROR) << "failed to read entry " << entry << " of tree " << input.GetName();
+        }
+        for (size_t i = 0; i < specs.size(); ++i) {
+          prefetched[i].object = objects[i];
+          prefetched[i].datasize = datasizes[i];
+        }
+        {
+          std::lock_guard<std::mutex> lock(mMutex);
+          mEntries.emplace(entry, std::move(prefetched));
+        }
+        mCondition.notify_all();
+      }
+    }
+
+    const self_type& mReader;
+    int mDepth;
+    int mEnd = 0;
+    int mNextEntry = 0;
+    int mFirstEntry = 0;
+    bool mStop = false;
+    std::map<int, PrefetchedEntry> mEntries;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<std::thread> mThreads;
+  };
+
   /// add a new branch definition
   /// we allow for multiple branch definition for the same key
   void addBranchSpec(KeyType key, const char* branchName)
@@ -253,6 +428,7 @@ class GenericRootTreeReader
           throw std::runtime_error("mismatching class type, expecting std::vector<char> for binary branch");
         }
         mBranchSpecs.back().second->sizebranch = sizebranch;
+        mBranchSpecs.back().second->classinfo = classinfo;
         LOG(INFO) << "binary branch set up: " << branchName;
       }
     } else {
@@ -289,6 +465,8 @@ class GenericRootTreeReader
 
   /// the input tree, using TChain to support multiple input files
   TChain mInput;
+  /// the input files
+  std::vector<std::string> mFileNames;
   /// definitions of branch specs
   std::vector<std::pair<KeyType, std::unique_ptr<BranchSpec>>> mBranchSpecs;
   /// number of entries in the tree
@@ -297,6 +475,8 @@ class GenericRootTreeReader
   int mEntry = -1;
   /// maximum number of entries to be processed
   int mMaxEntries = -1;
+  /// reading of the entries ahead, if enabled
+  std::unique_ptr<ReadAhead> mReadAhead;
 };
 
 using RootTreeReader = GenericRootTreeReader<rtr::DefaultKey>;
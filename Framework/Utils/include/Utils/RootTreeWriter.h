@@ -17,11 +17,19 @@
 
 #include "Framework/InputRecord.h"
 #include "Framework/DataRef.h"
+#include "Framework/DataRefUtils.h"
+#include "Headers/DataHeader.h"
 #include <TFile.h>
 #include <TTree.h>
 #include <TBranch.h>
 #include <TClass.h>
+#include <TROOT.h>
 #include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 #include <functional>
 #include <string>
 #include <stdexcept> // std::runtime_error
@@ -70,6 +78,14 @@ namespace framework
 /// as a std::vector<char>, this ensures separation on event basis as well as having binary
 /// data in parallel to ROOT objects in the same file, e.g. a binary data format from the
 /// reconstruction in parallel to MC labels.
+///
+/// Background writing:
+/// By default, the branches are filled and the tree is written inline in the
+/// processing call. With setBackgroundWriting, the processing call only extracts
+/// the input data into objects owned by the writer and queues them. A dedicated
+/// thread fills the branches, i.e. compresses and flushes the baskets. The queue is
+/// bounded by number of processing calls and optionally by the accumulated payload
+/// size, the processing call blocks if the queue is full.
 class RootTreeWriter
 {
  public:
@@ -149,6 +165,28 @@ class RootTreeWriter
     mFile = std::make_unique<TFile>(filename, "RECREATE");
     mTree = std::make_unique<TTree>(treename, treename);
     mTreeStructure->setup(mBranchSpecs, mTree.get());
+    if (mMaxQueuedEntries > 0) {
+      startBackgroundWriter();
+    }
+  }
+
+  /// fill the branches in a background thread
+  /// @param maxEntries  max number of processing calls waiting to be written, 0 disables
+  ///                    background writing
+  /// @param maxBytes    max accumulated payload size of the queued inputs, 0 for no limit;
+  ///                    a single processing call is always accepted if the queue is empty
+  ///
+  /// Can be called before or after init, but not after data has been processed.
+  void setBackgroundWriting(size_t maxEntries, size_t maxBytes = 0)
+  {
+    if (mBackgroundWriter) {
+      throw std::runtime_error("background writing can only be configured once");
+    }
+    mMaxQueuedEntries = maxEntries;
+    mMaxQueuedBytes = maxBytes;
+    if (mMaxQueuedEntries > 0 && mTree) {
+      startBackgroundWriter();
+    }
   }
 
   /// set the branch name for a branch definition from the constructor argument list
@@ -180,8 +218,15 @@ class RootTreeWriter
     if (!mTree || !mFile || mFile->IsZombie()) {
       throw std::runtime_error("Writer is invalid state, probably closed previously");
     }
+    if (mBackgroundWriter) {
+      // extract the data and leave the filling of the branches to the writer thread
+      QueuedEntry entry;
+      mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs, &entry);
+      mBackgroundWriter->push(std::move(entry));
+      return;
+    }
     // execute tree structure handlers and fill the individual branches
-    mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs);
+    mTreeStructure->exec(std::forward<ContextType>(context), mBranchSpecs, nullptr);
     // Note: number of entries will be set when closing the writer
   }
 
@@ -190,6 +235,11 @@ class RootTreeWriter
   void close()
   {
     mIsClosed = true;
+    if (mBackgroundWriter) {
+      // all queued data needs to be written before the tree is finalized
+      auto backgroundWriter = std::move(mBackgroundWriter);
+      backgroundWriter->finish();
+    }
     if (!mFile) {
       return;
     }
@@ -226,6 +276,118 @@ class RootTreeWriter
 
   using InputContext = InputRecord;
 
+  /// the data of one processing call, extracted from the inputs and owned by the fill
+  /// functions which are executed by the background writer
+  struct QueuedEntry {
+    std::vector<std::function<void()>> fills;
+    size_t size = 0;
+  };
+
+  /// the writer thread and its bounded queue of entries
+  class BackgroundWriter
+  {
+   public:
+    BackgroundWriter(size_t maxEntries, size_t maxBytes) : mMaxEntries(maxEntries), mMaxBytes(maxBytes)
+    {
+      mThread = std::thread([this]() { run(); });
+    }
+
+    ~BackgroundWriter()
+    {
+      if (mThread.joinable()) {
+        stop();
+      }
+    }
+
+    /// queue an entry, blocks until there is space in the queue
+    void push(QueuedEntry&& entry)
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mSpaceAvailable.wait(lock, [this, &entry]() {
+        return mError || mQueue.empty() ||
+               (mQueue.size() < mMaxEntries && (mMaxBytes == 0 || mQueuedBytes + entry.size <= mMaxBytes));
+      });
+      if (mError) {
+        std::rethrow_exception(mError);
+      }
+      mQueuedBytes += entry.size;
+      mQueue.emplace_back(std::move(entry));
+      mDataAvailable.notify_one();
+    }
+
+    /// write all queued entries and stop the thread
+    void finish()
+    {
+      stop();
+      if (mError) {
+        std::rethrow_exception(mError);
+      }
+    }
+
+   private:
+    void stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+      }
+      mDataAvailable.notify_one();
+      if (mThread.joinable()) {
+        mThread.join();
+      }
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      while (true) {
+        mDataAvailable.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+        if (mQueue.empty()) {
+          // stop has been requested and everything is written
+          break;
+        }
+        // the entry stays in the queue while it is written, it is accounted for
+        // the memory limit until its data has been released
+        auto& entry = mQueue.front();
+        lock.unlock();
+        try {
+          for (auto& fill : entry.fills) {
+            fill();
+          }
+        } catch (...) {
+          lock.lock();
+          mError = std::current_exception();
+          mQueue.clear();
+          mSpaceAvailable.notify_all();
+          break;
+        }
+        entry.fills.clear();
+        lock.lock();
+        mQueuedBytes -= entry.size;
+        mQueue.pop_front();
+        mSpaceAvailable.notify_all();
+      }
+    }
+
+    size_t mMaxEntries;
+    size_t mMaxBytes;
+    size_t mQueuedBytes = 0;
+    bool mStop = false;
+    std::exception_ptr mError;
+    std::deque<QueuedEntry> mQueue;
+    std::mutex mMutex;
+    std::condition_variable mDataAvailable;
+    std::condition_variable mSpaceAvailable;
+    std::thread mThread;
+  };
+
+  void startBackgroundWriter()
+  {
+    // inputs are deserialized while the writer thread is streaming to the file
+    ROOT::EnableThreadSafety();
+    mBackgroundWriter = std::make_unique<BackgroundWriter>(mMaxQueuedEntries, mMaxQueuedBytes);
+  }
+
   /// polymorphic interface for the mixin stack of branch type descriptions
   /// it implements the entry point for processing through exec method
   class TreeStructureInterface
@@ -242,7 +404,9 @@ class RootTreeWriter
     /// enters at the outermost element and recurses to the base elements
     /// Read the configured inputs from the input context, select the output branch
     /// and write the object
-    virtual void exec(InputContext&, std::vector<BranchSpec>&) {}
+    /// If an entry is provided, the extracted data is queued in the entry instead of
+    /// being written to the branches
+    virtual void exec(InputContext&, std::vector<BranchSpec>&, QueuedEntry*) {}
     /// get the size of the branch structure, i.e. the number of registered branch
     /// definitions
     virtual size_t size() const { return STAGE; }
@@ -250,7 +414,7 @@ class RootTreeWriter
     // a dummy method called in the recursive processing
     void setupInstance(std::vector<BranchSpec>&, TTree*) {}
     // a dummy method called in the recursive processing
-    void process(InputContext&, std::vector<BranchSpec>&) {}
+    void process(InputContext&, std::vector<BranchSpec>&, QueuedEntry*) {}
   };
 
   template <typename T = char>
@@ -280,9 +444,9 @@ class RootTreeWriter
 
     // this is the polymorphic entry point for processing of branch specs
     // recursive processing starting from the highest instance
-    void exec(InputContext& context, std::vector<BranchSpec>& specs) override
+    void exec(InputContext& context, std::vector<BranchSpec>& specs, QueuedEntry* entry) override
     {
-      process(context, specs);
+      process(context, specs, entry);
     }
     size_t size() const override { return STAGE; }
 
@@ -374,12 +538,64 @@ class RootTreeWriter
       branch->Fill();
     }
 
+    // the queueData methods are the counterparts of fillData for the background writer,
+    // the extracted data is owned by the queued fill function, the store variable is
+    // only set by the writer thread
+
+    // specialization for trivial structs or serialized objects without a TClass interface
+    template <typename T, typename std::enable_if_t<std::is_same<T, value_type>::value, int> = 0>
+    void queueData(InputContext& context, const char* key, TBranch* branch, size_t branchIdx, QueuedEntry& entry)
+    {
+      auto data = context.get<typename std::add_pointer<value_type>::type>(key);
+      entry.fills.emplace_back([this, branch, branchIdx, object = value_type(*data)]() {
+        mStore[branchIdx] = object;
+        branch->Fill();
+      });
+    }
+
+    // specialization for objects with ROOT dictionary
+    // deserialized objects are adopted, objects pointing to the message payload are copied
+    template <typename T, typename std::enable_if_t<std::is_same<T, value_type*>::value, int> = 0>
+    void queueData(InputContext& context, const char* key, TBranch* branch, size_t branchIdx, QueuedEntry& entry)
+    {
+      auto data = context.get<typename std::add_pointer<value_type>::type>(key);
+      auto const* header = DataRefUtils::getHeader<o2::header::DataHeader*>(context.get(key));
+      std::shared_ptr<value_type const> object;
+      if (header->payloadSerializationMethod == o2::header::gSerializationMethodROOT) {
+        object = std::move(data);
+      } else {
+        if constexpr (std::is_copy_constructible<value_type>::value) {
+          object = std::make_shared<value_type const>(*data);
+        } else {
+          throw std::runtime_error(std::string("can not queue non-copyable object of type ") + typeid(value_type).name());
+        }
+      }
+      entry.fills.emplace_back([this, branch, branchIdx, object]() {
+        mStore[branchIdx] = const_cast<value_type*>(object.get());
+        branch->Fill();
+      });
+    }
+
+    // specialization for binary buffers using const char*
+    template <typename T, typename std::enable_if_t<std::is_same<T, BinaryBranchStoreType<char>>::value, int> = 0>
+    void queueData(InputContext& context, const char* key, TBranch* branch, size_t branchIdx, QueuedEntry& entry)
+    {
+      auto data = context.get<gsl::span<char>>(key);
+      std::vector<char> buffer(data.begin(), data.end());
+      entry.fills.emplace_back([this, branch, branchIdx, buffer = std::move(buffer)]() {
+        std::get<2>(mStore.at(branchIdx)) = buffer.size();
+        std::get<1>(mStore.at(branchIdx))->Fill();
+        std::get<0>(mStore.at(branchIdx)) = buffer;
+        branch->Fill();
+      });
+    }
+
     // process previous stage and this stage
-    void process(InputContext& context, std::vector<BranchSpec>& specs)
+    void process(InputContext& context, std::vector<BranchSpec>& specs, QueuedEntry* entry)
     {
       // recursing through the tree structure by simply using method of the previous type,
       // i.e. the base class method.
-      PrevT::process(context, specs);
+      PrevT::process(context, specs, entry);
       constexpr size_t SpecIndex = STAGE - 1;
       BranchSpec const& spec = specs[SpecIndex];
       // loop over all defined inputs
@@ -393,7 +609,12 @@ class RootTreeWriter
             continue;
           }
         }
-        fillData<store_type>(context, key.c_str(), spec.branches.at(branchIdx), branchIdx);
+        if (entry) {
+          entry->size += DataRefUtils::getPayloadSize(dataref);
+          queueData<store_type>(context, key.c_str(), spec.branches.at(branchIdx), branchIdx, *entry);
+        } else {
+          fillData<store_type>(context, key.c_str(), spec.branches.at(branchIdx), branchIdx);
+        }
       }
     }
 
@@ -453,6 +674,12 @@ class RootTreeWriter
   std::unique_ptr<TreeStructureInterface> mTreeStructure;
   /// indicate that the writer has been closed
   bool mIsClosed = false;
+  /// max number of queued processing calls for background writing, 0 to disable
+  size_t mMaxQueuedEntries = 0;
+  /// max payload size of the queued processing calls, 0 for no limit
+  size_t mMaxQueuedBytes = 0;
+  /// the background writer, if enabled
+  std::unique_ptr<BackgroundWriter> mBackgroundWriter;
 };
 
 } // namespace framework
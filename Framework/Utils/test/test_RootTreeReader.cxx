@@ -66,8 +66,16 @@ DataProcessorSpec getSourceSpec()
                                                    Output{ "TST", "ARRAYOFDATA", 0, persistency },
                                                    "dataarray" // name of cluster branch
                                                    );
+    // the same data is published a second time by a reader in read-ahead mode
+    auto prefetchingReader = std::make_shared<RootTreeReader>("testtree",       // tree name
+                                                              fileName.c_str(), // input file name
+                                                              Output{ "TST", "ARRAYOFDATA", 1, persistency },
+                                                              "dataarray" // name of cluster branch
+                                                              );
+    prefetchingReader->setReadAhead(4, 2);
 
-    auto processingFct = [reader](ProcessingContext& pc) {
+    auto processingFct = [reader, prefetchingReader](ProcessingContext& pc) {
+      (++(*prefetchingReader))(pc);
       if (reader->getCount() == 0) {
         // add two additional headers on the stack in the first entry
         o2::header::NameHeader<16> auxHeader("extended_info");
@@ -84,7 +92,7 @@ DataProcessorSpec getSourceSpec()
 
   return DataProcessorSpec{ "source", // name of the processor
                             {},
-                            { OutputSpec{ "TST", "ARRAYOFDATA" } },
+                            { OutputSpec{ "TST", "ARRAYOFDATA", 0 }, OutputSpec{ "TST", "ARRAYOFDATA", 1 } },
                             AlgorithmSpec(initFct) };
 }
 
@@ -98,6 +106,7 @@ DataProcessorSpec getSinkSpec()
       LOG(INFO) << dh->dataOrigin.str << " " << dh->dataDescription.str << " " << dh->payloadSize;
     }
     auto data = pc.inputs().get<std::vector<o2::test::Polymorphic>>("input");
+    auto prefetched = pc.inputs().get<std::vector<o2::test::Polymorphic>>("prefetched");
     if (counter == 0) {
       // the first entry comes together with additional headers on the stack, test those ...
       auto auxHeader = DataRefUtils::getHeader<o2::header::NameHeader<16>*>(pc.inputs().get("input"));
@@ -116,13 +125,17 @@ DataProcessorSpec getSinkSpec()
       LOG(INFO) << data[idx].get();
       ASSERT_ERROR(data[idx].get() == 10 * counter + idx);
     }
+    ASSERT_ERROR(prefetched.size() == data.size());
+    for (int idx = 0; idx < prefetched.size() && idx < data.size(); idx++) {
+      ASSERT_ERROR(prefetched[idx].get() == data[idx].get());
+    }
     if (++counter >= kTreeSize) {
       pc.services().get<ControlService>().readyToQuit(true);
     }
   };
 
   return DataProcessorSpec{ "sink", // name of the processor
-                            { InputSpec{ "input", "TST", "ARRAYOFDATA" } },
+                            { InputSpec{ "input", "TST", "ARRAYOFDATA", 0 }, InputSpec{ "prefetched", "TST", "ARRAYOFDATA", 1 } },
                             Outputs{},
                             AlgorithmSpec(processingFct) };
 }
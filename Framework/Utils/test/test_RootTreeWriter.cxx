@@ -80,9 +80,8 @@ bool checkTree(const char* filename, const char* treename, Args&&... args)
   return checkBranch(*tree, std::forward<Args>(args)...);
 }
 
-BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
+void runRootTreeWriterTest(std::string filename, size_t backgroundWriterDepth)
 {
-  std::string filename = "test_RootTreeWriter.root";
   const char* treename = "testtree";
 
   using Container = std::vector<o2::test::Polymorphic>;
@@ -106,6 +105,7 @@ BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
                         RootTreeWriter::BranchDef<const char*>{ "input4", "binarybranch" });
 
   BOOST_CHECK(writer.getStoreSize() == 3);
+  writer.setBackgroundWriting(backgroundWriterDepth);
 
   // need to mimic a context to actually call the processing
   auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
@@ -175,6 +175,16 @@ BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
             BranchContent<Container>{ "containerbranch_1", c });
 }
 
+BOOST_AUTO_TEST_CASE(test_RootTreeWriter)
+{
+  runRootTreeWriterTest("test_RootTreeWriter.root", 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_RootTreeWriter_background)
+{
+  runRootTreeWriterTest("test_RootTreeWriter_background.root", 2);
+}
+
 template <typename T>
 using BranchDefinition = MakeRootTreeWriterSpec::BranchDefinition<T>;
 
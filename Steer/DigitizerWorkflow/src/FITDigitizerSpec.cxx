@@ -123,13 +123,11 @@ class FITDPLDigitizerTask
         labels.clear();
         // digits.clear();
         mDigitizer.process(&hits, &digit);
-        auto data = digit.getChDgData();
-        LOG(INFO) << "Have " << data.size() << " fired channels ";
+        LOG(INFO) << "Have " << digit.getChDgData().size() << " fired channels ";
         // copy digits into accumulator
         // labelAccum.mergeAtBack(*labels);
       }
-      mDigitizer.setTriggers(&digit);
-      mDigitizer.smearCFDtime(&digit);
+      mDigitizer.finalizeDigit(&digit);
       digitAccum.push_back(digit); // we should move it there actually
       LOG(INFO) << "Have " << digitAccum.back().getChDgData().size() << " fired channels ";
       digit.printStream(std::cout);
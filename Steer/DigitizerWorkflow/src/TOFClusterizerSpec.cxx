@@ -37,7 +37,7 @@ class TOFDPLClustererTask
  public:
   void init(framework::InitContext& ic)
   {
-    // nothing special to be set up
+    mClusterer.setNumberOfThreads(ic.options().get<int>("tof-cluster-threads"));
   }
 
   void run(framework::ProcessingContext& pc)
@@ -91,7 +91,7 @@ o2::framework::DataProcessorSpec getTOFClusterizerSpec()
     Outputs{ OutputSpec{ "TOF", "CLUSTERS", 0, Lifetime::Timeframe },
              OutputSpec{ "TOF", "CLUSTERSMCTR", 0, Lifetime::Timeframe } },
     AlgorithmSpec{ adaptFromTask<TOFDPLClustererTask>() },
-    Options{ /* for the moment no options */ }
+    Options{ { "tof-cluster-threads", VariantType::Int, 1, { "number of threads clusterizing the TOF strips" } } }
   };
 }
 
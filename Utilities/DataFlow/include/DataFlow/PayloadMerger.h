@@ -23,7 +23,9 @@ namespace o2 { namespace dataflow {
 /// payload into a separate memory area.
 ///
 /// - Append multiple messages via the aggregate method 
-/// - Finalise buffer creation with the finalise call.
+/// - Finalise buffer creation with the finalise call, either copying all
+///   the parts in a single buffer or handing out a scatter-gather list of
+///   the parts, without copies.
 template <typename ID>
 class PayloadMerger {
 public:
@@ -33,6 +35,15 @@ public:
   using IdExtractor = std::function<MergeableId(std::unique_ptr<FairMQMessage>&)>;
   using MergeCompletionCheker = std::function<bool(MergeableId, MessageMap &)>;
 
+  /// One element of a scatter-gather list: the region [data, data + size)
+  /// of the owned message is what needs to be sent.
+  struct Fragment {
+    std::unique_ptr<FairMQMessage> message;
+    char *data;
+    size_t size;
+  };
+  using Fragments = std::vector<Fragment>;
+
   /// Helper class to merge FairMQMessages sharing a user defined class of equivalence,
   /// specified by @makeId. Completeness of the class of equivalence can be asserted by 
   /// the @checkIfComplete policy. It's also possible to specify a user defined way of 
@@ -104,6 +115,33 @@ public:
     return sum;
   }
 
+  /// Same as finalise(char **, MergeableId &), but rather than copying the
+  /// parts into a single buffer, it moves the messages belonging to @a id
+  /// into @a out, together with the region of each of them which needs to
+  /// be sent, in the order they were aggregated. The payloads are not
+  /// touched, so that the caller can send them as a multipart message.
+  /// @return the sum of the sizes of the fragments, 0 if @a id is not
+  ///         complete yet.
+  size_t finalise(Fragments &out, MergeableId &id) {
+    out.clear();
+    if (mCheckIfComplete(id, mPartsMap) == false) {
+      return 0;
+    }
+    size_t sum = 0;
+    auto range = mPartsMap.equal_range(id);
+    for (auto hi = range.first, he = range.second; hi != he; ++hi) {
+      Fragment fragment;
+      fragment.message = std::move(hi->second);
+      fragment.size = mExtractPayload(&fragment.data,
+                                      reinterpret_cast<char *>(fragment.message->GetData()),
+                                      fragment.message->GetSize());
+      sum += fragment.size;
+      out.push_back(std::move(fragment));
+    }
+    mPartsMap.erase(range.first, range.second);
+    return sum;
+  }
+
   // Helper method which leaves the payload untouched
   static int64_t fullPayloadExtractor(char **payload,
                                       char *buffer,
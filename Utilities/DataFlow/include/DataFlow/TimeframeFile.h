@@ -0,0 +1,129 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef TIMEFRAME_FILE_H_
+#define TIMEFRAME_FILE_H_
+
+#include "Headers/DataHeader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FairMQParts;
+
+namespace o2 { namespace DataFlow {
+
+/// Layout of a timeframe file:
+///
+/// - The timeframes, as written by streamTimeframe, i.e. a sequence of
+///   DataHeader / payload pairs, each timeframe terminated by its
+///   TIMEFRAMEINDEX pair.
+/// - A trailing DataHeader / payload pair with description TFFILEINDEX,
+///   whose payload is an array of TimeframeFileIndexEntry followed by a
+///   TimeframeFileTrailer. Since the trailer is at a fixed position
+///   from the end of the file, the index can be located without
+///   parsing the rest of the file.
+///
+/// Files without the trailing index are still supported: in that case
+/// the index is rebuilt by hopping from one header to the next one.
+struct TimeframeFileIndexEntry {
+  uint64_t timeframe;
+  o2::header::DataOrigin origin;
+  o2::header::DataDescription description;
+  o2::header::DataHeader::SubSpecificationType subSpecification;
+  uint64_t headerOffset;
+  uint64_t headerSize;
+  uint64_t payloadOffset;
+  uint64_t payloadSize;
+};
+
+struct TimeframeFileTrailer {
+  static constexpr char const* Magic = "O2TFIDX1";
+  uint64_t indexOffset; // Offset of the DataHeader of the index part
+  uint64_t entries;     // Number of TimeframeFileIndexEntry in the index
+  char magic[8];
+};
+
+constexpr o2::header::DataDescription gDataDescriptionTimeframeFileIndex{ "TFFILEINDEX" };
+
+/// Same as streamTimeframe(std::ostream &, FairMQParts &), but also records
+/// where each part ended up in the file, for timeframe @a timeframe.
+void streamTimeframe(std::ostream &stream, FairMQParts &parts,
+                     uint64_t timeframe, std::vector<TimeframeFileIndexEntry> &index);
+
+/// Append the index part at the current position of @a stream. It should be
+/// the last thing written to a file.
+void writeTimeframeFileIndex(std::ostream &stream, std::vector<TimeframeFileIndexEntry> const &index);
+
+/// Read only, memory mapped, view of a timeframe file. Parts can be accessed
+/// randomly via the index and handed out without copies.
+class MappedTimeframeFile {
+public:
+  /// Maps @a filename in memory. Throws std::runtime_error on failure.
+  MappedTimeframeFile(std::string const &filename);
+  ~MappedTimeframeFile();
+
+  MappedTimeframeFile(MappedTimeframeFile const &) = delete;
+  MappedTimeframeFile &operator=(MappedTimeframeFile const &) = delete;
+
+  /// Whether the file had a trailing index or it had to be rebuilt.
+  bool hasIndex() const { return mHasIndex; }
+  size_t getNTimeframes() const { return mTimeframeBegin.empty() ? 0 : mTimeframeBegin.size() - 1; }
+  std::vector<TimeframeFileIndexEntry> const &getIndex() const { return mIndex; }
+
+  /// @return the [begin, end) range of index entries for timeframe @a tf
+  std::pair<TimeframeFileIndexEntry const *, TimeframeFileIndexEntry const *> getTimeframe(size_t tf) const;
+
+  char const *data(uint64_t offset) const { return mData + offset; }
+  size_t size() const { return mSize; }
+
+  /// Hint the kernel that the parts in the [begin, end) range of the index
+  /// are going to be needed soon, so that they are read ahead
+  /// asynchronously.
+  void prefetch(TimeframeFileIndexEntry const *begin, TimeframeFileIndexEntry const *end) const;
+
+private:
+  void readIndex();
+  void rebuildIndex();
+
+  int mFd = -1;
+  char const *mData = nullptr;
+  size_t mSize = 0;
+  bool mHasIndex = false;
+  std::vector<TimeframeFileIndexEntry> mIndex;
+  std::vector<size_t> mTimeframeBegin; // position in mIndex where each timeframe starts
+};
+
+/// Parts of a timeframe of a MappedTimeframeFile which are to be sent.
+struct TimeframeSelection {
+  /// Selected entries, in file order. It ends with the TIMEFRAMEINDEX
+  /// entry of the file when all the data parts are selected.
+  std::vector<TimeframeFileIndexEntry const *> entries;
+  /// When only some of the data parts are selected, the TIMEFRAMEINDEX of
+  /// the file does not describe them anymore: these are the header and the
+  /// payload of the index rebuilt for the selected parts, to be sent after
+  /// them. Empty otherwise.
+  std::vector<char> indexHeader;
+  std::vector<char> indexPayload;
+};
+
+/// Selects the data parts of timeframe @a tf of @a file accepted by
+/// @a isSelected, so that they still form a valid timeframe.
+TimeframeSelection selectTimeframeParts(MappedTimeframeFile const &file, size_t tf,
+                                        std::function<bool(TimeframeFileIndexEntry const &)> const &isSelected);
+
+} } // end
+
+#endif // TIMEFRAME_FILE_H_
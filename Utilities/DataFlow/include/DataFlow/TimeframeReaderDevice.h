@@ -12,7 +12,11 @@
 #define ALICEO2_TIMEFRAME_READER_H_
 
 #include "O2Device/O2Device.h"
+#include "Headers/DataHeader.h"
 #include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace o2 {
 namespace DataFlow {
@@ -23,6 +27,9 @@ class TimeframeReaderDevice : public Base::O2Device
 public:
     static constexpr const char* OptionKeyOutputChannelName = "output-channel-name";
     static constexpr const char* OptionKeyInputFileName = "input-file";
+    static constexpr const char* OptionKeyReadMode = "read-mode";
+    static constexpr const char* OptionKeyDataTypes = "data-types";
+    static constexpr const char* OptionKeyPrefetchDepth = "prefetch-depth";
 
     /// Default constructor
     TimeframeReaderDevice();
@@ -36,10 +43,21 @@ public:
     /// Overloads the ConditionalRun() method of FairMQDevice
     bool ConditionalRun() final;
 
+    /// Stream the file sequentially, parsing it as we go
+    void streamFile(std::string const& fn);
+    /// Map the file in memory and send the selected parts of each timeframe
+    /// without copying them.
+    void mapFile(std::string const& fn);
+
     std::string      mOutChannelName;
     std::string      mInFileName;
     std::fstream     mFile;
     std::vector<std::string> mSeen;
+    std::string      mReadMode;
+    // Only these origin / description pairs are sent in mmap mode.
+    // Everything is sent if empty.
+    std::vector<std::pair<o2::header::DataOrigin, o2::header::DataDescription>> mDataTypes;
+    size_t           mPrefetchDepth;
 };
 
 } // namespace DataFlow
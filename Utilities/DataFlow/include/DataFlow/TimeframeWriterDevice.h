@@ -12,7 +12,9 @@
 #define ALICEO2_TIMEFRAME_WRITER_DEVICE_H_
 
 #include "O2Device/O2Device.h"
+#include "DataFlow/TimeframeFile.h"
 #include <fstream>
+#include <vector>
 
 namespace o2 {
 namespace DataFlow {
@@ -49,6 +51,8 @@ public:
     size_t           mMaxFileSize;
     size_t           mMaxFiles;
     size_t           mFileCount;
+    size_t           mTimeframesInFile;
+    std::vector<TimeframeFileIndexEntry> mIndex;
 };
 
 } // namespace DataFlow
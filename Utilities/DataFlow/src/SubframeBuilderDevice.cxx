@@ -45,6 +45,7 @@ void o2::DataFlow::SubframeBuilderDevice::InitTask()
   mOutputChannelName = GetConfig()->GetValue<std::string>(OptionKeyOutputChannelName);
   mFLPId= GetConfig()->GetValue<size_t>(OptionKeyFLPId);
   mStripHBF= GetConfig()->GetValue<bool>(OptionKeyStripHBF);
+  mCopyPayload = GetConfig()->GetValue<bool>(OptionKeyCopyPayload);
 
   LOG(INFO) << "Obtaining data from DataPublisher\n";
   // Now that we have all the information lets create the policies to do the 
@@ -83,8 +84,11 @@ bool o2::DataFlow::SubframeBuilderDevice::BuildAndSendFrame(FairMQParts &inParts
 {
   auto id = mMerger->aggregate(inParts.At(1));
 
-  char **outBuffer;
-  size_t outSize = mMerger->finalise(outBuffer, id);
+  // Unless we are asked to merge everything in a single buffer, the
+  // heartbeat frames are forwarded as they are, one part each.
+  char *outBuffer = nullptr;
+  Merger::Fragments fragments;
+  size_t outSize = mCopyPayload ? mMerger->finalise(&outBuffer, id) : mMerger->finalise(fragments, id);
   // In this case we do not have enough subtimeframes for id,
   // so we simply return.
   if (outSize == 0)
@@ -118,10 +122,29 @@ bool o2::DataFlow::SubframeBuilderDevice::BuildAndSendFrame(FairMQParts &inParts
   O2Message outgoing;
   o2::Base::addDataBlock(outgoing, dh, NewSimpleMessage(md));
 
-  // Add the actual merged payload.
-  o2::Base::addDataBlock(outgoing, payloadheader,
-                         NewMessage(*outBuffer, outSize,
-                                    [](void* data, void* hint) { delete[] reinterpret_cast<char*>(hint); }, *outBuffer));
+  if (mCopyPayload) {
+    // Add the actual merged payload.
+    o2::Base::addDataBlock(outgoing, payloadheader,
+                           NewMessage(outBuffer, outSize,
+                                      [](void* data, void* hint) { delete[] reinterpret_cast<char*>(hint); }, outBuffer));
+  } else {
+    // Add one header / payload pair per fragment. When the whole heartbeat
+    // frame is sent, the original message is reused. Otherwise a new message
+    // pointing inside the original one is created, which keeps the latter
+    // alive until the transport is done with it.
+    for (auto& fragment : fragments) {
+      DataHeader fragmentHeader(payloadheader);
+      fragmentHeader.payloadSize = fragment.size;
+      if (fragment.data == fragment.message->GetData() && fragment.size == fragment.message->GetSize()) {
+        o2::Base::addDataBlock(outgoing, fragmentHeader, std::move(fragment.message));
+        continue;
+      }
+      auto owner = fragment.message.release();
+      o2::Base::addDataBlock(outgoing, fragmentHeader,
+                             NewMessage(fragment.data, fragment.size,
+                                        [](void*, void* hint) { delete reinterpret_cast<FairMQMessage*>(hint); }, owner));
+    }
+  }
   // send message
   Send(outgoing, mOutputChannelName.c_str());
   // FIXME: do we actually need this? outgoing should go out of scope
@@ -0,0 +1,279 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   TimeframeFile.cxx
+/// @brief  Indexed, memory mappable, timeframe files
+
+#include "DataFlow/TimeframeFile.h"
+#include "DataFlow/TimeframeParser.h"
+#include "TimeFrame/TimeFrame.h"
+
+#include <FairMQParts.h>
+
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using DataHeader = o2::header::DataHeader;
+using DataDescription = o2::header::DataDescription;
+using IndexElement = o2::DataFormat::IndexElement;
+
+namespace o2 { namespace DataFlow {
+
+void streamTimeframe(std::ostream &stream, FairMQParts &parts,
+                     uint64_t timeframe, std::vector<TimeframeFileIndexEntry> &index) {
+  uint64_t offset = stream.tellp();
+  // This does all the validation of the timeframe
+  streamTimeframe(stream, parts);
+
+  for (size_t i = 0; i + 1 < parts.Size(); i += 2) {
+    auto dh = o2::header::get<DataHeader*>(parts.At(i)->GetData());
+    TimeframeFileIndexEntry entry;
+    entry.timeframe = timeframe;
+    entry.origin = dh->dataOrigin;
+    entry.description = dh->dataDescription;
+    entry.subSpecification = dh->subSpecification;
+    entry.headerOffset = offset;
+    entry.headerSize = parts.At(i)->GetSize();
+    entry.payloadOffset = offset + entry.headerSize;
+    entry.payloadSize = parts.At(i + 1)->GetSize();
+    index.push_back(entry);
+    offset = entry.payloadOffset + entry.payloadSize;
+  }
+}
+
+void writeTimeframeFileIndex(std::ostream &stream, std::vector<TimeframeFileIndexEntry> const &index) {
+  TimeframeFileTrailer trailer;
+  trailer.indexOffset = stream.tellp();
+  trailer.entries = index.size();
+  memcpy(trailer.magic, TimeframeFileTrailer::Magic, sizeof(trailer.magic));
+
+  DataHeader dh;
+  dh.dataDescription = gDataDescriptionTimeframeFileIndex;
+  dh.dataOrigin = o2::header::gDataOriginAny;
+  dh.payloadSize = index.size() * sizeof(TimeframeFileIndexEntry) + sizeof(TimeframeFileTrailer);
+
+  stream.write(reinterpret_cast<char const *>(&dh), sizeof(dh));
+  stream.write(reinterpret_cast<char const *>(index.data()), index.size() * sizeof(TimeframeFileIndexEntry));
+  stream.write(reinterpret_cast<char const *>(&trailer), sizeof(trailer));
+}
+
+MappedTimeframeFile::MappedTimeframeFile(std::string const &filename) {
+  mFd = open(filename.c_str(), O_RDONLY);
+  if (mFd < 0) {
+    throw std::runtime_error("Unable to open " + filename);
+  }
+  struct stat st;
+  if (fstat(mFd, &st) != 0) {
+    close(mFd);
+    throw std::runtime_error("Unable to stat " + filename);
+  }
+  mSize = st.st_size;
+  if (mSize != 0) {
+    void *ptr = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, mFd, 0);
+    if (ptr == MAP_FAILED) {
+      close(mFd);
+      throw std::runtime_error("Unable to map " + filename);
+    }
+    mData = reinterpret_cast<char const *>(ptr);
+  }
+  try {
+    readIndex();
+    if (mHasIndex == false) {
+      rebuildIndex();
+    }
+  } catch (...) {
+    // The destructor is not invoked when the constructor throws
+    if (mData) {
+      munmap(const_cast<char *>(mData), mSize);
+    }
+    close(mFd);
+    throw;
+  }
+
+  // The index is sorted by timeframe, find where each of them starts.
+  for (size_t i = 0; i < mIndex.size(); ++i) {
+    while (mTimeframeBegin.size() <= mIndex[i].timeframe) {
+      mTimeframeBegin.push_back(i);
+    }
+  }
+  mTimeframeBegin.push_back(mIndex.size());
+}
+
+MappedTimeframeFile::~MappedTimeframeFile() {
+  if (mData) {
+    munmap(const_cast<char *>(mData), mSize);
+  }
+  if (mFd >= 0) {
+    close(mFd);
+  }
+}
+
+namespace {
+// Whether [offset, offset + size) fits in the first @a limit bytes, without
+// overflowing.
+bool inRange(uint64_t offset, uint64_t size, uint64_t limit) {
+  return offset <= limit && size <= limit - offset;
+}
+} // namespace
+
+void MappedTimeframeFile::readIndex() {
+  if (mSize < sizeof(DataHeader) + sizeof(TimeframeFileTrailer)) {
+    return;
+  }
+  TimeframeFileTrailer trailer;
+  memcpy(&trailer, mData + mSize - sizeof(trailer), sizeof(trailer));
+  if (memcmp(trailer.magic, TimeframeFileTrailer::Magic, sizeof(trailer.magic)) != 0) {
+    return;
+  }
+  // Everything in the trailer comes from the file, so the sizes are checked
+  // against what is left before doing any arithmetic with them.
+  if (trailer.indexOffset > mSize - sizeof(DataHeader) - sizeof(trailer)) {
+    throw std::runtime_error("Corrupted timeframe file index: bad index offset");
+  }
+  auto entriesOffset = trailer.indexOffset + sizeof(DataHeader);
+  auto entriesSize = mSize - sizeof(trailer) - entriesOffset;
+  if (trailer.entries > entriesSize / sizeof(TimeframeFileIndexEntry)
+      || trailer.entries * sizeof(TimeframeFileIndexEntry) != entriesSize) {
+    throw std::runtime_error("Corrupted timeframe file index: bad number of entries");
+  }
+  std::vector<TimeframeFileIndexEntry> index(trailer.entries);
+  memcpy(index.data(), mData + entriesOffset, entriesSize);
+
+  // Entries must point to the data before the index and be sorted by
+  // timeframe, with no gaps.
+  for (size_t i = 0; i < index.size(); ++i) {
+    auto const &entry = index[i];
+    if (entry.headerSize < sizeof(DataHeader)
+        || !inRange(entry.headerOffset, entry.headerSize, trailer.indexOffset)
+        || !inRange(entry.payloadOffset, entry.payloadSize, trailer.indexOffset)) {
+      std::ostringstream str;
+      str << "Corrupted timeframe file index: entry " << i << " is outside of the file";
+      throw std::runtime_error(str.str());
+    }
+    uint64_t previous = i == 0 ? 0 : index[i - 1].timeframe;
+    if (entry.timeframe < previous || entry.timeframe > previous + 1) {
+      std::ostringstream str;
+      str << "Corrupted timeframe file index: entry " << i << " has unexpected timeframe " << entry.timeframe;
+      throw std::runtime_error(str.str());
+    }
+  }
+  mIndex = std::move(index);
+  mHasIndex = true;
+}
+
+// Legacy files have no index. Hop from one header to the next one, which
+// does not require touching the payloads.
+void MappedTimeframeFile::rebuildIndex() {
+  uint64_t offset = 0;
+  uint64_t timeframe = 0;
+  while (offset < mSize) {
+    if (offset + sizeof(DataHeader) > mSize) {
+      throw std::runtime_error("Premature end of file");
+    }
+    DataHeader dh;
+    memcpy(&dh, mData + offset, sizeof(dh));
+    if (dh.headerSize < sizeof(DataHeader)) {
+      std::ostringstream str;
+      str << "Bad header size at offset " << offset << ". Found " << dh.headerSize;
+      throw std::runtime_error(str.str());
+    }
+    if (!inRange(offset + dh.headerSize, dh.payloadSize, mSize)) {
+      throw std::runtime_error("Unexpected end of file");
+    }
+    TimeframeFileIndexEntry entry;
+    entry.timeframe = timeframe;
+    entry.origin = dh.dataOrigin;
+    entry.description = dh.dataDescription;
+    entry.subSpecification = dh.subSpecification;
+    entry.headerOffset = offset;
+    entry.headerSize = dh.headerSize;
+    entry.payloadOffset = offset + dh.headerSize;
+    entry.payloadSize = dh.payloadSize;
+    mIndex.push_back(entry);
+    offset = entry.payloadOffset + entry.payloadSize;
+    if (dh.dataDescription == DataDescription("TIMEFRAMEINDEX")) {
+      timeframe++;
+    }
+  }
+}
+
+std::pair<TimeframeFileIndexEntry const *, TimeframeFileIndexEntry const *>
+MappedTimeframeFile::getTimeframe(size_t tf) const {
+  if (tf >= getNTimeframes()) {
+    throw std::runtime_error("Timeframe " + std::to_string(tf) + " not in file");
+  }
+  return std::make_pair(mIndex.data() + mTimeframeBegin[tf], mIndex.data() + mTimeframeBegin[tf + 1]);
+}
+
+void MappedTimeframeFile::prefetch(TimeframeFileIndexEntry const *begin, TimeframeFileIndexEntry const *end) const {
+  static const size_t pageSize = sysconf(_SC_PAGESIZE);
+  for (auto entry = begin; entry != end; ++entry) {
+    // madvise requires a page aligned address
+    size_t start = entry->headerOffset & ~(pageSize - 1);
+    size_t length = entry->payloadOffset + entry->payloadSize - start;
+    madvise(const_cast<char *>(mData) + start, length, MADV_WILLNEED);
+  }
+}
+
+TimeframeSelection selectTimeframeParts(MappedTimeframeFile const &file, size_t tf,
+                                        std::function<bool(TimeframeFileIndexEntry const &)> const &isSelected) {
+  TimeframeSelection selection;
+  TimeframeFileIndexEntry const *index = nullptr;
+  size_t dataParts = 0;
+  auto range = file.getTimeframe(tf);
+  for (auto entry = range.first; entry != range.second; ++entry) {
+    if (entry->description == DataDescription("TIMEFRAMEINDEX")) {
+      index = entry;
+      continue;
+    }
+    dataParts++;
+    if (isSelected(*entry)) {
+      selection.entries.push_back(entry);
+    }
+  }
+  if (selection.entries.empty()) {
+    return selection;
+  }
+  if (index && selection.entries.size() == dataParts) {
+    selection.entries.push_back(index);
+    return selection;
+  }
+
+  // The position of an element is the one of its header / payload pair,
+  // like in the index built by the FakeTimeframeBuilder.
+  std::vector<IndexElement> elements(selection.entries.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    memcpy(&elements[i].first, file.data(selection.entries[i]->headerOffset), sizeof(DataHeader));
+    elements[i].second = i;
+  }
+  DataHeader dh;
+  if (index) {
+    memcpy(&dh, file.data(index->headerOffset), sizeof(dh));
+  } else {
+    dh.dataDescription = DataDescription("TIMEFRAMEINDEX");
+    dh.dataOrigin = o2::header::gDataOriginAny;
+  }
+  dh.headerSize = sizeof(dh);
+  dh.payloadSize = elements.size() * sizeof(IndexElement);
+  auto header = reinterpret_cast<char const *>(&dh);
+  auto payload = reinterpret_cast<char const *>(elements.data());
+  selection.indexHeader.assign(header, header + sizeof(dh));
+  selection.indexPayload.assign(payload, payload + dh.payloadSize);
+  return selection;
+}
+
+} } // namespace o2::DataFlow
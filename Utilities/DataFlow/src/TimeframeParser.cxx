@@ -18,6 +18,7 @@
 #include <cstring>
 
 #include "DataFlow/TimeframeParser.h"
+#include "DataFlow/TimeframeFile.h"
 #include "Headers/SubframeMetadata.h"
 #include "Headers/DataHeader.h"
 #include "TimeFrame/TimeFrame.h"
@@ -94,6 +95,12 @@ void streamTimeframe(std::istream &stream,
         if (stream.eof()) {
           throw std::runtime_error("Premature end of stream");
         }
+        // The file index is always the last part of a file, and it is not
+        // part of any timeframe.
+        if (state.dh.dataDescription == gDataDescriptionTimeframeFileIndex) {
+          state.state = PARSE_END_STREAM;
+          break;
+        }
 
         // Otherwise we move to the state which is responsible for parsing the
         // kind of header.
@@ -114,7 +121,7 @@ void streamTimeframe(std::istream &stream,
           throw std::runtime_error(str.str());
         }
         // We get the full header size and read the rest of the header
-        state.headerBuffer = malloc(state.dh.headerSize);
+        state.headerBuffer = new char[state.dh.headerSize];
         memcpy(state.headerBuffer, &state.dh, sizeof(state.dh));
         LOG(INFO) << "Reading rest of the header of " << state.dh.headerSize - sizeof(state.dh) << " bytes\n";
         stream.read(reinterpret_cast<char*>(state.headerBuffer)+ sizeof(state.dh),
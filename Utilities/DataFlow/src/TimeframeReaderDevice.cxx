@@ -8,13 +8,16 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <algorithm>
 #include <cstring>
 
 #include "DataFlow/TimeframeReaderDevice.h"
 #include "DataFlow/TimeframeParser.h"
+#include "DataFlow/TimeframeFile.h"
 #include "Headers/SubframeMetadata.h"
 #include "Headers/DataHeader.h"
 #include <options/FairMQProgOptions.h>
+#include <boost/algorithm/string.hpp>
 
 using DataHeader = o2::header::DataHeader;
 
@@ -24,6 +27,7 @@ TimeframeReaderDevice::TimeframeReaderDevice()
   : O2Device{}
   , mOutChannelName{}
   , mFile{}
+  , mPrefetchDepth{0}
 {
 }
 
@@ -31,29 +35,44 @@ void TimeframeReaderDevice::InitTask()
 {
   mOutChannelName = GetConfig()->GetValue<std::string>(OptionKeyOutputChannelName);
   mInFileName = GetConfig()->GetValue<std::string>(OptionKeyInputFileName);
+  mReadMode = GetConfig()->GetValue<std::string>(OptionKeyReadMode);
+  mPrefetchDepth = GetConfig()->GetValue<size_t>(OptionKeyPrefetchDepth);
   mSeen.clear();
+
+  // Data types are given as a comma separated list of ORIGIN/DESCRIPTION
+  mDataTypes.clear();
+  auto dataTypes = GetConfig()->GetValue<std::string>(OptionKeyDataTypes);
+  std::vector<std::string> tokens;
+  boost::split(tokens, dataTypes, boost::is_any_of(","), boost::token_compress_on);
+  for (auto& token : tokens) {
+    if (token.empty()) {
+      continue;
+    }
+    auto slash = token.find('/');
+    if (slash == std::string::npos) {
+      throw std::runtime_error("Bad data type " + token + ". Expected ORIGIN/DESCRIPTION");
+    }
+    o2::header::DataOrigin origin;
+    o2::header::DataDescription description;
+    origin.runtimeInit(token.substr(0, slash).c_str());
+    description.runtimeInit(token.substr(slash + 1).c_str());
+    mDataTypes.emplace_back(origin, description);
+  }
 }
 
 bool TimeframeReaderDevice::ConditionalRun()
 {
-  auto addPartFn = [this](FairMQParts &parts, char *buffer, size_t size) {
-        parts.AddPart(this->NewMessage(buffer,
-                                       size,
-                                       [](void* data, void* hint) { delete[] (char*)data; },
-                                       nullptr));
-  };
-  auto sendFn = [this](FairMQParts &parts) {this->Send(parts, this->mOutChannelName);};
-
   // FIXME: For the moment we support a single file. This should really be a glob. We
   //        should also have a strategy for watching directories.
   std::vector<std::string> files;
   files.push_back(mInFileName);
   for (auto &&fn : files) {
-    mFile.open(fn, std::ofstream::in | std::ofstream::binary);
     try {
-      streamTimeframe(mFile,
-                      addPartFn,
-                      sendFn);
+      if (mReadMode == "mmap") {
+        mapFile(fn);
+      } else {
+        streamFile(fn);
+      }
     } catch(std::runtime_error &e) {
       LOG(ERROR) << e.what() << "\n";
     }
@@ -63,4 +82,85 @@ bool TimeframeReaderDevice::ConditionalRun()
   return false;
 }
 
+void TimeframeReaderDevice::streamFile(std::string const& fn)
+{
+  auto addPartFn = [this](FairMQParts &parts, char *buffer, size_t size) {
+        parts.AddPart(this->NewMessage(buffer,
+                                       size,
+                                       [](void* data, void* hint) { delete[] (char*)data; },
+                                       nullptr));
+  };
+  auto sendFn = [this](FairMQParts &parts) {this->Send(parts, this->mOutChannelName);};
+
+  mFile.open(fn, std::ofstream::in | std::ofstream::binary);
+  streamTimeframe(mFile,
+                  addPartFn,
+                  sendFn);
+}
+
+void TimeframeReaderDevice::mapFile(std::string const& fn)
+{
+  // The mapping must outlive the messages pointing to it, which are released
+  // by the transport whenever it is done with them.
+  auto file = std::make_shared<MappedTimeframeFile>(fn);
+  LOG(INFO) << "Mapped " << fn << " with " << file->getNTimeframes() << " timeframes"
+            << (file->hasIndex() ? "" : " (index rebuilt)") << "\n";
+
+  auto isSelected = [this](TimeframeFileIndexEntry const& entry) -> bool {
+    if (mDataTypes.empty()) {
+      return true;
+    }
+    for (auto& type : mDataTypes) {
+      if (entry.origin == type.first && entry.description == type.second) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto prefetch = [&file, &isSelected](size_t tf) {
+    auto range = file->getTimeframe(tf);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+      if (isSelected(*entry)) {
+        file->prefetch(entry, entry + 1);
+      }
+    }
+  };
+
+  auto release = [](void*, void* hint) { delete reinterpret_cast<std::shared_ptr<MappedTimeframeFile>*>(hint); };
+  auto newMessage = [this, &file, &release](uint64_t offset, uint64_t size) {
+    return this->NewMessage(const_cast<char*>(file->data(offset)), size, release,
+                            new std::shared_ptr<MappedTimeframeFile>(file));
+  };
+
+  for (size_t tf = 0; tf < std::min(mPrefetchDepth, file->getNTimeframes()); ++tf) {
+    prefetch(tf);
+  }
+
+  for (size_t tf = 0; tf < file->getNTimeframes() && CheckCurrentState(RUNNING); ++tf) {
+    // Keep the read ahead window mPrefetchDepth timeframes in front of us.
+    if (mPrefetchDepth && tf + mPrefetchDepth < file->getNTimeframes()) {
+      prefetch(tf + mPrefetchDepth);
+    }
+    FairMQParts parts;
+    auto selection = selectTimeframeParts(*file, tf, isSelected);
+    for (auto entry : selection.entries) {
+      parts.AddPart(newMessage(entry->headerOffset, entry->headerSize));
+      parts.AddPart(newMessage(entry->payloadOffset, entry->payloadSize));
+    }
+    // The index rebuilt for a subset of the parts is small, copy it
+    for (auto buffer : { &selection.indexHeader, &selection.indexPayload }) {
+      if (buffer->empty()) {
+        continue;
+      }
+      auto message = NewMessage(buffer->size());
+      memcpy(message->GetData(), buffer->data(), buffer->size());
+      parts.AddPart(std::move(message));
+    }
+    if (parts.Size()) {
+      Send(parts, mOutChannelName);
+    }
+  }
+}
+
 }} // namespace o2::DataFlow
@@ -18,6 +18,7 @@
 
 #include "DataFlow/TimeframeWriterDevice.h"
 #include "DataFlow/TimeframeParser.h"
+#include "DataFlow/TimeframeFile.h"
 #include "TimeFrame/TimeFrame.h"
 #include "Headers/SubframeMetadata.h"
 #include "Headers/DataHeader.h"
@@ -38,6 +39,8 @@ TimeframeWriterDevice::TimeframeWriterDevice()
   , mMaxFileSize{}
   , mMaxFiles{}
   , mFileCount{0}
+  , mTimeframesInFile{0}
+  , mIndex{}
 {
 }
 
@@ -68,6 +71,8 @@ void TimeframeWriterDevice::Run()
       }
       LOG(INFO) << "Opening " << filename << " for output\n";
       mFile.open(filename.c_str(), std::ofstream::out | std::ofstream::binary);
+      mIndex.clear();
+      mTimeframesInFile = 0;
       needsNewFile = false;
     }
 
@@ -75,9 +80,10 @@ void TimeframeWriterDevice::Run()
     if (Receive(timeframeParts, mInChannelName, 0, 100) <= 0)
       continue;
 
-    streamTimeframe(mFile, timeframeParts);
+    streamTimeframe(mFile, timeframeParts, mTimeframesInFile++, mIndex);
     if ((mFile.tellp() > mMaxFileSize) || (streamedTimeframes++ > mMaxTimeframes))
     {
+      writeTimeframeFileIndex(mFile, mIndex);
       mFile.flush();
       mFile.close();
       mFileCount++;
@@ -89,6 +95,7 @@ void TimeframeWriterDevice::Run()
 void TimeframeWriterDevice::PostRun()
 {
   if (mFile.is_open()) {
+    writeTimeframeFileIndex(mFile, mIndex);
     mFile.flush();
     mFile.close();
   }
@@ -39,7 +39,10 @@ void addCustomOptions(bpo::options_description& options)
      "ID of the FLP used as data source")
     (o2::DataFlow::SubframeBuilderDevice::OptionKeyStripHBF,
      bpo::bool_switch()->default_value(false),
-     "Strip HBH & HBT from each HBF");
+     "Strip HBH & HBT from each HBF")
+    (o2::DataFlow::SubframeBuilderDevice::OptionKeyCopyPayload,
+     bpo::bool_switch()->default_value(false),
+     "Copy all the HBF in a single payload, rather than sending one part per HBF");
 }
 
 FairMQDevicePtr getDevice(const FairMQProgOptions& /*config*/)
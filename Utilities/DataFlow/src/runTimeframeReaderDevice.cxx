@@ -23,6 +23,18 @@ void addCustomOptions(bpo::options_description& options)
     (o2::DataFlow::TimeframeReaderDevice::OptionKeyInputFileName,
      bpo::value<std::string>()->default_value("data.o2tf"),
      "Name of the input file");
+  options.add_options()
+    (o2::DataFlow::TimeframeReaderDevice::OptionKeyReadMode,
+     bpo::value<std::string>()->default_value("stream"),
+     "How to read the file: stream (parse it sequentially) or mmap (map it and use its index)");
+  options.add_options()
+    (o2::DataFlow::TimeframeReaderDevice::OptionKeyDataTypes,
+     bpo::value<std::string>()->default_value(""),
+     "Comma separated list of ORIGIN/DESCRIPTION to be sent in mmap mode. All if empty.");
+  options.add_options()
+    (o2::DataFlow::TimeframeReaderDevice::OptionKeyPrefetchDepth,
+     bpo::value<size_t>()->default_value(2),
+     "Number of timeframes to read ahead in mmap mode");
 }
 
 FairMQDevicePtr getDevice(const FairMQProgOptions& /*config*/)
@@ -0,0 +1,142 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include <benchmark/benchmark.h>
+
+#include "DataFlow/PayloadMerger.h"
+#include "DataFlow/SubframeUtils.h"
+#include "Headers/HeartbeatFrame.h"
+#include "fairmq/FairMQTransportFactory.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using SubframeId = o2::dataflow::SubframeId;
+using Merger = o2::dataflow::PayloadMerger<SubframeId>;
+using HeartbeatHeader = o2::header::HeartbeatHeader;
+
+namespace
+{
+// Bytes allocated with the global operator new while gCountAllocations is
+// set. The benchmarks are single threaded.
+bool gCountAllocations = false;
+size_t gAllocatedBytes = 0;
+
+// Bytes allocated with the global operator new while running @a f
+template <typename F>
+size_t allocatedBy(F&& f)
+{
+  gAllocatedBytes = 0;
+  gCountAllocations = true;
+  f();
+  gCountAllocations = false;
+  return gAllocatedBytes;
+}
+
+// A merger which needs @a parts heartbeat frames to complete a subtimeframe
+std::unique_ptr<Merger> createMerger(size_t parts)
+{
+  auto checkIfComplete = [parts](SubframeId id, Merger::MessageMap& m) -> bool {
+    return m.count(id) >= parts;
+  };
+  auto makeId = [](std::unique_ptr<FairMQMessage>& msg) {
+    auto header = reinterpret_cast<HeartbeatHeader const*>(msg->GetData());
+    return o2::dataflow::makeIdFromHeartbeatHeader(*header, 0, 1);
+  };
+  return std::make_unique<Merger>(makeId, checkIfComplete, o2::dataflow::extractDetectorPayloadStrip);
+}
+
+// Aggregates @a parts heartbeat frames of @a size bytes for @a orbit
+SubframeId fill(Merger& merger, FairMQTransportFactory& transport, size_t parts, size_t size, int64_t orbit)
+{
+  SubframeId id;
+  for (size_t i = 0; i < parts; ++i) {
+    auto msg = transport.CreateMessage(size);
+    memset(msg->GetData(), 0, sizeof(HeartbeatHeader));
+    reinterpret_cast<HeartbeatHeader*>(msg->GetData())->orbit = orbit;
+    id = merger.aggregate(msg);
+  }
+  return id;
+}
+} // namespace
+
+void* operator new(size_t size)
+{
+  if (gCountAllocations) {
+    gAllocatedBytes += size;
+  }
+  if (auto ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+// Build a subtimeframe of 16 heartbeat frames, copying them in a single
+// buffer. The argument is the size of each heartbeat frame.
+static void BM_MergeCopy(benchmark::State& state)
+{
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  size_t parts = 16;
+  auto merger = createMerger(parts);
+  int64_t orbit = 0;
+  size_t bytes = 0;
+  size_t allocated = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto id = fill(*merger, *transport, parts, state.range(0), orbit++);
+    state.ResumeTiming();
+    char* buffer = nullptr;
+    size_t size = 0;
+    allocated += allocatedBy([&]() { size = merger->finalise(&buffer, id); });
+    benchmark::DoNotOptimize(buffer);
+    bytes += size;
+    delete[] buffer;
+  }
+  state.SetBytesProcessed(bytes);
+  state.counters["allocated"] = benchmark::Counter(allocated, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_MergeCopy)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+// Same as above, but handing out the heartbeat frames as a scatter-gather
+// list, without copying them.
+static void BM_MergeScatterGather(benchmark::State& state)
+{
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  size_t parts = 16;
+  auto merger = createMerger(parts);
+  int64_t orbit = 0;
+  size_t bytes = 0;
+  size_t allocated = 0;
+  Merger::Fragments fragments;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto id = fill(*merger, *transport, parts, state.range(0), orbit++);
+    state.ResumeTiming();
+    allocated += allocatedBy([&]() { bytes += merger->finalise(fragments, id); });
+    benchmark::DoNotOptimize(fragments.data());
+  }
+  state.SetBytesProcessed(bytes);
+  state.counters["allocated"] = benchmark::Counter(allocated, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_MergeScatterGather)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+BENCHMARK_MAIN()
@@ -79,3 +79,40 @@ BOOST_AUTO_TEST_CASE(PayloadMergerTest) {
     BOOST_CHECK(finalBuf[i] == ((i % partSize) == 0 ? 127 : 1));
   }
 }
+
+BOOST_AUTO_TEST_CASE(PayloadMergerScatterGatherTest) {
+  auto zmq = FairMQTransportFactory::CreateTransportFactory("zeromq");
+
+  auto checkIfComplete = [](SubframeId id, o2::dataflow::PayloadMerger<SubframeId>::MessageMap &m) -> bool {
+    return m.count(id) >= 3;
+  };
+
+  auto makeId = [](std::unique_ptr<FairMQMessage> &msg) {
+    auto header = reinterpret_cast<o2::header::HeartbeatHeader const*>(msg->GetData());
+    return o2::dataflow::makeIdFromHeartbeatHeader(*header, 0, 2);
+  };
+
+  using Merger = o2::dataflow::PayloadMerger<SubframeId>;
+  Merger merger(makeId, checkIfComplete, o2::dataflow::extractDetectorPayloadStrip);
+  Merger::Fragments fragments;
+  auto id = fakeAddition(merger, zmq, 1);
+  BOOST_CHECK(merger.finalise(fragments, id) == 0);
+  BOOST_CHECK(fragments.empty());
+  id = fakeAddition(merger, zmq, 1);
+  BOOST_CHECK(merger.finalise(fragments, id) == 0);
+  id = fakeAddition(merger, zmq, 1);
+  size_t finalSize = merger.finalise(fragments, id);
+  size_t partSize = (1000-sizeof(HeartbeatHeader) - sizeof(HeartbeatTrailer));
+  BOOST_CHECK(finalSize == 3*partSize);
+  BOOST_REQUIRE(fragments.size() == 3);
+  for (auto &fragment : fragments) {
+    // The payload points inside the original message, no copies involved.
+    char *begin = reinterpret_cast<char*>(fragment.message->GetData());
+    BOOST_CHECK(fragment.data == begin + sizeof(HeartbeatHeader));
+    BOOST_CHECK(fragment.size == partSize);
+    BOOST_CHECK(fragment.data[0] == 127);
+    BOOST_CHECK(fragment.data[1] == 1);
+  }
+  // The parts have been handed out, nothing left to merge.
+  BOOST_CHECK(merger.finalise(fragments, id) == 0);
+}
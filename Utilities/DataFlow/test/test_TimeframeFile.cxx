@@ -0,0 +1,237 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Utilities DataFlowTimeframeFile
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "DataFlow/TimeframeFile.h"
+#include "DataFlow/TimeframeParser.h"
+#include "DataFlow/FakeTimeframeBuilder.h"
+#include "Headers/DataHeader.h"
+#include "TimeFrame/TimeFrame.h"
+#include "fairmq/FairMQTransportFactory.h"
+#include "fairmq/FairMQParts.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using DataHeader = o2::header::DataHeader;
+using DataOrigin = o2::header::DataOrigin;
+using DataDescription = o2::header::DataDescription;
+using IndexElement = o2::DataFormat::IndexElement;
+using namespace o2::DataFlow;
+
+namespace {
+// Writes @a nTimeframes fake timeframes to @a filename, with or without
+// the trailing index.
+void writeTestFile(std::string const &filename, size_t nTimeframes, bool withIndex)
+{
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  std::vector<TimeframeFileIndexEntry> index;
+
+  for (size_t tf = 0; tf < nTimeframes; ++tf) {
+    auto tpcFiller = [tf](char *b, size_t s) { memset(b, int(tf), s); };
+    auto itsFiller = [tf](char *b, size_t s) { memset(b, int(tf + 100), s); };
+    std::vector<FakeTimeframeSpec> specs = {
+      { .origin = "TPC", .dataDescription = "CLUSTERS", .bufferFiller = tpcFiller, .bufferSize = 1000 },
+      { .origin = "ITS", .dataDescription = "CLUSTERS", .bufferFiller = itsFiller, .bufferSize = 500 }
+    };
+    size_t bufferSize;
+    auto buffer = fakeTimeframeGenerator(specs, bufferSize);
+    std::istringstream in(std::string(buffer.get(), bufferSize));
+
+    auto onAddPart = [&transport](FairMQParts &parts, char *b, size_t size) {
+      parts.AddPart(transport->CreateMessage(b, size, [](void *data, void *) { delete[] (char *)data; }, nullptr));
+    };
+    auto onSend = [&out, &index, tf, withIndex](FairMQParts &parts) {
+      if (withIndex) {
+        streamTimeframe(out, parts, tf, index);
+      } else {
+        streamTimeframe(out, parts);
+      }
+    };
+    streamTimeframe(in, onAddPart, onSend);
+  }
+  if (withIndex) {
+    writeTimeframeFileIndex(out, index);
+  }
+}
+
+void checkFile(MappedTimeframeFile const &file, size_t nTimeframes)
+{
+  BOOST_REQUIRE_EQUAL(file.getNTimeframes(), nTimeframes);
+  for (size_t tf = 0; tf < nTimeframes; ++tf) {
+    auto range = file.getTimeframe(tf);
+    // two data parts and the timeframe index
+    BOOST_REQUIRE_EQUAL(range.second - range.first, 3);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+      BOOST_CHECK_EQUAL(entry->timeframe, tf);
+      auto dh = reinterpret_cast<DataHeader const *>(file.data(entry->headerOffset));
+      BOOST_CHECK(dh->dataOrigin == entry->origin);
+      BOOST_CHECK(dh->dataDescription == entry->description);
+      BOOST_CHECK_EQUAL(dh->payloadSize, entry->payloadSize);
+      auto payload = file.data(entry->payloadOffset);
+      if (entry->origin == DataOrigin("TPC")) {
+        BOOST_CHECK_EQUAL(entry->payloadSize, 1000);
+        BOOST_CHECK_EQUAL(payload[0], char(tf));
+        BOOST_CHECK_EQUAL(payload[999], char(tf));
+      } else if (entry->origin == DataOrigin("ITS")) {
+        BOOST_CHECK_EQUAL(entry->payloadSize, 500);
+        BOOST_CHECK_EQUAL(payload[499], char(tf + 100));
+      } else {
+        BOOST_CHECK(entry->description == DataDescription("TIMEFRAMEINDEX"));
+      }
+    }
+    file.prefetch(range.first, range.second);
+  }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestIndexedTimeframeFile)
+{
+  std::string filename = "test_TimeframeFile_indexed.o2tf";
+  writeTestFile(filename, 5, true);
+
+  MappedTimeframeFile file(filename);
+  BOOST_CHECK(file.hasIndex());
+  checkFile(file, 5);
+  BOOST_CHECK_THROW(file.getTimeframe(5), std::runtime_error);
+
+  // The sequential parser must still be able to read the file, skipping the
+  // index at the end.
+  std::ifstream in(filename, std::ios::binary);
+  size_t timeframes = 0;
+  streamTimeframe(in,
+                  [](FairMQParts &, char *b, size_t) { delete[] b; },
+                  [&timeframes](FairMQParts &) { timeframes++; });
+  BOOST_CHECK_EQUAL(timeframes, 5);
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestLegacyTimeframeFile)
+{
+  std::string filename = "test_TimeframeFile_legacy.o2tf";
+  writeTestFile(filename, 3, false);
+
+  MappedTimeframeFile file(filename);
+  BOOST_CHECK(file.hasIndex() == false);
+  checkFile(file, 3);
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TestCorruptedTimeframeFileIndex)
+{
+  std::string filename = "test_TimeframeFile_corrupted.o2tf";
+  // Overwrites @a size bytes at @a offset from the end of the file
+  auto patch = [&filename](long offset, void const *data, size_t size) {
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(-offset, std::ios::end);
+    file.write(reinterpret_cast<char const *>(data), size);
+  };
+  auto const trailerSize = sizeof(TimeframeFileTrailer);
+  auto const entrySize = sizeof(TimeframeFileIndexEntry);
+
+  // A number of entries which overflows once multiplied by the entry size
+  writeTestFile(filename, 2, true);
+  uint64_t entries = ~0ull / entrySize + 2;
+  patch(trailerSize - offsetof(TimeframeFileTrailer, entries), &entries, sizeof(entries));
+  BOOST_CHECK_THROW(MappedTimeframeFile{ filename }, std::runtime_error);
+
+  // An index offset past the end of the file
+  writeTestFile(filename, 2, true);
+  uint64_t indexOffset = ~0ull - 10;
+  patch(trailerSize - offsetof(TimeframeFileTrailer, indexOffset), &indexOffset, sizeof(indexOffset));
+  BOOST_CHECK_THROW(MappedTimeframeFile{ filename }, std::runtime_error);
+
+  // A payload of the last entry extending past the end of the file
+  writeTestFile(filename, 2, true);
+  uint64_t payloadSize = ~0ull - 10;
+  patch(trailerSize + entrySize - offsetof(TimeframeFileIndexEntry, payloadSize), &payloadSize, sizeof(payloadSize));
+  BOOST_CHECK_THROW(MappedTimeframeFile{ filename }, std::runtime_error);
+
+  // A timeframe number which would make the timeframe table explode
+  writeTestFile(filename, 2, true);
+  uint64_t timeframe = 1ull << 40;
+  patch(trailerSize + entrySize - offsetof(TimeframeFileIndexEntry, timeframe), &timeframe, sizeof(timeframe));
+  BOOST_CHECK_THROW(MappedTimeframeFile{ filename }, std::runtime_error);
+
+  // The untouched file is fine
+  writeTestFile(filename, 2, true);
+  MappedTimeframeFile file(filename);
+  checkFile(file, 2);
+  std::remove(filename.c_str());
+}
+
+// Builds the parts sent by the TimeframeReaderDevice in mmap mode, and runs
+// the same checks as the TimeframeValidatorDevice on them.
+BOOST_AUTO_TEST_CASE(TestTimeframeSelection)
+{
+  std::string filename = "test_TimeframeFile_selection.o2tf";
+  writeTestFile(filename, 2, true);
+  MappedTimeframeFile file(filename);
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+
+  auto send = [&transport, &file](TimeframeSelection const &selection) {
+    FairMQParts parts;
+    auto addPart = [&transport, &parts](char const *data, size_t size) {
+      auto message = transport->CreateMessage(size);
+      memcpy(message->GetData(), data, size);
+      parts.AddPart(std::move(message));
+    };
+    for (auto entry : selection.entries) {
+      addPart(file.data(entry->headerOffset), entry->headerSize);
+      addPart(file.data(entry->payloadOffset), entry->payloadSize);
+    }
+    if (selection.indexHeader.empty() == false) {
+      addPart(selection.indexHeader.data(), selection.indexHeader.size());
+      addPart(selection.indexPayload.data(), selection.indexPayload.size());
+    }
+    std::ostringstream out;
+    BOOST_CHECK_NO_THROW(streamTimeframe(out, parts));
+    return parts;
+  };
+
+  for (size_t tf = 0; tf < 2; ++tf) {
+    // Everything selected, the index of the file is sent as is
+    auto all = selectTimeframeParts(file, tf, [](TimeframeFileIndexEntry const &) { return true; });
+    BOOST_CHECK_EQUAL(all.entries.size(), 3);
+    BOOST_CHECK(all.indexHeader.empty());
+    BOOST_CHECK_EQUAL(send(all).Size(), 6);
+
+    // Only the TPC clusters, the index is rebuilt for them
+    auto tpc = selectTimeframeParts(file, tf, [](TimeframeFileIndexEntry const &entry) {
+      return entry.origin == DataOrigin("TPC") && entry.description == DataDescription("CLUSTERS");
+    });
+    BOOST_REQUIRE_EQUAL(tpc.entries.size(), 1);
+    BOOST_REQUIRE_EQUAL(tpc.indexPayload.size(), sizeof(IndexElement));
+    auto parts = send(tpc);
+    BOOST_REQUIRE_EQUAL(parts.Size(), 4);
+    auto indexHeader = reinterpret_cast<DataHeader const *>(parts.At(2)->GetData());
+    BOOST_CHECK(indexHeader->dataDescription == DataDescription("TIMEFRAMEINDEX"));
+    BOOST_CHECK_EQUAL(indexHeader->payloadSize, sizeof(IndexElement));
+    auto index = reinterpret_cast<IndexElement const *>(parts.At(3)->GetData());
+    BOOST_CHECK(index[0].first.dataOrigin == DataOrigin("TPC"));
+    BOOST_CHECK(index[0].first.dataDescription == DataDescription("CLUSTERS"));
+    BOOST_CHECK_EQUAL(index[0].first.payloadSize, 1000);
+    BOOST_CHECK_EQUAL(index[0].second, 0);
+
+    // Nothing selected, nothing to send
+    auto none = selectTimeframeParts(file, tf, [](TimeframeFileIndexEntry const &) { return false; });
+    BOOST_CHECK(none.entries.empty());
+    BOOST_CHECK(none.indexHeader.empty());
+  }
+  std::remove(filename.c_str());
+}
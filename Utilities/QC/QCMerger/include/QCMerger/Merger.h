@@ -11,34 +11,60 @@
 #pragma once
 
 #include <chrono>
+#include <string>
 #include <unordered_map>
 
-#include <TList.h>
+#include <TObject.h>
 
 namespace o2
 {
 namespace qc
 {
-typedef std::unordered_map<std::string, TList*> TCollectionMap;
-
+/// Merges the QC objects with the same title received from several producers.
+///
+/// Each received object is merged into the accumulated object of its title
+/// as soon as it arrives, so only one object per title is kept in memory and
+/// the merge cost is spread over the cycle. The accumulated object is
+/// returned once numberOfQCObjectsForCompleteData objects have been merged.
+///
+/// In delta mode the producers send only what they have filled since their
+/// last publication. The accumulated objects are then never reset, each
+/// complete cycle returns a copy of the running total.
+///
+/// The output of a merger can be the input of another one, so the objects of
+/// many producers can be reduced in a tree of MergerDevices. The mergers of
+/// the inner levels must not run in delta mode, they forward the sum of
+/// their inputs in each cycle.
 class Merger
 {
  public:
-  Merger(const int numberOfQCOgbjectForCompleteData);
+  Merger(const int numberOfQCOgbjectForCompleteData, const bool deltaMode = false);
   virtual ~Merger();
 
+  /// Merge the received object, which is owned by the merger from now on
+  /// \return the merged object when the data of a cycle is complete, owned by the caller, nullptr otherwise
   TObject* mergeObject(TObject* object);
-  TObject* mergeObjectWithGivenCollection(TObject* object);
-  void addReceivedObjectToMapByName(TObject* receivedObject);
   double getMergeTime();
   void dumpObjectsCollectionToFile(const char* title);
   void eraseCollection(const char* title);
 
  private:
-  TCollectionMap mTitlesToDataObjectsMap;
+  /// Object accumulated for one title
+  struct MergeEntry {
+    TObject* object{ nullptr };                ///< merged object, or running total in delta mode
+    int numberOfMergedObjects{ 0 };            ///< objects merged in the current cycle
+    std::chrono::microseconds mergeTime{ 0 }; ///< time spent merging in the current cycle
+  };
+
+  /// Merge source into target
+  /// \return false if the objects are not of a mergeable type
+  bool mergeInto(TObject* target, TObject* source) const;
+
+  std::unordered_map<std::string, MergeEntry> mTitlesToMergeEntries;
   std::chrono::microseconds mMergeTime{ 0 };
   unsigned int mNumberOfDumpedObjects{ 0 };
   const int NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA;
+  const bool DELTA_MODE;
 };
 }
-}
\ No newline at end of file
+}
@@ -11,9 +11,8 @@
 #include <FairMQLogger.h>
 
 #include <TH1.h>
-#include <TH2.h>
-#include <TH3.h>
-#include <THn.h>
+#include <THnBase.h>
+#include <TList.h>
 #include <TTree.h>
 
 #include "QCMerger/Merger.h"
@@ -26,99 +25,75 @@ namespace o2
 {
 namespace qc
 {
-Merger::Merger(const int numberOfQCOgbjectForCompleteData)
-  : NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA(numberOfQCOgbjectForCompleteData)
+Merger::Merger(const int numberOfQCOgbjectForCompleteData, const bool deltaMode)
+  : NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA(numberOfQCOgbjectForCompleteData), DELTA_MODE(deltaMode)
 {
 }
 
 TObject* Merger::mergeObject(TObject* object)
 {
-  auto foundEntry = mTitlesToDataObjectsMap.find(object->GetTitle());
+  auto foundEntry = mTitlesToMergeEntries.emplace(object->GetTitle(), MergeEntry()).first;
+  MergeEntry& entry = foundEntry->second;
 
-  if (foundEntry != mTitlesToDataObjectsMap.end() &&
-      foundEntry->second->GetSize() >= NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA - 1) {
-    TObject* output = mergeObjectWithGivenCollection(object);
-    eraseCollection(object->GetTitle());
-    return output;
+  if (entry.object == nullptr) {
+    entry.object = object;
   } else {
-    addReceivedObjectToMapByName(object);
+    auto measureTime = chrono::high_resolution_clock::now();
+    if (!mergeInto(entry.object, object)) {
+      LOG(ERROR) << "Object with type " << object->ClassName() << " is not one of mergable type.";
+    }
+    entry.mergeTime += chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - measureTime);
+    delete object;
+  }
+
+  if (++entry.numberOfMergedObjects < NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA) {
     return nullptr;
   }
+
+  mMergeTime = entry.mergeTime;
+  if (DELTA_MODE) {
+    entry.numberOfMergedObjects = 0;
+    entry.mergeTime = chrono::microseconds{ 0 };
+    return entry.object->Clone();
+  }
+  TObject* output = entry.object;
+  mTitlesToMergeEntries.erase(foundEntry);
+  return output;
 }
 
-void Merger::addReceivedObjectToMapByName(TObject* receivedObject)
+bool Merger::mergeInto(TObject* target, TObject* source) const
 {
-  auto foundList = mTitlesToDataObjectsMap.find(receivedObject->GetTitle());
-
-  if (foundList != mTitlesToDataObjectsMap.end()) {
-    foundList->second->Add(receivedObject);
+  TList mergeList;
+  mergeList.Add(source);
+
+  if (target->InheritsFrom(TH1::Class())) {
+    static_cast<TH1*>(target)->Merge(&mergeList);
+  } else if (target->InheritsFrom(THnBase::Class())) {
+    static_cast<THnBase*>(target)->Merge(&mergeList);
+  } else if (target->InheritsFrom(TTree::Class())) {
+    static_cast<TTree*>(target)->Merge(&mergeList);
   } else {
-    auto newItemIterator = mTitlesToDataObjectsMap.insert(make_pair(receivedObject->GetTitle(), new TList()));
-    newItemIterator.first->second->Add(receivedObject);
+    return false;
   }
+  return true;
 }
 
 void Merger::eraseCollection(const char* title)
 {
-  auto foundCollection = mTitlesToDataObjectsMap.find(title);
-  foundCollection->second->Delete();
-  delete foundCollection->second;
-  mTitlesToDataObjectsMap.erase(foundCollection);
+  auto foundEntry = mTitlesToMergeEntries.find(title);
+  delete foundEntry->second.object;
+  mTitlesToMergeEntries.erase(foundEntry);
 }
 
 void Merger::dumpObjectsCollectionToFile(const char* title)
 {
-  auto foundCollection = mTitlesToDataObjectsMap.find(title);
+  auto foundEntry = mTitlesToMergeEntries.find(title);
 
   ostringstream fileName;
   fileName << ++mNumberOfDumpedObjects << "_" << title << ".root";
-  foundCollection->second->SaveAs(fileName.str().c_str());
-  foundCollection->second->Delete();
-  delete foundCollection->second;
-  mTitlesToDataObjectsMap.erase(foundCollection);
-}
-
-TObject* Merger::mergeObjectWithGivenCollection(TObject* mergedObject)
-{
-  TCollection* mergeList = mTitlesToDataObjectsMap.find(mergedObject->GetTitle())->second;
-
-  TObject* result = nullptr;
-  TH1F* histogram1F = nullptr;
-  TH2F* histogram2F = nullptr;
-  TH3F* histogram3F = nullptr;
-  THnF* histogramNF = nullptr;
-  TTree* tree = nullptr;
-  const char* className = mergedObject->ClassName();
-
-  auto measureTime = chrono::high_resolution_clock::now();
-
-  if (strcmp(className, "TH1F") == 0) {
-    histogram1F = reinterpret_cast<TH1F*>(mergedObject);
-    histogram1F->Merge(mergeList);
-    result = histogram1F;
-  } else if (strcmp(className, "TH2F") == 0) {
-    histogram2F = reinterpret_cast<TH2F*>(mergedObject);
-    histogram2F->Merge(mergeList);
-    result = histogram2F;
-  } else if (strcmp(className, "TH3F") == 0) {
-    histogram3F = reinterpret_cast<TH3F*>(mergedObject);
-    histogram3F->Merge(mergeList);
-    result = histogram3F;
-  } else if (strcmp(className, "THnT<float>") == 0) {
-    histogramNF = reinterpret_cast<THnF*>(mergedObject);
-    histogramNF->Merge(mergeList);
-    result = histogramNF;
-  } else if (strcmp(className, "TTree") == 0) {
-    tree = reinterpret_cast<TTree*>(mergedObject);
-    tree->Merge(mergeList);
-    result = tree;
-  } else {
-    LOG(ERROR) << "Object with type " << className << " is not one of mergable type.";
-  }
-
-  mMergeTime = chrono::duration_cast<std::chrono::microseconds>(chrono::high_resolution_clock::now() - measureTime);
-
-  return mergedObject;
+  foundEntry->second.object->SaveAs(fileName.str().c_str());
+  delete foundEntry->second.object;
+  mTitlesToMergeEntries.erase(foundEntry);
 }
 
 double Merger::getMergeTime()
@@ -128,8 +103,8 @@ double Merger::getMergeTime()
 
 Merger::~Merger()
 {
-  for (auto const& entry : mTitlesToDataObjectsMap) {
-    entry.second->Delete();
+  for (auto const& entry : mTitlesToMergeEntries) {
+    delete entry.second.object;
   }
 }
 }
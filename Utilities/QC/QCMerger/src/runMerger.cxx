@@ -10,6 +10,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <sstream>
@@ -79,7 +80,7 @@ int main(int argc, char** argv)
 
   keyValue.putValue(inputAddress, stringLocalAddress.c_str());
 
-  if (argc != NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS + 1) {
+  if (argc != NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS + 1 && argc != NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS + 2) {
     LOG(ERROR) << "Not sufficient arguments value: " << NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS;
     exit(-1);
   }
@@ -88,6 +89,7 @@ int main(int argc, char** argv)
   const int NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA = atoi(argv[3]);
   const int INPUT_BUFFER_SIZE = atoi(argv[5]);
   const char* OUTPUT_HOST = argv[6];
+  const bool DELTA_MODE = argc > NUMBER_OF_REQUIRED_PROGRAM_PARAMETERS + 1 && strcmp(argv[7], "delta") == 0;
 
   bpo::options_description options("task-custom-cmd options");
   options.add_options()("help,h", "Produce help message");
@@ -96,7 +98,7 @@ int main(int argc, char** argv)
   bpo::store(bpo::command_line_parser(argc, argv).options(options).run(), vm);
   bpo::notify(vm);
 
-  MergerDevice mergerDevice(unique_ptr<Merger>(new Merger(NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA)), MERGER_DEVICE_ID);
+  MergerDevice mergerDevice(unique_ptr<Merger>(new Merger(NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA, DELTA_MODE)), MERGER_DEVICE_ID);
 
   LOG(INFO) << "PID: " << getpid();
   LOG(INFO) << "Merger id: " << mergerDevice.GetId();
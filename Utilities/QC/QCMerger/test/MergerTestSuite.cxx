@@ -63,4 +63,25 @@ BOOST_AUTO_TEST_CASE(mergeTenHistograms)
   }
 }
 
+BOOST_AUTO_TEST_CASE(mergeDeltaHistograms)
+{
+  const unsigned CYCLES_TO_TEST = 3;
+  unique_ptr<Merger> merger(new Merger(NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA, true));
+
+  for (int cycle = 1; cycle <= CYCLES_TO_TEST; ++cycle) {
+    TObject* mergedObject = nullptr;
+    for (int i = 0; i < NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA; ++i) {
+      BOOST_TEST(mergedObject == nullptr);
+      auto histogram = new TH1F(HISTOGRAM_NAME, HISTOGRAM_TITLE, NUMBER_OF_BINS, X_LOW, X_UP);
+      histogram->FillRandom(RANDOM_GENERATION_TYPE, NUMBER_OF_ENTRIES);
+      mergedObject = merger->mergeObject(histogram);
+    }
+
+    BOOST_REQUIRE(mergedObject != nullptr);
+    BOOST_TEST(reinterpret_cast<TH1F*>(mergedObject)->GetEntries() ==
+               (cycle * NUMBER_OF_QC_OBJECTS_FOR_COMPLETE_DATA * NUMBER_OF_ENTRIES));
+    delete mergedObject;
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -279,6 +279,15 @@ o2_define_bucket(
     dl
 )
 
+o2_define_bucket(
+    NAME
+    dataflow_benchmark_bucket
+
+    DEPENDENCIES
+    O2DeviceApplication_bucket
+    $<IF:$<BOOL:${benchmark_FOUND}>,benchmark::benchmark,$<0:"">>
+)
+
 o2_define_bucket(
     NAME
     InfoLogger_bucket
@@ -308,9 +317,11 @@ o2_define_bucket(
     AliceO2::Configuration
     InfoLogger_bucket
     AliceO2::Common
+    ${CURL_LIBRARIES}
 
     SYSTEMINCLUDE_DIRECTORIES
     ${CMAKE_SOURCE_DIR}/Utilities/PCG/include
+    ${CURL_INCLUDE_DIRS}
 )
 
 o2_define_bucket(
@@ -366,6 +377,15 @@ o2_define_bucket(
     ${CMAKE_SOURCE_DIR}/DataFormats/MemoryResources/include
 )
 
+o2_define_bucket(
+    NAME
+    data_format_headers_benchmark_bucket
+
+    DEPENDENCIES
+    data_format_headers_bucket
+    $<IF:$<BOOL:${benchmark_FOUND}>,benchmark::benchmark,$<0:"">>
+)
+
 # module DataFormats/Detectors/TPC
 o2_define_bucket(
     NAME
@@ -469,6 +489,15 @@ o2_define_bucket(
     ${CMAKE_SOURCE_DIR}/Common/Constants/include
 )
 
+o2_define_bucket(
+    NAME
+    common_math_benchmark_bucket
+
+    DEPENDENCIES
+    common_math_bucket
+    $<IF:$<BOOL:${benchmark_FOUND}>,benchmark::benchmark,$<0:"">>
+)
+
 o2_define_bucket(
     NAME
     common_field_bucket
@@ -1113,6 +1142,15 @@ o2_define_bucket(
     ${MS_GSL_INCLUDE_DIR}
 )
 
+o2_define_bucket(
+    NAME
+    tpc_simulation_benchmark_bucket
+
+    DEPENDENCIES
+    tpc_simulation_bucket
+    $<IF:$<BOOL:${benchmark_FOUND}>,benchmark::benchmark,$<0:"">>
+)
+
 
 o2_define_bucket(
     NAME
@@ -1206,11 +1244,13 @@ o2_define_bucket(
 
     DEPENDENCIES
     TPCReconstruction
+    TPCCalibration
     Framework
     DPLUtils
 
     INCLUDE_DIRECTORIES
     ${CMAKE_SOURCE_DIR}/Algorithm/include
+    ${CMAKE_SOURCE_DIR}/Detectors/TPC/calibration/include
    )
 
 # base bucket for generators not needing any external stuff
@@ -1674,6 +1714,15 @@ o2_define_bucket(
     ${CMAKE_SOURCE_DIR}/Common/MathUtils/include
 )
 
+o2_define_bucket(
+    NAME
+    hmpid_simulation_benchmark_bucket
+
+    DEPENDENCIES
+    hmpid_simulation_bucket
+    $<IF:$<BOOL:${benchmark_FOUND}>,benchmark::benchmark,$<0:"">>
+)
+
 
 o2_define_bucket(
     NAME
@@ -2072,6 +2121,15 @@ o2_define_bucket(
     ${CMAKE_SOURCE_DIR}/Detectors/MUON/MCH/Base/include
 )
 
+o2_define_bucket(
+    NAME
+    mch_preclustering_benchmark_bucket
+
+    DEPENDENCIES
+    mch_preclustering_bucket
+    $<IF:$<BOOL:${benchmark_FOUND}>,benchmark::benchmark,$<0:"">>
+)
+
 o2_define_bucket(
     NAME
     data_format_itsmft_bucket